@@ -1,6 +1,7 @@
 #pragma once
 
 #include "buffer.h"
+#include "executor.h"
 #include <functional>
 #include <memory>
 #include <string>
@@ -13,6 +14,7 @@ namespace video_pipeline {
 // Forward declarations
 class IBlock;
 class IPipeline;
+class FramePool;
 
 /**
  * @brief Block states
@@ -38,10 +40,14 @@ using BlockParams = std::map<std::string, std::string>;
 struct BlockStats {
     uint64_t frames_processed{0};
     uint64_t frames_dropped{0};
+    uint64_t frames_skipped{0};        // Not produced for lack of downstream credit
     uint64_t bytes_processed{0};
     double avg_fps{0.0};
     double avg_latency_ms{0.0};
     uint32_t queue_depth{0};
+    uint64_t frames_written_in_place{0};   // MakeWritable() without a copy
+    uint64_t frames_copied_on_write{0};    // MakeWritable() that had to copy
+    uint64_t buffered_bytes{0};            // Frames the block holds on to (e.g. a pre-roll ring)
     std::chrono::steady_clock::time_point last_frame_time;
 };
 
@@ -84,6 +90,11 @@ public:
     virtual BlockParams GetConfiguration() const = 0;
     virtual bool SetParameter(const std::string& key, const std::string& value) = 0;
     virtual std::string GetParameter(const std::string& key) const = 0;
+    
+    // Live reconfiguration: parameters that may change while the block runs,
+    // and applying such a change (false if `key` is not hot-reloadable)
+    virtual bool IsHotParameter(const std::string& /*key*/) const { return false; }
+    virtual bool UpdateParameter(const std::string& /*key*/, const std::string& /*value*/) { return false; }
 };
 
 using BlockPtr = std::shared_ptr<IBlock>;
@@ -113,6 +124,25 @@ public:
     BlockParams GetConfiguration() const override;
     bool SetParameter(const std::string& key, const std::string& value) override;
     std::string GetParameter(const std::string& key) const override;
+    
+    // Records the value; a running block applies it on its own thread between
+    // two frames (see ApplyPendingParameters), a stopped one immediately
+    bool UpdateParameter(const std::string& key, const std::string& value) override;
+    
+    // Scheduled execution: run as tasks on a shared executor instead of
+    // block-owned threads (set before Start; nullptr = own threads). Reads
+    // the `executor_priority` and `executor_worker` hints. Tasks are posted
+    // to the executor's task `group`.
+    void SetExecutor(std::shared_ptr<Executor> executor, int group = 0);
+    const std::shared_ptr<Executor>& GetExecutor() const { return executor_; }
+    
+    // Frames from AllocateFrame() come from `pool`, charged to `client`
+    // (set before Start; nullptr = allocated privately)
+    void SetFramePool(std::shared_ptr<FramePool> pool, int client = 0);
+    
+    // Placement of the block's own threads, from the `cpu_affinity`,
+    // `sched_policy`, `sched_priority` and `thread_name` parameters
+    ThreadSettings GetThreadSettings() const;
 
 protected:
     // Helper methods for derived classes
@@ -120,12 +150,44 @@ protected:
     void SetError(const std::string& error);
     void UpdateStats(bool frame_processed = true, size_t bytes = 0, bool dropped = false);
     
+    // Called first thing on every thread the block starts
+    void ApplyThreadSettings();
+    
+    // New frame from the shared frame pool if one is set, else a private
+    // allocation. nullptr (counted as a dropped frame) if the pool refuses.
+    VideoFramePtr AllocateFrame(const FrameInfo& info, size_t capacity = 0,
+                                const FrameMemoryOptions& memory = FrameMemoryOptions{});
+    
+    // Reads `wait_strategy` and `spin_us` into wait_strategy_/spin_time_
+    void ConfigureWaitStrategy();
+    
+    // Apply one hot parameter accepted by IsHotParameter(); runs on the
+    // block's frame thread, so it may touch state the frame path uses
+    virtual void ApplyParameter(const std::string& /*key*/, const std::string& /*value*/) {}
+    
+    // Called by frame loops at frame boundaries; cheap when nothing is pending
+    void ApplyPendingParameters();
+    
     // Thread safety
     mutable std::mutex mutex_;
     
     // Make stats accessible to derived classes
     BlockStats stats_;
     
+    // Scheduled execution
+    std::shared_ptr<Executor> executor_;
+    TaskPriority executor_priority_{TaskPriority::NORMAL};
+    int executor_worker_{-1};
+    int executor_group_{0};
+    
+    // Shared frame memory
+    std::shared_ptr<FramePool> frame_pool_;
+    int frame_pool_client_{0};
+    
+    // How the block's threads wait for frames and frame deadlines
+    WaitStrategy wait_strategy_{WaitStrategy::BLOCK};
+    std::chrono::microseconds spin_time_{50};
+    
 private:
     std::string name_;
     std::string type_;
@@ -134,6 +196,12 @@ private:
     std::string last_error_;
     ErrorCallback error_callback_;
     BlockParams params_;
+    
+    void ApplyParameters(const BlockParams& params);
+    
+    // Hot parameter updates waiting for the next frame boundary (under mutex_)
+    BlockParams pending_params_;
+    std::atomic<bool> params_pending_{false};
 };
 
 } // namespace video_pipeline
\ No newline at end of file
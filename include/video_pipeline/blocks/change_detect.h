@@ -0,0 +1,72 @@
+#pragma once
+
+#include "video_pipeline/video_processor.h"
+#include <cstdint>
+#include <vector>
+
+namespace video_pipeline {
+
+/**
+ * @brief Detects changes against a running background
+ *
+ * Each frame's luma is box-filtered down by `scale` and compared with a
+ * background that follows the scene with a time constant of
+ * `background_frames` frames. The sum of absolute differences is taken per
+ * tile; tiles whose mean difference exceeds `threshold` are marked in a
+ * ChangeMap attached to the frame (FrameInfo::change), and the frame counts
+ * as changed when at least `min_tiles` of them are. With `gate` set only
+ * changed frames, and those within `hold_ms` after one, are forwarded, so
+ * the branch behind it runs only while something happens. Pixels are never
+ * copied; a frame shared with other branches is forwarded as a view, while
+ * one that only its upstream pool still holds is annotated in place. Frames
+ * the gate holds back count as dropped.
+ */
+class ChangeDetect : public BaseVideoProcessor {
+public:
+    ChangeDetect();
+    ~ChangeDetect() override;
+
+    // IVideoSink/IVideoSource implementation
+    bool SupportsFormat(PixelFormat format) const override;
+    std::vector<PixelFormat> GetSupportedFormats() const override;
+
+    // IBlock implementation
+    bool Initialize(const BlockParams& params) override;
+    bool Start() override;
+
+    // `threshold` and `min_tiles` can be tuned while running
+    bool IsHotParameter(const std::string& key) const override;
+
+protected:
+    bool ProcessFrameImpl(VideoFramePtr frame) override;
+    void ApplyParameter(const std::string& key, const std::string& value) override;
+
+private:
+    // Box-filtered luma of `frame` into luma_; false for unusable frames
+    bool DownsampleLuma(const IVideoFrame& frame);
+
+    // Compare luma_ with the background and learn it
+    std::shared_ptr<ChangeMap> Compare();
+
+    // Settings
+    uint32_t scale_{4};               // Luma downsampling factor (1, 2, 4 or 8)
+    uint32_t tile_size_{16};          // Tile edge in downsampled pixels
+    uint32_t threshold_{10};          // Mean absolute difference of a changed tile
+    uint32_t min_tiles_{1};
+    uint32_t learn_shift_{5};         // Background learns 1/2^shift of each frame
+    bool gate_{false};
+    uint64_t hold_us_{1000000};
+
+    // Frame path state (worker thread only)
+    uint32_t luma_width_{0};
+    uint32_t luma_height_{0};
+    std::vector<uint16_t> row_sums_;      // Vertical sums of `scale_` source rows
+    std::vector<uint8_t> luma_;
+    std::vector<uint16_t> background_;    // 8.8 fixed point, empty until the first frame
+    std::vector<uint16_t> column_sums_;   // Differences over one row of tiles
+    std::vector<uint32_t> tile_sums_;
+    uint64_t last_change_us_{0};
+    bool holding_{false};
+};
+
+} // namespace video_pipeline
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "video_pipeline/video_processor.h"
+#include "video_pipeline/threading.h"
+#include <memory>
+#include <vector>
+
+namespace video_pipeline {
+
+/**
+ * @brief Converts frames between uncompressed pixel formats
+ *
+ * Rows are converted in pairs through a 4-byte-per-pixel intermediate (RGBA or
+ * YUVA), so 4:2:0 chroma is read and averaged once per row pair. RGB and YUV
+ * are related by the BT.601 full-range matrix used by JpegEncode. Conversions
+ * within one family (RGB swizzles, YUV420P/NV12/NV21, YUYV/UYVY) do not go
+ * through the matrix. Byte reorders between formats of the same layout (e.g.
+ * RGB24/BGR24, NV12/NV21) rewrite a frame no other block holds in place.
+ * Frames already in the target format are forwarded untouched. PipelineManager
+ * inserts this block when format negotiation finds no common format between
+ * two connected blocks.
+ */
+class ColorConvert : public BaseVideoProcessor {
+public:
+    ColorConvert();
+    ~ColorConvert() override;
+
+    // IVideoSink/IVideoSource implementation
+    bool SupportsFormat(PixelFormat format) const override;
+    std::vector<PixelFormat> GetSupportedFormats() const override;
+
+    // IBlock implementation
+    bool Initialize(const BlockParams& params) override;
+    bool Shutdown() override;
+
+    // ColorConvert specific
+    bool SetTargetFormat(PixelFormat format);
+    PixelFormat GetTargetFormat() const { return target_format_; }
+
+    // Relative cost of converting `from` to `to`: 0 for the same format, 1 for
+    // a byte shuffle, 2 for chroma resampling, 3 for an RGB/YUV matrix; -1 if
+    // the block cannot convert between them
+    static int ConversionCost(PixelFormat from, PixelFormat to);
+
+    std::unique_ptr<RowStage> CreateRowStage() const override;
+
+protected:
+    bool ProcessFrameImpl(VideoFramePtr frame) override;
+    FrameInfo DeriveOutputFormat(const FrameInfo& input) const override;
+
+private:
+    class Stage;
+
+    // Reorder the bytes of a frame of the same layout without a new frame
+    bool ConvertInPlace(VideoFramePtr frame);
+
+    PixelFormat target_format_{PixelFormat::RGB24};
+    size_t thread_count_{1};
+
+    std::unique_ptr<ThreadPool> thread_pool_;
+    std::vector<std::vector<uint8_t>> scratch_;     // Intermediate row pair per band
+};
+
+} // namespace video_pipeline
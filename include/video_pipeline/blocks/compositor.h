@@ -0,0 +1,108 @@
+#pragma once
+
+#include "video_pipeline/video_source.h"
+#include "video_pipeline/video_sink.h"
+#include "video_pipeline/blocks/scale.h"
+#include "video_pipeline/threading.h"
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace video_pipeline {
+
+class RowStage;
+
+/**
+ * @brief Combines several input streams into one frame (mosaic / multiview)
+ *
+ * Inputs connect to the ports `input0`..`input<N-1>`. Each port keeps only the
+ * latest frame it received, so a slow or stalled input never holds the others
+ * back. At its own frame rate the block produces a frame with each input
+ * scaled into its tile: a grid by default, or `rect<i>` rectangles, later
+ * ports drawn over earlier ones. Tiles are redrawn only when their input
+ * changed, into a canvas that is copied into each output frame. Inputs must
+ * be in the output format; format negotiation inserts converters for those
+ * that are not.
+ */
+class Compositor : public BaseVideoSource, public IVideoSink {
+public:
+    Compositor();
+    ~Compositor() override;
+
+    // IVideoSource implementation
+    FrameInfo GetOutputFormat() const override { return output_format_; }
+    bool SetOutputFormat(const FrameInfo& format) override;
+    std::vector<std::pair<uint32_t, uint32_t>> GetSupportedResolutions() const override { return {}; }
+
+    // IVideoSource/IVideoSink: inputs and output share the canvas format
+    bool SupportsFormat(PixelFormat format) const override;
+    std::vector<PixelFormat> GetSupportedFormats() const override;
+
+    // IVideoSink implementation: one latest-frame slot per port, never full
+    bool ProcessFrame(VideoFramePtr frame) override;
+    bool PushFrame(VideoFramePtr frame, const EdgePolicy& policy) override;
+    std::vector<std::string> GetInputPorts() const override;
+    FrameInfo GetInputFormat() const override { return input_format_; }
+    bool SetInputFormat(const FrameInfo& format) override;
+    size_t GetQueueDepth() const override { return 0; }
+    size_t GetMaxQueueDepth() const override { return 1; }
+    bool SetMaxQueueDepth(size_t /*depth*/) override { return true; }
+    bool IsBlocking() const override { return false; }
+    void SetBlocking(bool /*blocking*/) override {}
+
+    // IBlock implementation
+    bool Initialize(const BlockParams& params) override;
+    bool Start() override;
+    bool Stop() override;
+    bool Shutdown() override;
+
+protected:
+    bool ProduceFrame() override;
+
+private:
+    struct Rect {
+        uint32_t x{0};
+        uint32_t y{0};
+        uint32_t width{0};
+        uint32_t height{0};
+    };
+
+    struct Tile {
+        Rect rect;
+
+        // Latest input (under slots_mutex_); `serial` counts frames received,
+        // `taken` is the serial last picked up for drawing
+        VideoFramePtr frame;
+        uint64_t serial{0};
+        uint64_t taken{0};
+        std::chrono::steady_clock::time_point received;
+
+        // Producer side: serial on the canvas (0 = background) and the
+        // scaler sized for the current input
+        uint64_t drawn{0};
+        std::unique_ptr<Scale> scale;
+        std::unique_ptr<RowStage> stage;
+    };
+
+    bool ParseLayout();
+    void ResetCanvas();
+    void DrawTile(Tile& tile, const VideoFramePtr& frame);
+
+    // Configuration
+    FrameInfo input_format_;
+    size_t input_count_{4};
+    bool keep_aspect_{false};
+    std::chrono::milliseconds stale_after_{0};  // 0 = keep showing the last frame
+    uint8_t background_[3]{0, 0, 0};            // RGB
+    ScaleMethod method_{ScaleMethod::BILINEAR};
+    bool tiles_overlap_{false};
+
+    std::vector<Tile> tiles_;
+    std::mutex slots_mutex_;
+
+    std::vector<uint8_t> canvas_;
+    std::unique_ptr<ThreadPool> thread_pool_;
+};
+
+} // namespace video_pipeline
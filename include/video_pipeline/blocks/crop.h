@@ -0,0 +1,52 @@
+#pragma once
+
+#include "video_pipeline/video_processor.h"
+
+namespace video_pipeline {
+
+/**
+ * @brief Extracts a region of interest without copying
+ *
+ * Each output frame is a view (see CreateFrameView) into the input frame, so
+ * the cost is independent of the frame size. The output keeps the input's
+ * stride; the rectangle is clipped to the frame and aligned to chroma sample
+ * boundaries for subsampled formats.
+ */
+class Crop : public BaseVideoProcessor {
+public:
+    Crop();
+    ~Crop() override;
+
+    // IVideoSink/IVideoSource implementation
+    bool SupportsFormat(PixelFormat format) const override;
+    std::vector<PixelFormat> GetSupportedFormats() const override;
+
+    // IBlock implementation
+    bool Initialize(const BlockParams& params) override;
+
+    // Crop specific (width/height 0 = up to the right/bottom edge)
+    bool SetRegion(uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+
+    std::unique_ptr<RowStage> CreateRowStage() const override;
+
+protected:
+    bool ProcessFrameImpl(VideoFramePtr frame) override;
+    FrameInfo DeriveOutputFormat(const FrameInfo& input) const override;
+
+private:
+    class Stage;
+
+    struct Region {
+        uint32_t x{0};
+        uint32_t y{0};
+        uint32_t width{0};
+        uint32_t height{0};
+    };
+
+    // Region clipped to a frame of the given size (width/height 0 if empty)
+    Region ClipRegion(uint32_t frame_width, uint32_t frame_height) const;
+
+    Region region_;
+};
+
+} // namespace video_pipeline
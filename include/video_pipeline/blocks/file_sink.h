@@ -13,7 +13,8 @@ enum class FileFormat {
     RAW = 0,        // Raw frame data
     PPM,            // Portable Pixmap (for RGB formats)
     PGM,            // Portable Graymap (for Y plane)
-    YUV             // Raw YUV data
+    YUV,            // Raw YUV data
+    QOI             // Lossless QOI images (RGB24/RGBA32 encoded on write, QOI frames as-is)
 };
 
 /**
@@ -44,6 +45,10 @@ public:
     
     size_t GetFramesWritten() const { return frames_written_; }
     
+    // Write one frame on the calling thread, bypassing the queue (for blocks
+    // that own a FileSink, e.g. PreRollRecorder); the sink need not be started
+    bool WriteFrame(VideoFramePtr frame);
+    
 protected:
     bool ProcessFrameImpl(VideoFramePtr frame) override;
     
@@ -52,6 +57,10 @@ private:
     bool WriteFramePPM(VideoFramePtr frame);
     bool WriteFramePGM(VideoFramePtr frame);
     bool WriteFrameYUV(VideoFramePtr frame);
+    bool WriteFrameQOI(VideoFramePtr frame);
+    
+    // Compressed payload, or the visible rows of every plane without padding
+    void WritePixels(const IVideoFrame& frame);
     
     std::string GenerateFilename(const std::string& base_path, size_t frame_number, const std::string& extension);
     bool OpenOutputFile(const std::string& filename);
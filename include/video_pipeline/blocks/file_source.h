@@ -0,0 +1,78 @@
+#pragma once
+
+#include "video_pipeline/video_source.h"
+#include "video_pipeline/blocks/file_sink.h"
+#include "video_pipeline/threading.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace video_pipeline {
+
+/**
+ * @brief Video source that plays back recordings written by FileSink
+ *
+ * Reads either a single file (memory-mapped) or a numbered sequence
+ * `<path>_NNNNNN.<ext>` as produced by FileSink in multi-file mode.
+ * Supports raw frames (geometry from `width`/`height`/`format`) and QOI
+ * images, which are decoded to RGB24/RGBA32 or passed on as QOI frames.
+ */
+class FileSource : public BaseVideoSource {
+public:
+    FileSource();
+    virtual ~FileSource();
+
+    // IVideoSource implementation
+    FrameInfo GetOutputFormat() const override { return output_format_; }
+    bool SetOutputFormat(const FrameInfo& format) override;
+
+    bool SupportsFormat(PixelFormat format) const override;
+    std::vector<PixelFormat> GetSupportedFormats() const override;
+    std::vector<std::pair<uint32_t, uint32_t>> GetSupportedResolutions() const override { return {}; }
+
+    // IBlock implementation
+    bool Initialize(const BlockParams& params) override;
+    bool Start() override;
+    bool Stop() override;
+    bool Shutdown() override;
+
+    // File source specific
+    std::string GetInputPath() const { return input_path_; }
+    FileFormat GetFileFormat() const { return file_format_; }
+    size_t GetFramesRead() const { return frames_read_; }
+
+protected:
+    bool ProduceFrame() override;
+
+private:
+    VideoFramePtr ReadNextFrame();
+    bool OpenInput();
+    void CloseInput();
+    void Rewind();
+
+    bool MapFile(const std::string& filename);
+    bool LoadSequenceFile(size_t index);
+    std::string SequenceFilename(size_t index) const;
+
+    std::string input_path_;
+    FileFormat file_format_{FileFormat::RAW};
+    bool loop_{false};
+    bool decode_{true};         // QOI: decode to RGB, or emit QOI frames
+    uint8_t decode_channels_{0}; // 0 = as stored in the stream
+    size_t thread_count_{1};
+    std::atomic<size_t> frames_read_{0};
+    size_t frames_since_rewind_{0};
+
+    // Input: one mapped file, or the current file of a numbered sequence
+    bool sequence_{false};
+    const uint8_t* map_data_{nullptr};
+    size_t map_size_{0};
+    std::vector<uint8_t> sequence_data_;
+    size_t sequence_index_{0};
+    size_t read_offset_{0};
+
+    std::unique_ptr<ThreadPool> thread_pool_;
+};
+
+} // namespace video_pipeline
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "video_pipeline/video_processor.h"
+#include <cstdint>
+#include <vector>
+
+namespace video_pipeline {
+
+/**
+ * @brief Converts a stream to a fixed frame rate after a fan-out
+ *
+ * Output slots are laid on a grid of 1/fps from the first frame's timestamp.
+ * A frame is forwarded when it is the first to reach the next slot and
+ * dropped otherwise, so one branch can run at a fraction of the source rate
+ * while the source and other branches keep theirs. In `convert` mode slots
+ * that pass without a frame of their own repeat the previous frame: the
+ * repeat is a view of the same pixels (CreateFrameView) stamped with the
+ * slot time, so duplication never copies. Frames without a timestamp are
+ * timed on arrival.
+ */
+class FrameRateConvert : public BaseVideoProcessor {
+public:
+    FrameRateConvert();
+    ~FrameRateConvert() override;
+
+    // IVideoSink/IVideoSource implementation
+    bool SupportsFormat(PixelFormat format) const override;
+    std::vector<PixelFormat> GetSupportedFormats() const override;
+
+    // IBlock implementation
+    bool Initialize(const BlockParams& params) override;
+    bool Start() override;
+    bool Stop() override;
+
+    // `fps` can change while running; the slot already due keeps its time and
+    // later slots use the new interval
+    bool IsHotParameter(const std::string& key) const override;
+
+    // FrameRateConvert specific
+    bool SetDuplicate(bool duplicate);
+    bool GetDuplicate() const { return duplicate_; }
+
+protected:
+    bool ProcessFrameImpl(VideoFramePtr frame) override;
+    void ApplyParameter(const std::string& key, const std::string& value) override;
+
+private:
+    // Forget the grid; the next frame starts a new one
+    void ResetTiming();
+
+    bool duplicate_{false};
+    size_t max_repeat_{0};            // Repeats per gap; 0 = one second of slots
+
+    // Frame path state (worker thread only)
+    bool started_{false};
+    uint64_t next_slot_us_{0};
+    uint64_t input_interval_us_{0};   // Smoothed spacing of the input frames
+    uint64_t last_input_us_{0};
+    VideoFramePtr previous_;
+};
+
+} // namespace video_pipeline
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "video_pipeline/video_processor.h"
+#include "video_pipeline/threading.h"
+#include <memory>
+#include <vector>
+
+namespace video_pipeline {
+
+/**
+ * @brief Runs a chain of per-row transforms as one pass over the frame
+ *
+ * PipelineManager replaces runs of adjacent fusable processors (see
+ * BaseVideoProcessor::CreateRowStage) with one FusedTransform. Output frames
+ * are produced in strips of rows sized so that a strip of every frame in the
+ * chain fits in half the L2 cache: each stage reads the strip the previous
+ * one has just written while it is still in cache, and the frames between
+ * the stages never exist in full. Crops are windows into the strip before
+ * them. With `threads` > 1 the strips are split into bands processed in
+ * parallel. `strip_rows` overrides the strip height.
+ */
+class FusedTransform : public BaseVideoProcessor {
+public:
+    FusedTransform();
+    ~FusedTransform() override;
+
+    // IVideoSink/IVideoSource implementation (the first stage's formats)
+    bool SupportsFormat(PixelFormat format) const override;
+    std::vector<PixelFormat> GetSupportedFormats() const override;
+
+    // IBlock implementation
+    bool Initialize(const BlockParams& params) override;
+    bool Shutdown() override;
+
+    // Append a stage; stages run in the order added. Call before Initialize().
+    // The processor only supplies its settings and must not run itself.
+    bool AddStage(std::shared_ptr<BaseVideoProcessor> processor);
+    const std::vector<std::shared_ptr<BaseVideoProcessor>>& GetStages() const { return stages_; }
+
+    // Output rows per strip for the current input (0 before the first frame)
+    uint32_t GetStripRows() const { return strip_rows_; }
+
+protected:
+    bool ProcessFrameImpl(VideoFramePtr frame) override;
+    FrameInfo DeriveOutputFormat(const FrameInfo& input) const override;
+
+private:
+    struct Band;
+
+    bool Configure(const FrameInfo& input);
+
+    std::vector<std::shared_ptr<BaseVideoProcessor>> stages_;
+    std::vector<std::unique_ptr<Band>> bands_;     // Stage instances and strip buffers per thread
+    FrameInfo configured_input_;
+    FrameInfo configured_output_;
+    uint32_t strip_rows_{0};
+    uint32_t fixed_strip_rows_{0};  // `strip_rows`; 0 = sized to the L2 cache
+    size_t thread_count_{1};
+
+    std::unique_ptr<ThreadPool> thread_pool_;
+};
+
+} // namespace video_pipeline
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "video_pipeline/video_processor.h"
+#include "video_pipeline/threading.h"
+#include <memory>
+
+namespace video_pipeline {
+
+/**
+ * @brief JPEG chroma subsampling modes
+ */
+enum class JpegSubsampling {
+    AUTO = 0,   // Native subsampling of the input (4:2:2 for YUYV/UYVY, 4:2:0 otherwise)
+    YUV420,
+    YUV422
+};
+
+class JpegEncoder;
+
+/**
+ * @brief Baseline JPEG encoder producing MJPEG frames
+ *
+ * Self-contained (no external codec library). Accepts packed RGB, packed
+ * 4:2:2 YUV and 4:2:0 planar/semi-planar YUV without an intermediate RGB
+ * conversion. When `threads` > 1 the frame is split into restart-interval
+ * slices that are entropy coded in parallel and stitched with RSTn markers.
+ */
+class JpegEncode : public BaseVideoProcessor {
+public:
+    JpegEncode();
+    ~JpegEncode() override;
+    
+    // IVideoSink/IVideoSource implementation
+    bool SupportsFormat(PixelFormat format) const override;
+    std::vector<PixelFormat> GetSupportedFormats() const override;
+    
+    // IBlock implementation
+    bool Initialize(const BlockParams& params) override;
+    bool Shutdown() override;
+    
+    // Live reconfiguration: `quality` in addition to the sink parameters
+    bool IsHotParameter(const std::string& key) const override;
+    
+    // JPEG encoder specific
+    bool SetQuality(int quality);
+    int GetQuality() const { return quality_; }
+    
+    bool SetSubsampling(JpegSubsampling subsampling);
+    JpegSubsampling GetSubsampling() const { return subsampling_; }
+    
+protected:
+    bool ProcessFrameImpl(VideoFramePtr frame) override;
+    FrameInfo DeriveOutputFormat(const FrameInfo& input) const override;
+    void ApplyParameter(const std::string& key, const std::string& value) override;
+    
+private:
+    int quality_{85};
+    JpegSubsampling subsampling_{JpegSubsampling::AUTO};
+    size_t thread_count_{1};
+    uint32_t restart_rows_{0};  // MCU rows per restart interval (0 = one slice per thread)
+    
+    std::unique_ptr<JpegEncoder> encoder_;
+    std::unique_ptr<ThreadPool> thread_pool_;
+};
+
+} // namespace video_pipeline
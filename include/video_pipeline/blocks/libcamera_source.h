@@ -12,6 +12,8 @@ struct LibcameraBuffer {
     libcamera::FrameBuffer* buffer{nullptr};
     void* mapped{nullptr};
     size_t length{0};
+    int fd{-1};                 // dmabuf of plane 0, owned by the FrameBuffer
+    size_t offset{0};           // Offset of plane 0 in the dmabuf
 };
 
 /**
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "video_pipeline/video_sink.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace video_pipeline {
+
+class FileSink;
+
+/**
+ * @brief How PreRollRecorder keeps the frames it holds
+ */
+enum class PreRollStorage {
+    REFERENCE = 0,  // The frames themselves (zero-copy); only for sources that allocate every
+                    // frame, since held camera buffers stall capture. Pool frames are copied.
+    COPY,           // Private copies, so camera buffers and pool frames go back at once (default)
+    QOI             // QOI-compressed copies of RGB24/RGBA32 frames; other formats are copied
+};
+
+/**
+ * @brief Records clips that begin before the event that triggers them
+ *
+ * The last `pre_seconds` of frames are kept in a ring. A trigger - a frame
+ * that ChangeDetect marked as changed (`trigger=change`), Trigger(), or
+ * setting the hot parameter `record=true` - starts a clip with the ring's
+ * frames and continues it with live frames until `post_seconds` after the
+ * last trigger. Clips are written on a writer thread by a FileSink with
+ * this block's `path`, `format` and `single_file`, one per event
+ * (`<path>_<clip>`), so slow storage never stalls capture. By default the
+ * ring holds copies, so upstream camera buffers and pool frames go back at
+ * once. The ring and frames waiting to be written
+ * together stay within `max_memory_mb`: the ring loses its oldest frames,
+ * and while the writer falls behind new frames are dropped. The memory in
+ * use is reported as BlockStats::buffered_bytes.
+ */
+class PreRollRecorder : public BaseVideoSink {
+public:
+    PreRollRecorder();
+    ~PreRollRecorder() override;
+
+    // IVideoSink implementation
+    bool SupportsFormat(PixelFormat format) const override;
+    std::vector<PixelFormat> GetSupportedFormats() const override;
+
+    // IBlock implementation
+    bool Initialize(const BlockParams& params) override;
+    bool Start() override;
+    bool Stop() override;
+    bool Shutdown() override;
+    BlockStats GetStats() const override;
+
+    // `record` triggers (true) or ends (false) a clip while running
+    bool IsHotParameter(const std::string& key) const override;
+
+    // Start a clip with the next frame, or extend the current one; any thread
+    void Trigger() { trigger_requested_.store(true, std::memory_order_release); }
+
+    bool IsRecording() const { return recording_.load(std::memory_order_relaxed); }
+    uint64_t GetClipsWritten() const { return clips_written_.load(); }
+    uint64_t GetFramesWritten() const { return frames_written_.load(); }
+    size_t GetBufferedBytes() const { return buffered_bytes_.load(); }
+
+protected:
+    bool ProcessFrameImpl(VideoFramePtr frame) override;
+    void ApplyParameter(const std::string& key, const std::string& value) override;
+
+private:
+    struct StoredFrame {
+        VideoFramePtr frame;        // Null: end of clip
+        PixelFormat format{PixelFormat::UNKNOWN};  // Before compression
+        uint64_t timestamp_us{0};
+        size_t bytes{0};
+        uint64_t clip{0};
+    };
+
+    // Frame as the ring keeps it under storage_; null if it could not be made
+    VideoFramePtr StoreFrame(const VideoFramePtr& frame);
+
+    // Drop ring frames older than the pre-roll and, oldest first, until
+    // buffered_bytes_ is within the limit
+    void TrimRing(uint64_t now_us);
+
+    void QueueForWriting(StoredFrame entry);
+    void WriterThread();
+    std::unique_ptr<FileSink> OpenClip(uint64_t clip);
+
+    // Settings
+    uint64_t pre_us_{5000000};
+    uint64_t post_us_{5000000};
+    size_t max_bytes_{256u << 20};
+    PreRollStorage storage_{PreRollStorage::COPY};
+    bool trigger_on_change_{false};
+    std::string path_{"clip"};
+    std::string format_{"raw"};
+    bool single_file_{false};
+
+    // Frame path state (worker thread only)
+    std::deque<StoredFrame> ring_;
+    uint64_t record_until_us_{0};
+    uint64_t clip_{0};              // Last clip started; kept across restarts so files are not reused
+
+    std::atomic<bool> trigger_requested_{false};
+    std::atomic<bool> recording_{false};
+    std::atomic<size_t> buffered_bytes_{0};     // Ring and frames waiting for the writer
+
+    // Writer thread
+    std::deque<StoredFrame> write_queue_;
+    std::mutex write_mutex_;
+    std::condition_variable write_condition_;
+    std::thread writer_thread_;
+    bool stop_writer_{false};
+    std::atomic<uint64_t> clips_written_{0};
+    std::atomic<uint64_t> frames_written_{0};
+};
+
+} // namespace video_pipeline
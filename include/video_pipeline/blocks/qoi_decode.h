@@ -0,0 +1,39 @@
+#pragma once
+
+#include "video_pipeline/video_processor.h"
+#include "video_pipeline/threading.h"
+#include <memory>
+
+namespace video_pipeline {
+
+/**
+ * @brief QOI decoder restoring RGB24/RGBA32 frames from QOI frames
+ *
+ * Accepts standard and banded payloads; bands are decoded in parallel when
+ * `threads` > 1.
+ */
+class QoiDecode : public BaseVideoProcessor {
+public:
+    QoiDecode();
+    ~QoiDecode() override;
+    
+    // IVideoSink/IVideoSource implementation
+    bool SupportsFormat(PixelFormat format) const override;
+    std::vector<PixelFormat> GetSupportedFormats() const override;
+    
+    // IBlock implementation
+    bool Initialize(const BlockParams& params) override;
+    bool Shutdown() override;
+    
+protected:
+    bool ProcessFrameImpl(VideoFramePtr frame) override;
+    FrameInfo DeriveOutputFormat(const FrameInfo& input) const override;
+    
+private:
+    PixelFormat output_pixel_format_{PixelFormat::UNKNOWN};  // UNKNOWN = as stored in the stream
+    size_t thread_count_{1};
+    
+    std::unique_ptr<ThreadPool> thread_pool_;
+};
+
+} // namespace video_pipeline
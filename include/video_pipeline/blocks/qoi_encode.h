@@ -0,0 +1,42 @@
+#pragma once
+
+#include "video_pipeline/video_processor.h"
+#include "video_pipeline/threading.h"
+#include <memory>
+
+namespace video_pipeline {
+
+/**
+ * @brief Lossless QOI encoder producing QOI frames from RGB24/RGBA32 input
+ *
+ * With `tiles` > 1 the frame is split into horizontal bands that are encoded
+ * independently (one band per thread by default) and packed into the banded
+ * "qoit" layout described in qoi.h.
+ */
+class QoiEncode : public BaseVideoProcessor {
+public:
+    QoiEncode();
+    ~QoiEncode() override;
+    
+    // IVideoSink/IVideoSource implementation
+    bool SupportsFormat(PixelFormat format) const override;
+    std::vector<PixelFormat> GetSupportedFormats() const override;
+    
+    // IBlock implementation
+    bool Initialize(const BlockParams& params) override;
+    bool Shutdown() override;
+    
+    size_t GetTileCount() const { return tile_count_; }
+    
+protected:
+    bool ProcessFrameImpl(VideoFramePtr frame) override;
+    FrameInfo DeriveOutputFormat(const FrameInfo& input) const override;
+    
+private:
+    size_t thread_count_{1};
+    size_t tile_count_{0};  // 0 = one band per thread
+    
+    std::unique_ptr<ThreadPool> thread_pool_;
+};
+
+} // namespace video_pipeline
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "video_pipeline/video_processor.h"
+#include "video_pipeline/threading.h"
+#include <memory>
+
+namespace video_pipeline {
+
+/**
+ * @brief Scaling filters
+ */
+enum class ScaleMethod {
+    NEAREST = 0,
+    BILINEAR,
+    AREA        // Box average; downscaling only (falls back to bilinear when enlarging)
+};
+
+class Scaler;
+
+/**
+ * @brief Resizes frames of any uncompressed pixel format
+ *
+ * Coefficient tables are built once per input/output geometry. The vertical
+ * pass runs over whole source rows with SIMD kernels, then each channel group
+ * is resampled horizontally from the table. With `threads` > 1 output rows are
+ * split into bands processed in parallel. Output frames come from the
+ * processor's recycling pool; frames that already have the target size are
+ * forwarded untouched.
+ */
+class Scale : public BaseVideoProcessor {
+public:
+    Scale();
+    ~Scale() override;
+
+    // IVideoSink/IVideoSource implementation
+    bool SupportsFormat(PixelFormat format) const override;
+    std::vector<PixelFormat> GetSupportedFormats() const override;
+
+    // IBlock implementation
+    bool Initialize(const BlockParams& params) override;
+    bool Shutdown() override;
+
+    // Scale specific (0 = keep the input size, or keep the aspect ratio if the other is set)
+    bool SetTargetSize(uint32_t width, uint32_t height);
+    uint32_t GetTargetWidth() const { return target_width_; }
+    uint32_t GetTargetHeight() const { return target_height_; }
+
+    bool SetMethod(ScaleMethod method);
+    ScaleMethod GetMethod() const { return method_; }
+
+    std::unique_ptr<RowStage> CreateRowStage() const override;
+
+protected:
+    bool ProcessFrameImpl(VideoFramePtr frame) override;
+    FrameInfo DeriveOutputFormat(const FrameInfo& input) const override;
+
+private:
+    class Stage;
+
+    uint32_t target_width_{0};
+    uint32_t target_height_{0};
+    ScaleMethod method_{ScaleMethod::BILINEAR};
+    size_t thread_count_{1};
+
+    std::unique_ptr<Scaler> scaler_;
+    std::unique_ptr<ThreadPool> thread_pool_;
+};
+
+} // namespace video_pipeline
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "video_pipeline/video_sink.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace video_pipeline {
+
+class ShmRing;
+
+/**
+ * @brief What a ShmSource does when it falls behind the writer
+ */
+enum class ShmReaderPolicy : uint32_t {
+    LATEST = 0,     // Always take the newest frame, skipping older ones
+    QUEUE,          // Take frames in order; frames the writer already reused are lost
+    BLOCK           // Take frames in order; the writer waits instead of reusing unread frames
+};
+
+/**
+ * @brief Publishes frames to other processes through shared memory
+ *
+ * Frames are copied once into a memfd-backed ring of `slots` slots. Readers
+ * (ShmSource) connect to the Unix socket at `path`, receive the memfd and then
+ * read slots in place; no socket traffic happens per frame. A slot is reused
+ * once every reader has released it. If no slot frees up within `timeout_ms`
+ * (e.g. a BLOCK reader is behind) the frame is dropped. Readers that die
+ * while holding slots are detected and their slots reclaimed.
+ */
+class ShmSink : public BaseVideoSink {
+public:
+    ShmSink();
+    ~ShmSink() override;
+
+    bool SupportsFormat(PixelFormat format) const override;
+    std::vector<PixelFormat> GetSupportedFormats() const override;
+
+    bool Initialize(const BlockParams& params) override;
+    bool Start() override;
+    bool Stop() override;
+    bool Shutdown() override;
+
+    const std::string& GetPath() const { return path_; }
+
+protected:
+    bool ProcessFrameImpl(VideoFramePtr frame) override;
+
+private:
+    bool CreateRing(size_t frame_size);
+    std::shared_ptr<ShmRing> GetRing() const;
+    void AcceptorThread();
+    void CloseListener();
+
+    std::string path_{"@video_pipeline"};
+    uint32_t slot_count_{4};
+    size_t slot_size_{0};              // 0 = size of the first frame
+    int timeout_ms_{100};
+
+    int listen_fd_{-1};
+    mutable std::mutex ring_mutex_;
+    std::shared_ptr<ShmRing> ring_;
+
+    std::thread acceptor_thread_;
+    std::atomic<bool> stop_acceptor_{false};
+};
+
+} // namespace video_pipeline
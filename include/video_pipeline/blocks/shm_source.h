@@ -0,0 +1,56 @@
+#pragma once
+
+#include "video_pipeline/video_source.h"
+#include "video_pipeline/blocks/shm_sink.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace video_pipeline {
+
+/**
+ * @brief Receives frames from a ShmSink in another process without copying
+ *
+ * Connects to the sink's socket at `path` (retrying until it appears), maps
+ * its frame ring and emits frames that point straight into shared memory.
+ * The memory is mapped read-only: blocks that modify frames must call
+ * MakeWritable() first. A slot goes back to the writer when the last
+ * reference to its frame is dropped, so downstream queues that hold frames
+ * for long can stall a BLOCK reader or make the writer skip slots. If the
+ * writer goes away the source reconnects.
+ */
+class ShmSource : public BaseVideoSource {
+public:
+    ShmSource();
+    ~ShmSource() override;
+
+    // IVideoSource implementation
+    FrameInfo GetOutputFormat() const override { return output_format_; }
+    bool SetOutputFormat(const FrameInfo& format) override;
+
+    bool SupportsFormat(PixelFormat format) const override;
+    std::vector<PixelFormat> GetSupportedFormats() const override;
+    std::vector<std::pair<uint32_t, uint32_t>> GetSupportedResolutions() const override { return {}; }
+
+    // IBlock implementation
+    bool Initialize(const BlockParams& params) override;
+    bool Start() override;
+    bool Stop() override;
+    bool Shutdown() override;
+
+    ShmReaderPolicy GetPolicy() const { return policy_; }
+
+private:
+    void ReaderThread();
+    bool Connect();
+
+    std::string path_{"@video_pipeline"};
+    ShmReaderPolicy policy_{ShmReaderPolicy::LATEST};
+    std::shared_ptr<ShmRing> ring_;
+
+    std::thread reader_thread_;
+    std::atomic<bool> stop_reader_{false};
+};
+
+} // namespace video_pipeline
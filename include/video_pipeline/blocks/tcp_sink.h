@@ -2,14 +2,25 @@
 
 #include "video_pipeline/video_sink.h"
 #include <string>
+#include <vector>
 
 namespace video_pipeline {
 
 /**
- * @brief Streams raw frame bytes over a TCP socket.
+ * @brief TcpSink transport modes
+ */
+enum class TcpTransportMode {
+    RAW = 0,    // Frame bytes only
+    DELTA       // Framed keyframes + changed tiles (receive with TcpSource)
+};
+
+/**
+ * @brief Streams frames over a TCP socket.
  *
- * Useful for piping into tools like netcat/ffplay on another machine.
- * Expects the receiver to already know width/height/pixel_format.
+ * In RAW mode the bytes are sent as-is, which is useful for piping into tools
+ * like netcat/ffplay; the receiver must already know width/height/pixel_format.
+ * DELTA mode sends a keyframe periodically and otherwise only the tiles that
+ * changed since the previous frame (see src/blocks/delta_protocol.h).
  */
 class TcpSink : public BaseVideoSink {
 public:
@@ -24,6 +35,10 @@ public:
     bool Stop() override;
     bool Shutdown() override;
 
+    TcpTransportMode GetTransportMode() const { return mode_; }
+    uint64_t GetBytesSent() const { return bytes_sent_; }
+    uint64_t GetKeyframesSent() const { return keyframes_sent_; }
+
 protected:
     bool ProcessFrameImpl(VideoFramePtr frame) override;
 
@@ -31,11 +46,30 @@ private:
     bool Connect();
     void CloseSocket();
     bool SendAll(const uint8_t* data, size_t size);
+    bool SendFrame(const IVideoFrame& frame);
+    void BuildDeltaMessage(const IVideoFrame& frame);
+    // Frame bytes as one range; padded rows and views are packed into packed_ first
+    const uint8_t* ContiguousData(const IVideoFrame& frame, size_t& size, size_t& row_bytes);
 
     std::string host_{"127.0.0.1"};
     uint16_t port_{5000};
     bool reconnect_{true};
     int socket_fd_{-1};
+    std::vector<uint8_t> packed_;
+
+    // Delta transport
+    TcpTransportMode mode_{TcpTransportMode::RAW};
+    uint32_t keyframe_interval_{60};   // Frames between forced keyframes (0 = only when needed)
+    uint32_t tile_width_{64};          // Bytes
+    uint32_t tile_height_{16};         // Rows
+    bool force_keyframe_{true};
+    uint32_t frames_since_keyframe_{0};
+    FrameInfo reference_info_;
+    std::vector<uint8_t> reference_;   // Frame as reconstructed by the receiver
+    std::vector<uint32_t> changed_tiles_;
+    std::vector<uint8_t> message_;
+    uint64_t bytes_sent_{0};
+    uint64_t keyframes_sent_{0};
 };
 
 } // namespace video_pipeline
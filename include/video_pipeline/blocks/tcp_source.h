@@ -0,0 +1,69 @@
+#pragma once
+
+#include "video_pipeline/video_source.h"
+#include "video_pipeline/blocks/tcp_sink.h"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace video_pipeline {
+
+/**
+ * @brief Receives frames sent by a TcpSink
+ *
+ * Listens on `port` and accepts one sender at a time. In RAW mode fixed-size
+ * frames of the configured width/height/format are read. In DELTA mode the
+ * frame is rebuilt from keyframes and changed tiles; the reconstructed frame is
+ * updated in place unless downstream blocks still hold it, in which case it is
+ * copied first.
+ */
+class TcpSource : public BaseVideoSource {
+public:
+    TcpSource();
+    ~TcpSource() override;
+
+    // IVideoSource implementation
+    FrameInfo GetOutputFormat() const override { return output_format_; }
+    bool SetOutputFormat(const FrameInfo& format) override;
+
+    bool SupportsFormat(PixelFormat format) const override;
+    std::vector<PixelFormat> GetSupportedFormats() const override;
+    std::vector<std::pair<uint32_t, uint32_t>> GetSupportedResolutions() const override { return {}; }
+
+    // IBlock implementation
+    bool Initialize(const BlockParams& params) override;
+    bool Start() override;
+    bool Stop() override;
+    bool Shutdown() override;
+
+    uint64_t GetBytesReceived() const { return bytes_received_; }
+
+private:
+    void ReceiverThread();
+    bool Listen();
+    void CloseSockets();
+    bool ReadExact(uint8_t* data, size_t size);
+    // Return false when the connection is lost or the stream is corrupt
+    bool ReceiveRawFrame(VideoFramePtr& frame);
+    bool ReceiveDeltaMessage(VideoFramePtr& frame);
+
+    std::string bind_address_{"0.0.0.0"};
+    uint16_t port_{5000};
+    TcpTransportMode mode_{TcpTransportMode::RAW};
+
+    int listen_fd_{-1};
+    int conn_fd_{-1};
+
+    // Delta reconstruction state
+    VideoFramePtr current_;
+    bool have_keyframe_{false};
+    std::vector<uint8_t> payload_;
+    std::atomic<uint64_t> bytes_received_{0};
+
+    // Threading
+    std::thread receiver_thread_;
+    std::atomic<bool> stop_receiver_{false};
+};
+
+} // namespace video_pipeline
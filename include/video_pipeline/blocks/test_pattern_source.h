@@ -41,6 +41,9 @@ public:
     bool Stop() override;
     bool Shutdown() override;
     
+    // Live reconfiguration: `pattern` in addition to the source parameters
+    bool IsHotParameter(const std::string& key) const override;
+    
     // Test pattern specific
     bool SetTestPattern(TestPattern pattern);
     TestPattern GetTestPattern() const { return test_pattern_; }
@@ -48,8 +51,11 @@ public:
     void SetColor(uint8_t r, uint8_t g, uint8_t b);
     void GetColor(uint8_t& r, uint8_t& g, uint8_t& b) const;
     
+protected:
+    bool ProduceFrame() override;
+    void ApplyParameter(const std::string& key, const std::string& value) override;
+    
 private:
-    void GeneratorThread();
     void GenerateFrame(VideoFramePtr frame);
     void GenerateSolidColor(VideoFramePtr frame);
     void GenerateColorBars(VideoFramePtr frame);
@@ -61,10 +67,6 @@ private:
     TestPattern test_pattern_{TestPattern::COLOR_BARS};
     uint8_t color_r_{255}, color_g_{255}, color_b_{255};
     
-    // Threading
-    std::thread generator_thread_;
-    std::atomic<bool> stop_generator_{false};
-    
     // Animation state
     uint32_t frame_counter_{0};
     std::mt19937 rng_{std::random_device{}()};
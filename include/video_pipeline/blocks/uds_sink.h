@@ -0,0 +1,85 @@
+#pragma once
+
+#include "video_pipeline/video_sink.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace video_pipeline {
+
+/**
+ * @brief Passes frames to other processes as file descriptors
+ *
+ * Receivers (UdsSource) connect to the Unix socket at `path`. For every frame
+ * each receiver gets a small metadata message with the frame's backing fd
+ * attached (SCM_RIGHTS) and maps the same memory. Frames backed by a dmabuf
+ * (LibcameraSource) or by shareable memory (processors with `shareable=true`)
+ * are sent without copying; others are copied once into the sink's own memfd
+ * pool. The sink holds each frame until every receiver has sent it back, so a
+ * camera buffer is requeued, or a pool frame reused, only after the last
+ * receiver is done. A receiver with `max_in_flight` frames outstanding skips
+ * frames until it releases some.
+ */
+class UdsSink : public BaseVideoSink {
+public:
+    UdsSink();
+    ~UdsSink() override;
+
+    bool SupportsFormat(PixelFormat format) const override;
+    std::vector<PixelFormat> GetSupportedFormats() const override;
+
+    bool Initialize(const BlockParams& params) override;
+    bool Start() override;
+    bool Stop() override;
+    bool Shutdown() override;
+
+    const std::string& GetPath() const { return path_; }
+    size_t GetReceiverCount() const;
+    uint64_t GetFramesCopied() const { return frames_copied_; }
+
+protected:
+    bool ProcessFrameImpl(VideoFramePtr frame) override;
+
+private:
+    struct Receiver {
+        int fd{-1};
+        std::unordered_set<uint64_t> held;   // Frame ids not yet released
+    };
+
+    struct InFlightFrame {
+        VideoFramePtr frame;
+        uint32_t holders{0};
+    };
+
+    void IoThread();
+    void AcceptReceiver();
+    // Returns false if the receiver hung up or misbehaved
+    bool ReadReleases(Receiver& receiver);
+    void ReleaseFrame(uint64_t id);
+    void DropReceiver(size_t index);
+    void CloseAll();
+    // Frame with an fd holding the same pixels (the frame itself or a pooled copy)
+    VideoFramePtr ShareableFrame(const VideoFramePtr& frame);
+
+    std::string path_{"@video_pipeline_fd"};
+    uint32_t max_in_flight_{4};
+    size_t pool_size_{4};
+
+    int listen_fd_{-1};
+    mutable std::mutex io_mutex_;
+    std::vector<Receiver> receivers_;
+    std::unordered_map<uint64_t, InFlightFrame> in_flight_;
+    std::vector<VideoFramePtr> pool_;
+    uint64_t next_id_{0};
+    std::atomic<uint64_t> frames_copied_{0};
+
+    std::thread io_thread_;
+    std::atomic<bool> stop_io_{false};
+};
+
+} // namespace video_pipeline
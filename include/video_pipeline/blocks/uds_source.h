@@ -0,0 +1,62 @@
+#pragma once
+
+#include "video_pipeline/video_source.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace video_pipeline {
+
+/**
+ * @brief Receives frames from a UdsSink as shared memory
+ *
+ * Connects to the sink's socket at `path` (retrying until it appears), maps
+ * the fd sent with each frame read-only and emits a frame that points into
+ * it. Mappings are cached per buffer, so recycled camera and pool buffers are
+ * mapped only once. When the last reference to a frame is dropped a release
+ * message tells the sender it may reuse the buffer; holding frames for long
+ * therefore makes the sender skip frames for this receiver.
+ */
+class UdsSource : public BaseVideoSource {
+public:
+    UdsSource();
+    ~UdsSource() override;
+
+    // IVideoSource implementation
+    FrameInfo GetOutputFormat() const override { return output_format_; }
+    bool SetOutputFormat(const FrameInfo& format) override;
+
+    bool SupportsFormat(PixelFormat format) const override;
+    std::vector<PixelFormat> GetSupportedFormats() const override;
+    std::vector<std::pair<uint32_t, uint32_t>> GetSupportedResolutions() const override { return {}; }
+
+    // IBlock implementation
+    bool Initialize(const BlockParams& params) override;
+    bool Start() override;
+    bool Stop() override;
+    bool Shutdown() override;
+
+    struct Connection;
+    struct Mapping;
+
+private:
+    void ReceiverThread();
+    bool Connect();
+    void Disconnect();
+    // Mapping of the buffer behind fd; takes ownership of fd
+    std::shared_ptr<Mapping> MapBuffer(int fd);
+
+    std::string path_{"@video_pipeline_fd"};
+    size_t max_mappings_{32};
+
+    std::shared_ptr<Connection> connection_;
+    std::vector<std::shared_ptr<Mapping>> mappings_;   // Most recently used last
+
+    std::thread receiver_thread_;
+    std::atomic<bool> stop_receiver_{false};
+};
+
+} // namespace video_pipeline
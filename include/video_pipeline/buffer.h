@@ -6,6 +6,8 @@
 #include <cstdint>
 #include <chrono>
 #include <atomic>
+#include <functional>
+#include "ref_ptr.h"
 
 namespace video_pipeline {
 
@@ -22,7 +24,48 @@ enum class PixelFormat {
     NV12,       // Semi-planar YUV 4:2:0
     NV21,       // Semi-planar YUV 4:2:0 (VU)
     YUYV,       // Packed YUV 4:2:2
-    UYVY        // Packed YUV 4:2:2
+    UYVY,       // Packed YUV 4:2:2
+    MJPEG,      // Compressed JPEG frame (variable-length payload)
+    QOI         // Lossless QOI image (variable-length payload, see qoi.h)
+};
+
+/**
+ * @brief True for formats whose payload size is not derived from width/height
+ */
+bool IsCompressedFormat(PixelFormat format);
+
+/**
+ * @brief Pixel format name as used in configuration files ("RGB24", "NV12", ...)
+ */
+const char* PixelFormatToString(PixelFormat format);
+
+/**
+ * @brief Parse a pixel format name (case-insensitive); false if unknown
+ */
+bool ParsePixelFormat(const std::string& name, PixelFormat& format);
+
+/**
+ * @brief Change detection result attached to a frame (see ChangeDetect)
+ *
+ * The frame is covered by tiles_x by tiles_y tiles of tile_width by
+ * tile_height pixels (the last row and column may be cut off); bit i of
+ * `tiles` is set when tile i, counted row by row, differs from the
+ * background.
+ */
+struct ChangeMap {
+    float score{0.0f};               // Share of tiles that changed (0-1)
+    float mean_difference{0.0f};     // Mean luma difference to the background (0-255)
+    bool changed{false};             // Enough tiles changed to count as an event
+    uint32_t tile_width{0};          // Tile size in frame pixels
+    uint32_t tile_height{0};
+    uint32_t tiles_x{0};
+    uint32_t tiles_y{0};
+    std::vector<uint64_t> tiles;     // Changed-tile bitmap, 64 tiles per word
+    
+    bool IsTileChanged(uint32_t x, uint32_t y) const {
+        size_t index = static_cast<size_t>(y) * tiles_x + x;
+        return (tiles[index / 64] >> (index % 64)) & 1;
+    }
 };
 
 /**
@@ -35,11 +78,15 @@ struct FrameInfo {
     PixelFormat pixel_format{PixelFormat::UNKNOWN};
     uint64_t timestamp_us{0};        // Timestamp in microseconds (PTS)
     uint64_t sequence_number{0};     // Frame sequence number
+    bool is_keyframe{true};          // Decodable on its own (false for inter-coded frames)
     
     // For hardware-accelerated buffers
     bool is_hardware_buffer{false};
     void* hw_handle{nullptr};        // Platform-specific handle (e.g., dmabuf fd)
     
+    // Analysis results; shared by copies and not carried to other processes
+    std::shared_ptr<const ChangeMap> change;
+    
     size_t GetFrameSize() const;
     std::string ToString() const;
 };
@@ -57,6 +104,9 @@ public:
     virtual size_t GetSize() const = 0;
     virtual size_t GetCapacity() const = 0;
     
+    // Set the payload size (compressed or variable-length data); fails if size > capacity
+    virtual bool SetSize(size_t size) = 0;
+    
     // Frame metadata
     virtual const FrameInfo& GetFrameInfo() const = 0;
     virtual void SetFrameInfo(const FrameInfo& info) = 0;
@@ -65,13 +115,40 @@ public:
     virtual bool IsValid() const = 0;
     virtual void Reset() = 0;
     
-    // Reference counting for zero-copy
-    virtual void AddRef() = 0;
-    virtual void Release() = 0;
-    virtual uint32_t GetRefCount() const = 0;
+    // Intrusive reference counting for zero-copy sharing through RefPtr. The
+    // count starts at zero; dropping the last reference calls Recycle().
+    void AddRef() const noexcept { ref_count_.fetch_add(1, std::memory_order_relaxed); }
+    void Release() const noexcept {
+        if (ref_count_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            const_cast<IBuffer*>(this)->Recycle();
+        }
+    }
+    uint32_t GetRefCount() const noexcept { return ref_count_.load(std::memory_order_acquire); }
+    
+    // Set by a pool while it keeps a reference of its own to recycle the
+    // buffer. Cleared before the pool drops that reference.
+    void SetPoolHeld(bool held) noexcept { pool_held_.store(held, std::memory_order_release); }
+    bool IsPoolHeld() const noexcept { return pool_held_.load(std::memory_order_acquire); }
+    
+    // One reference besides the pool's, if any. The count is read first: a
+    // pool clears its mark before releasing, so a count taken after the
+    // release is never paired with a stale mark.
+    bool IsExclusive() const noexcept {
+        uint32_t refs = GetRefCount();
+        return refs == (IsPoolHeld() ? 2u : 1u);
+    }
+    
+protected:
+    // Last reference released. Deletes the buffer by default; pooled and camera
+    // buffers override this to hand their memory back instead.
+    virtual void Recycle() { delete this; }
+    
+private:
+    mutable std::atomic<uint32_t> ref_count_{0};
+    std::atomic<bool> pool_held_{false};
 };
 
-using BufferPtr = std::shared_ptr<IBuffer>;
+using BufferPtr = RefPtr<IBuffer>;
 
 /**
  * @brief Video frame - specialized buffer for video data
@@ -90,12 +167,79 @@ public:
     // Convenience methods
     virtual bool CopyFrom(const IVideoFrame& other) = 0;
     virtual BufferPtr Clone() const = 0;
+    
+    // True if the caller's reference is the only way to reach these pixels,
+    // so they can be modified without a copy (see MakeWritable). A recycling
+    // pool's own reference does not count: it hands the frame out again only
+    // once every other reference is gone.
+    virtual bool CanWriteInPlace() const { return IsExclusive(); }
+    
+    // File descriptor (memfd, dmabuf) holding the pixels, with the offset of
+    // GetPlaneData(0) in it, so another process can map the same memory.
+    // -1 if the memory is private to this process. The fd stays owned by the frame.
+    virtual int GetFd(size_t& offset) const {
+        offset = 0;
+        return -1;
+    }
 };
 
-using VideoFramePtr = std::shared_ptr<IVideoFrame>;
+using VideoFramePtr = RefPtr<IVideoFrame>;
+
+/**
+ * @brief Page backing for frame memory
+ */
+enum class PageMode {
+    DEFAULT = 0,    // Heap allocation, 4K pages
+    TRANSPARENT,    // mmap + madvise(MADV_HUGEPAGE); the kernel uses huge pages when it can
+    HUGETLB         // mmap(MAP_HUGETLB) from the reserved pool, TRANSPARENT if none is free
+};
+
+/**
+ * @brief How a frame's memory is allocated
+ *
+ * Anything but the defaults maps the frame with mmap, so it is meant for
+ * long-lived pooled frames rather than per-frame allocations.
+ */
+struct FrameMemoryOptions {
+    PageMode pages{PageMode::DEFAULT};
+    bool prefault{false};   // Fault every page in at allocation time
+    bool lock{false};       // mlock() the frame so it is never paged out (implies prefault)
+    bool shareable{false};  // Back the frame with a memfd so GetFd() can pass it to other processes
+    
+    bool IsDefault() const { return pages == PageMode::DEFAULT && !prefault && !lock && !shareable; }
+};
 
 // Factory functions
 BufferPtr CreateBuffer(size_t capacity);
 VideoFramePtr CreateVideoFrame(const FrameInfo& info);
+VideoFramePtr CreateVideoFrame(const FrameInfo& info, size_t capacity);  // For compressed payloads
+VideoFramePtr CreateVideoFrame(const FrameInfo& info, size_t capacity, const FrameMemoryOptions& memory);
+
+// Zero-copy view of a rectangle of an uncompressed frame. The view shares the
+// parent's memory and strides and keeps the parent alive; its rows are not
+// contiguous, so consumers must step by GetPlaneStride(). The rectangle is
+// aligned down to chroma sample boundaries. Returns nullptr if it does not fit.
+VideoFramePtr CreateFrameView(const VideoFramePtr& parent, uint32_t x, uint32_t y,
+                              uint32_t width, uint32_t height);
+
+// Allocates the destination of a copy-on-write copy
+using FrameAllocator = std::function<VideoFramePtr(const FrameInfo& info, size_t capacity)>;
+
+// Copy-on-write: leaves `frame` alone if CanWriteInPlace(), otherwise replaces
+// it with a private copy from `allocate` (CreateVideoFrame when empty). Views
+// are copied into packed frames. Returns false and leaves `frame` unchanged if
+// the copy could not be made.
+bool MakeWritable(VideoFramePtr& frame, const FrameAllocator& allocate = nullptr);
+
+/**
+ * @brief Process-wide MakeWritable() counters
+ */
+struct CopyOnWriteStats {
+    uint64_t in_place{0};       // Frames that were already exclusively owned
+    uint64_t copied{0};         // Frames that had to be copied
+    uint64_t bytes_copied{0};
+};
+
+CopyOnWriteStats GetCopyOnWriteStats();
 
 } // namespace video_pipeline
\ No newline at end of file
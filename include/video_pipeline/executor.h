@@ -0,0 +1,178 @@
+#pragma once
+
+#include "threading.h"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+
+namespace video_pipeline {
+
+/**
+ * @brief Order in which ready executor tasks are picked
+ */
+enum class TaskPriority {
+    HIGH = 0,
+    NORMAL,
+    LOW
+};
+
+/**
+ * @brief Shared fixed-size executor for scheduled pipelines
+ *
+ * Runs block activations (a sink draining its queue, a source producing its
+ * next frame) on a small set of workers instead of one thread per block.
+ * Ready tasks are picked by priority, then in submission order. A task may be
+ * hinted to a worker to keep a block's data in that core's cache; an idle
+ * worker only takes such a task while the hinted worker is busy. Timed tasks
+ * become ready at their deadline.
+ *
+ * Tasks belong to a group (one per pipeline when several share the executor).
+ * A group may be limited to a number of concurrently running tasks, and at
+ * each priority level the group that has used the least worker time relative
+ * to its weight goes first.
+ */
+class Executor {
+public:
+    // 0 threads = one per core; pinned workers are bound to one core each
+    explicit Executor(size_t num_threads = 0, bool pin_workers = false);
+    ~Executor();
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    // Queue a task; `worker` < 0 lets any worker run it
+    void Post(Task task, TaskPriority priority = TaskPriority::NORMAL, int worker = -1, int group = 0);
+
+    // Queue a task once `when` has passed; returns an id for Cancel()
+    uint64_t PostAt(std::chrono::steady_clock::time_point when, Task task,
+                    TaskPriority priority = TaskPriority::NORMAL, int worker = -1, int group = 0);
+    
+    // New task group running at most `max_workers` tasks at once (0 = no
+    // limit) with a share of worker time proportional to `weight`. Group 0
+    // always exists, unlimited with weight 1.
+    int AddGroup(size_t max_workers, unsigned weight = 1);
+    
+    // Retire a group once its pipeline has shut down; AddGroup() reuses the
+    // id after the group's last queued or timed task has run
+    void RemoveGroup(int group);
+    
+    struct GroupStats {
+        uint64_t tasks_run{0};
+        std::chrono::nanoseconds busy_time{0};  // Worker time spent in the group's tasks
+    };
+    GroupStats GetGroupStats(int group) const;
+
+    // Drop a timed task that has not become ready yet
+    bool Cancel(uint64_t timer_id);
+
+    // Run one ready task on the calling thread (lets a blocked worker help); false if none
+    bool RunPendingTask();
+
+    bool IsWorkerThread() const;
+    size_t GetThreadCount() const { return threads_.size(); }
+
+    // Wait on `condition` until done(); a worker runs ready tasks meanwhile,
+    // so the task it waits for cannot be starved by the wait itself
+    template<typename Predicate>
+    void Wait(std::unique_lock<std::mutex>& lock, std::condition_variable& condition, Predicate done);
+    
+    // As Wait(), giving up at `deadline`; returns done()
+    template<typename Predicate>
+    bool WaitUntil(std::unique_lock<std::mutex>& lock, std::condition_variable& condition,
+                   std::chrono::steady_clock::time_point deadline, Predicate done);
+
+    // Run the tasks that are ready, drop pending timers and join the workers
+    void Shutdown();
+
+private:
+    static constexpr int kPriorityLevels = 3;
+
+    struct TimedTask {
+        uint64_t id;
+        Task task;
+        TaskPriority priority;
+        int worker;
+        int group;
+    };
+
+    struct ReadyTask {
+        Task task;
+        int group;
+    };
+
+    struct ReadyQueues {
+        std::deque<ReadyTask> level[kPriorityLevels];
+    };
+
+    struct Group {
+        size_t max_workers{0};
+        unsigned weight{1};
+        size_t running{0};
+        size_t queued{0};
+        uint64_t vruntime{0};   // Busy nanoseconds divided by weight
+        GroupStats stats;
+        bool removed{false};
+    };
+
+    void WorkerThread(size_t index);
+    void Enqueue(Task&& task, TaskPriority priority, int worker, int group);
+    void ReleaseDueTimers(std::chrono::steady_clock::time_point now);
+    // `nested` is the group of the task the calling worker is already running,
+    // which may exceed its limit so a task waiting on its own group progresses
+    bool TakeTask(int worker, int nested, Task& task, int& group);
+    void RunTask(Task& task, int group, std::unique_lock<std::mutex>& lock);
+
+    std::vector<std::thread> threads_;
+    std::vector<std::unique_ptr<ReadyQueues>> local_;   // Hinted tasks per worker
+    ReadyQueues shared_;
+    std::vector<bool> busy_;
+    std::vector<Group> groups_;
+    std::multimap<std::chrono::steady_clock::time_point, TimedTask> timers_;
+    uint64_t next_timer_id_{1};
+
+    mutable std::mutex mutex_;
+    std::condition_variable condition_;
+    bool stop_{false};
+};
+
+template<typename Predicate>
+void Executor::Wait(std::unique_lock<std::mutex>& lock, std::condition_variable& condition, Predicate done) {
+    if (!IsWorkerThread()) {
+        condition.wait(lock, done);
+        return;
+    }
+
+    while (!done()) {
+        lock.unlock();
+        bool ran = RunPendingTask();
+        lock.lock();
+        if (!ran && !done()) {
+            condition.wait_for(lock, std::chrono::milliseconds(1));
+        }
+    }
+}
+
+template<typename Predicate>
+bool Executor::WaitUntil(std::unique_lock<std::mutex>& lock, std::condition_variable& condition,
+                         std::chrono::steady_clock::time_point deadline, Predicate done) {
+    if (!IsWorkerThread()) {
+        return condition.wait_until(lock, deadline, done);
+    }
+
+    while (!done()) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        lock.unlock();
+        bool ran = RunPendingTask();
+        lock.lock();
+        if (!ran && !done()) {
+            condition.wait_until(lock, std::min(deadline, std::chrono::steady_clock::now() +
+                                                          std::chrono::milliseconds(1)));
+        }
+    }
+    return true;
+}
+
+} // namespace video_pipeline
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "buffer.h"
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace video_pipeline {
+
+/**
+ * @brief Recycling frame pool shared by the blocks of several pipelines
+ *
+ * A pooled frame is idle once only the pool holds it and is then handed to
+ * whichever block next needs a frame it can hold (the smallest that fits), so
+ * memory follows the frames in flight across all pipelines instead of every
+ * block keeping its own worst case. Frames in use are charged to the client
+ * (pipeline) that acquired them; a client over its byte quota, or a request
+ * that would take the pool over its own limit, gets no frame. The pool's own
+ * reference is marked (IBuffer::SetPoolHeld), so a frame a single consumer
+ * holds can still be written in place.
+ */
+class FramePool {
+public:
+    // `max_bytes` limits all pooled frames together; 0 = no limit
+    explicit FramePool(size_t max_bytes = 0);
+    ~FramePool();
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    // Register a client with a quota on the bytes of frames it holds (0 = no
+    // quota). Client 0 always exists and has no quota.
+    int AddClient(const std::string& name, size_t max_bytes = 0);
+
+    // Release a client; AddClient() reuses the id once every frame the
+    // client still holds has come back
+    void RemoveClient(int client);
+
+    // A frame of at least max(info.GetFrameSize(), capacity) bytes with
+    // `memory` backing, or nullptr if a quota or the pool limit refuses it
+    VideoFramePtr Acquire(int client, const FrameInfo& info, size_t capacity = 0,
+                          const FrameMemoryOptions& memory = FrameMemoryOptions{});
+
+    // Free the idle frames
+    void Trim();
+
+    struct Stats {
+        size_t frames{0};
+        size_t bytes{0};            // All pooled frames
+        size_t idle_bytes{0};
+        uint64_t reused{0};         // Acquisitions served by an idle frame
+        uint64_t allocated{0};
+        uint64_t refused{0};
+    };
+    Stats GetStats() const;
+
+    // Bytes of pooled frames `client` holds right now
+    size_t GetClientBytes(int client) const;
+
+private:
+    struct Entry {
+        VideoFramePtr frame;
+        int client;
+        size_t capacity;
+        FrameMemoryOptions memory;
+    };
+
+    struct Client {
+        std::string name;
+        size_t max_bytes;
+        bool removed{false};
+    };
+
+    size_t max_bytes_;
+    std::vector<Entry> entries_;
+    std::vector<Client> clients_;
+    Stats stats_;
+    mutable std::mutex mutex_;
+};
+
+} // namespace video_pipeline
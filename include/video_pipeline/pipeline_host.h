@@ -0,0 +1,70 @@
+#pragma once
+
+#include "pipeline_manager.h"
+#include "frame_pool.h"
+#include "executor.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace video_pipeline {
+
+/**
+ * @brief Runs several pipelines in one process on shared resources
+ *
+ * All pipelines share one executor and one frame pool, and their statistics
+ * are reported together. Each pipeline's `[pipeline]` settings set its
+ * quotas: `max_workers` (executor workers it may occupy at once),
+ * `cpu_weight` (share of worker time under contention) and
+ * `memory_quota_mb` (pooled frame memory it may hold).
+ */
+class PipelineHost {
+public:
+    // `executor_threads` 0 = one per core; `pool_bytes` 0 = no limit on the
+    // frame pool as a whole
+    explicit PipelineHost(size_t executor_threads = 0, size_t pool_bytes = 0, bool pin_workers = false);
+    ~PipelineHost();
+
+    PipelineHost(const PipelineHost&) = delete;
+    PipelineHost& operator=(const PipelineHost&) = delete;
+
+    // Initialize a pipeline under its configured name (started with the
+    // host, or immediately if the host is running)
+    bool AddPipeline(const PipelineConfig& config);
+    bool LoadPipeline(const std::string& config_file);
+    bool RemovePipeline(const std::string& name);
+
+    bool Start();
+    bool Stop();
+    bool Shutdown();
+    bool IsRunning() const;
+
+    std::shared_ptr<PipelineManager> GetPipeline(const std::string& name) const;
+    std::vector<std::string> GetPipelineNames() const;
+
+    // Block statistics of every pipeline, keyed "pipeline/block"
+    std::map<std::string, BlockStats> GetAllStats() const;
+
+    // Per-pipeline worker time and pooled memory, and the pool's totals
+    std::string GetResourceUsage() const;
+
+    const std::shared_ptr<Executor>& GetExecutor() const { return executor_; }
+    const std::shared_ptr<FramePool>& GetFramePool() const { return frame_pool_; }
+
+    std::string GetLastError() const;
+
+private:
+    bool AddPipeline(const std::string& name, std::shared_ptr<PipelineManager> pipeline);
+
+    std::shared_ptr<Executor> executor_;
+    std::shared_ptr<FramePool> frame_pool_;
+    std::map<std::string, std::shared_ptr<PipelineManager>> pipelines_;
+    std::vector<std::string> order_;    // Start order; stopped in reverse
+    bool running_{false};
+    std::string last_error_;
+    mutable std::mutex mutex_;
+};
+
+} // namespace video_pipeline
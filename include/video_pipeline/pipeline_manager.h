@@ -3,12 +3,16 @@
 #include "block.h"
 #include "video_source.h"
 #include "video_sink.h"
+#include "frame_pool.h"
+#include <chrono>
 #include <vector>
 #include <memory>
 #include <map>
 
 namespace video_pipeline {
 
+class FusedTransform;
+
 /**
  * @brief Connection between blocks
  */
@@ -18,6 +22,10 @@ struct Connection {
     std::string sink_block;
     std::string sink_input{"input"};
     
+    // Delivery policy (see DropPolicy); empty = from the sink's `blocking` flag
+    std::string drop_policy;
+    uint32_t block_timeout_ms{0};   // drop_policy=block only; 0 = wait indefinitely
+    
     std::string ToString() const;
 };
 
@@ -100,27 +108,142 @@ public:
                                    const std::string& format = "yaml");
     PipelineConfig GetConfiguration() const { return config_; }
     
+    // Apply a changed configuration without restarting the pipeline: blocks
+    // that were added or whose type or a non-hot parameter changed are
+    // started, removed and replaced blocks are drained and stopped, hot
+    // parameters are updated in place, and connections switch between two
+    // frames. Rolls back and returns false if the new graph cannot be built.
+    bool Reconfigure(const PipelineConfig& config);
+    bool ReloadConfiguration(const std::string& config_file);
+    
+    // Run on an executor and frame pool shared with other pipelines in the
+    // process (see PipelineHost). Call before Initialize(); the pipeline
+    // registers its `max_workers`, `cpu_weight` and `memory_quota_mb` quotas.
+    void SetSharedResources(std::shared_ptr<Executor> executor, std::shared_ptr<FramePool> frame_pool);
+    int GetExecutorGroup() const { return executor_group_; }
+    int GetFramePoolClient() const { return frame_pool_client_; }
+    
     // Error handling
     void SetErrorCallback(ErrorCallback callback);
     std::string GetLastError() const;
+    
+    // Negotiated format of every connection, one "from -> to: format" line
+    // each, including connections through inserted converters
+    std::vector<std::string> GetFormatPlan() const;
 
 private:
     // Internal methods
+    bool ReadConfiguration(const std::string& config_file, PipelineConfig& config);
+    bool ParseConfiguration(const std::string& config_content, const std::string& format, PipelineConfig& config);
     bool CreateBlocks();
     bool ConfigureBlocks();
-    bool ConnectBlocks();
+    bool BuildGraph();
+    bool NegotiateFormats();
+    
+    // Replace chains of fusable processors with FusedTransform blocks, then
+    // record the format of every connection left
+    bool FuseTransforms();
+    void RecordFormatPlan();
+    
+    // FuseTransforms() helpers: put `fused` in place of the chain of nodes,
+    // and the running FusedTransform (during Reconfigure) made of exactly
+    // the chain's blocks, if any
+    void ReplaceWithFusion(const std::vector<size_t>& chain, const std::shared_ptr<FusedTransform>& fused,
+                           std::vector<bool>& dead_node, std::vector<bool>& dead_edge);
+    std::shared_ptr<FusedTransform> TakeReusableFusion(const std::vector<size_t>& chain);
+    
+    // Where a source's frames go. The frame callback reads the target list
+    // once per frame, so Reconfigure() can swap it while the source runs.
+    using Target = std::pair<std::shared_ptr<IVideoSink>, EdgePolicy>;
+    using TargetList = std::shared_ptr<const std::vector<Target>>;
+    struct Route {
+        TargetList targets;     // std::atomic_load/atomic_store only
+    };
+    
+    // Sources that already have a route get their new targets in `deferred`
+    // instead of immediately, when given
+    bool ConnectBlocks(std::vector<std::pair<std::shared_ptr<Route>, TargetList>>* deferred = nullptr);
+    
+    // Swap in a route's targets; returns the list it replaced
+    static TargetList PublishRoute(Route& route, TargetList targets);
+    
+    // Wait until no frame is being delivered through `replaced` any more;
+    // false if one still is after `timeout`
+    static bool WaitForRoutes(const std::vector<TargetList>& replaced, std::chrono::milliseconds timeout);
+    
+    // Longest Reconfigure() waits for a source to finish delivering a frame
+    // to its old connections before rolling back
+    static constexpr std::chrono::milliseconds kRouteSwitchTimeout{2000};
+    bool ConfigureExecution();
+    void ReleaseExecution();    // Undo ConfigureExecution()
+    bool ConfigureAffinity();
     void OnBlockError(IBlock* block, const std::string& error);
     
+    void StopBlocks(const std::vector<size_t>& order);
+    bool StopPipeline();    // Stop() with graph_mutex_ already held
+    std::string GetSetting(const std::string& key) const;
+    
+    // Format negotiation helpers: the input `sink` should receive for a given
+    // upstream output (false if no conversion reaches it), and the chain of
+    // converters inserted after node `from` to produce it (`last` = its end)
+    bool ChooseInputFormat(const FrameInfo& output, const IVideoSink& sink, FrameInfo& input) const;
+    bool InsertConversion(size_t from, const FrameInfo& output, const FrameInfo& input,
+                          size_t topo_position, const EdgePolicy& policy, size_t& last);
+    // Sets a node's input format; a running block (during Reconfigure) must
+    // already have it
+    bool SetNodeInputFormat(size_t index, const FrameInfo& format);
+    
+    // Reconfigure() helpers
+    BlockPtr CreateConfiguredBlock(const PipelineConfig::BlockDef& block_def);
+    BlockPtr TakeReusableBlock(const std::string& name, const std::string& type, const BlockParams& params,
+                               const FrameInfo& input);
+    
+    // Block graph built from the connections by BuildGraph()
+    struct GraphEdge {
+        size_t from;
+        size_t to;
+        EdgePolicy policy;
+    };
+    
+    struct GraphNode {
+        BlockPtr block;
+        IVideoSource* source{nullptr};  // Block interfaces, cast once
+        IVideoSink* sink{nullptr};
+        std::vector<size_t> out_edges;  // Indices into edges_
+        size_t in_degree{0};
+        bool inserted{false};           // Added by format negotiation or fusion
+        bool fused{false};              // A FusedTransform standing in for a chain
+    };
+    
     // Pipeline state
     PipelineConfig config_;
     std::map<std::string, BlockPtr> blocks_;
+    std::vector<GraphNode> nodes_;
+    std::vector<GraphEdge> edges_;
+    std::vector<size_t> topo_order_;    // Upstream blocks before downstream ones
+    std::chrono::milliseconds drain_timeout_{500};
+    std::vector<std::string> format_plan_;
+    std::map<const IBlock*, std::shared_ptr<Route>> routes_;
+    std::map<std::string, BlockPtr> reusable_;  // Old converters and fused blocks during Reconfigure()
     std::atomic<bool> is_running_{false};
     
+    // Shared workers when the pipeline runs with `execution=scheduled`
+    std::shared_ptr<Executor> executor_;
+    int executor_group_{0};
+    
+    // Resources shared with other pipelines (PipelineHost)
+    std::shared_ptr<Executor> shared_executor_;
+    std::shared_ptr<FramePool> frame_pool_;
+    int frame_pool_client_{0};
+    
     // Error handling
     ErrorCallback error_callback_;
     std::string last_error_;
     
-    // Thread safety
+    // Thread safety. graph_mutex_ serializes Initialize(), Start(), Stop(),
+    // Reconfigure() and Shutdown() and is taken before mutex_; Reconfigure()
+    // releases mutex_ while it waits for sources to switch routes.
+    std::mutex graph_mutex_;
     mutable std::mutex mutex_;
 };
 
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "buffer.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace video_pipeline {
+
+class ThreadPool;
+
+/**
+ * @file qoi.h
+ * @brief Lossless QOI ("Quite OK Image") codec for RGB24/RGBA32 frames
+ *
+ * Two payload layouts are produced and accepted:
+ * - "qoif": a standard QOI image (header, chunk stream, end marker), readable
+ *   by any QOI decoder.
+ * - "qoit": a banded container used when a frame is split into horizontal
+ *   bands. Each band is an independent chunk stream (fresh encoder state), so
+ *   bands can be encoded and decoded on separate cores. Layout:
+ *   magic(4) width(4) height(4) channels(1) colorspace(1) bands(2), followed by
+ *   one big-endian 32-bit byte size per band and the band streams.
+ * Both layouts end with the standard 8-byte end marker.
+ */
+
+/**
+ * @brief QOI image description (header fields)
+ */
+struct QoiDesc {
+    uint32_t width{0};
+    uint32_t height{0};
+    uint8_t channels{3};      // 3 = RGB, 4 = RGBA
+    uint8_t colorspace{0};    // 0 = sRGB with linear alpha, 1 = all linear
+};
+
+constexpr size_t kQoiHeaderSize = 14;
+constexpr size_t kQoiBandedHeaderSize = 16;
+constexpr size_t kQoiEndMarkerSize = 8;
+constexpr size_t kQoiMaxBands = 256;
+
+// Worst-case chunk stream size for `pixels` pixels (no header or end marker)
+inline size_t QoiMaxChunkBytes(size_t pixels, uint8_t channels) {
+    return pixels * (channels + 1);
+}
+
+/**
+ * @brief Incremental QOI chunk encoder
+ *
+ * Pixels may be pushed in any number of calls (e.g. row by row, so strided
+ * frames need no repacking). Finish() flushes a pending run; the caller adds
+ * the header and end marker when producing a standard image.
+ */
+class QoiEncoder {
+public:
+    explicit QoiEncoder(uint8_t channels = 3) { Reset(channels); }
+
+    void Reset(uint8_t channels);
+
+    // Encode `count` packed pixels; `out` must hold QoiMaxChunkBytes(count). Returns bytes written.
+    size_t Encode(const uint8_t* pixels, size_t count, uint8_t* out);
+
+    // Flush a pending run (at most 1 byte). Returns bytes written.
+    size_t Finish(uint8_t* out);
+
+private:
+    uint8_t channels_{3};
+    uint32_t prev_{0};
+    uint32_t index_[64]{};
+    uint32_t run_{0};
+};
+
+/**
+ * @brief Incremental QOI chunk decoder
+ *
+ * Only complete chunks are consumed, so input can arrive in arbitrary pieces:
+ * feed the unconsumed tail again together with the next piece.
+ */
+class QoiDecoder {
+public:
+    explicit QoiDecoder(uint8_t channels = 3) { Reset(channels); }
+
+    // `channels` is the output pixel size; it may differ from the encoded channel count
+    void Reset(uint8_t channels);
+
+    // Decode up to `count` pixels. Returns pixels produced; `consumed` receives input bytes used.
+    size_t Decode(const uint8_t* data, size_t size, size_t& consumed, uint8_t* pixels, size_t count);
+
+private:
+    uint8_t channels_{3};
+    uint32_t prev_{0};
+    uint32_t index_[64]{};
+    uint32_t run_{0};
+};
+
+// Header helpers. ParseQoiHeader accepts both "qoif" and "qoit" payloads.
+void WriteQoiHeader(const QoiDesc& desc, uint8_t* out);
+bool ParseQoiHeader(const uint8_t* data, size_t size, QoiDesc& desc, size_t* bands = nullptr);
+
+// Total byte size of the first image in `data` (either layout), or 0 if incomplete/invalid
+size_t QoiImageSize(const uint8_t* data, size_t size);
+
+/**
+ * @brief Encode an RGB24/RGBA32 frame into a QOI frame
+ *
+ * bands <= 1 produces a standard image, otherwise a banded container. Bands
+ * other than the first are submitted to `pool` when one is given.
+ */
+VideoFramePtr QoiEncodeFrame(const IVideoFrame& frame, size_t bands, ThreadPool* pool);
+
+/**
+ * @brief Decode a QOI payload into an RGB24 (channels = 3) or RGBA32 (channels = 4) frame
+ *
+ * channels = 0 keeps the channel count stored in the header. `consumed`
+ * receives the size of the decoded image, for payloads holding several images.
+ */
+VideoFramePtr QoiDecodeFrame(const uint8_t* data, size_t size, uint8_t channels, ThreadPool* pool,
+                             size_t* consumed = nullptr);
+
+} // namespace video_pipeline
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace video_pipeline {
+
+/**
+ * @brief Handle to an intrusively reference-counted object
+ *
+ * T provides AddRef() and Release(); the count lives in the object itself, so
+ * copying a handle is one atomic increment and there is no separate control
+ * block. What happens to the object on the last Release() is up to T (see
+ * IBuffer::Recycle). The interface mirrors the subset of std::shared_ptr the
+ * framework uses.
+ */
+template<typename T>
+class RefPtr {
+public:
+    using element_type = T;
+
+    constexpr RefPtr() noexcept = default;
+    constexpr RefPtr(std::nullptr_t) noexcept {}
+
+    // Takes a new reference; objects start with a count of zero
+    explicit RefPtr(T* ptr) noexcept : ptr_(ptr) {
+        if (ptr_) ptr_->AddRef();
+    }
+
+    RefPtr(const RefPtr& other) noexcept : RefPtr(other.ptr_) {}
+    RefPtr(RefPtr&& other) noexcept : ptr_(other.ptr_) { other.ptr_ = nullptr; }
+
+    template<typename U, typename = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+    RefPtr(const RefPtr<U>& other) noexcept : RefPtr(other.get()) {}
+
+    template<typename U, typename = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+    RefPtr(RefPtr<U>&& other) noexcept : ptr_(other.ptr_) { other.ptr_ = nullptr; }
+
+    ~RefPtr() {
+        if (ptr_) ptr_->Release();
+    }
+
+    RefPtr& operator=(RefPtr other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    RefPtr& operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    T* get() const noexcept { return ptr_; }
+    T& operator*() const noexcept { return *ptr_; }
+    T* operator->() const noexcept { return ptr_; }
+    explicit operator bool() const noexcept { return ptr_ != nullptr; }
+
+    void reset() noexcept { RefPtr().swap(*this); }
+    void reset(T* ptr) noexcept { RefPtr(ptr).swap(*this); }
+    void swap(RefPtr& other) noexcept { std::swap(ptr_, other.ptr_); }
+
+    // Number of handles sharing the object (0 if empty)
+    long use_count() const noexcept { return ptr_ ? static_cast<long>(ptr_->GetRefCount()) : 0; }
+
+private:
+    template<typename U> friend class RefPtr;
+
+    T* ptr_{nullptr};
+};
+
+template<typename T, typename... Args>
+RefPtr<T> MakeRef(Args&&... args) {
+    return RefPtr<T>(new T(std::forward<Args>(args)...));
+}
+
+template<typename T, typename U>
+RefPtr<T> StaticRefCast(const RefPtr<U>& ptr) noexcept {
+    return RefPtr<T>(static_cast<T*>(ptr.get()));
+}
+
+template<typename T, typename U>
+RefPtr<T> DynamicRefCast(const RefPtr<U>& ptr) noexcept {
+    return RefPtr<T>(dynamic_cast<T*>(ptr.get()));
+}
+
+template<typename T, typename U>
+bool operator==(const RefPtr<T>& a, const RefPtr<U>& b) noexcept { return a.get() == b.get(); }
+template<typename T, typename U>
+bool operator!=(const RefPtr<T>& a, const RefPtr<U>& b) noexcept { return a.get() != b.get(); }
+template<typename T>
+bool operator==(const RefPtr<T>& a, std::nullptr_t) noexcept { return !a; }
+template<typename T>
+bool operator==(std::nullptr_t, const RefPtr<T>& a) noexcept { return !a; }
+template<typename T>
+bool operator!=(const RefPtr<T>& a, std::nullptr_t) noexcept { return static_cast<bool>(a); }
+template<typename T>
+bool operator!=(std::nullptr_t, const RefPtr<T>& a) noexcept { return static_cast<bool>(a); }
+
+} // namespace video_pipeline
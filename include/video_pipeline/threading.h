@@ -1,19 +1,122 @@
 #pragma once
 
 #include <thread>
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <mutex>
 #include <condition_variable>
+#include <exception>
 #include <functional>
 #include <vector>
 #include <queue>
 #include <future>
 #include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
 
 namespace video_pipeline {
 
 /**
- * @brief Thread pool for executing tasks
+ * @brief Move-only type-erased `void()` callable
+ *
+ * Callables up to kInlineSize bytes (lambdas capturing a few references or
+ * indices) are stored inline, so queuing a task does not allocate; larger ones
+ * fall back to the heap.
+ */
+class Task {
+public:
+    static constexpr size_t kInlineSize = 56;
+
+    Task() noexcept = default;
+
+    template<typename F, typename = std::enable_if_t<!std::is_same<std::decay_t<F>, Task>::value>>
+    Task(F&& f) {
+        using Fn = std::decay_t<F>;
+        if constexpr (sizeof(Fn) <= kInlineSize && alignof(Fn) <= alignof(std::max_align_t) &&
+                      std::is_nothrow_move_constructible<Fn>::value) {
+            new (storage_) Fn(std::forward<F>(f));
+            ops_ = &InlineOps<Fn>::kOps;
+        } else {
+            new (storage_) Fn*(new Fn(std::forward<F>(f)));
+            ops_ = &HeapOps<Fn>::kOps;
+        }
+    }
+
+    Task(Task&& other) noexcept { MoveFrom(other); }
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            MoveFrom(other);
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() { Reset(); }
+
+    explicit operator bool() const noexcept { return ops_ != nullptr; }
+    void operator()() { ops_->invoke(storage_); }
+
+private:
+    struct Ops {
+        void (*invoke)(void* storage);
+        void (*relocate)(void* dst, void* src);   // Move-construct into dst, destroy src
+        void (*destroy)(void* storage);
+    };
+
+    template<typename Fn>
+    struct InlineOps {
+        static void Invoke(void* p) { (*static_cast<Fn*>(p))(); }
+        static void Relocate(void* dst, void* src) {
+            new (dst) Fn(std::move(*static_cast<Fn*>(src)));
+            static_cast<Fn*>(src)->~Fn();
+        }
+        static void Destroy(void* p) { static_cast<Fn*>(p)->~Fn(); }
+        static constexpr Ops kOps{&Invoke, &Relocate, &Destroy};
+    };
+
+    template<typename Fn>
+    struct HeapOps {
+        static void Invoke(void* p) { (**static_cast<Fn**>(p))(); }
+        static void Relocate(void* dst, void* src) { new (dst) Fn*(*static_cast<Fn**>(src)); }
+        static void Destroy(void* p) { delete *static_cast<Fn**>(p); }
+        static constexpr Ops kOps{&Invoke, &Relocate, &Destroy};
+    };
+
+    void MoveFrom(Task& other) noexcept {
+        if (other.ops_) {
+            other.ops_->relocate(storage_, other.storage_);
+            ops_ = other.ops_;
+            other.ops_ = nullptr;
+        }
+    }
+
+    void Reset() noexcept {
+        if (ops_) {
+            ops_->destroy(storage_);
+            ops_ = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char storage_[kInlineSize];
+    const Ops* ops_{nullptr};
+};
+
+/**
+ * @brief Work-stealing thread pool
+ *
+ * Every worker owns a deque of tasks. Tasks submitted from a worker go to its
+ * own deque and are taken newest-first (their data is still in cache); tasks
+ * from other threads are spread round-robin over the workers. An idle worker
+ * steals the oldest task of another worker before going to sleep. Threads
+ * waiting on a TaskGroup run pending tasks instead of blocking, so groups can
+ * be nested inside pool tasks.
  */
 class ThreadPool {
 public:
@@ -26,33 +129,91 @@ public:
     ThreadPool(ThreadPool&&) = delete;
     ThreadPool& operator=(ThreadPool&&) = delete;
     
-    // Submit a task to the thread pool
+    // Submit a task to the thread pool; prefer TaskGroup/ParallelFor, which do not allocate a future
     template<typename F, typename... Args>
-    auto Submit(F&& f, Args&&... args) -> std::future<typename std::result_of<F(Args...)>::type>;
+    auto Submit(F&& f, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>>;
     
     // Get number of threads
     size_t GetThreadCount() const { return threads_.size(); }
     
-    // Get number of pending tasks
+    // Get number of tasks queued but not yet started
     size_t GetPendingTaskCount() const;
     
-    // Wait for all tasks to complete
+    // Wait until every task submitted so far has finished (not from a pool thread)
     void WaitForAll();
     
-    // Shutdown the thread pool
+    // Run remaining tasks and join the workers
     void Shutdown();
     
+    // Run one queued task on the calling thread; false if there was none
+    bool RunPendingTask();
+    
 private:
-    void WorkerThread();
+    friend class TaskGroup;
+    struct WorkQueue;
+    
+    // Queue a task; false once the pool is shut down
+    bool Push(Task&& task);
+    bool PopTask(Task& task);
+    void RunTask(Task& task);
+    void WorkerThread(size_t index);
     
     std::vector<std::thread> threads_;
-    std::queue<std::function<void()>> tasks_;
+    std::vector<std::unique_ptr<WorkQueue>> queues_;
+    std::atomic<size_t> next_queue_{0};
+    
+    std::atomic<size_t> queued_{0};       // Tasks in the deques
+    std::atomic<size_t> unfinished_{0};   // Queued or running
+    std::atomic<size_t> sleeping_{0};
     
-    mutable std::mutex queue_mutex_;
+    mutable std::mutex sleep_mutex_;
     std::condition_variable condition_;
+    std::condition_variable done_condition_;
     std::atomic<bool> stop_{false};
 };
 
+/**
+ * @brief Set of pool tasks that is waited for as a whole
+ *
+ * Wait() returns once every task run through the group has finished, and
+ * rethrows the first exception one of them threw. The waiting thread runs
+ * pending pool tasks meanwhile. Without a pool tasks run inline.
+ */
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool* pool) : pool_(pool) {}
+    ~TaskGroup();
+    
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+    
+    template<typename F>
+    void Run(F&& f);
+    
+    void Wait();
+    
+private:
+    void Finish();
+    void WaitNoThrow();
+    void SetError(std::exception_ptr error);
+    
+    ThreadPool* pool_;
+    std::atomic<size_t> pending_{0};
+    std::mutex mutex_;
+    std::condition_variable done_;
+    std::exception_ptr error_;
+};
+
+/**
+ * @brief Runs fn(chunk_begin, chunk_end) over [begin, end) in parallel
+ *
+ * The range is split into at most one chunk per pool thread plus one run on
+ * the calling thread, none shorter than `grain` (e.g. enough rows to amortize
+ * the hand-off). Returns when all chunks are done; runs inline without a pool.
+ */
+template<typename F>
+void ParallelFor(ThreadPool* pool, size_t begin, size_t end, size_t grain, const F& fn);
+
 /**
  * @brief Thread-safe queue template
  */
@@ -124,6 +285,77 @@ private:
 void PreciseSleep(const std::chrono::microseconds& duration);
 void PreciseSleep(const std::chrono::milliseconds& duration);
 
+/**
+ * @brief How a thread waits for work that is expected shortly
+ */
+enum class WaitStrategy {
+    BLOCK = 0,      // Park on the condition variable/timer right away
+    SPIN,           // Spin for a bounded time, then park
+    BUSY_POLL       // Never park; needs a core of its own
+};
+
+bool ParseWaitStrategy(const std::string& name, WaitStrategy& strategy);
+
+/**
+ * @brief Tell the core we are in a spin loop (PAUSE on x86, YIELD on ARM)
+ */
+inline void CpuRelax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+/**
+ * @brief Spin until `ready()` holds, within the strategy's budget
+ *
+ * BLOCK only checks once, SPIN gives up after `spin_time` and BUSY_POLL never
+ * does, so its predicate must also become true on shutdown. Returns the last
+ * value of `ready()`; the caller parks if it is false.
+ */
+template<typename Predicate>
+bool SpinWait(WaitStrategy strategy, std::chrono::microseconds spin_time, Predicate ready) {
+    if (strategy == WaitStrategy::BLOCK) {
+        return ready();
+    }
+    
+    auto deadline = std::chrono::steady_clock::now() + spin_time;
+    for (uint32_t n = 1; !ready(); ++n) {
+        CpuRelax();
+        // Reading the clock costs more than a pause, so only check it now and then
+        if (strategy == WaitStrategy::SPIN && (n & 63) == 0 &&
+            std::chrono::steady_clock::now() >= deadline) {
+            return ready();
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Scheduling classes a thread can run under
+ */
+enum class SchedPolicy {
+    OTHER = 0,  // Default time-sharing
+    FIFO,       // Real-time, runs until it blocks or yields
+    RR,         // Real-time, round-robin among equal priorities
+    BATCH,      // Time-sharing, treated as CPU-bound
+    IDLE        // Only runs when nothing else wants the core
+};
+
+/**
+ * @brief Placement and scheduling applied to a thread when it starts
+ *
+ * Default-constructed settings leave the thread as the OS created it.
+ */
+struct ThreadSettings {
+    std::vector<int> cpu_cores;     // Empty = inherit the process mask
+    SchedPolicy policy{SchedPolicy::OTHER};
+    int priority{0};                // 1-99 for FIFO/RR, ignored otherwise
+    bool set_policy{false};         // Change the policy at all
+    std::string name;               // Truncated to 15 characters; empty = keep
+};
+
 /**
  * @brief CPU affinity utilities (Linux-specific)
  */
@@ -140,28 +372,88 @@ public:
     // Thread priority utilities
     static bool SetThreadPriority(std::thread& thread, int priority);
     static bool SetCurrentThreadPriority(int priority);
+    static bool SetCurrentThreadScheduling(SchedPolicy policy, int priority);
+    
+    // Name shown by top/ps/perf for the calling thread
+    static bool SetCurrentThreadName(const std::string& name);
+    
+    // Cores removed from the general scheduler (isolcpus=), within our mask
+    static std::vector<int> GetIsolatedCores();
+    
+    // Parse "2", "0,3" or "4-7,10" into core numbers
+    static bool ParseCoreList(const std::string& list, std::vector<int>& cores);
+    static bool ParseSchedPolicy(const std::string& name, SchedPolicy& policy);
+    
+    // Apply all settings to the calling thread; returns false if any failed
+    static bool ApplyToCurrentThread(const ThreadSettings& settings);
 };
 
 // Template implementations
 template<typename F, typename... Args>
-auto ThreadPool::Submit(F&& f, Args&&... args) -> std::future<typename std::result_of<F(Args...)>::type> {
-    using return_type = typename std::result_of<F(Args...)>::type;
+auto ThreadPool::Submit(F&& f, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>> {
+    using return_type = std::invoke_result_t<F, Args...>;
     
-    auto task = std::make_shared<std::packaged_task<return_type()>>(
-        std::bind(std::forward<F>(f), std::forward<Args>(args)...));
+    std::packaged_task<return_type()> task(
+        [f = std::forward<F>(f), args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+            return std::apply(std::move(f), std::move(args));
+        });
     
-    std::future<return_type> result = task->get_future();
-    
-    {
-        std::lock_guard<std::mutex> lock(queue_mutex_);
-        if (stop_) {
-            throw std::runtime_error("ThreadPool is stopped");
+    std::future<return_type> result = task.get_future();
+    if (!Push(Task(std::move(task)))) {
+        throw std::runtime_error("ThreadPool is stopped");
+    }
+    return result;
+}
+
+template<typename F>
+void TaskGroup::Run(F&& f) {
+    if (pool_) {
+        pending_.fetch_add(1);
+        bool queued = pool_->Push(Task([this, f = std::forward<F>(f)]() mutable {
+            try {
+                f();
+            } catch (...) {
+                SetError(std::current_exception());
+            }
+            // Release captured state before Wait() can return
+            { [[maybe_unused]] auto done = std::move(f); }
+            Finish();
+        }));
+        if (queued) {
+            return;
         }
-        tasks_.emplace([task](){ (*task)(); });
+        pending_.fetch_sub(1);
     }
     
-    condition_.notify_one();
-    return result;
+    try {
+        f();
+    } catch (...) {
+        SetError(std::current_exception());
+    }
+}
+
+template<typename F>
+void ParallelFor(ThreadPool* pool, size_t begin, size_t end, size_t grain, const F& fn) {
+    if (end <= begin) {
+        return;
+    }
+    
+    size_t count = end - begin;
+    grain = std::max<size_t>(grain, 1);
+    size_t chunks = pool ? std::min(pool->GetThreadCount() + 1, (count + grain - 1) / grain) : 1;
+    if (chunks <= 1) {
+        fn(begin, end);
+        return;
+    }
+    
+    TaskGroup group(pool);
+    for (size_t c = 1; c < chunks; ++c) {
+        group.Run([&fn, begin, count, chunks, c]() {
+            fn(begin + count * c / chunks, begin + count * (c + 1) / chunks);
+        });
+    }
+    fn(begin, begin + count / chunks);
+    group.Wait();
 }
 
 template<typename T>
@@ -6,7 +6,7 @@
  * 
  * This header provides access to all the core components of the video pipeline framework:
  * - Buffer and video frame interfaces
- * - Block interfaces (IBlock, IVideoSource, IVideoSink)
+ * - Block interfaces (IBlock, IVideoSource, IVideoSink, BaseVideoProcessor)
  * - Pipeline management (PipelineManager, BlockRegistry)
  * - Configuration parsing
  * - Logging and timing utilities
@@ -17,10 +17,13 @@
 #include "block.h"
 #include "video_source.h"
 #include "video_sink.h"
+#include "video_processor.h"
 
 // Framework management
 #include "pipeline_manager.h"
+#include "pipeline_host.h"
 #include "block_registry.h"
+#include "executor.h"
 #include "config_parser.h"
 
 // Utilities
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "video_source.h"
+#include "video_sink.h"
+#include <memory>
+#include <vector>
+
+namespace video_pipeline {
+
+class RowStage;
+
+/**
+ * @brief Base video processor implementation
+ *
+ * A processor consumes frames like a sink (queue + worker thread inherited
+ * from BaseVideoSink) and produces frames like a source. Derived classes
+ * implement ProcessFrameImpl() and call EmitFrame() for each output frame.
+ */
+class BaseVideoProcessor : public BaseVideoSink, public IVideoSource {
+public:
+    BaseVideoProcessor(const std::string& name, const std::string& type);
+    virtual ~BaseVideoProcessor();
+    
+    // IVideoSource implementation
+    bool SetFrameCallback(FrameCallback callback) override;
+    bool SetCreditProbe(CreditProbe probe) override;
+    FrameInfo GetOutputFormat() const override { return output_format_; }
+    bool SetOutputFormat(const FrameInfo& format) override;
+    
+    double GetFrameRate() const override { return frame_rate_; }
+    bool SetFrameRate(double fps) override;
+    size_t GetBufferCount() const override { return buffer_count_; }
+    bool SetBufferCount(size_t count) override;
+    
+    // Processors accept any resolution unless they override this
+    std::vector<std::pair<uint32_t, uint32_t>> GetSupportedResolutions() const override { return {}; }
+    
+    // IVideoSink override: keeps the output format in step with the input
+    bool SetInputFormat(const FrameInfo& format) override;
+    
+    // IVideoSink override: no credit while every downstream edge is full, so
+    // backpressure reaches the source through a chain of processors
+    bool HasCapacity(const EdgePolicy& policy) const override;
+    
+    // IBlock implementation: common processor parameters
+    bool Initialize(const BlockParams& params) override;
+    
+    // Memory backing for the output pool (huge pages, prefault, mlock, memfd)
+    bool SetFrameMemory(const FrameMemoryOptions& options);
+    const FrameMemoryOptions& GetFrameMemory() const { return frame_memory_; }
+    
+    // Strip-wise form of this processor with its current settings, so the
+    // pipeline can fuse it with adjacent transforms (see FusedTransform);
+    // nullptr if it must see whole frames. Each call returns an independent
+    // stage; the processor must outlive it.
+    virtual std::unique_ptr<RowStage> CreateRowStage() const;
+    
+protected:
+    // Output format produced for a given input format (identity by default)
+    virtual FrameInfo DeriveOutputFormat(const FrameInfo& input) const { return input; }
+    
+    // Forward a processed frame downstream
+    void EmitFrame(VideoFramePtr frame);
+    
+    // Output frame from a recycling pool of up to buffer_count_ frames. A pooled
+    // frame is handed out again once no downstream block holds a reference;
+    // the pool's own reference does not stop a consumer writing in place.
+    // With prefault or lock set the whole pool is allocated on first use.
+    VideoFramePtr AcquireOutputFrame(const FrameInfo& info, size_t capacity = 0);
+    
+    // Copy-on-write for in-place processing: keeps an exclusively owned frame,
+    // otherwise swaps in a copy taken from the output pool. Counted in the
+    // block's statistics.
+    bool MakeWritable(VideoFramePtr& frame);
+    
+    // Configuration
+    FrameInfo output_format_;
+    double frame_rate_{0.0};   // 0 = same as input
+    size_t buffer_count_{3};
+    
+    // Frame emission
+    FrameCallback frame_callback_;
+    CreditProbe credit_probe_;
+    
+private:
+    // Drop the pool's references, unmarking them first
+    void ReleaseOutputPool();
+    
+    std::vector<VideoFramePtr> output_pool_;
+    FrameMemoryOptions frame_memory_;
+};
+
+} // namespace video_pipeline
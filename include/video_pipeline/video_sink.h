@@ -2,13 +2,37 @@
 
 #include "block.h"
 #include "buffer.h"
-#include <queue>
+#include <chrono>
+#include <deque>
 #include <condition_variable>
 #include <thread>
 #include <atomic>
 
 namespace video_pipeline {
 
+/**
+ * @brief What a connection does with a frame when the sink's queue is full
+ */
+enum class DropPolicy {
+    BLOCK = 0,          // Wait for space (up to EdgePolicy::block_timeout), then drop the new frame
+    DROP_NEWEST,        // Discard the incoming frame
+    DROP_OLDEST,        // Discard the oldest queued frame
+    LATEST_ONLY,        // Always replace whatever is queued with the new frame
+    DROP_NON_KEYFRAMES  // Discard non-keyframes; a keyframe evicts the oldest non-keyframe
+};
+
+bool ParseDropPolicy(const std::string& name, DropPolicy& policy);
+const char* DropPolicyToString(DropPolicy policy);
+
+/**
+ * @brief Delivery policy of one connection into a sink
+ */
+struct EdgePolicy {
+    DropPolicy drop{DropPolicy::BLOCK};
+    std::chrono::milliseconds block_timeout{0};     // BLOCK only; 0 = wait indefinitely
+    size_t port{0};     // Input port of the sink the connection ends at (see IVideoSink::GetInputPorts)
+};
+
 /**
  * @brief Video sink interface
  */
@@ -18,6 +42,25 @@ public:
     
     // Sink-specific methods
     virtual bool ProcessFrame(VideoFramePtr frame) = 0;
+    
+    // Deliver a frame under a connection's policy; false if it was not queued
+    virtual bool PushFrame(VideoFramePtr frame, const EdgePolicy& /*policy*/) {
+        return ProcessFrame(std::move(frame));
+    }
+    
+    // Credit: whether a frame pushed now under `policy` would be kept rather
+    // than dropped. Upstream sources use it to skip producing doomed frames.
+    virtual bool HasCapacity(const EdgePolicy& /*policy*/) const { return true; }
+    
+    // Wait until every queued frame has been processed (no new frames must
+    // arrive meanwhile); false if `timeout` expired first
+    virtual bool Drain(std::chrono::milliseconds /*timeout*/) { return true; }
+    
+    // Names of the inputs a connection's `sink_input` may select. A frame's
+    // input reaches PushFrame() as the index of its port in EdgePolicy::port.
+    // Blocks with several inputs take each input's frame size as it comes.
+    virtual std::vector<std::string> GetInputPorts() const { return {"input"}; }
+    
     virtual FrameInfo GetInputFormat() const = 0;
     virtual bool SetInputFormat(const FrameInfo& format) = 0;
     
@@ -33,6 +76,13 @@ public:
     // Sink-specific capabilities
     virtual bool SupportsFormat(PixelFormat format) const = 0;
     virtual std::vector<PixelFormat> GetSupportedFormats() const = 0;
+    
+    // Input the pipeline's format negotiation may deliver: formats in order of
+    // preference (candidates when a conversion is needed) and resolutions
+    // (empty = any). Defaults to what the block supports.
+    virtual bool AcceptsFormat(PixelFormat format) const { return SupportsFormat(format); }
+    virtual std::vector<PixelFormat> GetAcceptedFormats() const { return GetSupportedFormats(); }
+    virtual std::vector<std::pair<uint32_t, uint32_t>> GetAcceptedResolutions() const { return {}; }
 };
 
 /**
@@ -43,8 +93,11 @@ public:
     BaseVideoSink(const std::string& name, const std::string& type);
     virtual ~BaseVideoSink() = default;
     
-    // IVideoSink implementation
+    // IVideoSink implementation (ProcessFrame uses the sink's own `blocking` flag)
     bool ProcessFrame(VideoFramePtr frame) override;
+    bool PushFrame(VideoFramePtr frame, const EdgePolicy& policy) override;
+    bool HasCapacity(const EdgePolicy& policy) const override;
+    bool Drain(std::chrono::milliseconds timeout) override;
     FrameInfo GetInputFormat() const override { return input_format_; }
     bool SetInputFormat(const FrameInfo& format) override;
     
@@ -55,7 +108,16 @@ public:
     bool IsBlocking() const override { return is_blocking_; }
     void SetBlocking(bool blocking) override { is_blocking_ = blocking; }
     
+    // Narrowed by the `accept_formats` and `accept_resolutions` parameters
+    bool AcceptsFormat(PixelFormat format) const override;
+    std::vector<PixelFormat> GetAcceptedFormats() const override;
+    std::vector<std::pair<uint32_t, uint32_t>> GetAcceptedResolutions() const override { return accepted_resolutions_; }
+    
+    // Live reconfiguration: `queue_depth`
+    bool IsHotParameter(const std::string& key) const override;
+    
     // Common functionality
+    BlockStats GetStats() const override;
     bool Initialize(const BlockParams& params) override;
     bool Start() override;
     bool Stop() override;
@@ -65,20 +127,46 @@ protected:
     // Pure virtual method for derived classes to implement
     virtual bool ProcessFrameImpl(VideoFramePtr frame) = 0;
     
+    // Called from ProcessFrameImpl() for a frame the block consumed on
+    // purpose without processing it (decimated, gated out, no room to keep
+    // it): the frame is counted once, as dropped, even though
+    // ProcessFrameImpl() returns true
+    void DiscardFrame() { frame_discarded_ = true; }
+    
+    void ApplyParameter(const std::string& key, const std::string& value) override;
+    
     // Configuration
     FrameInfo input_format_;
-    size_t max_queue_depth_{10};
+    std::atomic<size_t> max_queue_depth_{10};   // Hot: `queue_depth`
     bool is_blocking_{true};
+    std::vector<PixelFormat> accepted_formats_;     // Empty = whatever SupportsFormat allows
+    std::vector<std::pair<uint32_t, uint32_t>> accepted_resolutions_;
     
 private:
+    // Frames handed to a scheduled sink per executor task before yielding
+    static constexpr size_t kScheduledBatch = 4;
+    
     // Worker thread for processing frames
     void WorkerThread();
     
+    // Executor task draining the queue in scheduled mode
+    void RunScheduled();
+    void HandleFrame(VideoFramePtr frame);
+    void FinishFrame();
+    
+    // Make room for `frame` in a full queue; false if the frame is dropped instead
+    bool MakeRoom(std::unique_lock<std::mutex>& lock, const VideoFramePtr& frame, const EdgePolicy& policy);
+    
     // Frame queue and synchronization
-    std::queue<VideoFramePtr> frame_queue_;
+    std::deque<VideoFramePtr> frame_queue_;
     mutable std::mutex queue_mutex_;
     std::condition_variable queue_condition_;
     std::condition_variable queue_not_full_condition_;
+    std::condition_variable idle_condition_;        // Queue empty and nothing in flight
+    size_t in_flight_{0};       // Frames taken off the queue but not yet processed
+    bool frame_discarded_{false};   // Set by DiscardFrame() for the frame in HandleFrame()
+    bool scheduled_{false};     // A drain task is queued or running
+    std::atomic<size_t> queued_frames_{0};  // frame_queue_.size(), readable without the lock
     
     // Thread management
     std::thread worker_thread_;
@@ -5,6 +5,7 @@
 #include <functional>
 #include <queue>
 #include <condition_variable>
+#include <thread>
 
 namespace video_pipeline {
 
@@ -13,6 +14,21 @@ namespace video_pipeline {
  */
 using FrameCallback = std::function<void(VideoFramePtr frame)>;
 
+/**
+ * @brief Downstream credit query: true if at least one outgoing connection
+ * would keep a frame emitted now
+ */
+using CreditProbe = std::function<bool()>;
+
+/**
+ * @brief What a producer source does when downstream has no credit
+ */
+enum class CongestionMode {
+    IGNORE = 0,     // Produce anyway and let the connections drop
+    SKIP,           // Skip this frame slot
+    THROTTLE        // Skip and halve the frame rate (down to 1/8) until credit returns
+};
+
 /**
  * @brief Video source interface
  */
@@ -22,6 +38,9 @@ public:
     
     // Source-specific methods
     virtual bool SetFrameCallback(FrameCallback callback) = 0;
+    
+    // Backpressure from the pipeline; sources that cannot skip work ignore it
+    virtual bool SetCreditProbe(CreditProbe /*probe*/) { return false; }
     virtual FrameInfo GetOutputFormat() const = 0;
     virtual bool SetOutputFormat(const FrameInfo& format) = 0;
     
@@ -49,6 +68,7 @@ public:
     
     // IVideoSource implementation
     bool SetFrameCallback(FrameCallback callback) override;
+    bool SetCreditProbe(CreditProbe probe) override;
     double GetFrameRate() const override { return frame_rate_; }
     bool SetFrameRate(double fps) override;
     size_t GetBufferCount() const override { return buffer_count_; }
@@ -58,11 +78,30 @@ public:
     bool Initialize(const BlockParams& params) override;
     bool Stop() override;
     
+    // Live reconfiguration: `fps`, `congestion`
+    bool IsHotParameter(const std::string& key) const override;
+    
 protected:
+    void ApplyParameter(const std::string& key, const std::string& value) override;
+    
+
     // Helper methods for derived classes
     void EmitFrame(VideoFramePtr frame);
     bool ShouldEmitFrame() const;  // For frame rate limiting
     
+    // Producer loop for sources that generate frames at their own pace (test
+    // patterns, file playback): ProduceFrame() is called once per frame
+    // interval on a producer thread, or as timed executor tasks when the
+    // block is scheduled. It returns false at the end of the stream.
+    virtual bool ProduceFrame() { return false; }
+    void StartProducer();
+    void StopProducer();
+    
+    // Consult downstream credit before producing a frame. Returns false if
+    // the `congestion` mode says to skip it; the skip is counted and the
+    // next frame slot is one (possibly throttled) interval later.
+    bool HasDownstreamCredit();
+    
     // Configuration
     FrameInfo output_format_;
     double frame_rate_{30.0};
@@ -73,8 +112,30 @@ protected:
     std::chrono::steady_clock::time_point last_frame_time_;
     std::chrono::microseconds frame_interval_{33333}; // ~30 FPS
     
+    // Backpressure
+    CreditProbe credit_probe_;
+    CongestionMode congestion_mode_{CongestionMode::SKIP};
+    
 private:
+    static constexpr uint32_t kMaxThrottle = 3;     // Up to 8x the frame interval
+    
     void UpdateFrameInterval();
+    void SetCongestionMode(const std::string& mode);
+    std::chrono::microseconds CurrentInterval() const { return frame_interval_ * (1 << throttle_); }
+    void ProducerThread();
+    void ProducerTick();
+    void WaitForNextFrame();
+    
+    std::thread producer_thread_;
+    std::atomic<bool> stop_producer_{false};
+    uint32_t throttle_{0};      // Interval doubled this many times under congestion
+    
+    // Producer thread parks on these until the next frame is due; a scheduled
+    // producer keeps one tick queued or running while active
+    std::mutex producer_mutex_;
+    std::condition_variable producer_condition_;
+    bool producer_active_{false};
+    uint64_t producer_timer_{0};
 };
 
 } // namespace video_pipeline
\ No newline at end of file
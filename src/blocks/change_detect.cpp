@@ -0,0 +1,418 @@
+#include "video_pipeline/blocks/change_detect.h"
+#include "video_pipeline/logger.h"
+#include "video_pipeline/timer.h"
+#include "utils/frame_planes.h"
+#include "utils/simd.h"
+#include <algorithm>
+
+namespace video_pipeline {
+
+using namespace simd;
+
+namespace {
+
+// How the bytes of a source row feed the 16-bit column sums
+enum class RowLayout {
+    BYTES,      // Every byte (RGB channels, or luma at full resolution)
+    PAIRS,      // Two neighbouring luma bytes per sum (planar luma)
+    EVEN,       // Even bytes only (YUYV luma)
+    ODD         // Odd bytes only (UYVY luma)
+};
+
+// Start (add = false) or continue column sums of a row of `bytes` bytes. The
+// 16-bit lanes of a byte vector hold an even byte low and an odd byte high,
+// so the packed layouts need only a mask or a shift.
+template<RowLayout kLayout>
+void AccumulateRow(const uint8_t* row, uint16_t* sums, size_t bytes, bool add) {
+    size_t x = 0;
+    for (; x + 16 <= bytes; x += 16) {
+        u8x16 v = Load<u8x16>(row + x);
+        if constexpr (kLayout == RowLayout::BYTES) {
+            u16x8 low = WidenLow(v);
+            u16x8 high = WidenHigh(v);
+            if (add) {
+                low += Load<u16x8>(sums + x);
+                high += Load<u16x8>(sums + x + 8);
+            }
+            Store(sums + x, low);
+            Store(sums + x + 8, high);
+        } else {
+            u16x8 lanes = (u16x8)v;
+            u16x8 values;
+            if constexpr (kLayout == RowLayout::PAIRS) {
+                values = (lanes & 0xff) + (lanes >> 8);
+            } else if constexpr (kLayout == RowLayout::EVEN) {
+                values = lanes & 0xff;
+            } else {
+                values = lanes >> 8;
+            }
+            if (add) {
+                values += Load<u16x8>(sums + x / 2);
+            }
+            Store(sums + x / 2, values);
+        }
+    }
+    if constexpr (kLayout == RowLayout::BYTES) {
+        for (; x < bytes; ++x) {
+            sums[x] = (add ? sums[x] : 0) + row[x];
+        }
+    } else {
+        for (; x + 2 <= bytes; x += 2) {
+            uint16_t value = kLayout == RowLayout::PAIRS ? row[x] + row[x + 1]
+                           : kLayout == RowLayout::EVEN  ? row[x] : row[x + 1];
+            sums[x / 2] = (add ? sums[x / 2] : 0) + value;
+        }
+    }
+}
+
+// out[i] = in[2i] + in[2i + 1]; `out` may be `in`
+void PairwiseAdd(const uint16_t* in, uint16_t* out, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        u16x8 a = Load<u16x8>(in + 2 * i);
+        u16x8 b = Load<u16x8>(in + 2 * i + 8);
+        Store(out + i, u16x8(EvenLanes(a, b) + OddLanes(a, b)));
+    }
+    for (; i < count; ++i) {
+        out[i] = in[2 * i] + in[2 * i + 1];
+    }
+}
+
+// BT.601 luma of summed RGB channels (sums of up to 8 rows stay below 2^16)
+void WeightRgb(const uint16_t* in, uint16_t* out, size_t count, uint32_t step, uint32_t red, uint32_t blue) {
+    for (size_t i = 0; i < count; ++i, in += step) {
+        out[i] = static_cast<uint16_t>((77 * in[red] + 150 * in[1] + 29 * in[blue]) >> 8);
+    }
+}
+
+// Add |luma - background| per pixel to `column_sums`, then move the 8.8
+// background 1/2^shift of the way toward the luma
+void DiffAndLearn(const uint8_t* luma, uint16_t* background, uint16_t* column_sums, size_t count,
+                  unsigned shift) {
+    auto update = [shift](u16x8 current, uint16_t* reference_ptr, uint16_t* sum_ptr) {
+        current <<= 8;
+        u16x8 reference = Load<u16x8>(reference_ptr);
+        u16x8 rising = (u16x8)(current > reference);
+        u16x8 delta = ((current - reference) & rising) | ((reference - current) & ~rising);
+        u16x8 step = delta >> shift;
+        Store(sum_ptr, u16x8(Load<u16x8>(sum_ptr) + (delta >> 8)));
+        Store(reference_ptr, u16x8(reference + (step & rising) - (step & ~rising)));
+    };
+
+    size_t x = 0;
+    for (; x + 16 <= count; x += 16) {
+        u8x16 v = Load<u8x16>(luma + x);
+        update(WidenLow(v), background + x, column_sums + x);
+        update(WidenHigh(v), background + x + 8, column_sums + x + 8);
+    }
+    for (; x < count; ++x) {
+        uint16_t current = static_cast<uint16_t>(luma[x] << 8);
+        uint16_t reference = background[x];
+        uint16_t delta = current > reference ? current - reference : reference - current;
+        column_sums[x] += delta >> 8;
+        uint16_t step = delta >> shift;
+        background[x] = current > reference ? reference + step : reference - step;
+    }
+}
+
+unsigned Log2(uint32_t value) {
+    unsigned bits = 0;
+    while (value > 1) {
+        value >>= 1;
+        ++bits;
+    }
+    return bits;
+}
+
+} // namespace
+
+ChangeDetect::ChangeDetect()
+    : BaseVideoProcessor("ChangeDetect", "ChangeDetect") {
+}
+
+ChangeDetect::~ChangeDetect() {
+    Shutdown();
+}
+
+bool ChangeDetect::SupportsFormat(PixelFormat format) const {
+    return PackedBytesPerPixel(format) != 0;
+}
+
+std::vector<PixelFormat> ChangeDetect::GetSupportedFormats() const {
+    return {
+        PixelFormat::NV12,
+        PixelFormat::NV21,
+        PixelFormat::YUV420P,
+        PixelFormat::YUYV,
+        PixelFormat::UYVY,
+        PixelFormat::RGB24,
+        PixelFormat::BGR24,
+        PixelFormat::RGBA32,
+        PixelFormat::BGRA32
+    };
+}
+
+bool ChangeDetect::Initialize(const BlockParams& params) {
+    if (!BaseVideoProcessor::Initialize(params)) {
+        return false;
+    }
+
+    auto scale_str = BaseBlock::GetParameter("scale");
+    if (!scale_str.empty()) {
+        scale_ = std::stoul(scale_str);
+        if (scale_ != 1 && scale_ != 2 && scale_ != 4 && scale_ != 8) {
+            SetError("ChangeDetect scale must be 1, 2, 4 or 8: " + scale_str);
+            return false;
+        }
+    }
+
+    auto tile_str = BaseBlock::GetParameter("tile");
+    if (!tile_str.empty()) {
+        tile_size_ = std::stoul(tile_str);
+        if (tile_size_ == 0 || tile_size_ > 256) {
+            SetError("ChangeDetect tile must be 1-256: " + tile_str);
+            return false;
+        }
+    }
+
+    auto threshold_str = BaseBlock::GetParameter("threshold");
+    if (!threshold_str.empty()) {
+        threshold_ = std::min<uint32_t>(255, std::stoul(threshold_str));
+    }
+
+    auto min_tiles_str = BaseBlock::GetParameter("min_tiles");
+    if (!min_tiles_str.empty()) {
+        min_tiles_ = std::max<uint32_t>(1, std::stoul(min_tiles_str));
+    }
+
+    // Time constant in frames, rounded to a power of two
+    auto frames_str = BaseBlock::GetParameter("background_frames");
+    if (!frames_str.empty()) {
+        uint32_t frames = std::min<uint32_t>(256, std::max<uint32_t>(1, std::stoul(frames_str)));
+        learn_shift_ = Log2(frames + frames / 2);
+    }
+
+    gate_ = BaseBlock::GetParameter("gate") == "true";
+
+    auto hold_str = BaseBlock::GetParameter("hold_ms");
+    if (!hold_str.empty()) {
+        hold_us_ = std::stoull(hold_str) * 1000;
+    }
+
+    VP_LOG_INFO_F("ChangeDetect initialized: scale=1/{}, tile={}, threshold={}, min_tiles={}, background={} frames{}",
+                  scale_, tile_size_ * scale_, threshold_, min_tiles_, 1u << learn_shift_,
+                  gate_ ? ", gating" : "");
+    return true;
+}
+
+bool ChangeDetect::Start() {
+    // Learn the scene again after a restart
+    background_.clear();
+    holding_ = false;
+    return BaseVideoProcessor::Start();
+}
+
+bool ChangeDetect::IsHotParameter(const std::string& key) const {
+    return key == "threshold" || key == "min_tiles" || BaseVideoProcessor::IsHotParameter(key);
+}
+
+void ChangeDetect::ApplyParameter(const std::string& key, const std::string& value) {
+    if (key == "threshold") {
+        threshold_ = std::min<uint32_t>(255, std::stoul(value));
+    } else if (key == "min_tiles") {
+        min_tiles_ = std::max<uint32_t>(1, std::stoul(value));
+    } else {
+        BaseVideoProcessor::ApplyParameter(key, value);
+    }
+}
+
+bool ChangeDetect::DownsampleLuma(const IVideoFrame& frame) {
+    FramePlanes planes;
+    if (!ResolvePlanes(frame, planes)) {
+        return false;
+    }
+
+    uint32_t width = planes.width / scale_;
+    uint32_t height = planes.height / scale_;
+    if (width == 0 || height == 0) {
+        return false;
+    }
+    if (width != luma_width_ || height != luma_height_) {
+        luma_width_ = width;
+        luma_height_ = height;
+        luma_.assign(static_cast<size_t>(width) * height, 0);
+        column_sums_.assign(width, 0);
+        background_.clear();
+    }
+
+    // Box filter: vertical sums of `scale_` rows, reduced to one luma sum
+    // per column, then halved in width until `scale_` columns are summed.
+    // Planar luma is already summed in pairs by the vertical pass.
+    const uint32_t columns = width * scale_;
+    const unsigned rounds = Log2(scale_);
+    uint32_t step = PackedBytesPerPixel(planes.format);
+    uint32_t red = 0, blue = 2;
+    void (*accumulate)(const uint8_t*, uint16_t*, size_t, bool) = AccumulateRow<RowLayout::BYTES>;
+    uint32_t count = columns;
+    unsigned pairwise_rounds = rounds;
+    switch (planes.format) {
+        case PixelFormat::YUV420P:
+        case PixelFormat::NV12:
+        case PixelFormat::NV21:
+            step = 1;
+            if (scale_ > 1) {
+                accumulate = AccumulateRow<RowLayout::PAIRS>;
+                count = columns / 2;
+                pairwise_rounds = rounds - 1;
+            }
+            break;
+        case PixelFormat::YUYV:
+            accumulate = AccumulateRow<RowLayout::EVEN>;
+            break;
+        case PixelFormat::UYVY:
+            accumulate = AccumulateRow<RowLayout::ODD>;
+            break;
+        case PixelFormat::BGR24:
+        case PixelFormat::BGRA32:
+            red = 2;
+            blue = 0;
+            break;
+        default:
+            break;
+    }
+    const bool rgb = step >= 3;
+
+    const size_t row_bytes = static_cast<size_t>(columns) * step;
+    row_sums_.resize(row_bytes);
+    for (uint32_t y = 0; y < height; ++y) {
+        const uint8_t* row = planes.plane[0] + static_cast<size_t>(y) * scale_ * planes.stride[0];
+        for (uint32_t r = 0; r < scale_; ++r, row += planes.stride[0]) {
+            accumulate(row, row_sums_.data(), row_bytes, r > 0);
+        }
+
+        uint16_t* sums = row_sums_.data();
+        if (rgb) {
+            WeightRgb(sums, sums, columns, step, red, blue);
+        }
+        for (unsigned i = 0, n = count / 2; i < pairwise_rounds; ++i, n /= 2) {
+            PairwiseAdd(sums, sums, n);
+        }
+
+        uint8_t* out = luma_.data() + static_cast<size_t>(y) * width;
+        uint32_t x = 0;
+        for (; x + 8 <= width; x += 8) {
+            StoreNarrow(out + x, u16x8(Load<u16x8>(sums + x) >> (2 * rounds)));
+        }
+        for (; x < width; ++x) {
+            out[x] = static_cast<uint8_t>(sums[x] >> (2 * rounds));
+        }
+    }
+    return true;
+}
+
+std::shared_ptr<ChangeMap> ChangeDetect::Compare() {
+    auto change = std::make_shared<ChangeMap>();
+    change->tile_width = tile_size_ * scale_;
+    change->tile_height = tile_size_ * scale_;
+    change->tiles_x = (luma_width_ + tile_size_ - 1) / tile_size_;
+    change->tiles_y = (luma_height_ + tile_size_ - 1) / tile_size_;
+    const size_t tile_count = static_cast<size_t>(change->tiles_x) * change->tiles_y;
+    change->tiles.assign((tile_count + 63) / 64, 0);
+
+    // The first frame becomes the background
+    if (background_.empty()) {
+        background_.resize(luma_.size());
+        for (size_t i = 0; i < luma_.size(); ++i) {
+            background_[i] = static_cast<uint16_t>(luma_[i] << 8);
+        }
+        return change;
+    }
+
+    // Differences are summed per column over a row of tiles (at most
+    // 256 x 255, within 16 bits) and reduced to tile sums once per row of tiles
+    tile_sums_.assign(tile_count, 0);
+    uint64_t total = 0;
+    for (uint32_t ty = 0; ty < change->tiles_y; ++ty) {
+        std::fill(column_sums_.begin(), column_sums_.end(), 0);
+        uint32_t y_end = std::min(luma_height_, (ty + 1) * tile_size_);
+        for (uint32_t y = ty * tile_size_; y < y_end; ++y) {
+            size_t offset = static_cast<size_t>(y) * luma_width_;
+            DiffAndLearn(luma_.data() + offset, background_.data() + offset, column_sums_.data(), luma_width_,
+                         learn_shift_);
+        }
+
+        uint32_t* sums = tile_sums_.data() + static_cast<size_t>(ty) * change->tiles_x;
+        for (uint32_t x = 0; x < luma_width_; ++x) {
+            sums[x / tile_size_] += column_sums_[x];
+        }
+        for (uint32_t tx = 0; tx < change->tiles_x; ++tx) {
+            total += sums[tx];
+        }
+    }
+
+    // Partial tiles at the right and bottom edge are judged by their own area
+    uint32_t changed_tiles = 0;
+    for (uint32_t ty = 0; ty < change->tiles_y; ++ty) {
+        uint32_t rows = std::min(tile_size_, luma_height_ - ty * tile_size_);
+        for (uint32_t tx = 0; tx < change->tiles_x; ++tx) {
+            uint32_t columns = std::min(tile_size_, luma_width_ - tx * tile_size_);
+            size_t index = static_cast<size_t>(ty) * change->tiles_x + tx;
+            if (tile_sums_[index] > threshold_ * rows * columns) {
+                change->tiles[index / 64] |= uint64_t{1} << (index % 64);
+                ++changed_tiles;
+            }
+        }
+    }
+
+    change->score = static_cast<float>(changed_tiles) / tile_count;
+    change->mean_difference = static_cast<float>(total) / luma_.size();
+    change->changed = changed_tiles >= min_tiles_;
+    return change;
+}
+
+bool ChangeDetect::ProcessFrameImpl(VideoFramePtr frame) {
+    if (!frame || !frame->IsValid()) {
+        VP_LOG_WARNING_F("ChangeDetect '{}' received invalid frame", GetName());
+        return false;
+    }
+
+    if (!SupportsFormat(frame->GetFrameInfo().pixel_format) || !DownsampleLuma(*frame)) {
+        VP_LOG_WARNING_F("ChangeDetect '{}' cannot analyse {}", GetName(), frame->GetFrameInfo().ToString());
+        return false;
+    }
+
+    auto change = Compare();
+
+    uint64_t now_us = frame->GetFrameInfo().timestamp_us;
+    if (now_us == 0) {
+        now_us = Timer::GetCurrentTimestampUs();
+    }
+    if (change->changed) {
+        last_change_us_ = now_us;
+        holding_ = true;
+    } else if (holding_ && now_us - last_change_us_ >= hold_us_) {
+        holding_ = false;
+    }
+
+    if (gate_ && !holding_) {
+        DiscardFrame();
+        return true;
+    }
+
+    // Annotate a private frame in place; a shared one gets a view of its own
+    FrameInfo info = frame->GetFrameInfo();
+    info.change = std::move(change);
+    if (!frame->CanWriteInPlace()) {
+        auto view = CreateFrameView(frame, 0, 0, info.width, info.height);
+        if (!view || view->GetFrameInfo().width != info.width || view->GetFrameInfo().height != info.height) {
+            EmitFrame(std::move(frame));
+            return true;
+        }
+        frame = std::move(view);
+    }
+    frame->SetFrameInfo(info);
+    EmitFrame(std::move(frame));
+    return true;
+}
+
+} // namespace video_pipeline
@@ -0,0 +1,547 @@
+#include "video_pipeline/blocks/color_convert.h"
+#include "video_pipeline/logger.h"
+#include "utils/frame_planes.h"
+#include "utils/row_stage.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace video_pipeline {
+
+namespace {
+
+enum class Family {
+    NONE,
+    RGB,        // Packed RGB with or without alpha
+    YUV420,     // YUV420P, NV12, NV21
+    YUV422      // YUYV, UYVY
+};
+
+Family FamilyOf(PixelFormat format) {
+    switch (format) {
+        case PixelFormat::RGB24:
+        case PixelFormat::BGR24:
+        case PixelFormat::RGBA32:
+        case PixelFormat::BGRA32: return Family::RGB;
+        case PixelFormat::YUV420P:
+        case PixelFormat::NV12:
+        case PixelFormat::NV21: return Family::YUV420;
+        case PixelFormat::YUYV:
+        case PixelFormat::UYVY: return Family::YUV422;
+        default: return Family::NONE;
+    }
+}
+
+// Byte offsets of R, G, B and A within a packed RGB pixel (a < 0: no alpha)
+struct RgbLayout {
+    int r, g, b, a;
+    uint32_t bpp;
+};
+
+RgbLayout RgbLayoutOf(PixelFormat format) {
+    switch (format) {
+        case PixelFormat::BGR24: return {2, 1, 0, -1, 3};
+        case PixelFormat::RGBA32: return {0, 1, 2, 3, 4};
+        case PixelFormat::BGRA32: return {2, 1, 0, 3, 4};
+        default: return {0, 1, 2, -1, 3};
+    }
+}
+
+// Byte offsets within a 4:2:2 pixel pair
+struct PairLayout {
+    int y0, u, y1, v;
+};
+
+PairLayout PairLayoutOf(PixelFormat format) {
+    return (format == PixelFormat::UYVY) ? PairLayout{1, 0, 3, 2} : PairLayout{0, 1, 2, 3};
+}
+
+// Chroma sample pointers of a 4:2:0 row pair; NV12/NV21 interleave with step 2
+struct ChromaRow {
+    const uint8_t* u;
+    const uint8_t* v;
+    uint32_t step;
+};
+
+inline uint8_t Clamp8(int value) {
+    return static_cast<uint8_t>(std::min(255, std::max(0, value)));
+}
+
+/**
+ * Intermediate rows hold 4 bytes per pixel: R, G, B, A for the RGB family and
+ * Y, U, V, 255 for the YUV families.
+ */
+void UnpackRow(const FramePlanes& src, uint32_t y, uint32_t width, uint8_t* out) {
+    const uint8_t* row = src.plane[0] + static_cast<size_t>(src.stride[0]) * y;
+
+    switch (FamilyOf(src.format)) {
+        case Family::RGB: {
+            RgbLayout layout = RgbLayoutOf(src.format);
+            for (uint32_t x = 0; x < width; ++x, row += layout.bpp, out += 4) {
+                out[0] = row[layout.r];
+                out[1] = row[layout.g];
+                out[2] = row[layout.b];
+                out[3] = (layout.a >= 0) ? row[layout.a] : 255;
+            }
+            break;
+        }
+        case Family::YUV420: {
+            uint32_t chroma_y = std::min(y / 2, src.height / 2 - 1);
+            uint32_t last = src.width / 2 - 1;
+            ChromaRow chroma;
+            if (src.format == PixelFormat::YUV420P) {
+                chroma = {src.plane[1] + static_cast<size_t>(src.stride[1]) * chroma_y,
+                          src.plane[2] + static_cast<size_t>(src.stride[2]) * chroma_y, 1};
+            } else {
+                const uint8_t* uv = src.plane[1] + static_cast<size_t>(src.stride[1]) * chroma_y;
+                bool swap = (src.format == PixelFormat::NV21);
+                chroma = {uv + (swap ? 1 : 0), uv + (swap ? 0 : 1), 2};
+            }
+            for (uint32_t x = 0; x < width; ++x, out += 4) {
+                uint32_t c = std::min(x / 2, last) * chroma.step;
+                out[0] = row[x];
+                out[1] = chroma.u[c];
+                out[2] = chroma.v[c];
+                out[3] = 255;
+            }
+            break;
+        }
+        case Family::YUV422: {
+            PairLayout layout = PairLayoutOf(src.format);
+            uint32_t last = src.width / 2 - 1;
+            for (uint32_t x = 0; x < width; ++x, out += 4) {
+                const uint8_t* pair = row + std::min(x / 2, last) * 4;
+                out[0] = pair[(x & 1) ? layout.y1 : layout.y0];
+                out[1] = pair[layout.u];
+                out[2] = pair[layout.v];
+                out[3] = 255;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+// BT.601 full range, same coefficients as JpegEncode
+void RgbToYuvRow(uint8_t* row, uint32_t width) {
+    for (uint32_t x = 0; x < width; ++x, row += 4) {
+        int r = row[0], g = row[1], b = row[2];
+        row[0] = static_cast<uint8_t>((r * 77 + g * 150 + b * 29 + 128) >> 8);
+        row[1] = static_cast<uint8_t>((b * 128 + 32895 - r * 43 - g * 85) >> 8);
+        row[2] = static_cast<uint8_t>((r * 128 + 32895 - g * 107 - b * 21) >> 8);
+    }
+}
+
+void YuvToRgbRow(uint8_t* row, uint32_t width) {
+    for (uint32_t x = 0; x < width; ++x, row += 4) {
+        int luma = row[0], u = row[1] - 128, v = row[2] - 128;
+        row[0] = Clamp8(luma + ((359 * v + 128) >> 8));
+        row[1] = Clamp8(luma - ((88 * u + 183 * v + 128) >> 8));
+        row[2] = Clamp8(luma + ((454 * u + 128) >> 8));
+    }
+}
+
+// Write intermediate rows y and y + 1 (row1 null: only row y exists)
+void PackRows(const uint8_t* row0, const uint8_t* row1, const MutableFramePlanes& dst, uint32_t y) {
+    const uint32_t width = dst.width;
+
+    switch (FamilyOf(dst.format)) {
+        case Family::RGB: {
+            RgbLayout layout = RgbLayoutOf(dst.format);
+            const uint8_t* rows[2] = {row0, row1};
+            for (uint32_t i = 0; i < 2 && rows[i]; ++i) {
+                const uint8_t* in = rows[i];
+                uint8_t* out = dst.plane[0] + static_cast<size_t>(dst.stride[0]) * (y + i);
+                for (uint32_t x = 0; x < width; ++x, in += 4, out += layout.bpp) {
+                    out[layout.r] = in[0];
+                    out[layout.g] = in[1];
+                    out[layout.b] = in[2];
+                    if (layout.a >= 0) {
+                        out[layout.a] = in[3];
+                    }
+                }
+            }
+            break;
+        }
+        case Family::YUV422: {
+            PairLayout layout = PairLayoutOf(dst.format);
+            const uint8_t* rows[2] = {row0, row1};
+            for (uint32_t i = 0; i < 2 && rows[i]; ++i) {
+                const uint8_t* in = rows[i];
+                uint8_t* out = dst.plane[0] + static_cast<size_t>(dst.stride[0]) * (y + i);
+                for (uint32_t x = 0; x + 1 < width; x += 2, in += 8, out += 4) {
+                    out[layout.y0] = in[0];
+                    out[layout.y1] = in[4];
+                    out[layout.u] = static_cast<uint8_t>((in[1] + in[5] + 1) >> 1);
+                    out[layout.v] = static_cast<uint8_t>((in[2] + in[6] + 1) >> 1);
+                }
+            }
+            break;
+        }
+        case Family::YUV420: {
+            uint8_t* luma0 = dst.plane[0] + static_cast<size_t>(dst.stride[0]) * y;
+            uint8_t* luma1 = luma0 + dst.stride[0];
+            for (uint32_t x = 0; x < width; ++x) {
+                luma0[x] = row0[x * 4];
+            }
+            if (row1) {
+                for (uint32_t x = 0; x < width; ++x) {
+                    luma1[x] = row1[x * 4];
+                }
+            }
+
+            const uint8_t* below = row1 ? row1 : row0;
+            uint32_t chroma_y = y / 2;
+            uint8_t* u;
+            uint8_t* v;
+            uint32_t step;
+            if (dst.format == PixelFormat::YUV420P) {
+                u = dst.plane[1] + static_cast<size_t>(dst.stride[1]) * chroma_y;
+                v = dst.plane[2] + static_cast<size_t>(dst.stride[2]) * chroma_y;
+                step = 1;
+            } else {
+                uint8_t* uv = dst.plane[1] + static_cast<size_t>(dst.stride[1]) * chroma_y;
+                bool swap = (dst.format == PixelFormat::NV21);
+                u = uv + (swap ? 1 : 0);
+                v = uv + (swap ? 0 : 1);
+                step = 2;
+            }
+            for (uint32_t c = 0; c < width / 2; ++c) {
+                const uint8_t* a = row0 + c * 8;
+                const uint8_t* b = below + c * 8;
+                u[c * step] = static_cast<uint8_t>((a[1] + a[5] + b[1] + b[5] + 2) >> 2);
+                v[c * step] = static_cast<uint8_t>((a[2] + a[6] + b[2] + b[6] + 2) >> 2);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+// Rows [begin, end) of a frame; `src` and `dst` hold the frame's rows from
+// `src_row` and `dst_row` on (even, so 4:2:0 chroma rows line up)
+void ConvertRows(const FramePlanes& src, uint32_t src_row, const MutableFramePlanes& dst, uint32_t dst_row,
+                 uint32_t begin, uint32_t end, std::vector<uint8_t>& scratch) {
+    const uint32_t width = dst.width;
+    const size_t row_bytes = static_cast<size_t>(width) * 4;
+    scratch.resize(row_bytes * 2);
+    uint8_t* rows[2] = {scratch.data(), scratch.data() + row_bytes};
+
+    bool src_rgb = FamilyOf(src.format) == Family::RGB;
+    bool dst_rgb = FamilyOf(dst.format) == Family::RGB;
+
+    for (uint32_t y = begin; y < end; y += 2) {
+        uint32_t count = std::min<uint32_t>(2, end - y);
+        for (uint32_t i = 0; i < count; ++i) {
+            UnpackRow(src, y + i - src_row, width, rows[i]);
+            if (src_rgb && !dst_rgb) {
+                RgbToYuvRow(rows[i], width);
+            } else if (!src_rgb && dst_rgb) {
+                YuvToRgbRow(rows[i], width);
+            }
+        }
+        PackRows(rows[0], (count == 2) ? rows[1] : nullptr, dst, y - dst_row);
+    }
+}
+
+// Reorder the bytes of rows [begin, end) into the other format of the same
+// layout (see SameLayout). `begin` is even, so 4:2:0 chroma rows are never
+// shared between calls.
+void SwapRows(const MutableFramePlanes& planes, uint32_t begin, uint32_t end) {
+    switch (FamilyOf(planes.format)) {
+        case Family::RGB: {
+            // Both layouts are R,G,B or B,G,R with alpha (if any) last
+            const uint32_t bpp = RgbLayoutOf(planes.format).bpp;
+            for (uint32_t y = begin; y < end; ++y) {
+                uint8_t* p = planes.plane[0] + static_cast<size_t>(planes.stride[0]) * y;
+                for (uint32_t x = 0; x < planes.width; ++x, p += bpp) {
+                    std::swap(p[0], p[2]);
+                }
+            }
+            break;
+        }
+        case Family::YUV422: {
+            // Y0 U Y1 V <-> U Y0 V Y1
+            for (uint32_t y = begin; y < end; ++y) {
+                uint8_t* p = planes.plane[0] + static_cast<size_t>(planes.stride[0]) * y;
+                for (uint32_t x = 0; x < planes.width; ++x, p += 2) {
+                    std::swap(p[0], p[1]);
+                }
+            }
+            break;
+        }
+        case Family::YUV420: {
+            // NV12 <-> NV21: only the interleaved chroma changes
+            for (uint32_t y = begin / 2; y < end / 2; ++y) {
+                uint8_t* p = planes.plane[1] + static_cast<size_t>(planes.stride[1]) * y;
+                for (uint32_t x = 0; x < planes.width / 2; ++x, p += 2) {
+                    std::swap(p[0], p[1]);
+                }
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+} // namespace
+
+/**
+ * @brief ColorConvert as a fusable row stage, with its own intermediate rows
+ */
+class ColorConvert::Stage : public RowStage {
+public:
+    explicit Stage(const ColorConvert* block) : block_(block) {}
+
+    bool Configure(const FrameInfo& input) override {
+        if (!block_->SupportsFormat(input.pixel_format)) {
+            return false;
+        }
+        input_ = input;
+        output_ = block_->DeriveOutputFormat(input);
+        bool subsampled = FamilyOf(input.pixel_format) != Family::RGB;
+        return input.pixel_format == block_->target_format_ ||
+               (output_.width > 0 && output_.height > 0 && (!subsampled || (input.width >= 2 && input.height >= 2)));
+    }
+
+    const FrameInfo& GetOutputFormat() const override { return output_; }
+
+    void GetInputRows(uint32_t begin, uint32_t end, uint32_t& first, uint32_t& last) const override {
+        first = begin;
+        last = end;
+    }
+
+    bool View(const FramePlanes& src, uint32_t src_row, FramePlanes& out, uint32_t& out_row) const override {
+        if (input_.pixel_format != block_->target_format_) {
+            return false;
+        }
+        out = src;
+        out_row = src_row;
+        return true;
+    }
+
+    void Run(const FramePlanes& src, uint32_t src_row, const MutableFramePlanes& dst,
+             uint32_t begin, uint32_t end) override {
+        ConvertRows(src, src_row, dst, begin, begin, end, scratch_);
+    }
+
+private:
+    const ColorConvert* block_;
+    FrameInfo input_;
+    FrameInfo output_;
+    std::vector<uint8_t> scratch_;
+};
+
+ColorConvert::ColorConvert()
+    : BaseVideoProcessor("ColorConvert", "ColorConvert") {
+    output_format_ = DeriveOutputFormat(input_format_);
+}
+
+ColorConvert::~ColorConvert() {
+    Shutdown();
+}
+
+bool ColorConvert::SupportsFormat(PixelFormat format) const {
+    return FamilyOf(format) != Family::NONE;
+}
+
+std::vector<PixelFormat> ColorConvert::GetSupportedFormats() const {
+    return {
+        PixelFormat::RGB24,
+        PixelFormat::BGR24,
+        PixelFormat::RGBA32,
+        PixelFormat::BGRA32,
+        PixelFormat::YUV420P,
+        PixelFormat::NV12,
+        PixelFormat::NV21,
+        PixelFormat::YUYV,
+        PixelFormat::UYVY
+    };
+}
+
+int ColorConvert::ConversionCost(PixelFormat from, PixelFormat to) {
+    Family a = FamilyOf(from);
+    Family b = FamilyOf(to);
+    if (a == Family::NONE || b == Family::NONE) {
+        return -1;
+    }
+    if (from == to) {
+        return 0;
+    }
+    if (a == b) {
+        return 1;
+    }
+    return (a == Family::RGB || b == Family::RGB) ? 3 : 2;
+}
+
+bool ColorConvert::Initialize(const BlockParams& params) {
+    if (!BaseVideoProcessor::Initialize(params)) {
+        return false;
+    }
+
+    auto format_str = BaseBlock::GetParameter("format");
+    if (!format_str.empty()) {
+        PixelFormat format;
+        if (!ParsePixelFormat(format_str, format)) {
+            SetError("Unknown target pixel format: " + format_str);
+            return false;
+        }
+        if (!SetTargetFormat(format)) {
+            return false;
+        }
+    }
+
+    auto threads_str = BaseBlock::GetParameter("threads");
+    if (!threads_str.empty()) {
+        thread_count_ = std::max<size_t>(1, std::stoul(threads_str));
+    }
+
+    // The worker thread converts one band itself; the pool takes the rest
+    if (thread_count_ > 1) {
+        thread_pool_ = std::make_unique<ThreadPool>(thread_count_ - 1);
+    }
+
+    VP_LOG_INFO_F("ColorConvert initialized: format={}, threads={}",
+                  PixelFormatToString(target_format_), thread_count_);
+    return true;
+}
+
+bool ColorConvert::Shutdown() {
+    bool ok = BaseVideoProcessor::Shutdown();
+    thread_pool_.reset();
+    return ok;
+}
+
+std::unique_ptr<RowStage> ColorConvert::CreateRowStage() const {
+    return std::make_unique<Stage>(this);
+}
+
+bool ColorConvert::SetTargetFormat(PixelFormat format) {
+    if (!SupportsFormat(format)) {
+        SetError(std::string("Cannot convert to ") + PixelFormatToString(format));
+        return false;
+    }
+
+    if (BaseBlock::GetState() == BlockState::RUNNING) {
+        SetError("Cannot change target format while running");
+        return false;
+    }
+
+    target_format_ = format;
+    output_format_ = DeriveOutputFormat(input_format_);
+    return true;
+}
+
+FrameInfo ColorConvert::DeriveOutputFormat(const FrameInfo& input) const {
+    FrameInfo output = input;
+    output.pixel_format = target_format_;
+
+    // Subsampled chroma needs even dimensions
+    switch (FamilyOf(target_format_)) {
+        case Family::YUV420:
+            output.height &= ~1u;
+            output.width &= ~1u;
+            break;
+        case Family::YUV422:
+            output.width &= ~1u;
+            break;
+        default:
+            break;
+    }
+
+    output.stride = output.width * PackedBytesPerPixel(target_format_);
+    output.is_hardware_buffer = false;
+    output.hw_handle = nullptr;
+    return output;
+}
+
+bool ColorConvert::ProcessFrameImpl(VideoFramePtr frame) {
+    if (!frame || !frame->IsValid()) {
+        VP_LOG_WARNING_F("ColorConvert '{}' received invalid frame", GetName());
+        return false;
+    }
+
+    const auto& in_info = frame->GetFrameInfo();
+    if (!SupportsFormat(in_info.pixel_format)) {
+        VP_LOG_WARNING_F("ColorConvert '{}' unsupported input: {}", GetName(), in_info.ToString());
+        return false;
+    }
+
+    if (in_info.pixel_format == target_format_) {
+        EmitFrame(std::move(frame));
+        return true;
+    }
+
+    FrameInfo out_info = DeriveOutputFormat(in_info);
+    bool subsampled = FamilyOf(in_info.pixel_format) != Family::RGB;
+    if (out_info.width == 0 || out_info.height == 0 || (subsampled && (in_info.width < 2 || in_info.height < 2))) {
+        VP_LOG_WARNING_F("ColorConvert '{}' cannot convert {} to {}", GetName(), in_info.ToString(),
+                         PixelFormatToString(target_format_));
+        return false;
+    }
+
+    // Byte reorders run in place on a frame nobody else holds
+    if (SameLayout(in_info.pixel_format, target_format_) && out_info.width == in_info.width &&
+        out_info.height == in_info.height && frame->CanWriteInPlace()) {
+        return ConvertInPlace(std::move(frame));
+    }
+
+    FramePlanes src;
+    if (!ResolvePlanes(static_cast<const IVideoFrame&>(*frame), src)) {
+        VP_LOG_WARNING_F("ColorConvert '{}' cannot access input planes: {}", GetName(), in_info.ToString());
+        return false;
+    }
+
+    auto output = AcquireOutputFrame(out_info);
+    MutableFramePlanes dst;
+    if (!output || !ResolvePlanes(*output, dst)) {
+        VP_LOG_WARNING_F("ColorConvert '{}' failed to allocate output frame", GetName());
+        return false;
+    }
+
+    // Bands of whole row pairs, so 4:2:0 chroma rows are never shared
+    size_t pairs = (out_info.height + 1) / 2;
+    size_t bands = std::max<size_t>(1, std::min(thread_count_, pairs));
+    if (scratch_.size() < bands) {
+        scratch_.resize(bands);
+    }
+    ParallelFor(thread_pool_.get(), 0, bands, 1, [&](size_t first, size_t last) {
+        for (size_t b = first; b < last; ++b) {
+            uint32_t begin = static_cast<uint32_t>(pairs * b / bands) * 2;
+            uint32_t end = std::min<uint32_t>(static_cast<uint32_t>(pairs * (b + 1) / bands) * 2, out_info.height);
+            ConvertRows(src, 0, dst, 0, begin, end, scratch_[b]);
+        }
+    });
+
+    EmitFrame(std::move(output));
+    return true;
+}
+
+bool ColorConvert::ConvertInPlace(VideoFramePtr frame) {
+    MutableFramePlanes planes;
+    if (!MakeWritable(frame) || !ResolvePlanes(*frame, planes)) {
+        VP_LOG_WARNING_F("ColorConvert '{}' cannot write {} in place", GetName(), frame->GetFrameInfo().ToString());
+        return false;
+    }
+
+    size_t pairs = (planes.height + 1) / 2;
+    size_t bands = std::max<size_t>(1, std::min(thread_count_, pairs));
+    ParallelFor(thread_pool_.get(), 0, bands, 1, [&](size_t first, size_t last) {
+        for (size_t b = first; b < last; ++b) {
+            uint32_t begin = static_cast<uint32_t>(pairs * b / bands) * 2;
+            uint32_t end = std::min<uint32_t>(static_cast<uint32_t>(pairs * (b + 1) / bands) * 2, planes.height);
+            SwapRows(planes, begin, end);
+        }
+    });
+
+    FrameInfo info = frame->GetFrameInfo();
+    info.pixel_format = target_format_;
+    frame->SetFrameInfo(info);
+    EmitFrame(std::move(frame));
+    return true;
+}
+
+} // namespace video_pipeline
@@ -0,0 +1,501 @@
+#include "video_pipeline/blocks/compositor.h"
+#include "video_pipeline/logger.h"
+#include "utils/frame_planes.h"
+#include "utils/row_stage.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+namespace video_pipeline {
+
+namespace {
+
+constexpr size_t kMaxInputs = 16;
+
+bool IsSubsampled420(PixelFormat format) {
+    return format == PixelFormat::YUV420P || format == PixelFormat::NV12 || format == PixelFormat::NV21;
+}
+
+bool IsPacked422(PixelFormat format) {
+    return format == PixelFormat::YUYV || format == PixelFormat::UYVY;
+}
+
+// Region of `planes` at (x, y) of the given size; x, y, width and height are
+// even wherever chroma is subsampled along that axis
+template<typename Byte>
+FramePlanesT<Byte> SubPlanes(const FramePlanesT<Byte>& planes, uint32_t x, uint32_t y,
+                             uint32_t width, uint32_t height) {
+    FramePlanesT<Byte> region = RowWindow(planes, y, height);
+    region.plane[0] += static_cast<size_t>(x) * PackedBytesPerPixel(planes.format);
+    for (int p = 1; p < planes.count; ++p) {
+        // NV12/NV21 chroma is interleaved (2 bytes per sample), YUV420P is 1 byte per sample
+        region.plane[p] += (planes.count == 2) ? x : x / 2;
+    }
+    region.width = width;
+    return region;
+}
+
+// Fill every pixel with one colour, given as RGB and converted like ColorConvert
+// (BT.601 full range)
+void FillPlanes(const MutableFramePlanes& planes, const uint8_t rgb[3]) {
+    const int r = rgb[0], g = rgb[1], b = rgb[2];
+    const auto y = static_cast<uint8_t>((r * 77 + g * 150 + b * 29 + 128) >> 8);
+    const auto u = static_cast<uint8_t>((b * 128 + 32895 - r * 43 - g * 85) >> 8);
+    const auto v = static_cast<uint8_t>((r * 128 + 32895 - g * 107 - b * 21) >> 8);
+
+    // Repeating byte pattern of each plane's rows
+    std::vector<uint8_t> pattern[3];
+    switch (planes.format) {
+        case PixelFormat::RGB24:   pattern[0] = {rgb[0], rgb[1], rgb[2]}; break;
+        case PixelFormat::BGR24:   pattern[0] = {rgb[2], rgb[1], rgb[0]}; break;
+        case PixelFormat::RGBA32:  pattern[0] = {rgb[0], rgb[1], rgb[2], 255}; break;
+        case PixelFormat::BGRA32:  pattern[0] = {rgb[2], rgb[1], rgb[0], 255}; break;
+        case PixelFormat::YUYV:    pattern[0] = {y, u, y, v}; break;
+        case PixelFormat::UYVY:    pattern[0] = {u, y, v, y}; break;
+        case PixelFormat::NV12:    pattern[0] = {y}; pattern[1] = {u, v}; break;
+        case PixelFormat::NV21:    pattern[0] = {y}; pattern[1] = {v, u}; break;
+        case PixelFormat::YUV420P: pattern[0] = {y}; pattern[1] = {u}; pattern[2] = {v}; break;
+        default: return;
+    }
+
+    for (int p = 0; p < planes.count; ++p) {
+        const size_t row_bytes = PlaneRowBytes(planes, p);
+        const uint32_t rows = PlaneRows(planes, p);
+        if (rows == 0) {
+            continue;
+        }
+        uint8_t* first = planes.plane[p];
+        for (size_t i = 0; i < row_bytes; ++i) {
+            first[i] = pattern[p][i % pattern[p].size()];
+        }
+        for (uint32_t row = 1; row < rows; ++row) {
+            std::memcpy(first + static_cast<size_t>(row) * planes.stride[p], first, row_bytes);
+        }
+    }
+}
+
+} // namespace
+
+Compositor::Compositor()
+    : BaseVideoSource("Compositor", "Compositor") {
+    output_format_.width = 1280;
+    output_format_.height = 720;
+    output_format_.pixel_format = PixelFormat::RGB24;
+    output_format_.stride = output_format_.width * 3;
+}
+
+Compositor::~Compositor() {
+    Stop();
+    Shutdown();
+}
+
+bool Compositor::SetOutputFormat(const FrameInfo& format) {
+    if (BaseBlock::GetState() == BlockState::RUNNING) {
+        SetError("Cannot change output format while running");
+        return false;
+    }
+
+    if (PackedBytesPerPixel(format.pixel_format) == 0 || format.width == 0 || format.height == 0) {
+        SetError("Unsupported compositor output: " + format.ToString());
+        return false;
+    }
+
+    output_format_ = format;
+    output_format_.stride = format.width * PackedBytesPerPixel(format.pixel_format);
+    return tiles_.empty() || ParseLayout();
+}
+
+bool Compositor::SupportsFormat(PixelFormat format) const {
+    return format == output_format_.pixel_format;
+}
+
+std::vector<PixelFormat> Compositor::GetSupportedFormats() const {
+    return {output_format_.pixel_format};
+}
+
+bool Compositor::ProcessFrame(VideoFramePtr frame) {
+    return PushFrame(std::move(frame), EdgePolicy{});
+}
+
+bool Compositor::PushFrame(VideoFramePtr frame, const EdgePolicy& policy) {
+    bool accepted = frame && frame->GetFrameInfo().pixel_format == output_format_.pixel_format;
+    bool replaced_unseen = false;
+
+    VideoFramePtr previous;     // Released outside the lock
+    if (accepted) {
+        std::lock_guard<std::mutex> lock(slots_mutex_);
+        if (policy.port < tiles_.size()) {
+            Tile& tile = tiles_[policy.port];
+            replaced_unseen = tile.frame && tile.taken != tile.serial;
+            previous = std::move(tile.frame);
+            tile.frame = std::move(frame);
+            tile.serial++;
+            tile.received = std::chrono::steady_clock::now();
+        } else {
+            accepted = false;
+        }
+    }
+
+    // Frames that were never drawn count as dropped
+    if (!accepted || replaced_unseen) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.frames_dropped++;
+    }
+    return accepted;
+}
+
+std::vector<std::string> Compositor::GetInputPorts() const {
+    std::vector<std::string> ports;
+    for (size_t i = 0; i < input_count_; ++i) {
+        ports.push_back("input" + std::to_string(i));
+    }
+    return ports;
+}
+
+bool Compositor::SetInputFormat(const FrameInfo& format) {
+    if (!SupportsFormat(format.pixel_format)) {
+        SetError("Compositor inputs must be " + std::string(PixelFormatToString(output_format_.pixel_format)) +
+                 ", got " + format.ToString());
+        return false;
+    }
+
+    // Every input may have its own size; this is the last one negotiated
+    input_format_ = format;
+    return true;
+}
+
+bool Compositor::Initialize(const BlockParams& params) {
+    if (!BaseVideoSource::Initialize(params)) {
+        return false;
+    }
+
+    // Any uncompressed format the scaler handles
+    auto format_str = BaseBlock::GetParameter("format");
+    if (!format_str.empty()) {
+        PixelFormat format;
+        if (!ParsePixelFormat(format_str, format) || PackedBytesPerPixel(format) == 0) {
+            SetError("Unsupported compositor format: " + format_str);
+            return false;
+        }
+        output_format_.pixel_format = format;
+    }
+    if (output_format_.width == 0 || output_format_.height == 0 ||
+        output_format_.width > 16384 || output_format_.height > 16384) {
+        SetError("Invalid compositor size: " + std::to_string(output_format_.width) + "x" +
+                 std::to_string(output_format_.height));
+        return false;
+    }
+    output_format_.stride = output_format_.width * PackedBytesPerPixel(output_format_.pixel_format);
+
+    auto inputs_str = BaseBlock::GetParameter("inputs");
+    if (!inputs_str.empty()) {
+        input_count_ = std::stoul(inputs_str);
+    }
+    if (input_count_ == 0 || input_count_ > kMaxInputs) {
+        SetError("Compositor inputs must be 1-" + std::to_string(kMaxInputs));
+        return false;
+    }
+
+    keep_aspect_ = BaseBlock::GetParameter("keep_aspect") == "true";
+
+    auto stale_str = BaseBlock::GetParameter("stale_ms");
+    if (!stale_str.empty()) {
+        stale_after_ = std::chrono::milliseconds(std::stoul(stale_str));
+    }
+
+    auto background_str = BaseBlock::GetParameter("background");
+    if (!background_str.empty()) {
+        std::istringstream parser(background_str);
+        unsigned r = 0, g = 0, b = 0;
+        char sep1 = 0, sep2 = 0;
+        if (!(parser >> r >> sep1 >> g >> sep2 >> b) || sep1 != ',' || sep2 != ',' || r > 255 || g > 255 || b > 255) {
+            SetError("Invalid compositor background '" + background_str + "' (expected r,g,b)");
+            return false;
+        }
+        background_[0] = static_cast<uint8_t>(r);
+        background_[1] = static_cast<uint8_t>(g);
+        background_[2] = static_cast<uint8_t>(b);
+    }
+
+    auto method_str = BaseBlock::GetParameter("method");
+    if (!method_str.empty()) {
+        if (method_str == "nearest") method_ = ScaleMethod::NEAREST;
+        else if (method_str == "bilinear") method_ = ScaleMethod::BILINEAR;
+        else if (method_str == "area") method_ = ScaleMethod::AREA;
+        else {
+            VP_LOG_WARNING_F("Unknown scale method '{}', using bilinear", method_str);
+        }
+    }
+
+    // Tiles that do not overlap are scaled in parallel
+    size_t threads = 1;
+    auto threads_str = BaseBlock::GetParameter("threads");
+    if (!threads_str.empty()) {
+        threads = std::max<size_t>(1, std::stoul(threads_str));
+    }
+    thread_pool_ = (threads > 1) ? std::make_unique<ThreadPool>(threads - 1) : nullptr;
+
+    // Each tile scales through its own Scale stage, never started as a block
+    tiles_.clear();
+    tiles_.resize(input_count_);
+    for (auto& tile : tiles_) {
+        tile.scale = std::make_unique<Scale>();
+        tile.scale->SetMethod(method_);
+        tile.stage = tile.scale->CreateRowStage();
+    }
+
+    if (!ParseLayout()) {
+        return false;
+    }
+
+    VP_LOG_INFO_F("Compositor initialized: {} inputs -> {} at {} fps{}", input_count_, output_format_.ToString(),
+                  frame_rate_, tiles_overlap_ ? " (overlapping tiles)" : "");
+    return true;
+}
+
+bool Compositor::ParseLayout() {
+    const PixelFormat format = output_format_.pixel_format;
+    const uint32_t x_mask = (IsSubsampled420(format) || IsPacked422(format)) ? ~1u : ~0u;
+    const uint32_t y_mask = IsSubsampled420(format) ? ~1u : ~0u;
+    const uint32_t width = output_format_.width;
+    const uint32_t height = output_format_.height;
+
+    // Grid cells in port order, row by row
+    uint32_t columns = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(input_count_))));
+    auto columns_str = BaseBlock::GetParameter("columns");
+    if (!columns_str.empty() && std::stoul(columns_str) > 0) {
+        columns = static_cast<uint32_t>(std::min<size_t>(std::stoul(columns_str), input_count_));
+    }
+    const uint32_t rows = static_cast<uint32_t>((input_count_ + columns - 1) / columns);
+
+    for (size_t i = 0; i < tiles_.size(); ++i) {
+        uint32_t column = static_cast<uint32_t>(i % columns);
+        uint32_t row = static_cast<uint32_t>(i / columns);
+        Rect rect;
+        rect.x = (width * column / columns) & x_mask;
+        rect.y = (height * row / rows) & y_mask;
+        rect.width = ((width * (column + 1) / columns) & x_mask) - rect.x;
+        rect.height = ((height * (row + 1) / rows) & y_mask) - rect.y;
+
+        // `rect<i>=x,y,w,h` places an input anywhere, e.g. picture in picture
+        auto rect_str = BaseBlock::GetParameter("rect" + std::to_string(i));
+        if (!rect_str.empty()) {
+            std::istringstream parser(rect_str);
+            char sep1 = 0, sep2 = 0, sep3 = 0;
+            if (!(parser >> rect.x >> sep1 >> rect.y >> sep2 >> rect.width >> sep3 >> rect.height) ||
+                sep1 != ',' || sep2 != ',' || sep3 != ',' || rect.x >= width || rect.y >= height) {
+                SetError("Invalid rect" + std::to_string(i) + " '" + rect_str + "' (expected x,y,width,height on the canvas)");
+                return false;
+            }
+            rect.width = std::min(rect.width, width - rect.x);
+            rect.height = std::min(rect.height, height - rect.y);
+            rect.x &= x_mask;
+            rect.y &= y_mask;
+            rect.width &= x_mask;
+            rect.height &= y_mask;
+        }
+
+        if (rect.width < 2 || rect.height < 2) {
+            SetError("Compositor tile " + std::to_string(i) + " is empty on a " + std::to_string(width) + "x" +
+                     std::to_string(height) + " canvas");
+            return false;
+        }
+        tiles_[i].rect = rect;
+    }
+
+    tiles_overlap_ = false;
+    for (size_t i = 0; i < tiles_.size(); ++i) {
+        for (size_t j = 0; j < i; ++j) {
+            const Rect& a = tiles_[i].rect;
+            const Rect& b = tiles_[j].rect;
+            if (a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height) {
+                tiles_overlap_ = true;
+            }
+        }
+    }
+    return true;
+}
+
+bool Compositor::Start() {
+    if (BaseBlock::GetState() == BlockState::RUNNING) {
+        return true;
+    }
+
+    if (BaseBlock::GetState() != BlockState::INITIALIZED && BaseBlock::GetState() != BlockState::STOPPED) {
+        SetError("Cannot start from state: " + BaseBlock::GetStateString());
+        return false;
+    }
+
+    SetState(BlockState::STARTING);
+
+    ResetCanvas();
+    StartProducer();
+
+    SetState(BlockState::RUNNING);
+    VP_LOG_INFO_F("Compositor '{}' started", BaseBlock::GetName());
+    return true;
+}
+
+bool Compositor::Stop() {
+    if (BaseBlock::GetState() != BlockState::RUNNING) {
+        return true;
+    }
+
+    SetState(BlockState::STOPPING);
+
+    StopProducer();
+
+    // Give the inputs' buffers back to their pools
+    std::vector<VideoFramePtr> released;
+    {
+        std::lock_guard<std::mutex> lock(slots_mutex_);
+        for (auto& tile : tiles_) {
+            released.push_back(std::move(tile.frame));
+        }
+    }
+
+    SetState(BlockState::STOPPED);
+    VP_LOG_INFO_F("Compositor '{}' stopped", BaseBlock::GetName());
+    return true;
+}
+
+bool Compositor::Shutdown() {
+    Stop();
+    thread_pool_.reset();
+    return true;
+}
+
+void Compositor::ResetCanvas() {
+    canvas_.assign(output_format_.GetFrameSize(), 0);
+    MutableFramePlanes canvas;
+    if (PackedPlanes(output_format_, canvas_.data(), canvas)) {
+        FillPlanes(canvas, background_);
+    }
+    for (auto& tile : tiles_) {
+        tile.drawn = 0;
+    }
+}
+
+void Compositor::DrawTile(Tile& tile, const VideoFramePtr& frame) {
+    MutableFramePlanes canvas;
+    PackedPlanes(output_format_, canvas_.data(), canvas);
+    const Rect& rect = tile.rect;
+    MutableFramePlanes area = SubPlanes(canvas, rect.x, rect.y, rect.width, rect.height);
+
+    FramePlanes src;
+    if (!frame || !ResolvePlanes(static_cast<const IVideoFrame&>(*frame), src)) {
+        FillPlanes(area, background_);
+        return;
+    }
+    const FrameInfo& info = frame->GetFrameInfo();
+
+    // Letterbox: the largest size with the input's aspect ratio, centred
+    const PixelFormat format = output_format_.pixel_format;
+    const uint32_t x_mask = (IsSubsampled420(format) || IsPacked422(format)) ? ~1u : ~0u;
+    const uint32_t y_mask = IsSubsampled420(format) ? ~1u : ~0u;
+    Rect fit{0, 0, rect.width, rect.height};
+    if (keep_aspect_) {
+        if (static_cast<uint64_t>(info.width) * rect.height > static_cast<uint64_t>(rect.width) * info.height) {
+            fit.height = static_cast<uint32_t>(static_cast<uint64_t>(rect.width) * info.height / info.width);
+        } else {
+            fit.width = static_cast<uint32_t>(static_cast<uint64_t>(rect.height) * info.width / info.height);
+        }
+        fit.width = std::max<uint32_t>(2, fit.width & x_mask);
+        fit.height = std::max<uint32_t>(2, fit.height & y_mask);
+        fit.x = ((rect.width - fit.width) / 2) & x_mask;
+        fit.y = ((rect.height - fit.height) / 2) & y_mask;
+        if (fit.width < rect.width || fit.height < rect.height) {
+            FillPlanes(area, background_);
+        }
+    }
+
+    tile.scale->SetTargetSize(fit.width, fit.height);
+    if (!tile.stage->Configure(info)) {
+        FillPlanes(area, background_);
+        return;
+    }
+    const FrameInfo& scaled = tile.stage->GetOutputFormat();
+    MutableFramePlanes dst = SubPlanes(area, fit.x, fit.y, scaled.width, scaled.height);
+
+    // Inputs that already have the tile size are copied
+    FramePlanes view;
+    uint32_t view_row = 0;
+    if (tile.stage->View(src, 0, view, view_row)) {
+        CopyPlanes(view, dst);
+    } else {
+        tile.stage->Run(src, 0, dst, 0, scaled.height);
+    }
+}
+
+bool Compositor::ProduceFrame() {
+    const auto now = std::chrono::steady_clock::now();
+
+    // Pick up the latest frame of every input; an input shows the background
+    // until its first frame and, with stale_ms, once it stops delivering
+    std::vector<VideoFramePtr> frames(tiles_.size());
+    std::vector<uint64_t> content(tiles_.size(), 0);
+    {
+        std::lock_guard<std::mutex> lock(slots_mutex_);
+        for (size_t i = 0; i < tiles_.size(); ++i) {
+            Tile& tile = tiles_[i];
+            if (!tile.frame || (stale_after_.count() > 0 && now - tile.received > stale_after_)) {
+                continue;
+            }
+            frames[i] = tile.frame;
+            content[i] = tile.serial;
+            tile.taken = tile.serial;
+        }
+    }
+
+    // Redraw changed tiles, and tiles drawn over a redrawn one
+    std::vector<size_t> dirty;
+    for (size_t i = 0; i < tiles_.size(); ++i) {
+        bool redraw = content[i] != tiles_[i].drawn;
+        for (size_t j = 0; !redraw && tiles_overlap_ && j < dirty.size(); ++j) {
+            const Rect& a = tiles_[i].rect;
+            const Rect& b = tiles_[dirty[j]].rect;
+            redraw = a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+        }
+        if (redraw) {
+            dirty.push_back(i);
+        }
+    }
+
+    auto draw = [&](size_t first, size_t last) {
+        for (size_t d = first; d < last; ++d) {
+            size_t i = dirty[d];
+            DrawTile(tiles_[i], frames[i]);
+            tiles_[i].drawn = content[i];
+        }
+    };
+    if (tiles_overlap_) {
+        draw(0, dirty.size());
+    } else {
+        ParallelFor(thread_pool_.get(), 0, dirty.size(), 1, draw);
+    }
+    frames.clear();
+
+    // Over a frame pool quota this slot is skipped
+    auto frame = AllocateFrame(output_format_);
+    if (!frame) {
+        last_frame_time_ = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    FramePlanes canvas;
+    MutableFramePlanes dst;
+    if (!PackedPlanes(output_format_, static_cast<const uint8_t*>(canvas_.data()), canvas) ||
+        !ResolvePlanes(*frame, dst)) {
+        VP_LOG_WARNING_F("Compositor '{}' cannot access output planes", GetName());
+        last_frame_time_ = std::chrono::steady_clock::now();
+        return true;
+    }
+    CopyPlanes(canvas, dst);
+
+    EmitFrame(std::move(frame));
+    return true;
+}
+
+} // namespace video_pipeline
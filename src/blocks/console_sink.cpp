@@ -106,6 +106,8 @@ void ConsoleSink::LogFrameInfo(VideoFramePtr frame) {
 void ConsoleSink::LogPixelData(VideoFramePtr frame) {
     const auto& info = frame->GetFrameInfo();
     const uint8_t* data = static_cast<const uint8_t*>(frame->GetData());
+    // Rows may be padded or belong to a larger frame (FrameView); 0 for compressed data
+    const size_t stride = frame->GetPlaneStride(0);
     
     std::cout << "[" << BaseBlock::GetName() << "] Pixel data (first " << max_pixels_ << " pixels):" << std::endl;
     
@@ -117,8 +119,15 @@ void ConsoleSink::LogPixelData(VideoFramePtr frame) {
             std::cout << std::endl;
         }
         
+        const uint8_t* row = data;
+        size_t column = i;
+        if (stride > 0 && info.width > 0) {
+            row = data + (i / info.width) * stride;
+            column = i % info.width;
+        }
+        
         std::cout << "  " << std::setw(2) << i << ": " 
-                  << FormatPixelValue(data, info.pixel_format, i);
+                  << FormatPixelValue(row, info.pixel_format, column);
     }
     
     std::cout << std::endl;
@@ -0,0 +1,227 @@
+#include "video_pipeline/blocks/crop.h"
+#include "video_pipeline/logger.h"
+#include "utils/frame_planes.h"
+#include "utils/row_stage.h"
+#include <algorithm>
+
+namespace video_pipeline {
+
+/**
+ * @brief Crop as a fusable row stage: a window into its input rows
+ */
+class Crop::Stage : public RowStage {
+public:
+    explicit Stage(const Crop* block) : block_(block) {}
+
+    bool Configure(const FrameInfo& input) override {
+        if (!block_->SupportsFormat(input.pixel_format)) {
+            return false;
+        }
+        output_ = block_->DeriveOutputFormat(input);
+        Region clipped = block_->ClipRegion(input.width, input.height);
+
+        // Same alignment as CreateFrameView
+        bool planar = input.pixel_format == PixelFormat::YUV420P || input.pixel_format == PixelFormat::NV12 ||
+                      input.pixel_format == PixelFormat::NV21;
+        bool packed_422 = input.pixel_format == PixelFormat::YUYV || input.pixel_format == PixelFormat::UYVY;
+        x_ = (planar || packed_422) ? clipped.x & ~1u : clipped.x;
+        y_ = planar ? clipped.y & ~1u : clipped.y;
+        return output_.width > 0 && output_.height > 0;
+    }
+
+    const FrameInfo& GetOutputFormat() const override { return output_; }
+
+    void GetInputRows(uint32_t begin, uint32_t end, uint32_t& first, uint32_t& last) const override {
+        first = begin + y_;
+        last = end + y_;
+    }
+
+    bool View(const FramePlanes& src, uint32_t src_row, FramePlanes& out, uint32_t& out_row) const override {
+        // Rows above the region are skipped (both even for 4:2:0)
+        uint32_t skip = (src_row < y_) ? y_ - src_row : 0;
+        out = RowWindow(src, skip, src.height - std::min(skip, src.height));
+        out.plane[0] += static_cast<size_t>(x_) * PackedBytesPerPixel(src.format);
+        for (int p = 1; p < src.count; ++p) {
+            // NV12/NV21 chroma is interleaved (2 bytes per sample), YUV420P is 1 byte per sample
+            out.plane[p] += (src.count == 2) ? x_ : x_ / 2;
+        }
+        out.width = output_.width;
+        out_row = src_row + skip - y_;
+        return true;
+    }
+
+    bool IsView() const override { return true; }
+
+    void Run(const FramePlanes& src, uint32_t src_row, const MutableFramePlanes& dst,
+             uint32_t begin, uint32_t end) override {
+        FramePlanes view;
+        uint32_t view_row = 0;
+        View(src, src_row, view, view_row);
+        CopyPlanes(RowWindow(view, begin - view_row, end - begin), dst);
+    }
+
+private:
+    const Crop* block_;
+    FrameInfo output_;
+    uint32_t x_{0};
+    uint32_t y_{0};
+};
+
+Crop::Crop()
+    : BaseVideoProcessor("Crop", "Crop") {
+    output_format_ = DeriveOutputFormat(input_format_);
+}
+
+Crop::~Crop() {
+    Shutdown();
+}
+
+bool Crop::SupportsFormat(PixelFormat format) const {
+    return PackedBytesPerPixel(format) != 0;
+}
+
+std::vector<PixelFormat> Crop::GetSupportedFormats() const {
+    return {
+        PixelFormat::RGB24,
+        PixelFormat::BGR24,
+        PixelFormat::RGBA32,
+        PixelFormat::BGRA32,
+        PixelFormat::YUV420P,
+        PixelFormat::NV12,
+        PixelFormat::NV21,
+        PixelFormat::YUYV,
+        PixelFormat::UYVY
+    };
+}
+
+bool Crop::Initialize(const BlockParams& params) {
+    if (!BaseVideoProcessor::Initialize(params)) {
+        return false;
+    }
+
+    Region region = region_;
+
+    auto x_str = BaseBlock::GetParameter("x");
+    if (!x_str.empty()) {
+        region.x = std::stoul(x_str);
+    }
+
+    auto y_str = BaseBlock::GetParameter("y");
+    if (!y_str.empty()) {
+        region.y = std::stoul(y_str);
+    }
+
+    auto width_str = BaseBlock::GetParameter("width");
+    if (!width_str.empty()) {
+        region.width = std::stoul(width_str);
+    }
+
+    auto height_str = BaseBlock::GetParameter("height");
+    if (!height_str.empty()) {
+        region.height = std::stoul(height_str);
+    }
+
+    if (!SetRegion(region.x, region.y, region.width, region.height)) {
+        return false;
+    }
+
+    VP_LOG_INFO_F("Crop initialized: region={}x{}+{}+{}",
+                  region_.width, region_.height, region_.x, region_.y);
+    return true;
+}
+
+bool Crop::SetRegion(uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    if (BaseBlock::GetState() == BlockState::RUNNING) {
+        SetError("Cannot change crop region while running");
+        return false;
+    }
+
+    region_.x = x;
+    region_.y = y;
+    region_.width = width;
+    region_.height = height;
+    output_format_ = DeriveOutputFormat(input_format_);
+    return true;
+}
+
+std::unique_ptr<RowStage> Crop::CreateRowStage() const {
+    return std::make_unique<Stage>(this);
+}
+
+Crop::Region Crop::ClipRegion(uint32_t frame_width, uint32_t frame_height) const {
+    Region clipped;
+    if (region_.x >= frame_width || region_.y >= frame_height) {
+        return clipped;
+    }
+
+    clipped.x = region_.x;
+    clipped.y = region_.y;
+    clipped.width = frame_width - region_.x;
+    clipped.height = frame_height - region_.y;
+    if (region_.width > 0) {
+        clipped.width = std::min(clipped.width, region_.width);
+    }
+    if (region_.height > 0) {
+        clipped.height = std::min(clipped.height, region_.height);
+    }
+    return clipped;
+}
+
+FrameInfo Crop::DeriveOutputFormat(const FrameInfo& input) const {
+    FrameInfo output = input;
+    Region clipped = ClipRegion(input.width, input.height);
+
+    // Same alignment as CreateFrameView
+    switch (input.pixel_format) {
+        case PixelFormat::YUV420P:
+        case PixelFormat::NV12:
+        case PixelFormat::NV21:
+            clipped.height &= ~1u;
+            clipped.width &= ~1u;
+            break;
+        case PixelFormat::YUYV:
+        case PixelFormat::UYVY:
+            clipped.width &= ~1u;
+            break;
+        default:
+            break;
+    }
+
+    // Views keep the parent's row pitch
+    output.width = clipped.width;
+    output.height = clipped.height;
+    return output;
+}
+
+bool Crop::ProcessFrameImpl(VideoFramePtr frame) {
+    if (!frame || !frame->IsValid()) {
+        VP_LOG_WARNING_F("Crop '{}' received invalid frame", GetName());
+        return false;
+    }
+
+    const auto& info = frame->GetFrameInfo();
+    if (!SupportsFormat(info.pixel_format)) {
+        VP_LOG_WARNING_F("Crop '{}' unsupported input: {}", GetName(), info.ToString());
+        return false;
+    }
+
+    Region clipped = ClipRegion(info.width, info.height);
+    if (clipped.x == 0 && clipped.y == 0 && clipped.width == info.width && clipped.height == info.height) {
+        EmitFrame(std::move(frame));
+        return true;
+    }
+
+    auto view = CreateFrameView(frame, clipped.x, clipped.y, clipped.width, clipped.height);
+    if (!view) {
+        VP_LOG_WARNING_F("Crop '{}' region {}x{}+{}+{} does not fit {}", GetName(),
+                         region_.width, region_.height, region_.x, region_.y, info.ToString());
+        return false;
+    }
+
+    // The view keeps the parent alive; ours would stop downstream writing in place
+    frame.reset();
+    EmitFrame(std::move(view));
+    return true;
+}
+
+} // namespace video_pipeline
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "video_pipeline/buffer.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file delta_protocol.h
+ * @brief Keyframe/delta wire format shared by TcpSink (mode=delta) and TcpSource
+ *
+ * Every message is a MessageHeader followed by `payload_size` bytes. The frame
+ * payload is viewed as rows of `row_bytes` bytes (planar formats simply
+ * continue with the chroma rows) and cut into tiles of tile_width bytes by
+ * tile_height rows. A keyframe carries the whole payload; a delta carries
+ * `tile_count` entries of { uint32 tile index, tile bytes row by row }.
+ * Fields are in host byte order; all supported targets are little-endian.
+ */
+
+namespace video_pipeline {
+namespace delta {
+
+constexpr uint32_t kMagic = 0x54445056;  // "VPDT"
+constexpr uint8_t kVersion = 1;
+
+enum class MessageType : uint8_t {
+    KEYFRAME = 0,
+    DELTA = 1
+};
+
+struct MessageHeader {
+    uint32_t magic{kMagic};
+    uint8_t version{kVersion};
+    uint8_t type{0};
+    uint8_t pixel_format{0};
+    uint8_t reserved{0};
+    uint32_t width{0};
+    uint32_t height{0};
+    uint32_t frame_size{0};     // Reconstructed payload size in bytes
+    uint32_t row_bytes{0};
+    uint16_t tile_width{0};     // Bytes
+    uint16_t tile_height{0};    // Rows
+    uint32_t tile_count{0};     // Changed tiles (delta only)
+    uint64_t sequence_number{0};
+    uint64_t timestamp_us{0};
+    uint32_t payload_size{0};
+    uint32_t reserved2{0};
+};
+
+static_assert(sizeof(MessageHeader) == 56, "MessageHeader layout is part of the wire format");
+
+/**
+ * @brief Tile geometry over a frame payload of `frame_size` bytes
+ */
+struct TileGrid {
+    size_t frame_size{0};
+    size_t row_bytes{0};
+    size_t rows{0};
+    size_t tile_width{0};
+    size_t tile_height{0};
+    size_t tiles_x{0};
+    size_t tiles_y{0};
+
+    bool Init(size_t size, size_t row, size_t tw, size_t th) {
+        if (size == 0 || row == 0 || tw == 0 || th == 0) {
+            return false;
+        }
+        frame_size = size;
+        row_bytes = std::min(row, size);
+        rows = (size + row_bytes - 1) / row_bytes;
+        tile_width = tw;
+        tile_height = th;
+        tiles_x = (row_bytes + tw - 1) / tw;
+        tiles_y = (rows + th - 1) / th;
+        return true;
+    }
+
+    size_t TileCount() const { return tiles_x * tiles_y; }
+
+    // Calls f(offset, length) for each row segment of a tile; the last frame row may be short
+    template<typename F>
+    void ForEachRow(size_t tile, F&& f) const {
+        size_t tx = tile % tiles_x;
+        size_t ty = tile / tiles_x;
+        size_t x0 = tx * tile_width;
+        size_t y_end = std::min(rows, (ty + 1) * tile_height);
+        for (size_t y = ty * tile_height; y < y_end; ++y) {
+            size_t row_start = y * row_bytes;
+            size_t row_len = std::min(row_bytes, frame_size - row_start);
+            if (x0 >= row_len) {
+                continue;
+            }
+            f(row_start + x0, std::min(tile_width, row_len - x0));
+        }
+    }
+
+    size_t TileBytes(size_t tile) const {
+        size_t bytes = 0;
+        ForEachRow(tile, [&bytes](size_t, size_t len) { bytes += len; });
+        return bytes;
+    }
+};
+
+} // namespace delta
+} // namespace video_pipeline
@@ -1,5 +1,8 @@
 #include "video_pipeline/blocks/file_sink.h"
+#include "video_pipeline/qoi.h"
 #include "video_pipeline/logger.h"
+#include "utils/frame_planes.h"
+#include <algorithm>
 #include <filesystem>
 #include <iomanip>
 #include <sstream>
@@ -51,6 +54,7 @@ bool FileSink::Initialize(const BlockParams& params) {
         else if (format_str == "ppm") file_format_ = FileFormat::PPM;
         else if (format_str == "pgm") file_format_ = FileFormat::PGM;
         else if (format_str == "yuv") file_format_ = FileFormat::YUV;
+        else if (format_str == "qoi") file_format_ = FileFormat::QOI;
         else {
             VP_LOG_WARNING_F("Unknown file format '{}', using raw", format_str);
         }
@@ -110,6 +114,10 @@ bool FileSink::SetFileFormat(FileFormat format) {
 }
 
 bool FileSink::ProcessFrameImpl(VideoFramePtr frame) {
+    return WriteFrame(std::move(frame));
+}
+
+bool FileSink::WriteFrame(VideoFramePtr frame) {
     if (!frame || !frame->IsValid()) {
         VP_LOG_ERROR("Invalid frame received");
         return false;
@@ -130,6 +138,9 @@ bool FileSink::ProcessFrameImpl(VideoFramePtr frame) {
         case FileFormat::YUV:
             success = WriteFrameYUV(frame);
             break;
+        case FileFormat::QOI:
+            success = WriteFrameQOI(frame);
+            break;
         default:
             VP_LOG_ERROR_F("Unsupported file format: {}", static_cast<int>(file_format_));
             return false;
@@ -164,10 +175,7 @@ bool FileSink::WriteFrameRaw(VideoFramePtr frame) {
     }
     
     // Write frame data
-    const void* data = frame->GetData();
-    size_t size = frame->GetSize();
-    
-    output_file_->write(static_cast<const char*>(data), size);
+    WritePixels(*frame);
     bool ok = output_file_->good();
     
     if (!single_file_) {
@@ -197,15 +205,20 @@ bool FileSink::WriteFramePPM(VideoFramePtr frame) {
     *output_file_ << info.width << " " << info.height << "\n";
     *output_file_ << "255\n";
     
-    // Write pixel data
-    const uint8_t* data = static_cast<const uint8_t*>(frame->GetData());
-    
-    if (info.pixel_format == PixelFormat::RGB24) {
-        output_file_->write(reinterpret_cast<const char*>(data), info.width * info.height * 3);
-    } else if (info.pixel_format == PixelFormat::RGBA32) {
-        // Convert RGBA to RGB
-        for (uint32_t i = 0; i < info.width * info.height; ++i) {
-            output_file_->write(reinterpret_cast<const char*>(&data[i * 4]), 3);
+    // Write pixel data row by row; the frame may be a padded buffer or a view
+    const uint8_t* data = static_cast<const uint8_t*>(frame->GetPlaneData(0));
+    const uint32_t bpp = (info.pixel_format == PixelFormat::RGBA32) ? 4 : 3;
+    const size_t stride = std::max<size_t>(frame->GetPlaneStride(0), info.width * bpp);
+    
+    for (uint32_t y = 0; y < info.height; ++y) {
+        const uint8_t* row = data + y * stride;
+        if (info.pixel_format == PixelFormat::RGB24) {
+            output_file_->write(reinterpret_cast<const char*>(row), info.width * 3);
+        } else {
+            // Convert RGBA to RGB
+            for (uint32_t x = 0; x < info.width; ++x) {
+                output_file_->write(reinterpret_cast<const char*>(&row[x * 4]), 3);
+            }
         }
     }
     
@@ -227,21 +240,25 @@ bool FileSink::WriteFramePGM(VideoFramePtr frame) {
     *output_file_ << info.width << " " << info.height << "\n";
     *output_file_ << "255\n";
     
-    const uint8_t* data = static_cast<const uint8_t*>(frame->GetData());
-    
-    // Convert to grayscale if needed
-    if (info.pixel_format == PixelFormat::RGB24) {
-        for (uint32_t i = 0; i < info.width * info.height; ++i) {
-            uint8_t gray = static_cast<uint8_t>(
-                0.299 * data[i * 3 + 0] + 
-                0.587 * data[i * 3 + 1] + 
-                0.114 * data[i * 3 + 2]);
-            output_file_->write(reinterpret_cast<const char*>(&gray), 1);
+    const uint8_t* data = static_cast<const uint8_t*>(frame->GetPlaneData(0));
+    const uint32_t bpp = (info.pixel_format == PixelFormat::RGB24) ? 3 : 1;
+    const size_t stride = std::max<size_t>(frame->GetPlaneStride(0), info.width * bpp);
+    
+    for (uint32_t y = 0; y < info.height; ++y) {
+        const uint8_t* row = data + y * stride;
+        // Convert to grayscale if needed
+        if (info.pixel_format == PixelFormat::RGB24) {
+            for (uint32_t x = 0; x < info.width; ++x) {
+                uint8_t gray = static_cast<uint8_t>(
+                    0.299 * row[x * 3 + 0] + 
+                    0.587 * row[x * 3 + 1] + 
+                    0.114 * row[x * 3 + 2]);
+                output_file_->write(reinterpret_cast<const char*>(&gray), 1);
+            }
+        } else {
+            // Assume grayscale or use Y plane for YUV
+            output_file_->write(reinterpret_cast<const char*>(row), info.width);
         }
-    } else {
-        // Assume grayscale or use Y plane for YUV
-        size_t gray_size = info.width * info.height;
-        output_file_->write(reinterpret_cast<const char*>(data), gray_size);
     }
     
     bool ok = output_file_->good();
@@ -267,10 +284,45 @@ bool FileSink::WriteFrameYUV(VideoFramePtr frame) {
     }
     
     // Write YUV data
-    const void* data = frame->GetData();
-    size_t size = frame->GetSize();
+    WritePixels(*frame);
+    bool ok = output_file_->good();
+    
+    if (!single_file_) {
+        CloseOutputFile();
+    }
+    
+    return ok;
+}
+
+bool FileSink::WriteFrameQOI(VideoFramePtr frame) {
+    // Frames from a QoiEncode block are written as-is; raw RGB is encoded here
+    VideoFramePtr encoded = frame;
+    if (frame->GetFrameInfo().pixel_format != PixelFormat::QOI) {
+        encoded = QoiEncodeFrame(*frame, 1, nullptr);
+        if (!encoded) {
+            VP_LOG_ERROR("QOI format only supports RGB24, RGBA32 and QOI frames");
+            return false;
+        }
+    }
+    
+    std::string filename;
+    
+    if (single_file_) {
+        // Consecutive images in one file; each is self-delimiting
+        filename = output_path_;
+        if (frames_written_ == 0) {
+            if (!OpenOutputFile(filename)) {
+                return false;
+            }
+        }
+    } else {
+        filename = GenerateFilename(output_path_, frames_written_, "qoi");
+        if (!OpenOutputFile(filename)) {
+            return false;
+        }
+    }
     
-    output_file_->write(static_cast<const char*>(data), size);
+    output_file_->write(static_cast<const char*>(encoded->GetData()), encoded->GetSize());
     bool ok = output_file_->good();
     
     if (!single_file_) {
@@ -280,6 +332,19 @@ bool FileSink::WriteFrameYUV(VideoFramePtr frame) {
     return ok;
 }
 
+void FileSink::WritePixels(const IVideoFrame& frame) {
+    FramePlanes planes;
+    if (IsCompressedFormat(frame.GetFrameInfo().pixel_format) || !ResolvePlanes(frame, planes) ||
+        IsContiguous(planes)) {
+        output_file_->write(static_cast<const char*>(frame.GetData()), frame.GetSize());
+        return;
+    }
+    
+    ForEachPlaneRow(planes, [&](const uint8_t* row, size_t bytes) {
+        output_file_->write(reinterpret_cast<const char*>(row), bytes);
+    });
+}
+
 std::string FileSink::GenerateFilename(const std::string& base_path, size_t frame_number, const std::string& extension) {
     std::ostringstream oss;
     oss << base_path << "_" << std::setfill('0') << std::setw(6) << frame_number << "." << extension;
@@ -0,0 +1,366 @@
+#include "video_pipeline/blocks/file_source.h"
+#include "video_pipeline/qoi.h"
+#include "video_pipeline/logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace video_pipeline {
+
+FileSource::FileSource()
+    : BaseVideoSource("FileSource", "FileSource") {
+    input_path_ = "output";
+}
+
+FileSource::~FileSource() {
+    Stop();
+    Shutdown();
+}
+
+bool FileSource::SetOutputFormat(const FrameInfo& format) {
+    if (BaseBlock::GetState() == BlockState::RUNNING) {
+        SetError("Cannot change output format while running");
+        return false;
+    }
+
+    if (!SupportsFormat(format.pixel_format)) {
+        SetError("Unsupported pixel format");
+        return false;
+    }
+
+    output_format_ = format;
+    return true;
+}
+
+bool FileSource::SupportsFormat(PixelFormat format) const {
+    return format != PixelFormat::UNKNOWN && format != PixelFormat::MJPEG;
+}
+
+std::vector<PixelFormat> FileSource::GetSupportedFormats() const {
+    return {
+        PixelFormat::RGB24,
+        PixelFormat::BGR24,
+        PixelFormat::RGBA32,
+        PixelFormat::BGRA32,
+        PixelFormat::YUV420P,
+        PixelFormat::NV12,
+        PixelFormat::NV21,
+        PixelFormat::YUYV,
+        PixelFormat::UYVY,
+        PixelFormat::QOI
+    };
+}
+
+bool FileSource::Initialize(const BlockParams& params) {
+    if (!BaseVideoSource::Initialize(params)) {
+        return false;
+    }
+
+    auto path = BaseBlock::GetParameter("path");
+    if (!path.empty()) {
+        input_path_ = path;
+    }
+
+    // Default the file format from the extension
+    auto file_format_str = BaseBlock::GetParameter("file_format");
+    if (file_format_str.empty()) {
+        file_format_str = (std::filesystem::path(input_path_).extension() == ".qoi") ? "qoi" : "raw";
+    }
+    if (file_format_str == "raw") file_format_ = FileFormat::RAW;
+    else if (file_format_str == "qoi") file_format_ = FileFormat::QOI;
+    else {
+        SetError("Unsupported FileSource file format: " + file_format_str);
+        return false;
+    }
+
+    auto loop_str = BaseBlock::GetParameter("loop");
+    if (!loop_str.empty()) {
+        loop_ = (loop_str == "true" || loop_str == "1");
+    }
+
+    auto decode_str = BaseBlock::GetParameter("decode");
+    if (!decode_str.empty()) {
+        decode_ = (decode_str == "true" || decode_str == "1");
+    }
+
+    // An explicit RGB24/RGBA32 `format` selects the decoded channel count
+    auto format_str = BaseBlock::GetParameter("format");
+    if (format_str == "RGB24") decode_channels_ = 3;
+    else if (format_str == "RGBA32") decode_channels_ = 4;
+
+    auto threads_str = BaseBlock::GetParameter("threads");
+    if (!threads_str.empty()) {
+        thread_count_ = std::max<size_t>(1, std::stoul(threads_str));
+    }
+    if (thread_count_ > 1) {
+        thread_pool_ = std::make_unique<ThreadPool>(thread_count_ - 1);
+    }
+
+    if (!OpenInput()) {
+        return false;
+    }
+
+    // QOI geometry comes from the first image header
+    if (file_format_ == FileFormat::QOI) {
+        const uint8_t* data = sequence_ ? sequence_data_.data() : map_data_;
+        size_t size = sequence_ ? sequence_data_.size() : map_size_;
+        QoiDesc desc;
+        if (!ParseQoiHeader(data, size, desc)) {
+            SetError("Not a QOI file: " + input_path_);
+            return false;
+        }
+
+        uint8_t channels = decode_channels_ ? decode_channels_ : desc.channels;
+        output_format_.width = desc.width;
+        output_format_.height = desc.height;
+        if (decode_) {
+            output_format_.pixel_format = (channels == 4) ? PixelFormat::RGBA32 : PixelFormat::RGB24;
+            output_format_.stride = desc.width * channels;
+        } else {
+            output_format_.pixel_format = PixelFormat::QOI;
+            output_format_.stride = 0;
+        }
+    }
+
+    VP_LOG_INFO_F("FileSource initialized: path='{}', file_format={}, sequence={}, loop={}, output={}",
+                  input_path_, static_cast<int>(file_format_), sequence_, loop_, output_format_.ToString());
+    return true;
+}
+
+bool FileSource::Start() {
+    if (BaseBlock::GetState() == BlockState::RUNNING) {
+        return true;
+    }
+
+    if (BaseBlock::GetState() != BlockState::INITIALIZED && BaseBlock::GetState() != BlockState::STOPPED) {
+        SetError("Cannot start from state: " + BaseBlock::GetStateString());
+        return false;
+    }
+
+    SetState(BlockState::STARTING);
+
+    Rewind();
+    frames_since_rewind_ = 0;
+    StartProducer();
+
+    SetState(BlockState::RUNNING);
+    VP_LOG_INFO_F("FileSource '{}' started", BaseBlock::GetName());
+    return true;
+}
+
+bool FileSource::Stop() {
+    if (BaseBlock::GetState() != BlockState::RUNNING) {
+        return true;
+    }
+
+    SetState(BlockState::STOPPING);
+
+    StopProducer();
+
+    SetState(BlockState::STOPPED);
+    VP_LOG_INFO_F("FileSource '{}' stopped after {} frames", BaseBlock::GetName(), frames_read_.load());
+    return true;
+}
+
+bool FileSource::Shutdown() {
+    Stop();
+    CloseInput();
+    thread_pool_.reset();
+    return true;
+}
+
+bool FileSource::ProduceFrame() {
+    auto frame = ReadNextFrame();
+    if (!frame && loop_ && frames_since_rewind_ > 0) {
+        Rewind();
+        frames_since_rewind_ = 0;
+        frame = ReadNextFrame();
+    }
+    if (!frame) {
+        VP_LOG_INFO_F("FileSource '{}' reached end of input", BaseBlock::GetName());
+        return false;
+    }
+
+    EmitFrame(std::move(frame));
+    frames_read_++;
+    frames_since_rewind_++;
+    return true;
+}
+
+VideoFramePtr FileSource::ReadNextFrame() {
+    // Advance to the next file of a sequence once the current one is used up
+    if (sequence_ && read_offset_ >= sequence_data_.size()) {
+        if (!LoadSequenceFile(sequence_index_)) {
+            return nullptr;
+        }
+        sequence_index_++;
+        read_offset_ = 0;
+    }
+
+    const uint8_t* data = (sequence_ ? sequence_data_.data() : map_data_) + read_offset_;
+    size_t size = (sequence_ ? sequence_data_.size() : map_size_) - read_offset_;
+    if (size == 0) {
+        return nullptr;
+    }
+
+    if (file_format_ == FileFormat::RAW) {
+        size_t frame_size = output_format_.GetFrameSize();
+        if (frame_size == 0 || size < frame_size) {
+            if (size > 0 && frame_size > 0) {
+                VP_LOG_WARNING_F("FileSource '{}' ignoring {} trailing bytes", BaseBlock::GetName(), size);
+            }
+            read_offset_ += size;
+            return nullptr;
+        }
+
+        auto frame = CreateVideoFrame(output_format_);
+        if (!frame) {
+            return nullptr;
+        }
+        std::memcpy(frame->GetData(), data, frame_size);
+        read_offset_ += frame_size;
+        return frame;
+    }
+
+    if (decode_) {
+        size_t consumed = 0;
+        auto frame = QoiDecodeFrame(data, size, decode_channels_, thread_pool_.get(), &consumed);
+        if (!frame) {
+            VP_LOG_WARNING_F("FileSource '{}' stopping at undecodable QOI data (offset {})",
+                             BaseBlock::GetName(), read_offset_);
+            read_offset_ += size;
+            return nullptr;
+        }
+        read_offset_ += consumed;
+        return frame;
+    }
+
+    // Pass-through: copy one whole image into a QOI frame
+    QoiDesc desc;
+    size_t image_size = QoiImageSize(data, size);
+    if (image_size == 0 || !ParseQoiHeader(data, size, desc)) {
+        VP_LOG_WARNING_F("FileSource '{}' stopping at invalid QOI data (offset {})",
+                         BaseBlock::GetName(), read_offset_);
+        read_offset_ += size;
+        return nullptr;
+    }
+
+    FrameInfo info;
+    info.width = desc.width;
+    info.height = desc.height;
+    info.pixel_format = PixelFormat::QOI;
+
+    auto frame = CreateVideoFrame(info, image_size);
+    if (!frame) {
+        return nullptr;
+    }
+    std::memcpy(frame->GetData(), data, image_size);
+    frame->SetSize(image_size);
+    read_offset_ += image_size;
+    return frame;
+}
+
+bool FileSource::OpenInput() {
+    CloseInput();
+
+    std::error_code ec;
+    if (std::filesystem::is_regular_file(input_path_, ec)) {
+        sequence_ = false;
+        return MapFile(input_path_);
+    }
+
+    // Fall back to a FileSink numbered sequence
+    sequence_ = true;
+    if (!LoadSequenceFile(0)) {
+        SetError("FileSource input not found: " + input_path_ + " (or " + SequenceFilename(0) + ")");
+        return false;
+    }
+    sequence_index_ = 1;
+    read_offset_ = 0;
+    return true;
+}
+
+void FileSource::CloseInput() {
+    if (map_data_) {
+        munmap(const_cast<uint8_t*>(map_data_), map_size_);
+        map_data_ = nullptr;
+        map_size_ = 0;
+    }
+    sequence_data_.clear();
+    read_offset_ = 0;
+}
+
+void FileSource::Rewind() {
+    read_offset_ = 0;
+    if (sequence_) {
+        // Force a reload starting from the first file
+        sequence_data_.clear();
+        sequence_index_ = 0;
+    }
+}
+
+bool FileSource::MapFile(const std::string& filename) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        SetError("FileSource failed to open " + filename + ": " + std::strerror(errno));
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        SetError("FileSource input is empty or unreadable: " + filename);
+        close(fd);
+        return false;
+    }
+
+    void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        SetError("FileSource failed to map " + filename + ": " + std::strerror(errno));
+        return false;
+    }
+
+    // Playback reads front to back; let the kernel read ahead aggressively
+    madvise(addr, st.st_size, MADV_SEQUENTIAL);
+
+    map_data_ = static_cast<const uint8_t*>(addr);
+    map_size_ = static_cast<size_t>(st.st_size);
+    VP_LOG_DEBUG_F("FileSource mapped {} ({} bytes)", filename, map_size_);
+    return true;
+}
+
+bool FileSource::LoadSequenceFile(size_t index) {
+    std::string filename = SequenceFilename(index);
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    sequence_data_.resize(static_cast<size_t>(std::max<std::streamsize>(0, size)));
+    if (size > 0 && !file.read(reinterpret_cast<char*>(sequence_data_.data()), size)) {
+        VP_LOG_WARNING_F("FileSource failed to read {}", filename);
+        return false;
+    }
+    return true;
+}
+
+std::string FileSource::SequenceFilename(size_t index) const {
+    // Mirrors FileSink::GenerateFilename
+    std::ostringstream oss;
+    oss << input_path_ << "_" << std::setfill('0') << std::setw(6) << index << "."
+        << (file_format_ == FileFormat::QOI ? "qoi" : "raw");
+    return oss.str();
+}
+
+} // namespace video_pipeline
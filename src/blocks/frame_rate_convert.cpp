@@ -0,0 +1,204 @@
+#include "video_pipeline/blocks/frame_rate_convert.h"
+#include "video_pipeline/logger.h"
+#include "video_pipeline/timer.h"
+#include <algorithm>
+
+namespace video_pipeline {
+
+namespace {
+
+// Another reference to the same pixels with its own timestamp. Compressed
+// frames cannot be viewed, so they are repeated as the same frame.
+VideoFramePtr Repeat(const VideoFramePtr& frame, uint64_t timestamp_us) {
+    const auto& info = frame->GetFrameInfo();
+    if (IsCompressedFormat(info.pixel_format)) {
+        return frame;
+    }
+
+    auto view = CreateFrameView(frame, 0, 0, info.width, info.height);
+    if (!view || view->GetFrameInfo().width != info.width || view->GetFrameInfo().height != info.height) {
+        return frame;
+    }
+
+    FrameInfo stamped = view->GetFrameInfo();
+    stamped.timestamp_us = timestamp_us;
+    view->SetFrameInfo(stamped);
+    return view;
+}
+
+} // namespace
+
+FrameRateConvert::FrameRateConvert()
+    : BaseVideoProcessor("FrameRateConvert", "FrameRateConvert") {
+}
+
+FrameRateConvert::~FrameRateConvert() {
+    Shutdown();
+}
+
+bool FrameRateConvert::SupportsFormat(PixelFormat format) const {
+    // Frames are forwarded as they are, compressed ones included
+    return format != PixelFormat::UNKNOWN;
+}
+
+std::vector<PixelFormat> FrameRateConvert::GetSupportedFormats() const {
+    return {
+        PixelFormat::RGB24,
+        PixelFormat::BGR24,
+        PixelFormat::RGBA32,
+        PixelFormat::BGRA32,
+        PixelFormat::YUV420P,
+        PixelFormat::NV12,
+        PixelFormat::NV21,
+        PixelFormat::YUYV,
+        PixelFormat::UYVY,
+        PixelFormat::MJPEG,
+        PixelFormat::QOI
+    };
+}
+
+bool FrameRateConvert::Initialize(const BlockParams& params) {
+    if (!BaseVideoProcessor::Initialize(params)) {
+        return false;
+    }
+
+    auto fps_str = BaseBlock::GetParameter("fps");
+    if (!fps_str.empty() && !SetFrameRate(std::stod(fps_str))) {
+        return false;
+    }
+
+    auto mode_str = BaseBlock::GetParameter("mode");
+    if (!mode_str.empty()) {
+        if (mode_str == "decimate") duplicate_ = false;
+        else if (mode_str == "convert") duplicate_ = true;
+        else {
+            SetError("Invalid frame rate mode: " + mode_str + " (expected decimate or convert)");
+            return false;
+        }
+    }
+
+    auto repeat_str = BaseBlock::GetParameter("max_repeat");
+    if (!repeat_str.empty()) {
+        max_repeat_ = std::stoul(repeat_str);
+    }
+
+    if (frame_rate_ <= 0) {
+        VP_LOG_WARNING_F("FrameRateConvert '{}' has no fps set, frames pass through", GetName());
+    }
+
+    VP_LOG_INFO_F("FrameRateConvert initialized: fps={}, mode={}", frame_rate_,
+                  duplicate_ ? "convert" : "decimate");
+    return true;
+}
+
+bool FrameRateConvert::Start() {
+    ResetTiming();
+    return BaseVideoProcessor::Start();
+}
+
+bool FrameRateConvert::Stop() {
+    bool ok = BaseVideoProcessor::Stop();
+    previous_.reset();
+    return ok;
+}
+
+bool FrameRateConvert::SetDuplicate(bool duplicate) {
+    if (BaseBlock::GetState() == BlockState::RUNNING) {
+        SetError("Cannot change frame rate mode while running");
+        return false;
+    }
+
+    duplicate_ = duplicate;
+    return true;
+}
+
+bool FrameRateConvert::IsHotParameter(const std::string& key) const {
+    return key == "fps" || BaseVideoProcessor::IsHotParameter(key);
+}
+
+void FrameRateConvert::ApplyParameter(const std::string& key, const std::string& value) {
+    if (key != "fps") {
+        BaseVideoProcessor::ApplyParameter(key, value);
+        return;
+    }
+
+    // The slot already due keeps its time; later slots use the new interval
+    double fps = std::stod(value);
+    if (fps < 0 || fps > 1000) {
+        VP_LOG_WARNING_F("FrameRateConvert '{}': invalid fps {}", GetName(), value);
+        return;
+    }
+    frame_rate_ = fps;
+}
+
+void FrameRateConvert::ResetTiming() {
+    started_ = false;
+    next_slot_us_ = 0;
+    input_interval_us_ = 0;
+    last_input_us_ = 0;
+    previous_.reset();
+}
+
+bool FrameRateConvert::ProcessFrameImpl(VideoFramePtr frame) {
+    if (!frame || !frame->IsValid()) {
+        VP_LOG_WARNING_F("FrameRateConvert '{}' received invalid frame", GetName());
+        return false;
+    }
+
+    if (frame_rate_ <= 0) {
+        EmitFrame(std::move(frame));
+        return true;
+    }
+
+    uint64_t now_us = frame->GetFrameInfo().timestamp_us;
+    if (now_us == 0) {
+        now_us = Timer::GetCurrentTimestampUs();
+    }
+    const uint64_t interval_us = static_cast<uint64_t>(1000000.0 / frame_rate_);
+
+    // Time going backwards means a new stream (e.g. a restarted sender)
+    if (started_ && now_us < last_input_us_) {
+        ResetTiming();
+    }
+    if (started_) {
+        uint64_t spacing = now_us - last_input_us_;
+        input_interval_us_ = input_interval_us_ ? (input_interval_us_ * 7 + spacing) / 8 : spacing;
+    }
+    last_input_us_ = now_us;
+
+    if (started_) {
+        // Jitter allowance: half of the finer of the input and output spacing
+        uint64_t slack = std::min(interval_us, input_interval_us_ ? input_interval_us_ : interval_us) / 2;
+
+        // Too early for the next slot: a later frame will fill it
+        if (now_us + slack < next_slot_us_) {
+            DiscardFrame();
+            return true;
+        }
+
+        // Slots that passed without a frame repeat the previous one, up to
+        // one second of them after a stall
+        if (duplicate_ && previous_) {
+            size_t limit = max_repeat_ ? max_repeat_ : std::max<size_t>(1, static_cast<size_t>(frame_rate_));
+            for (size_t repeats = 0; repeats < limit && next_slot_us_ + slack < now_us; ++repeats) {
+                EmitFrame(Repeat(previous_, next_slot_us_));
+                next_slot_us_ += interval_us;
+            }
+        }
+    }
+
+    // This frame takes the next slot; a gap that was not filled restarts the grid here
+    if (!started_ || now_us > next_slot_us_ + interval_us / 2) {
+        next_slot_us_ = now_us;
+    }
+    next_slot_us_ += interval_us;
+    started_ = true;
+
+    if (duplicate_) {
+        previous_ = frame;
+    }
+    EmitFrame(std::move(frame));
+    return true;
+}
+
+} // namespace video_pipeline
@@ -0,0 +1,296 @@
+#include "video_pipeline/blocks/fused_transform.h"
+#include "video_pipeline/logger.h"
+#include "utils/frame_planes.h"
+#include "utils/plane_copy.h"
+#include "utils/row_stage.h"
+#include <algorithm>
+#include <utility>
+
+namespace video_pipeline {
+
+namespace {
+
+// Fewer rows per strip cost more in rows recomputed at strip edges (scaling
+// filters read past them) than they save in cache misses
+constexpr uint32_t kMinStripRows = 8;
+
+bool IsSubsampled420(PixelFormat format) {
+    return format == PixelFormat::YUV420P || format == PixelFormat::NV12 || format == PixelFormat::NV21;
+}
+
+FramePlanes AsConst(const MutableFramePlanes& planes) {
+    FramePlanes result;
+    result.format = planes.format;
+    result.width = planes.width;
+    result.height = planes.height;
+    result.count = planes.count;
+    for (int p = 0; p < 3; ++p) {
+        result.plane[p] = planes.plane[p];
+        result.stride[p] = planes.stride[p];
+    }
+    return result;
+}
+
+} // namespace
+
+/**
+ * @brief Work area of one thread: its own stage instances, the rows each
+ * stage reads for the current strip and one strip buffer per stage output
+ */
+struct FusedTransform::Band {
+    std::vector<std::unique_ptr<RowStage>> stages;
+    std::vector<std::pair<uint32_t, uint32_t>> rows;    // rows[i]: input rows of stage i; rows[n]: output
+    std::vector<std::vector<uint8_t>> buffers;
+
+    // Produce output rows [begin, end) of `dst` from the input frame `src`
+    void RunStrip(const FrameInfo& input, const FramePlanes& src, const MutableFramePlanes& dst,
+                  uint32_t begin, uint32_t end) {
+        const size_t n = stages.size();
+
+        // Rows each stage needs, from the last stage back to the input frame
+        rows[n] = {begin, end};
+        for (size_t i = n; i-- > 0;) {
+            uint32_t first = 0;
+            uint32_t last = 0;
+            stages[i]->GetInputRows(rows[i + 1].first, rows[i + 1].second, first, last);
+            const FrameInfo& format = (i == 0) ? input : stages[i - 1]->GetOutputFormat();
+            if (IsSubsampled420(format.pixel_format)) {
+                first &= ~1u;
+                last = std::min(format.height, last + (last & 1));
+            }
+            rows[i] = {first, last};
+        }
+
+        // Then forward, each stage reading the strip the previous one wrote
+        FramePlanes window = src;
+        uint32_t window_row = 0;
+        bool written = false;
+        for (size_t i = 0; i < n; ++i) {
+            RowStage& stage = *stages[i];
+            uint32_t out_begin = rows[i + 1].first;
+            uint32_t out_end = rows[i + 1].second;
+
+            FramePlanes view;
+            uint32_t view_row = 0;
+            if (stage.View(window, window_row, view, view_row)) {
+                window = view;
+                window_row = view_row;
+                written = false;
+                continue;
+            }
+
+            if (i + 1 == n) {
+                stage.Run(window, window_row, RowWindow(dst, begin, end - begin), begin, end);
+                written = true;
+                break;
+            }
+
+            FrameInfo strip_info = stage.GetOutputFormat();
+            strip_info.height = out_end - out_begin;
+            auto& buffer = buffers[i];
+            if (buffer.size() < strip_info.GetFrameSize()) {
+                buffer.resize(strip_info.GetFrameSize());
+            }
+            MutableFramePlanes strip;
+            PackedPlanes(strip_info, buffer.data(), strip);
+            stage.Run(window, window_row, strip, out_begin, out_end);
+
+            window = AsConst(strip);
+            window_row = out_begin;
+        }
+
+        // Chains ending in a view (e.g. a conversion to the format it already has)
+        if (!written) {
+            CopyPlanes(RowWindow(window, begin - window_row, end - begin), RowWindow(dst, begin, end - begin));
+        }
+    }
+};
+
+FusedTransform::FusedTransform()
+    : BaseVideoProcessor("FusedTransform", "FusedTransform") {
+}
+
+FusedTransform::~FusedTransform() {
+    Shutdown();
+}
+
+bool FusedTransform::SupportsFormat(PixelFormat format) const {
+    return !stages_.empty() && static_cast<const IVideoSink&>(*stages_.front()).SupportsFormat(format);
+}
+
+std::vector<PixelFormat> FusedTransform::GetSupportedFormats() const {
+    if (stages_.empty()) {
+        return {};
+    }
+    return static_cast<const IVideoSink&>(*stages_.front()).GetSupportedFormats();
+}
+
+bool FusedTransform::AddStage(std::shared_ptr<BaseVideoProcessor> processor) {
+    if (BaseBlock::GetState() != BlockState::UNINITIALIZED) {
+        SetError("Stages must be added before initialization");
+        return false;
+    }
+
+    if (!processor || !processor->CreateRowStage()) {
+        SetError("Block '" + (processor ? processor->GetName() : std::string("null")) +
+                 "' cannot run as a fused stage");
+        return false;
+    }
+
+    stages_.push_back(std::move(processor));
+    return true;
+}
+
+bool FusedTransform::Initialize(const BlockParams& params) {
+    if (!BaseVideoProcessor::Initialize(params)) {
+        return false;
+    }
+
+    if (stages_.empty()) {
+        SetError("FusedTransform has no stages");
+        return false;
+    }
+
+    auto threads_str = BaseBlock::GetParameter("threads");
+    if (!threads_str.empty()) {
+        thread_count_ = std::max<size_t>(1, std::stoul(threads_str));
+    }
+
+    auto strip_str = BaseBlock::GetParameter("strip_rows");
+    if (!strip_str.empty()) {
+        fixed_strip_rows_ = static_cast<uint32_t>(std::stoul(strip_str));
+    }
+
+    bands_.clear();
+    for (size_t b = 0; b < thread_count_; ++b) {
+        auto band = std::make_unique<Band>();
+        for (const auto& processor : stages_) {
+            band->stages.push_back(processor->CreateRowStage());
+        }
+        band->rows.resize(stages_.size() + 1);
+        band->buffers.resize(stages_.size());
+        bands_.push_back(std::move(band));
+    }
+
+    // The worker thread runs one band itself; the pool takes the rest
+    if (thread_count_ > 1) {
+        thread_pool_ = std::make_unique<ThreadPool>(thread_count_ - 1);
+    }
+
+    std::string chain;
+    for (const auto& processor : stages_) {
+        chain += (chain.empty() ? "" : " -> ") + processor->GetName();
+    }
+    VP_LOG_INFO_F("FusedTransform initialized: {}, threads={}, strip_rows={}", chain, thread_count_,
+                  fixed_strip_rows_ ? std::to_string(fixed_strip_rows_) : std::string("auto"));
+    return true;
+}
+
+bool FusedTransform::Shutdown() {
+    bool ok = BaseVideoProcessor::Shutdown();
+    thread_pool_.reset();
+    return ok;
+}
+
+FrameInfo FusedTransform::DeriveOutputFormat(const FrameInfo& input) const {
+    FrameInfo output = input;
+    for (const auto& processor : stages_) {
+        auto stage = processor->CreateRowStage();
+        if (!stage || !stage->Configure(output)) {
+            break;
+        }
+        output = stage->GetOutputFormat();
+    }
+
+    // Output frames are always unpadded, even after a crop
+    output.stride = output.width * PackedBytesPerPixel(output.pixel_format);
+    output.is_hardware_buffer = false;
+    output.hw_handle = nullptr;
+    return output;
+}
+
+bool FusedTransform::Configure(const FrameInfo& input) {
+    strip_rows_ = 0;
+    for (auto& band : bands_) {
+        FrameInfo format = input;
+        for (auto& stage : band->stages) {
+            if (!stage->Configure(format)) {
+                return false;
+            }
+            format = stage->GetOutputFormat();
+        }
+        configured_output_ = format;
+    }
+    configured_output_.stride = configured_output_.width * PackedBytesPerPixel(configured_output_.pixel_format);
+    configured_output_.is_hardware_buffer = false;
+    configured_output_.hw_handle = nullptr;
+    if (configured_output_.width == 0 || configured_output_.height == 0) {
+        return false;
+    }
+
+    // Bytes of every frame in the chain per output row, strips filling half
+    // the L2 cache (the rest holds filter tables, scratch rows and whatever
+    // else the core runs)
+    const auto& stages = bands_.front()->stages;
+    size_t bytes = input.GetFrameSize();
+    for (const auto& stage : stages) {
+        bytes += stage->GetOutputFormat().GetFrameSize();
+    }
+    size_t per_row = std::max<size_t>(1, bytes / configured_output_.height);
+    size_t rows = fixed_strip_rows_ ? fixed_strip_rows_ : std::max<size_t>(kMinStripRows, L2CacheSize() / 2 / per_row);
+    strip_rows_ = static_cast<uint32_t>(std::min<size_t>(rows, configured_output_.height)) & ~1u;
+    strip_rows_ = std::max<uint32_t>(strip_rows_, 2);
+
+    configured_input_ = input;
+    VP_LOG_DEBUG_F("FusedTransform '{}': {} -> {} in strips of {} rows", GetName(), input.ToString(),
+                   configured_output_.ToString(), strip_rows_);
+    return true;
+}
+
+bool FusedTransform::ProcessFrameImpl(VideoFramePtr frame) {
+    if (!frame || !frame->IsValid()) {
+        VP_LOG_WARNING_F("FusedTransform '{}' received invalid frame", GetName());
+        return false;
+    }
+
+    const auto& in_info = frame->GetFrameInfo();
+    if (strip_rows_ == 0 || in_info.pixel_format != configured_input_.pixel_format ||
+        in_info.width != configured_input_.width || in_info.height != configured_input_.height) {
+        if (!Configure(in_info)) {
+            VP_LOG_WARNING_F("FusedTransform '{}' cannot process {}", GetName(), in_info.ToString());
+            return false;
+        }
+    }
+
+    FramePlanes src;
+    if (!ResolvePlanes(static_cast<const IVideoFrame&>(*frame), src)) {
+        VP_LOG_WARNING_F("FusedTransform '{}' cannot access input planes: {}", GetName(), in_info.ToString());
+        return false;
+    }
+
+    auto output = AcquireOutputFrame(configured_output_);
+    MutableFramePlanes dst;
+    if (!output || !ResolvePlanes(*output, dst)) {
+        VP_LOG_WARNING_F("FusedTransform '{}' failed to allocate output frame", GetName());
+        return false;
+    }
+
+    // Each band takes a run of whole strips
+    const uint32_t height = configured_output_.height;
+    const size_t strips = (height + strip_rows_ - 1) / strip_rows_;
+    const size_t bands = std::min(bands_.size(), strips);
+    ParallelFor(thread_pool_.get(), 0, bands, 1, [&](size_t first, size_t last) {
+        for (size_t b = first; b < last; ++b) {
+            for (size_t s = strips * b / bands; s < strips * (b + 1) / bands; ++s) {
+                uint32_t begin = static_cast<uint32_t>(s) * strip_rows_;
+                uint32_t end = std::min(height, begin + strip_rows_);
+                bands_[b]->RunStrip(configured_input_, src, dst, begin, end);
+            }
+        }
+    });
+
+    EmitFrame(std::move(output));
+    return true;
+}
+
+} // namespace video_pipeline
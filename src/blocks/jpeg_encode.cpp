@@ -0,0 +1,913 @@
+#include "video_pipeline/blocks/jpeg_encode.h"
+#include "video_pipeline/logger.h"
+#include "utils/frame_planes.h"
+#include "utils/simd.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace video_pipeline {
+
+namespace {
+
+using namespace simd;
+
+// Zigzag scan position -> natural (row-major) coefficient index
+const uint8_t kZigzag[64] = {
+     0,  1,  8, 16,  9,  2,  3, 10,
+    17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34,
+    27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36,
+    29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46,
+    53, 60, 61, 54, 47, 55, 62, 63
+};
+
+// ITU-T T.81 Annex K quantization tables (natural order)
+const uint8_t kLumaQuant[64] = {
+    16, 11, 10, 16,  24,  40,  51,  61,
+    12, 12, 14, 19,  26,  58,  60,  55,
+    14, 13, 16, 24,  40,  57,  69,  56,
+    14, 17, 22, 29,  51,  87,  80,  62,
+    18, 22, 37, 56,  68, 109, 103,  77,
+    24, 35, 55, 64,  81, 104, 113,  92,
+    49, 64, 78, 87, 103, 121, 120, 101,
+    72, 92, 95, 98, 112, 100, 103,  99
+};
+
+const uint8_t kChromaQuant[64] = {
+    17, 18, 24, 47, 99, 99, 99, 99,
+    18, 21, 26, 66, 99, 99, 99, 99,
+    24, 26, 56, 99, 99, 99, 99, 99,
+    47, 66, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99
+};
+
+// ITU-T T.81 Annex K Huffman tables
+const uint8_t kDcLumaBits[16] = {0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0};
+const uint8_t kDcChromaBits[16] = {0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0};
+const uint8_t kDcValues[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+
+const uint8_t kAcLumaBits[16] = {0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d};
+const uint8_t kAcLumaValues[162] = {
+    0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+    0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+    0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+    0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+    0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+    0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+    0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+    0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+    0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa
+};
+
+const uint8_t kAcChromaBits[16] = {0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77};
+const uint8_t kAcChromaValues[162] = {
+    0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+    0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0,
+    0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26,
+    0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+    0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+    0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+    0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5,
+    0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+    0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda,
+    0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa
+};
+
+// AAN (Arai/Agui/Nakajima) constants, 13 fractional bits
+constexpr int kConstBits = 13;
+constexpr int32_t kFix0_382683433 = 3135;
+constexpr int32_t kFix0_541196100 = 4433;
+constexpr int32_t kFix0_707106781 = 5793;
+constexpr int32_t kFix1_306562965 = 10703;
+
+/**
+ * @brief Derived Huffman code table (symbol -> code/length)
+ */
+struct HuffmanTable {
+    uint16_t code[256]{};
+    uint8_t size[256]{};
+
+    void Build(const uint8_t bits[16], const uint8_t* values) {
+        uint16_t next_code = 0;
+        int k = 0;
+        for (int len = 1; len <= 16; ++len) {
+            for (int i = 0; i < bits[len - 1]; ++i) {
+                code[values[k]] = next_code++;
+                size[values[k]] = static_cast<uint8_t>(len);
+                ++k;
+            }
+            next_code <<= 1;
+        }
+    }
+};
+
+/**
+ * @brief Entropy-coded segment writer with 0xFF byte stuffing
+ */
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>& out) : out_(out) {}
+
+    void Put(uint32_t bits, int count) {
+        acc_ = (acc_ << count) | (bits & ((1u << count) - 1));
+        count_ += count;
+        while (count_ >= 8) {
+            count_ -= 8;
+            uint8_t byte = static_cast<uint8_t>(acc_ >> count_);
+            out_.push_back(byte);
+            if (byte == 0xFF) {
+                out_.push_back(0x00);
+            }
+        }
+    }
+
+    // Pad the final partial byte with 1-bits
+    void Flush() {
+        if (count_ > 0) {
+            Put(0x7F, 8 - count_);
+        }
+    }
+
+private:
+    std::vector<uint8_t>& out_;
+    uint64_t acc_{0};
+    int count_{0};
+};
+
+inline int BitLength(uint32_t value) {
+    return value ? 32 - __builtin_clz(value) : 0;
+}
+
+template<typename V>
+inline V Descale(V v, int32_t c) {
+    return (v * c + (1 << (kConstBits - 1))) >> kConstBits;
+}
+
+// One AAN forward DCT pass over 8 row vectors (lanes are independent columns)
+inline void Fdct8(i32x4* d) {
+    i32x4 tmp0 = d[0] + d[7];
+    i32x4 tmp7 = d[0] - d[7];
+    i32x4 tmp1 = d[1] + d[6];
+    i32x4 tmp6 = d[1] - d[6];
+    i32x4 tmp2 = d[2] + d[5];
+    i32x4 tmp5 = d[2] - d[5];
+    i32x4 tmp3 = d[3] + d[4];
+    i32x4 tmp4 = d[3] - d[4];
+
+    // Even part
+    i32x4 tmp10 = tmp0 + tmp3;
+    i32x4 tmp13 = tmp0 - tmp3;
+    i32x4 tmp11 = tmp1 + tmp2;
+    i32x4 tmp12 = tmp1 - tmp2;
+
+    d[0] = tmp10 + tmp11;
+    d[4] = tmp10 - tmp11;
+
+    i32x4 z1 = Descale(tmp12 + tmp13, kFix0_707106781);
+    d[2] = tmp13 + z1;
+    d[6] = tmp13 - z1;
+
+    // Odd part
+    tmp10 = tmp4 + tmp5;
+    tmp11 = tmp5 + tmp6;
+    tmp12 = tmp6 + tmp7;
+
+    i32x4 z5 = Descale(tmp10 - tmp12, kFix0_382683433);
+    i32x4 z2 = Descale(tmp10, kFix0_541196100) + z5;
+    i32x4 z4 = Descale(tmp12, kFix1_306562965) + z5;
+    i32x4 z3 = Descale(tmp11, kFix0_707106781);
+
+    i32x4 z11 = tmp7 + z3;
+    i32x4 z13 = tmp7 - z3;
+
+    d[5] = z13 + z2;
+    d[3] = z13 - z2;
+    d[1] = z11 + z4;
+    d[7] = z11 - z4;
+}
+
+// BT.601 full-range RGB -> YCbCr on planar 8-bit rows, 8 pixels per step.
+// 16-bit lanes with 8-bit coefficients; offsets keep every intermediate in 0..65535.
+void RgbToYCbCrRow(const uint8_t* r, const uint8_t* g, const uint8_t* b, uint32_t count,
+                   uint8_t* y, uint8_t* cb, uint8_t* cr) {
+    for (uint32_t x = 0; x < count; x += 8) {
+        u16x8 vr = LoadWiden(r + x);
+        u16x8 vg = LoadWiden(g + x);
+        u16x8 vb = LoadWiden(b + x);
+
+        u16x8 vy = (vr * 77 + vg * 150 + vb * 29 + 128) >> 8;
+        u16x8 vcb = (vb * 128 + 32895 - vr * 43 - vg * 85) >> 8;
+        u16x8 vcr = (vr * 128 + 32895 - vg * 107 - vb * 21) >> 8;
+
+        StoreNarrow(y + x, vy);
+        StoreNarrow(cb + x, vcb);
+        StoreNarrow(cr + x, vcr);
+    }
+}
+
+// Horizontal 2:1 (and optional vertical 2:1) chroma decimation, 8 outputs per step.
+// Little-endian 16-bit lanes split a byte pair into even (low) and odd (high) samples.
+void DownsampleRow(const uint8_t* row0, const uint8_t* row1, uint32_t out_count, uint8_t* out) {
+    for (uint32_t x = 0; x < out_count; x += 8) {
+        u16x8 a = Load<u16x8>(row0 + x * 2);
+        u16x8 sum = (a & 0xFF) + (a >> 8);
+        if (row1) {
+            u16x8 b = Load<u16x8>(row1 + x * 2);
+            sum = (sum + (b & 0xFF) + (b >> 8) + 2) >> 2;
+        } else {
+            sum = (sum + 1) >> 1;
+        }
+        StoreNarrow(out + x, sum);
+    }
+}
+
+// Vertical average of two rows (4:2:2 chroma -> 4:2:0), 16 bytes per step
+void AverageRows(const uint8_t* row0, const uint8_t* row1, uint32_t count, uint8_t* out) {
+    for (uint32_t x = 0; x < count; x += 8) {
+        u16x8 a = LoadWiden(row0 + x);
+        u16x8 b = LoadWiden(row1 + x);
+        StoreNarrow(out + x, (a + b + 1) >> 1);
+    }
+}
+
+// Copy `count` bytes and replicate the last one up to `padded`
+inline void CopyPadded(uint8_t* dst, const uint8_t* src, uint32_t count, uint32_t padded) {
+    std::memcpy(dst, src, count);
+    std::memset(dst + count, src[count - 1], padded - count);
+}
+
+inline void PadRow(uint8_t* row, uint32_t count, uint32_t padded) {
+    std::memset(row + count, row[count - 1], padded - count);
+}
+
+using SourceFrame = FramePlanes;
+
+} // namespace
+
+/**
+ * @brief Baseline JPEG codec core used by JpegEncode
+ */
+class JpegEncoder {
+public:
+    JpegEncoder() {
+        dc_tables_[0].Build(kDcLumaBits, kDcValues);
+        dc_tables_[1].Build(kDcChromaBits, kDcValues);
+        ac_tables_[0].Build(kAcLumaBits, kAcLumaValues);
+        ac_tables_[1].Build(kAcChromaBits, kAcChromaValues);
+
+        // Coefficients leave the DCT transposed; fold that into the scan order
+        for (int i = 0; i < 64; ++i) {
+            int natural = kZigzag[i];
+            scan_order_[i] = static_cast<uint8_t>((natural & 7) * 8 + (natural >> 3));
+        }
+
+        SetQuality(85);
+    }
+
+    void SetQuality(int quality) {
+        quality = std::clamp(quality, 1, 100);
+        int scale = (quality < 50) ? 5000 / quality : 200 - quality * 2;
+
+        static const double kAanScale[8] = {
+            1.0, 1.387039845, 1.306562965, 1.175875602,
+            1.0, 0.785694958, 0.541196100, 0.275899379
+        };
+
+        for (int t = 0; t < 2; ++t) {
+            const uint8_t* base = (t == 0) ? kLumaQuant : kChromaQuant;
+            for (int n = 0; n < 64; ++n) {
+                int q = std::clamp((base[n] * scale + 50) / 100, 1, 255);
+                quant_[t][n] = static_cast<uint8_t>(q);
+
+                // The AAN DCT leaves each coefficient scaled by 8 * s[row] * s[col]
+                int row = n >> 3;
+                int col = n & 7;
+                double divisor = q * kAanScale[row] * kAanScale[col] * 8.0;
+                reciprocal_[t][col * 8 + row] = static_cast<float>(1.0 / divisor);
+            }
+        }
+
+        header_.clear();
+    }
+
+    VideoFramePtr Encode(const IVideoFrame& input, JpegSubsampling subsampling,
+                         size_t slice_hint, uint32_t restart_rows, ThreadPool* pool) {
+        SourceFrame src;
+        if (!ResolveSource(input, src)) {
+            return nullptr;
+        }
+
+        // Geometry: 16-pixel wide MCUs; 16 rows for 4:2:0, 8 rows for 4:2:2
+        if (subsampling == JpegSubsampling::AUTO) {
+            subsampling = (src.format == PixelFormat::YUYV || src.format == PixelFormat::UYVY)
+                ? JpegSubsampling::YUV422 : JpegSubsampling::YUV420;
+        }
+        v_samp_ = (subsampling == JpegSubsampling::YUV420) ? 2 : 1;
+        mcu_rows_ = 8 * v_samp_;
+        mcus_x_ = (src.width + 15) / 16;
+        mcus_y_ = (src.height + mcu_rows_ - 1) / mcu_rows_;
+        padded_width_ = mcus_x_ * 16;
+
+        // Slice layout: each slice is a whole number of restart intervals
+        uint32_t rows_per_slice = restart_rows;
+        if (rows_per_slice == 0) {
+            size_t slices = std::max<size_t>(1, slice_hint);
+            rows_per_slice = static_cast<uint32_t>((mcus_y_ + slices - 1) / slices);
+        }
+        rows_per_slice = std::clamp<uint32_t>(rows_per_slice, 1, std::max<uint32_t>(1, 65535 / mcus_x_));
+        uint32_t slice_count = (mcus_y_ + rows_per_slice - 1) / rows_per_slice;
+        uint16_t restart_interval = (slice_count > 1) ? static_cast<uint16_t>(rows_per_slice * mcus_x_) : 0;
+
+        BuildHeader(src.width, src.height, restart_interval);
+
+        if (slices_.size() < slice_count) {
+            slices_.resize(slice_count);
+        }
+
+        // The first slices run on the calling thread, the rest on the pool
+        ParallelFor(pool, 0, slice_count, 1, [&](size_t first, size_t last) {
+            for (size_t s = first; s < last; ++s) {
+                uint32_t begin = static_cast<uint32_t>(s) * rows_per_slice;
+                EncodeSlice(src, begin, std::min(mcus_y_, begin + rows_per_slice), slices_[s]);
+            }
+        });
+
+        // Stitch header + slices (separated by RSTn) + EOI
+        size_t total = header_.size() + 2;
+        for (uint32_t s = 0; s < slice_count; ++s) {
+            total += slices_[s].output.size() + 2;
+        }
+
+        FrameInfo info;
+        info.width = src.width;
+        info.height = src.height;
+        info.pixel_format = PixelFormat::MJPEG;
+        info.timestamp_us = input.GetFrameInfo().timestamp_us;
+        info.sequence_number = input.GetFrameInfo().sequence_number;
+
+        auto output = CreateVideoFrame(info, total);
+        if (!output) {
+            return nullptr;
+        }
+
+        uint8_t* dst = static_cast<uint8_t*>(output->GetData());
+        std::memcpy(dst, header_.data(), header_.size());
+        dst += header_.size();
+        for (uint32_t s = 0; s < slice_count; ++s) {
+            const auto& data = slices_[s].output;
+            std::memcpy(dst, data.data(), data.size());
+            dst += data.size();
+            if (s + 1 < slice_count) {
+                *dst++ = 0xFF;
+                *dst++ = static_cast<uint8_t>(0xD0 + (s & 7));
+            }
+        }
+        *dst++ = 0xFF;
+        *dst++ = 0xD9;
+
+        output->SetSize(dst - static_cast<uint8_t*>(output->GetData()));
+        return output;
+    }
+
+private:
+    /**
+     * @brief Per-slice working memory, reused across frames
+     */
+    struct Slice {
+        std::vector<uint8_t> luma;        // mcu_rows x padded_width
+        std::vector<uint8_t> chroma[2];   // 8 x padded_width/2
+        std::vector<uint8_t> scratch[7];  // Row temporaries for deinterleave/conversion
+        std::vector<uint8_t> output;
+    };
+
+    bool ResolveSource(const IVideoFrame& input, SourceFrame& src) const {
+        const auto& info = input.GetFrameInfo();
+        if (info.width > 65535 || info.height > 65535) {
+            return false;
+        }
+        return ResolvePlanes(input, src);
+    }
+
+    void BuildHeader(uint32_t width, uint32_t height, uint16_t restart_interval) {
+        if (!header_.empty() && header_width_ == width && header_height_ == height &&
+            header_v_samp_ == v_samp_ && header_restart_ == restart_interval) {
+            return;
+        }
+
+        header_.clear();
+        auto put8 = [this](uint8_t v) { header_.push_back(v); };
+        auto put16 = [this](uint16_t v) {
+            header_.push_back(static_cast<uint8_t>(v >> 8));
+            header_.push_back(static_cast<uint8_t>(v & 0xFF));
+        };
+
+        // SOI + JFIF APP0
+        put16(0xFFD8);
+        put16(0xFFE0);
+        put16(16);
+        for (char c : {'J', 'F', 'I', 'F', '\0'}) put8(static_cast<uint8_t>(c));
+        put16(0x0101);
+        put8(0);
+        put16(1);
+        put16(1);
+        put8(0);
+        put8(0);
+
+        // DQT (zigzag order)
+        put16(0xFFDB);
+        put16(2 + 2 * 65);
+        for (int t = 0; t < 2; ++t) {
+            put8(static_cast<uint8_t>(t));
+            for (int i = 0; i < 64; ++i) put8(quant_[t][kZigzag[i]]);
+        }
+
+        // SOF0
+        put16(0xFFC0);
+        put16(8 + 3 * 3);
+        put8(8);
+        put16(static_cast<uint16_t>(height));
+        put16(static_cast<uint16_t>(width));
+        put8(3);
+        put8(1); put8(static_cast<uint8_t>(0x20 | v_samp_)); put8(0);
+        put8(2); put8(0x11); put8(1);
+        put8(3); put8(0x11); put8(1);
+
+        // DHT
+        struct TableSpec { uint8_t id; const uint8_t* bits; const uint8_t* values; };
+        const TableSpec tables[4] = {
+            {0x00, kDcLumaBits, kDcValues},
+            {0x10, kAcLumaBits, kAcLumaValues},
+            {0x01, kDcChromaBits, kDcValues},
+            {0x11, kAcChromaBits, kAcChromaValues},
+        };
+        uint16_t dht_length = 2;
+        for (const auto& t : tables) {
+            dht_length += 17;
+            for (int i = 0; i < 16; ++i) dht_length += t.bits[i];
+        }
+        put16(0xFFC4);
+        put16(dht_length);
+        for (const auto& t : tables) {
+            put8(t.id);
+            int count = 0;
+            for (int i = 0; i < 16; ++i) {
+                put8(t.bits[i]);
+                count += t.bits[i];
+            }
+            for (int i = 0; i < count; ++i) put8(t.values[i]);
+        }
+
+        // DRI
+        if (restart_interval > 0) {
+            put16(0xFFDD);
+            put16(4);
+            put16(restart_interval);
+        }
+
+        // SOS
+        put16(0xFFDA);
+        put16(12);
+        put8(3);
+        put8(1); put8(0x00);
+        put8(2); put8(0x11);
+        put8(3); put8(0x11);
+        put8(0);
+        put8(63);
+        put8(0);
+
+        header_width_ = width;
+        header_height_ = height;
+        header_v_samp_ = v_samp_;
+        header_restart_ = restart_interval;
+    }
+
+    void EncodeSlice(const SourceFrame& src, uint32_t row_begin, uint32_t row_end, Slice& slice) const {
+        const uint32_t chroma_width = padded_width_ / 2;
+        slice.luma.resize(static_cast<size_t>(mcu_rows_) * padded_width_);
+        slice.chroma[0].resize(8 * chroma_width);
+        slice.chroma[1].resize(8 * chroma_width);
+        for (auto& s : slice.scratch) {
+            s.resize(padded_width_);
+        }
+
+        slice.output.clear();
+        slice.output.reserve(static_cast<size_t>(row_end - row_begin) * mcu_rows_ * padded_width_ / 2);
+        BitWriter writer(slice.output);
+        int last_dc[3] = {0, 0, 0};
+
+        for (uint32_t my = row_begin; my < row_end; ++my) {
+            FillStrip(src, my, slice);
+
+            for (uint32_t mx = 0; mx < mcus_x_; ++mx) {
+                const uint8_t* luma = slice.luma.data() + mx * 16;
+                for (uint32_t by = 0; by < v_samp_; ++by) {
+                    for (uint32_t bx = 0; bx < 2; ++bx) {
+                        EncodeBlock(luma + by * 8 * padded_width_ + bx * 8, padded_width_, 0, last_dc[0], writer);
+                    }
+                }
+                EncodeBlock(slice.chroma[0].data() + mx * 8, chroma_width, 1, last_dc[1], writer);
+                EncodeBlock(slice.chroma[1].data() + mx * 8, chroma_width, 1, last_dc[2], writer);
+            }
+        }
+
+        writer.Flush();
+    }
+
+    // Convert one MCU row of the source into padded Y/Cb/Cr strips
+    void FillStrip(const SourceFrame& src, uint32_t my, Slice& slice) const {
+        const uint32_t chroma_width = padded_width_ / 2;
+        const uint32_t src_chroma_width = (src.width + 1) / 2;
+        const uint32_t src_chroma_height = (src.height + 1) / 2;
+        const uint32_t y0 = my * mcu_rows_;
+        uint8_t* luma = slice.luma.data();
+        uint8_t* cb = slice.chroma[0].data();
+        uint8_t* cr = slice.chroma[1].data();
+        auto src_row = [&](int plane, uint32_t y, uint32_t max_y) {
+            return src.plane[plane] + static_cast<size_t>(src.stride[plane]) * std::min(y, max_y - 1);
+        };
+
+        switch (src.format) {
+            case PixelFormat::RGB24:
+            case PixelFormat::BGR24:
+            case PixelFormat::RGBA32:
+            case PixelFormat::BGRA32: {
+                const uint32_t bpp = (src.format == PixelFormat::RGB24 || src.format == PixelFormat::BGR24) ? 3 : 4;
+                const bool bgr = (src.format == PixelFormat::BGR24 || src.format == PixelFormat::BGRA32);
+                uint8_t* r = slice.scratch[0].data();
+                uint8_t* g = slice.scratch[1].data();
+                uint8_t* b = slice.scratch[2].data();
+                uint8_t* full_cb[2] = {slice.scratch[3].data(), slice.scratch[4].data()};
+                uint8_t* full_cr[2] = {slice.scratch[5].data(), slice.scratch[6].data()};
+
+                for (uint32_t i = 0; i < mcu_rows_; ++i) {
+                    const uint8_t* row = src_row(0, y0 + i, src.height);
+                    for (uint32_t x = 0; x < src.width; ++x) {
+                        r[x] = row[x * bpp + (bgr ? 2 : 0)];
+                        g[x] = row[x * bpp + 1];
+                        b[x] = row[x * bpp + (bgr ? 0 : 2)];
+                    }
+                    PadRow(r, src.width, padded_width_);
+                    PadRow(g, src.width, padded_width_);
+                    PadRow(b, src.width, padded_width_);
+
+                    // Full-resolution chroma goes to a row pair so 4:2:0 can average vertically
+                    uint32_t parity = (v_samp_ == 2) ? (i & 1) : 0;
+                    RgbToYCbCrRow(r, g, b, padded_width_, luma + i * padded_width_, full_cb[parity], full_cr[parity]);
+
+                    if (v_samp_ == 2) {
+                        if (parity == 1) {
+                            DownsampleRow(full_cb[0], full_cb[1], chroma_width, cb + (i / 2) * chroma_width);
+                            DownsampleRow(full_cr[0], full_cr[1], chroma_width, cr + (i / 2) * chroma_width);
+                        }
+                    } else {
+                        DownsampleRow(full_cb[0], nullptr, chroma_width, cb + i * chroma_width);
+                        DownsampleRow(full_cr[0], nullptr, chroma_width, cr + i * chroma_width);
+                    }
+                }
+                break;
+            }
+
+            case PixelFormat::YUYV:
+            case PixelFormat::UYVY: {
+                const uint32_t y_off = (src.format == PixelFormat::YUYV) ? 0 : 1;
+                const uint32_t c_off = 1 - y_off;
+                uint8_t* row_cb[2] = {slice.scratch[0].data(), slice.scratch[1].data()};
+                uint8_t* row_cr[2] = {slice.scratch[2].data(), slice.scratch[3].data()};
+
+                for (uint32_t i = 0; i < mcu_rows_; ++i) {
+                    const uint8_t* row = src_row(0, y0 + i, src.height);
+                    uint8_t* out_y = luma + i * padded_width_;
+                    for (uint32_t x = 0; x < src.width; ++x) {
+                        out_y[x] = row[x * 2 + y_off];
+                    }
+                    PadRow(out_y, src.width, padded_width_);
+
+                    uint32_t parity = (v_samp_ == 2) ? (i & 1) : 0;
+                    uint8_t* u = (v_samp_ == 2) ? row_cb[parity] : cb + i * chroma_width;
+                    uint8_t* v = (v_samp_ == 2) ? row_cr[parity] : cr + i * chroma_width;
+                    for (uint32_t x = 0; x < src_chroma_width; ++x) {
+                        u[x] = row[x * 4 + c_off];
+                        v[x] = row[x * 4 + c_off + 2];
+                    }
+                    PadRow(u, src_chroma_width, chroma_width);
+                    PadRow(v, src_chroma_width, chroma_width);
+
+                    if (v_samp_ == 2 && parity == 1) {
+                        AverageRows(row_cb[0], row_cb[1], chroma_width, cb + (i / 2) * chroma_width);
+                        AverageRows(row_cr[0], row_cr[1], chroma_width, cr + (i / 2) * chroma_width);
+                    }
+                }
+                break;
+            }
+
+            case PixelFormat::NV12:
+            case PixelFormat::NV21:
+            case PixelFormat::YUV420P: {
+                for (uint32_t i = 0; i < mcu_rows_; ++i) {
+                    CopyPadded(luma + i * padded_width_, src_row(0, y0 + i, src.height), src.width, padded_width_);
+                }
+
+                // 4:2:0 sources map chroma rows 1:1 into 4:2:0 output, or duplicate rows for 4:2:2
+                const uint32_t chroma_y0 = (v_samp_ == 2) ? my * 8 : my * 4;
+                for (uint32_t j = 0; j < 8; ++j) {
+                    uint32_t sy = (v_samp_ == 2) ? chroma_y0 + j : chroma_y0 + j / 2;
+                    uint8_t* u = cb + j * chroma_width;
+                    uint8_t* v = cr + j * chroma_width;
+                    if (src.format == PixelFormat::YUV420P) {
+                        CopyPadded(u, src_row(1, sy, src_chroma_height), src_chroma_width, chroma_width);
+                        CopyPadded(v, src_row(2, sy, src_chroma_height), src_chroma_width, chroma_width);
+                    } else {
+                        const uint8_t* uv = src_row(1, sy, src_chroma_height);
+                        const uint32_t u_off = (src.format == PixelFormat::NV12) ? 0 : 1;
+                        for (uint32_t x = 0; x < src_chroma_width; ++x) {
+                            u[x] = uv[x * 2 + u_off];
+                            v[x] = uv[x * 2 + (1 - u_off)];
+                        }
+                        PadRow(u, src_chroma_width, chroma_width);
+                        PadRow(v, src_chroma_width, chroma_width);
+                    }
+                }
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+
+    void EncodeBlock(const uint8_t* pixels, uint32_t stride, int table, int& last_dc, BitWriter& writer) const {
+        // Level shift into row vectors: lo = columns 0-3, hi = columns 4-7
+        i32x4 lo[8], hi[8];
+        for (int r = 0; r < 8; ++r) {
+            const uint8_t* p = pixels + r * stride;
+            lo[r] = i32x4{p[0], p[1], p[2], p[3]} - 128;
+            hi[r] = i32x4{p[4], p[5], p[6], p[7]} - 128;
+        }
+
+        // Vertical pass, transpose, vertical pass again (= horizontal pass)
+        Fdct8(lo);
+        Fdct8(hi);
+
+        alignas(16) int32_t t[64];
+        for (int r = 0; r < 8; ++r) {
+            for (int c = 0; c < 4; ++c) {
+                t[c * 8 + r] = lo[r][c];
+                t[(c + 4) * 8 + r] = hi[r][c];
+            }
+        }
+        for (int r = 0; r < 8; ++r) {
+            lo[r] = Load<i32x4>(t + r * 8);
+            hi[r] = Load<i32x4>(t + r * 8 + 4);
+        }
+
+        Fdct8(lo);
+        Fdct8(hi);
+
+        // Quantize: round-half-away-from-zero via a sign-copied 0.5 bias
+        alignas(16) int32_t q[64];
+        const float* recip = reciprocal_[table];
+        for (int r = 0; r < 8; ++r) {
+            for (int h = 0; h < 2; ++h) {
+                f32x4 v = __builtin_convertvector(h ? hi[r] : lo[r], f32x4) * Load<f32x4>(recip + r * 8 + h * 4);
+                i32x4 sign = (i32x4)v & static_cast<int32_t>(0x80000000);
+                v += (f32x4)(sign | 0x3F000000);
+                Store(q + r * 8 + h * 4, __builtin_convertvector(v, i32x4));
+            }
+        }
+
+        // DC
+        int dc = std::clamp(q[scan_order_[0]], -2047, 2047);
+        int diff = dc - last_dc;
+        last_dc = dc;
+        EmitValue(diff, dc_tables_[table], 0, writer);
+
+        // AC run-length coding
+        const HuffmanTable& ac = ac_tables_[table];
+        int run = 0;
+        for (int k = 1; k < 64; ++k) {
+            int value = q[scan_order_[k]];
+            if (value == 0) {
+                ++run;
+                continue;
+            }
+            while (run > 15) {
+                writer.Put(ac.code[0xF0], ac.size[0xF0]);
+                run -= 16;
+            }
+            EmitValue(std::clamp(value, -1023, 1023), ac, run, writer);
+            run = 0;
+        }
+        if (run > 0) {
+            writer.Put(ac.code[0x00], ac.size[0x00]);
+        }
+    }
+
+    static void EmitValue(int value, const HuffmanTable& table, int run, BitWriter& writer) {
+        uint32_t magnitude = static_cast<uint32_t>(value < 0 ? -value : value);
+        int bits = BitLength(magnitude);
+        int symbol = (run << 4) | bits;
+        writer.Put(table.code[symbol], table.size[symbol]);
+        if (bits > 0) {
+            writer.Put(static_cast<uint32_t>(value < 0 ? value - 1 : value), bits);
+        }
+    }
+
+    HuffmanTable dc_tables_[2];
+    HuffmanTable ac_tables_[2];
+    uint8_t scan_order_[64];
+    uint8_t quant_[2][64];
+    alignas(16) float reciprocal_[2][64];
+
+    // Current frame geometry
+    uint32_t v_samp_{2};
+    uint32_t mcu_rows_{16};
+    uint32_t mcus_x_{0};
+    uint32_t mcus_y_{0};
+    uint32_t padded_width_{0};
+
+    // Cached stream header
+    std::vector<uint8_t> header_;
+    uint32_t header_width_{0};
+    uint32_t header_height_{0};
+    uint32_t header_v_samp_{0};
+    uint16_t header_restart_{0};
+
+    std::vector<Slice> slices_;
+};
+
+JpegEncode::JpegEncode()
+    : BaseVideoProcessor("JpegEncode", "JpegEncode")
+    , encoder_(std::make_unique<JpegEncoder>()) {
+    output_format_ = DeriveOutputFormat(input_format_);
+}
+
+JpegEncode::~JpegEncode() {
+    Shutdown();
+}
+
+bool JpegEncode::SupportsFormat(PixelFormat format) const {
+    switch (format) {
+        case PixelFormat::RGB24:
+        case PixelFormat::BGR24:
+        case PixelFormat::RGBA32:
+        case PixelFormat::BGRA32:
+        case PixelFormat::YUV420P:
+        case PixelFormat::NV12:
+        case PixelFormat::NV21:
+        case PixelFormat::YUYV:
+        case PixelFormat::UYVY:
+            return true;
+        default:
+            return false;
+    }
+}
+
+std::vector<PixelFormat> JpegEncode::GetSupportedFormats() const {
+    return {
+        PixelFormat::RGB24,
+        PixelFormat::BGR24,
+        PixelFormat::RGBA32,
+        PixelFormat::BGRA32,
+        PixelFormat::YUV420P,
+        PixelFormat::NV12,
+        PixelFormat::NV21,
+        PixelFormat::YUYV,
+        PixelFormat::UYVY
+    };
+}
+
+bool JpegEncode::Initialize(const BlockParams& params) {
+    if (!BaseVideoProcessor::Initialize(params)) {
+        return false;
+    }
+
+    auto quality_str = BaseBlock::GetParameter("quality");
+    if (!quality_str.empty()) {
+        if (!SetQuality(std::stoi(quality_str))) {
+            return false;
+        }
+    }
+
+    auto subsampling_str = BaseBlock::GetParameter("subsampling");
+    if (!subsampling_str.empty()) {
+        if (subsampling_str == "420") subsampling_ = JpegSubsampling::YUV420;
+        else if (subsampling_str == "422") subsampling_ = JpegSubsampling::YUV422;
+        else if (subsampling_str == "auto") subsampling_ = JpegSubsampling::AUTO;
+        else {
+            VP_LOG_WARNING_F("Unknown JPEG subsampling '{}', using auto", subsampling_str);
+        }
+    }
+
+    auto threads_str = BaseBlock::GetParameter("threads");
+    if (!threads_str.empty()) {
+        thread_count_ = std::max<size_t>(1, std::stoul(threads_str));
+    }
+
+    auto restart_str = BaseBlock::GetParameter("restart_rows");
+    if (!restart_str.empty()) {
+        restart_rows_ = std::stoul(restart_str);
+    }
+
+    // The worker thread encodes one slice itself; the pool takes the rest
+    if (thread_count_ > 1) {
+        thread_pool_ = std::make_unique<ThreadPool>(thread_count_ - 1);
+    }
+
+    VP_LOG_INFO_F("JpegEncode initialized: quality={}, subsampling={}, threads={}, restart_rows={}",
+                  quality_, static_cast<int>(subsampling_), thread_count_, restart_rows_);
+    return true;
+}
+
+bool JpegEncode::Shutdown() {
+    bool ok = BaseVideoProcessor::Shutdown();
+    thread_pool_.reset();
+    return ok;
+}
+
+bool JpegEncode::SetQuality(int quality) {
+    if (quality < 1 || quality > 100) {
+        SetError("Invalid JPEG quality: " + std::to_string(quality));
+        return false;
+    }
+
+    if (BaseBlock::GetState() == BlockState::RUNNING) {
+        SetError("Cannot change JPEG quality while running");
+        return false;
+    }
+
+    quality_ = quality;
+    encoder_->SetQuality(quality);
+    return true;
+}
+
+bool JpegEncode::IsHotParameter(const std::string& key) const {
+    return key == "quality" || BaseVideoProcessor::IsHotParameter(key);
+}
+
+void JpegEncode::ApplyParameter(const std::string& key, const std::string& value) {
+    if (key != "quality") {
+        BaseVideoProcessor::ApplyParameter(key, value);
+        return;
+    }
+
+    // Between two frames on the worker thread, so the tables can be rebuilt
+    int quality = std::stoi(value);
+    if (quality < 1 || quality > 100) {
+        VP_LOG_WARNING_F("JpegEncode '{}': invalid quality {}", GetName(), value);
+        return;
+    }
+    quality_ = quality;
+    encoder_->SetQuality(quality);
+}
+
+bool JpegEncode::SetSubsampling(JpegSubsampling subsampling) {
+    if (BaseBlock::GetState() == BlockState::RUNNING) {
+        SetError("Cannot change JPEG subsampling while running");
+        return false;
+    }
+
+    subsampling_ = subsampling;
+    return true;
+}
+
+FrameInfo JpegEncode::DeriveOutputFormat(const FrameInfo& input) const {
+    FrameInfo output = input;
+    output.pixel_format = PixelFormat::MJPEG;
+    output.stride = 0;
+    output.is_hardware_buffer = false;
+    output.hw_handle = nullptr;
+    return output;
+}
+
+bool JpegEncode::ProcessFrameImpl(VideoFramePtr frame) {
+    if (!frame || !frame->IsValid()) {
+        VP_LOG_WARNING_F("JpegEncode '{}' received invalid frame", GetName());
+        return false;
+    }
+
+    if (!SupportsFormat(frame->GetFrameInfo().pixel_format)) {
+        VP_LOG_WARNING_F("JpegEncode '{}' unsupported input: {}", GetName(), frame->GetFrameInfo().ToString());
+        return false;
+    }
+
+    auto output = encoder_->Encode(*frame, subsampling_, thread_count_, restart_rows_, thread_pool_.get());
+    if (!output) {
+        VP_LOG_WARNING_F("JpegEncode '{}' failed to encode frame", GetName());
+        return false;
+    }
+
+    EmitFrame(output);
+    return true;
+}
+
+} // namespace video_pipeline
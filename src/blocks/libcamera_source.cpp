@@ -1,6 +1,7 @@
 #include "video_pipeline/blocks/libcamera_source.h"
 #include "video_pipeline/logger.h"
 #include "video_pipeline/timer.h"
+#include "utils/frame_planes.h"
 #include <sys/mman.h>
 #include <algorithm>
 #include <cstring>
@@ -12,9 +13,11 @@ namespace {
 
 class LibcameraFrame : public IVideoFrame {
 public:
-    LibcameraFrame(void* data, size_t length, const FrameInfo& info, libcamera::Request* request, LibcameraSource* owner)
-        : data_(data)
-        , length_(length)
+    LibcameraFrame(const LibcameraBuffer& buffer, const FrameInfo& info, libcamera::Request* request, LibcameraSource* owner)
+        : data_(buffer.mapped)
+        , length_(buffer.length)
+        , fd_(buffer.fd)
+        , fd_offset_(buffer.offset)
         , frame_info_(info)
         , request_(request)
         , owner_(owner) {}
@@ -24,26 +27,23 @@ public:
     // IBuffer
     void* GetData() override { return data_; }
     const void* GetData() const override { return data_; }
-    size_t GetSize() const override { return frame_info_.GetFrameSize(); }
+    size_t GetSize() const override { return payload_size_ ? payload_size_ : frame_info_.GetFrameSize(); }
     size_t GetCapacity() const override { return length_; }
+    bool SetSize(size_t size) override {
+        if (size > length_) return false;
+        payload_size_ = size;
+        return true;
+    }
 
     const FrameInfo& GetFrameInfo() const override { return frame_info_; }
-    void SetFrameInfo(const FrameInfo& info) override { frame_info_ = info; }
+    void SetFrameInfo(const FrameInfo& info) override {
+        frame_info_ = info;
+        payload_size_ = 0;
+    }
 
     bool IsValid() const override { return data_ != nullptr && GetFrameSize() <= length_; }
     void Reset() override { frame_info_ = FrameInfo{}; }
 
-    void AddRef() override { ref_count_.fetch_add(1, std::memory_order_relaxed); }
-    void Release() override {
-        if (ref_count_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
-            if (owner_) {
-                owner_->RecycleRequest(request_);
-            }
-            delete this;
-        }
-    }
-    uint32_t GetRefCount() const override { return ref_count_.load(std::memory_order_relaxed); }
-
     // IVideoFrame
     void* GetPlaneData(int plane) override {
         return (plane == 0) ? data_ : nullptr;
@@ -60,12 +60,42 @@ public:
     int GetPlaneCount() const override { return 1; }
 
     bool CopyFrom(const IVideoFrame& other) override {
-        if (other.GetFrameInfo().GetFrameSize() > length_) return false;
-        std::memcpy(data_, other.GetData(), other.GetFrameInfo().GetFrameSize());
-        frame_info_ = other.GetFrameInfo();
+        const auto& other_info = other.GetFrameInfo();
+        if (IsCompressedFormat(other_info.pixel_format)) {
+            if (other.GetSize() > length_) return false;
+            std::memcpy(data_, other.GetData(), other.GetSize());
+            frame_info_ = other_info;
+            payload_size_ = other.GetSize();
+            return true;
+        }
+
+        // Keep this buffer's row pitch; the source may be packed, padded or a view
+        FramePlanes src;
+        if (!ResolvePlanes(other, src)) {
+            return false;
+        }
+
+        const FrameInfo previous = frame_info_;
+        frame_info_ = other_info;
+        frame_info_.stride = previous.stride;
+
+        MutableFramePlanes dst;
+        if (!ResolvePlanes(*this, dst) || PlanesExtent(dst) > length_) {
+            frame_info_ = previous;
+            return false;
+        }
+        frame_info_.stride = dst.stride[0];
+        payload_size_ = 0;
+        CopyPlanes(src, dst);
         return true;
     }
 
+    // The dmabuf can be passed to other processes (see UdsSink)
+    int GetFd(size_t& offset) const override {
+        offset = fd_offset_;
+        return fd_;
+    }
+
     BufferPtr Clone() const override {
         // Zero-copy frames cannot clone without allocation; fall back to copy.
         auto clone_info = frame_info_;
@@ -76,15 +106,26 @@ public:
         return clone;
     }
 
+protected:
+    // Last reference dropped: requeue the camera buffer
+    void Recycle() override {
+        if (owner_) {
+            owner_->RecycleRequest(request_);
+        }
+        delete this;
+    }
+
 private:
     size_t GetFrameSize() const { return frame_info_.GetFrameSize(); }
 
     void* data_{nullptr};
     size_t length_{0};
+    int fd_{-1};
+    size_t fd_offset_{0};
+    size_t payload_size_{0};
     FrameInfo frame_info_{};
     libcamera::Request* request_{nullptr};
     LibcameraSource* owner_{nullptr};
-    std::atomic<uint32_t> ref_count_{1};
 };
 
 } // namespace
@@ -287,7 +328,7 @@ bool LibcameraSource::SetupBuffers() {
             return false;
         }
 
-        buffer_map_[fb] = LibcameraBuffer{const_cast<libcamera::FrameBuffer*>(fb), map, plane.length};
+        buffer_map_[fb] = LibcameraBuffer{const_cast<libcamera::FrameBuffer*>(fb), map, plane.length, fd, 0};
 
         auto request = camera_->createRequest();
         if (!request) {
@@ -410,8 +451,7 @@ void LibcameraSource::OnRequestComplete(libcamera::Request* request) {
     info.hw_handle = const_cast<libcamera::FrameBuffer*>(fb);
 
     // Zero-copy: wrap libcamera buffer and requeue when the last reference is released.
-    auto frame = VideoFramePtr(new LibcameraFrame(mapped.mapped, mapped.length, info, request, this),
-                               [](IVideoFrame* f) { f->Release(); });
+    VideoFramePtr frame = MakeRef<LibcameraFrame>(mapped, info, request, this);
     EmitFrame(frame);
 }
 
@@ -0,0 +1,396 @@
+#include "video_pipeline/blocks/pre_roll_recorder.h"
+#include "video_pipeline/blocks/file_sink.h"
+#include "video_pipeline/qoi.h"
+#include "video_pipeline/logger.h"
+#include "video_pipeline/timer.h"
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+namespace video_pipeline {
+
+namespace {
+
+// Private copy: the packed pixels, or exactly the payload of a compressed frame
+VideoFramePtr CopyFrame(const IVideoFrame& frame) {
+    const FrameInfo& info = frame.GetFrameInfo();
+    if (IsCompressedFormat(info.pixel_format)) {
+        auto copy = CreateVideoFrame(info, frame.GetSize());
+        if (!copy || !copy->SetSize(frame.GetSize())) {
+            return nullptr;
+        }
+        std::memcpy(copy->GetData(), frame.GetData(), frame.GetSize());
+        return copy;
+    }
+
+    auto copy = CreateVideoFrame(info);
+    if (!copy || !copy->CopyFrom(frame)) {
+        return nullptr;
+    }
+    return copy;
+}
+
+} // namespace
+
+PreRollRecorder::PreRollRecorder()
+    : BaseVideoSink("PreRollRecorder", "PreRollRecorder") {
+}
+
+PreRollRecorder::~PreRollRecorder() {
+    Stop();
+}
+
+bool PreRollRecorder::SupportsFormat(PixelFormat format) const {
+    return format != PixelFormat::UNKNOWN;
+}
+
+std::vector<PixelFormat> PreRollRecorder::GetSupportedFormats() const {
+    return {
+        PixelFormat::RGB24, PixelFormat::BGR24, PixelFormat::RGBA32, PixelFormat::BGRA32,
+        PixelFormat::YUV420P, PixelFormat::NV12,  PixelFormat::NV21,  PixelFormat::YUYV,
+        PixelFormat::UYVY,  PixelFormat::MJPEG, PixelFormat::QOI};
+}
+
+bool PreRollRecorder::Initialize(const BlockParams& params) {
+    if (!BaseVideoSink::Initialize(params)) {
+        return false;
+    }
+
+    auto pre_str = BaseBlock::GetParameter("pre_seconds");
+    if (!pre_str.empty()) {
+        pre_us_ = static_cast<uint64_t>(std::max(0.0, std::stod(pre_str)) * 1000000);
+    }
+
+    auto post_str = BaseBlock::GetParameter("post_seconds");
+    if (!post_str.empty()) {
+        post_us_ = static_cast<uint64_t>(std::max(0.0, std::stod(post_str)) * 1000000);
+    }
+
+    auto memory_str = BaseBlock::GetParameter("max_memory_mb");
+    if (!memory_str.empty()) {
+        max_bytes_ = static_cast<size_t>(std::stoul(memory_str)) << 20;
+        if (max_bytes_ == 0) {
+            SetError("PreRollRecorder max_memory_mb must be at least 1");
+            return false;
+        }
+    }
+
+    auto storage_str = BaseBlock::GetParameter("storage");
+    if (storage_str == "reference") {
+        storage_ = PreRollStorage::REFERENCE;
+    } else if (storage_str.empty() || storage_str == "copy") {
+        storage_ = PreRollStorage::COPY;
+    } else if (storage_str == "qoi") {
+        storage_ = PreRollStorage::QOI;
+    } else {
+        SetError("PreRollRecorder storage must be reference, copy or qoi: " + storage_str);
+        return false;
+    }
+
+    auto trigger_str = BaseBlock::GetParameter("trigger");
+    if (trigger_str.empty() || trigger_str == "manual") {
+        trigger_on_change_ = false;
+    } else if (trigger_str == "change") {
+        trigger_on_change_ = true;
+    } else {
+        SetError("PreRollRecorder trigger must be change or manual: " + trigger_str);
+        return false;
+    }
+
+    auto path = BaseBlock::GetParameter("path");
+    if (!path.empty()) {
+        path_ = path;
+    }
+
+    auto format_str = BaseBlock::GetParameter("format");
+    if (!format_str.empty()) {
+        if (format_str != "raw" && format_str != "ppm" && format_str != "pgm" && format_str != "yuv" &&
+            format_str != "qoi") {
+            SetError("PreRollRecorder format must be raw, ppm, pgm, yuv or qoi: " + format_str);
+            return false;
+        }
+        format_ = format_str;
+    }
+
+    auto single_file_str = BaseBlock::GetParameter("single_file");
+    if (!single_file_str.empty()) {
+        single_file_ = (single_file_str == "true" || single_file_str == "1");
+    }
+
+    VP_LOG_INFO_F("PreRollRecorder initialized: pre={}s, post={}s, max_memory={} MB, storage={}, trigger={}, "
+                  "path='{}', format={}", pre_us_ / 1e6, post_us_ / 1e6, max_bytes_ >> 20,
+                  storage_str.empty() ? "copy" : storage_str, trigger_on_change_ ? "change" : "manual",
+                  path_, format_);
+    return true;
+}
+
+bool PreRollRecorder::Start() {
+    // Checked before touching the ring or the writer, which a running block is using
+    if (BaseBlock::GetState() != BlockState::INITIALIZED && BaseBlock::GetState() != BlockState::STOPPED) {
+        SetError("Cannot start PreRollRecorder from state: " + BaseBlock::GetStateString());
+        return false;
+    }
+
+    // A writer left over from a start that failed part way
+    if (writer_thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(write_mutex_);
+            stop_writer_ = true;
+        }
+        write_condition_.notify_all();
+        writer_thread_.join();
+    }
+
+    ring_.clear();
+    record_until_us_ = 0;
+    recording_.store(false);
+    trigger_requested_.store(false);
+    {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        stop_writer_ = false;
+    }
+    writer_thread_ = std::thread(&PreRollRecorder::WriterThread, this);
+
+    if (!BaseVideoSink::Start()) {
+        Stop();
+        return false;
+    }
+    return true;
+}
+
+bool PreRollRecorder::Stop() {
+    bool ok = BaseVideoSink::Stop();
+
+    // The clip in progress is finished; the writer empties its queue before exiting
+    if (recording_.exchange(false)) {
+        QueueForWriting(StoredFrame{});
+    }
+    {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        stop_writer_ = true;
+    }
+    write_condition_.notify_all();
+    if (writer_thread_.joinable()) {
+        writer_thread_.join();
+    }
+
+    for (const auto& entry : ring_) {
+        buffered_bytes_.fetch_sub(entry.bytes);
+    }
+    ring_.clear();
+    return ok;
+}
+
+bool PreRollRecorder::Shutdown() {
+    Stop();
+    return BaseVideoSink::Shutdown();
+}
+
+BlockStats PreRollRecorder::GetStats() const {
+    BlockStats stats = BaseVideoSink::GetStats();
+    stats.buffered_bytes = buffered_bytes_.load();
+    return stats;
+}
+
+bool PreRollRecorder::IsHotParameter(const std::string& key) const {
+    return key == "record" || BaseVideoSink::IsHotParameter(key);
+}
+
+void PreRollRecorder::ApplyParameter(const std::string& key, const std::string& value) {
+    if (key == "record") {
+        if (value == "true") {
+            Trigger();
+        } else {
+            // End the clip with the next frame
+            trigger_requested_.store(false);
+            record_until_us_ = 0;
+        }
+    } else {
+        BaseVideoSink::ApplyParameter(key, value);
+    }
+}
+
+VideoFramePtr PreRollRecorder::StoreFrame(const VideoFramePtr& frame) {
+    PixelFormat format = frame->GetFrameInfo().pixel_format;
+    switch (storage_) {
+        case PreRollStorage::REFERENCE:
+            // Seconds of pool frames would leave the upstream pool with
+            // nothing to hand out, so those are copied regardless
+            return frame->IsPoolHeld() ? CopyFrame(*frame) : frame;
+        case PreRollStorage::QOI:
+            if (format == PixelFormat::RGB24 || format == PixelFormat::RGBA32) {
+                // The encoder allocates for the worst case; keep only the payload
+                auto encoded = QoiEncodeFrame(*frame, 1, nullptr);
+                return encoded ? CopyFrame(*encoded) : nullptr;
+            }
+            return CopyFrame(*frame);
+        case PreRollStorage::COPY:
+        default:
+            return CopyFrame(*frame);
+    }
+}
+
+void PreRollRecorder::TrimRing(uint64_t now_us) {
+    while (!ring_.empty() &&
+           (ring_.front().timestamp_us + pre_us_ < now_us || buffered_bytes_.load() > max_bytes_)) {
+        buffered_bytes_.fetch_sub(ring_.front().bytes);
+        ring_.pop_front();
+    }
+}
+
+bool PreRollRecorder::ProcessFrameImpl(VideoFramePtr frame) {
+    if (!frame || !frame->IsValid()) {
+        VP_LOG_WARNING_F("PreRollRecorder '{}' received invalid frame", GetName());
+        return false;
+    }
+
+    const FrameInfo& info = frame->GetFrameInfo();
+    uint64_t now_us = info.timestamp_us;
+    if (now_us == 0) {
+        now_us = Timer::GetCurrentTimestampUs();
+    }
+
+    bool triggered = trigger_requested_.exchange(false, std::memory_order_acq_rel);
+    if (trigger_on_change_ && info.change && info.change->changed) {
+        triggered = true;
+    }
+
+    if (triggered) {
+        if (!recording_.load(std::memory_order_relaxed)) {
+            // The clip starts with the pre-roll
+            ++clip_;
+            recording_.store(true);
+            VP_LOG_INFO_F("PreRollRecorder '{}' recording clip {} with {} frames of pre-roll", GetName(), clip_,
+                          ring_.size());
+            for (auto& entry : ring_) {
+                entry.clip = clip_;
+                QueueForWriting(std::move(entry));
+            }
+            ring_.clear();
+        }
+        record_until_us_ = now_us + post_us_;
+    } else if (recording_.load(std::memory_order_relaxed) && now_us >= record_until_us_) {
+        QueueForWriting(StoredFrame{});
+        recording_.store(false);
+    }
+
+    StoredFrame entry;
+    entry.frame = StoreFrame(frame);
+    if (!entry.frame) {
+        VP_LOG_WARNING_F("PreRollRecorder '{}' cannot store {}", GetName(), info.ToString());
+        DiscardFrame();
+        return true;
+    }
+    entry.format = info.pixel_format;
+    entry.timestamp_us = now_us;
+    entry.bytes = entry.frame->GetCapacity();
+    entry.clip = clip_;
+
+    if (recording_.load(std::memory_order_relaxed)) {
+        // The writer is behind: keep what is queued and drop the new frame
+        if (buffered_bytes_.load() + entry.bytes > max_bytes_) {
+            DiscardFrame();
+            return true;
+        }
+        buffered_bytes_.fetch_add(entry.bytes);
+        QueueForWriting(std::move(entry));
+    } else {
+        buffered_bytes_.fetch_add(entry.bytes);
+        ring_.push_back(std::move(entry));
+        TrimRing(now_us);
+    }
+    return true;
+}
+
+void PreRollRecorder::QueueForWriting(StoredFrame entry) {
+    {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        write_queue_.push_back(std::move(entry));
+    }
+    write_condition_.notify_one();
+}
+
+std::unique_ptr<FileSink> PreRollRecorder::OpenClip(uint64_t clip) {
+    std::ostringstream path;
+    path << path_ << "_" << std::setfill('0') << std::setw(4) << clip;
+
+    auto sink = std::make_unique<FileSink>();
+    sink->SetName(GetName() + "_clip");
+    BlockParams params{
+        {"path", path.str()},
+        {"format", format_},
+        {"single_file", single_file_ ? "true" : "false"}
+    };
+    for (const auto& param : params) {
+        sink->SetParameter(param.first, param.second);
+    }
+    if (!sink->Initialize(params)) {
+        VP_LOG_ERROR_F("PreRollRecorder '{}' cannot write clip {}: {}", GetName(), clip, sink->GetLastError());
+        return nullptr;
+    }
+    return sink;
+}
+
+void PreRollRecorder::WriterThread() {
+    VP_LOG_DEBUG_F("PreRollRecorder '{}' writer thread started", GetName());
+
+    std::unique_ptr<FileSink> sink;
+    uint64_t open_clip = 0;     // Clip `sink` writes; its remaining frames are skipped if null
+    for (;;) {
+        StoredFrame entry;
+        {
+            std::unique_lock<std::mutex> lock(write_mutex_);
+            write_condition_.wait(lock, [this] { return stop_writer_ || !write_queue_.empty(); });
+            if (write_queue_.empty()) {
+                break;
+            }
+            entry = std::move(write_queue_.front());
+            write_queue_.pop_front();
+        }
+
+        if (!entry.frame) {
+            if (sink) {
+                VP_LOG_INFO_F("PreRollRecorder '{}' wrote clip {} ({} frames)", GetName(), open_clip,
+                              sink->GetFramesWritten());
+                clips_written_++;
+            }
+            sink.reset();
+            open_clip = 0;
+            continue;
+        }
+
+        if (entry.clip != open_clip) {
+            sink = OpenClip(entry.clip);
+            open_clip = entry.clip;
+        }
+
+        if (sink) {
+            // Frames compressed for the ring are written as they arrived,
+            // unless the clip is QOI as well
+            VideoFramePtr frame = entry.frame;
+            if (frame->GetFrameInfo().pixel_format == PixelFormat::QOI && entry.format != PixelFormat::QOI &&
+                format_ != "qoi") {
+                frame = QoiDecodeFrame(static_cast<const uint8_t*>(frame->GetData()), frame->GetSize(),
+                                       entry.format == PixelFormat::RGBA32 ? 4 : 3, nullptr);
+            }
+            if (frame && sink->WriteFrame(frame)) {
+                frames_written_++;
+            } else {
+                VP_LOG_ERROR_F("PreRollRecorder '{}' failed to write clip {}; skipping the rest of it",
+                               GetName(), open_clip);
+                sink.reset();
+            }
+        }
+
+        entry.frame = nullptr;
+        buffered_bytes_.fetch_sub(entry.bytes);
+    }
+
+    if (sink) {
+        clips_written_++;
+    }
+    VP_LOG_DEBUG_F("PreRollRecorder '{}' writer thread stopped", GetName());
+}
+
+} // namespace video_pipeline
@@ -0,0 +1,104 @@
+#include "video_pipeline/blocks/qoi_decode.h"
+#include "video_pipeline/qoi.h"
+#include "video_pipeline/logger.h"
+#include <algorithm>
+
+namespace video_pipeline {
+
+QoiDecode::QoiDecode()
+    : BaseVideoProcessor("QoiDecode", "QoiDecode") {
+    output_format_ = DeriveOutputFormat(input_format_);
+}
+
+QoiDecode::~QoiDecode() {
+    Shutdown();
+}
+
+bool QoiDecode::SupportsFormat(PixelFormat format) const {
+    return format == PixelFormat::QOI;
+}
+
+std::vector<PixelFormat> QoiDecode::GetSupportedFormats() const {
+    return { PixelFormat::QOI };
+}
+
+bool QoiDecode::Initialize(const BlockParams& params) {
+    if (!BaseVideoProcessor::Initialize(params)) {
+        return false;
+    }
+
+    auto format_str = BaseBlock::GetParameter("format");
+    if (!format_str.empty()) {
+        if (format_str == "RGB24") output_pixel_format_ = PixelFormat::RGB24;
+        else if (format_str == "RGBA32") output_pixel_format_ = PixelFormat::RGBA32;
+        else if (format_str == "auto") output_pixel_format_ = PixelFormat::UNKNOWN;
+        else {
+            VP_LOG_WARNING_F("Unknown QOI output format '{}', using the stream's channel count", format_str);
+        }
+    }
+
+    auto threads_str = BaseBlock::GetParameter("threads");
+    if (!threads_str.empty()) {
+        thread_count_ = std::max<size_t>(1, std::stoul(threads_str));
+    }
+
+    if (thread_count_ > 1) {
+        thread_pool_ = std::make_unique<ThreadPool>(thread_count_ - 1);
+    }
+
+    output_format_ = DeriveOutputFormat(input_format_);
+
+    VP_LOG_INFO_F("QoiDecode initialized: format={}, threads={}",
+                  static_cast<int>(output_pixel_format_), thread_count_);
+    return true;
+}
+
+bool QoiDecode::Shutdown() {
+    bool ok = BaseVideoProcessor::Shutdown();
+    thread_pool_.reset();
+    return ok;
+}
+
+FrameInfo QoiDecode::DeriveOutputFormat(const FrameInfo& input) const {
+    // The channel count is only known per frame; report RGB24 unless configured
+    FrameInfo output = input;
+    output.pixel_format = (output_pixel_format_ == PixelFormat::UNKNOWN) ? PixelFormat::RGB24 : output_pixel_format_;
+    output.stride = output.width * (output.pixel_format == PixelFormat::RGBA32 ? 4 : 3);
+    output.is_hardware_buffer = false;
+    output.hw_handle = nullptr;
+    return output;
+}
+
+bool QoiDecode::ProcessFrameImpl(VideoFramePtr frame) {
+    if (!frame || !frame->IsValid()) {
+        VP_LOG_WARNING_F("QoiDecode '{}' received invalid frame", GetName());
+        return false;
+    }
+
+    if (!SupportsFormat(frame->GetFrameInfo().pixel_format)) {
+        VP_LOG_WARNING_F("QoiDecode '{}' unsupported input: {}", GetName(), frame->GetFrameInfo().ToString());
+        return false;
+    }
+
+    uint8_t channels = 0;
+    if (output_pixel_format_ == PixelFormat::RGB24) channels = 3;
+    else if (output_pixel_format_ == PixelFormat::RGBA32) channels = 4;
+
+    auto output = QoiDecodeFrame(static_cast<const uint8_t*>(frame->GetData()), frame->GetSize(),
+                                 channels, thread_pool_.get());
+    if (!output) {
+        VP_LOG_WARNING_F("QoiDecode '{}' failed to decode frame", GetName());
+        return false;
+    }
+
+    // Carry the input timing across
+    FrameInfo info = output->GetFrameInfo();
+    info.timestamp_us = frame->GetFrameInfo().timestamp_us;
+    info.sequence_number = frame->GetFrameInfo().sequence_number;
+    output->SetFrameInfo(info);
+
+    EmitFrame(std::move(output));
+    return true;
+}
+
+} // namespace video_pipeline
@@ -0,0 +1,89 @@
+#include "video_pipeline/blocks/qoi_encode.h"
+#include "video_pipeline/qoi.h"
+#include "video_pipeline/logger.h"
+#include <algorithm>
+
+namespace video_pipeline {
+
+QoiEncode::QoiEncode()
+    : BaseVideoProcessor("QoiEncode", "QoiEncode") {
+    output_format_ = DeriveOutputFormat(input_format_);
+}
+
+QoiEncode::~QoiEncode() {
+    Shutdown();
+}
+
+bool QoiEncode::SupportsFormat(PixelFormat format) const {
+    return format == PixelFormat::RGB24 || format == PixelFormat::RGBA32;
+}
+
+std::vector<PixelFormat> QoiEncode::GetSupportedFormats() const {
+    return {
+        PixelFormat::RGB24,
+        PixelFormat::RGBA32
+    };
+}
+
+bool QoiEncode::Initialize(const BlockParams& params) {
+    if (!BaseVideoProcessor::Initialize(params)) {
+        return false;
+    }
+
+    auto threads_str = BaseBlock::GetParameter("threads");
+    if (!threads_str.empty()) {
+        thread_count_ = std::max<size_t>(1, std::stoul(threads_str));
+    }
+
+    auto tiles_str = BaseBlock::GetParameter("tiles");
+    if (!tiles_str.empty()) {
+        tile_count_ = std::min<size_t>(std::stoul(tiles_str), kQoiMaxBands);
+    }
+
+    // The worker thread encodes one band itself; the pool takes the rest
+    if (thread_count_ > 1) {
+        thread_pool_ = std::make_unique<ThreadPool>(thread_count_ - 1);
+    }
+
+    VP_LOG_INFO_F("QoiEncode initialized: threads={}, tiles={}", thread_count_, tile_count_);
+    return true;
+}
+
+bool QoiEncode::Shutdown() {
+    bool ok = BaseVideoProcessor::Shutdown();
+    thread_pool_.reset();
+    return ok;
+}
+
+FrameInfo QoiEncode::DeriveOutputFormat(const FrameInfo& input) const {
+    FrameInfo output = input;
+    output.pixel_format = PixelFormat::QOI;
+    output.stride = 0;
+    output.is_hardware_buffer = false;
+    output.hw_handle = nullptr;
+    return output;
+}
+
+bool QoiEncode::ProcessFrameImpl(VideoFramePtr frame) {
+    if (!frame || !frame->IsValid()) {
+        VP_LOG_WARNING_F("QoiEncode '{}' received invalid frame", GetName());
+        return false;
+    }
+
+    if (!SupportsFormat(frame->GetFrameInfo().pixel_format)) {
+        VP_LOG_WARNING_F("QoiEncode '{}' unsupported input: {}", GetName(), frame->GetFrameInfo().ToString());
+        return false;
+    }
+
+    size_t bands = tile_count_ ? tile_count_ : thread_count_;
+    auto output = QoiEncodeFrame(*frame, bands, thread_pool_.get());
+    if (!output) {
+        VP_LOG_WARNING_F("QoiEncode '{}' failed to encode frame", GetName());
+        return false;
+    }
+
+    EmitFrame(output);
+    return true;
+}
+
+} // namespace video_pipeline
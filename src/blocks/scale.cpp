@@ -0,0 +1,715 @@
+#include "video_pipeline/blocks/scale.h"
+#include "video_pipeline/logger.h"
+#include "utils/frame_planes.h"
+#include "utils/row_stage.h"
+#include "utils/simd.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace video_pipeline {
+
+namespace {
+
+using namespace simd;
+
+/**
+ * @brief Source taps of one output sample along an axis
+ *
+ * NEAREST uses i0. BILINEAR blends i0 and i1 with an 8-bit weight (0 = i0 only).
+ * AREA averages the half-open range [i0, i1).
+ */
+struct Tap {
+    uint32_t i0{0};
+    uint32_t i1{0};
+    uint32_t weight{0};
+};
+
+void BuildTaps(ScaleMethod method, uint32_t src, uint32_t dst, std::vector<Tap>& taps) {
+    taps.resize(dst);
+    for (uint32_t i = 0; i < dst; ++i) {
+        Tap& t = taps[i];
+        switch (method) {
+            case ScaleMethod::NEAREST:
+                t.i0 = std::min<uint32_t>(src - 1, static_cast<uint32_t>((2ull * i + 1) * src / (2ull * dst)));
+                break;
+
+            case ScaleMethod::BILINEAR: {
+                // Pixel centers aligned: x_src = (x + 0.5) * src / dst - 0.5
+                double pos = (i + 0.5) * src / dst - 0.5;
+                pos = std::clamp(pos, 0.0, static_cast<double>(src - 1));
+                t.i0 = static_cast<uint32_t>(pos);
+                t.i1 = std::min(t.i0 + 1, src - 1);
+                t.weight = static_cast<uint32_t>(std::lround((pos - t.i0) * 256.0));
+                if (t.weight >= 256) {
+                    t.i0 = t.i1;
+                    t.weight = 0;
+                }
+                if (t.weight == 0) {
+                    t.i1 = t.i0;
+                }
+                break;
+            }
+
+            case ScaleMethod::AREA:
+                t.i0 = static_cast<uint32_t>(static_cast<uint64_t>(i) * src / dst);
+                t.i1 = std::max(t.i0 + 1, static_cast<uint32_t>(static_cast<uint64_t>(i + 1) * src / dst));
+                break;
+        }
+    }
+}
+
+// out = (a * (256 - w) + b * w + 128) >> 8, 8 bytes per step.
+// 255 * 256 + 128 still fits the 16-bit lanes.
+void InterpolateRow(const uint8_t* a, const uint8_t* b, uint32_t weight, uint8_t* out, size_t len) {
+    const uint16_t wa = static_cast<uint16_t>(256 - weight);
+    const uint16_t wb = static_cast<uint16_t>(weight);
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        u16x8 va = LoadWiden(a + i);
+        u16x8 vb = LoadWiden(b + i);
+        StoreNarrow(out + i, (va * wa + vb * wb + 128) >> 8);
+    }
+    for (; i < len; ++i) {
+        out[i] = static_cast<uint8_t>((a[i] * wa + b[i] * wb + 128) >> 8);
+    }
+}
+
+// acc += row, widening bytes to 32-bit sums, 16 bytes per step
+void AccumulateRow(const uint8_t* row, uint32_t* acc, size_t len) {
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        for (size_t j = 0; j < 16; j += 4) {
+            u32x4 sum = Load<u32x4>(acc + i + j) + __builtin_convertvector(Load<u8x4>(row + i + j), u32x4);
+            Store(acc + i + j, sum);
+        }
+    }
+    for (; i < len; ++i) {
+        acc[i] += row[i];
+    }
+}
+
+// 8 source bytes picked by index, widened to 16-bit lanes
+inline u16x8 Gather(const uint8_t* row, const uint32_t* index) {
+    return u16x8{row[index[0]], row[index[1]], row[index[2]], row[index[3]],
+                 row[index[4]], row[index[5]], row[index[6]], row[index[7]]};
+}
+
+// out[i] = row[src[i]]
+void PickColumns(const uint8_t* row, const uint32_t* src, uint8_t* out, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        out[i] = row[src[i]];
+    }
+}
+
+// out[i] = (row[a[i]] * (256 - w[i]) + row[b[i]] * w[i] + 128) >> 8, 8 bytes per step
+void BlendColumns(const uint8_t* row, const uint32_t* a, const uint32_t* b, const uint16_t* weight,
+                  uint8_t* out, size_t len) {
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        u16x8 wb = Load<u16x8>(weight + i);
+        u16x8 wa = 256 - wb;
+        StoreNarrow(out + i, (Gather(row, a + i) * wa + Gather(row, b + i) * wb + 128) >> 8);
+    }
+    for (; i < len; ++i) {
+        out[i] = static_cast<uint8_t>((row[a[i]] * (256 - weight[i]) + row[b[i]] * weight[i] + 128) >> 8);
+    }
+}
+
+// out[i] = mean of the `taps` sums picked by columns[k * len + i] over `rows`
+// rows, of which count[i] are real (the rest pick a zero sum); 4 bytes per
+// step. The mean never exceeds 255, so rounding needs no clamp.
+void AverageColumns(const uint32_t* sums, const uint32_t* columns, uint32_t taps, const uint32_t* count,
+                    uint32_t rows, uint8_t* out, size_t len) {
+    size_t i = 0;
+    for (; i + 4 <= len; i += 4) {
+        u32x4 total{};
+        for (uint32_t k = 0; k < taps; ++k) {
+            const uint32_t* index = columns + k * len + i;
+            total += u32x4{sums[index[0]], sums[index[1]], sums[index[2]], sums[index[3]]};
+        }
+        f32x4 n = __builtin_convertvector(Load<u32x4>(count + i) * rows, f32x4);
+        f32x4 mean = __builtin_convertvector(total, f32x4) * (1.0f / n) + 0.5f;
+        Store(out + i, __builtin_convertvector(__builtin_convertvector(mean, u32x4), u8x4));
+    }
+    for (; i < len; ++i) {
+        uint32_t total = 0;
+        for (uint32_t k = 0; k < taps; ++k) {
+            total += sums[columns[k * len + i]];
+        }
+        const float scale = 1.0f / static_cast<float>(count[i] * rows);
+        out[i] = static_cast<uint8_t>(total * scale + 0.5f);
+    }
+}
+
+/**
+ * @brief Samples of one channel group within a plane row
+ *
+ * Sample x, channel c of a row lives at offset + x * step + c * channel_step.
+ */
+struct Component {
+    uint32_t offset{0};
+    uint32_t step{1};
+    uint32_t channels{1};
+    uint32_t channel_step{1};
+    uint32_t src_width{0};
+    uint32_t dst_width{0};
+    std::vector<Tap> taps;
+};
+
+/**
+ * @brief Scaling layout of one plane
+ */
+struct PlaneLayout {
+    uint32_t src_height{0};
+    uint32_t dst_height{0};
+    uint32_t row_shift{0};     // Plane row = frame row >> row_shift (1 for 4:2:0 chroma)
+    uint32_t row_bytes{0};     // Source bytes per row that the vertical pass touches
+    std::vector<Component> components;
+    std::vector<Tap> row_taps;
+
+    // Horizontal pass flattened to one entry per output byte, all components
+    // interleaved as in the row. Bytes no component covers get filler.
+    uint32_t out_bytes{0};
+    std::vector<uint32_t> col_src;      // Source byte of the first tap
+    std::vector<uint32_t> col_next;     // BILINEAR: source byte of the second tap
+    std::vector<uint16_t> col_weight;   // BILINEAR: weight of the second tap
+    uint32_t col_taps{0};               // AREA: widest box
+    std::vector<uint32_t> col_box;      // AREA: source byte of tap k at [k * out_bytes + i], row_bytes past the box
+    std::vector<uint32_t> col_count;    // AREA: taps in the box
+};
+
+} // namespace
+
+/**
+ * @brief Table-driven separable scaler
+ *
+ * Rebuilds its tables only when the input geometry, output geometry or method
+ * changes. Each output row is produced by a vertical pass over whole source
+ * rows into a scratch row followed by a horizontal pass over the whole output
+ * row, driven by per-byte source tables so every format shares one kernel.
+ */
+class Scaler {
+public:
+    bool Configure(PixelFormat format, uint32_t src_width, uint32_t src_height,
+                   uint32_t dst_width, uint32_t dst_height, ScaleMethod method) {
+        // Box filtering only makes sense when shrinking
+        if (method == ScaleMethod::AREA && (dst_width > src_width || dst_height > src_height)) {
+            method = ScaleMethod::BILINEAR;
+        }
+
+        if (configured_ && format == format_ && method == method_ &&
+            src_width == src_width_ && src_height == src_height_ &&
+            dst_width == dst_width_ && dst_height == dst_height_) {
+            return true;
+        }
+
+        format_ = format;
+        method_ = method;
+        src_width_ = src_width;
+        src_height_ = src_height;
+        dst_width_ = dst_width;
+        dst_height_ = dst_height;
+        configured_ = false;
+        planes_.clear();
+
+        // Odd source sizes drop the last partial chroma column/row, which keeps
+        // reads inside planes whose stride is derived from the luma width
+        const uint32_t src_cw = src_width / 2;
+        const uint32_t src_ch = src_height / 2;
+        const uint32_t dst_cw = dst_width / 2;
+        const uint32_t dst_ch = dst_height / 2;
+
+        switch (format) {
+            case PixelFormat::RGB24:
+            case PixelFormat::BGR24:
+            case PixelFormat::RGBA32:
+            case PixelFormat::BGRA32: {
+                uint32_t bpp = PackedBytesPerPixel(format);
+                AddPlane(src_height, dst_height, src_width * bpp);
+                AddComponent(0, bpp, bpp, 1, src_width, dst_width);
+                break;
+            }
+
+            case PixelFormat::YUYV:
+            case PixelFormat::UYVY: {
+                // Luma every 2 bytes, interleaved U/V every 4 bytes at half width
+                uint32_t luma = (format == PixelFormat::YUYV) ? 0 : 1;
+                AddPlane(src_height, dst_height, (src_width & ~1u) * 2);
+                AddComponent(luma, 2, 1, 1, src_width & ~1u, dst_width);
+                AddComponent(1 - luma, 4, 2, 2, src_width / 2, dst_cw);
+                break;
+            }
+
+            case PixelFormat::NV12:
+            case PixelFormat::NV21:
+                AddPlane(src_height, dst_height, src_width);
+                AddComponent(0, 1, 1, 1, src_width, dst_width);
+                AddPlane(src_ch, dst_ch, src_cw * 2, 1);
+                AddComponent(0, 2, 2, 1, src_cw, dst_cw);
+                break;
+
+            case PixelFormat::YUV420P:
+                AddPlane(src_height, dst_height, src_width);
+                AddComponent(0, 1, 1, 1, src_width, dst_width);
+                for (int p = 1; p < 3; ++p) {
+                    AddPlane(src_ch, dst_ch, src_cw, 1);
+                    AddComponent(0, 1, 1, 1, src_cw, dst_cw);
+                }
+                break;
+
+            default:
+                return false;
+        }
+
+        for (auto& plane : planes_) {
+            if (plane.src_height == 0 || plane.dst_height == 0) {
+                return false;
+            }
+            BuildTaps(method_, plane.src_height, plane.dst_height, plane.row_taps);
+            for (auto& comp : plane.components) {
+                if (comp.src_width == 0 || comp.dst_width == 0) {
+                    return false;
+                }
+                BuildTaps(method_, comp.src_width, comp.dst_width, comp.taps);
+            }
+            BuildColumns(plane);
+        }
+
+        configured_ = true;
+        return true;
+    }
+
+    ScaleMethod GetMethod() const { return method_; }
+
+    // Scale all planes; output rows are split into `bands` processed in parallel
+    void Run(const FramePlanes& src, const MutableFramePlanes& dst, size_t bands, ThreadPool* pool) {
+        bands = std::max<size_t>(1, std::min<size_t>(bands, dst_height_ / 2));
+        if (scratch_.size() < bands) {
+            scratch_.resize(bands);
+        }
+
+        auto run_band = [&](size_t b) {
+            Scratch& scratch = scratch_[b];
+            for (size_t p = 0; p < planes_.size(); ++p) {
+                const PlaneLayout& plane = planes_[p];
+                uint32_t begin = static_cast<uint32_t>(plane.dst_height * b / bands);
+                uint32_t end = static_cast<uint32_t>(plane.dst_height * (b + 1) / bands);
+                ScaleRows(plane, src.plane[p], src.stride[p], 0,
+                          dst.plane[p] + static_cast<size_t>(begin) * dst.stride[p], dst.stride[p], begin, end, scratch);
+            }
+        };
+
+        ParallelFor(pool, 0, bands, 1, [&](size_t first, size_t last) {
+            for (size_t b = first; b < last; ++b) {
+                run_band(b);
+            }
+        });
+    }
+
+    // Source frame rows [first, last) read for output frame rows [begin, end)
+    void GetInputRows(uint32_t begin, uint32_t end, uint32_t& first, uint32_t& last) const {
+        first = src_height_;
+        last = 0;
+        for (const auto& plane : planes_) {
+            uint32_t row_begin = begin >> plane.row_shift;
+            uint32_t row_end = std::min(plane.dst_height, end >> plane.row_shift);
+            if (row_begin >= row_end) {
+                continue;
+            }
+            const Tap& top = plane.row_taps[row_begin];
+            const Tap& bottom = plane.row_taps[row_end - 1];
+            uint32_t past = (method_ == ScaleMethod::AREA) ? bottom.i1
+                          : (method_ == ScaleMethod::BILINEAR) ? bottom.i1 + 1 : bottom.i0 + 1;
+            first = std::min(first, top.i0 << plane.row_shift);
+            last = std::max(last, past << plane.row_shift);
+        }
+        last = std::min(last, src_height_);
+        first = std::min(first, last);
+    }
+
+    // Scale output rows [begin, end) on the calling thread. `src` holds
+    // source rows from `src_row` on, `dst` output rows from `begin` on; both
+    // are even for 4:2:0 formats.
+    void RunRows(const FramePlanes& src, uint32_t src_row, const MutableFramePlanes& dst,
+                 uint32_t begin, uint32_t end) {
+        if (scratch_.empty()) {
+            scratch_.resize(1);
+        }
+        for (size_t p = 0; p < planes_.size(); ++p) {
+            const PlaneLayout& plane = planes_[p];
+            uint32_t row_begin = begin >> plane.row_shift;
+            uint32_t row_end = std::min(plane.dst_height, end >> plane.row_shift);
+            ScaleRows(plane, src.plane[p], src.stride[p], src_row >> plane.row_shift,
+                      dst.plane[p], dst.stride[p], row_begin, row_end, scratch_[0]);
+        }
+    }
+
+private:
+    struct Scratch {
+        std::vector<uint8_t> row;
+        std::vector<uint32_t> sums;
+    };
+
+    void AddPlane(uint32_t src_height, uint32_t dst_height, uint32_t row_bytes, uint32_t row_shift = 0) {
+        PlaneLayout plane;
+        plane.src_height = src_height;
+        plane.dst_height = dst_height;
+        plane.row_shift = row_shift;
+        plane.row_bytes = row_bytes;
+        planes_.push_back(std::move(plane));
+    }
+
+    void AddComponent(uint32_t offset, uint32_t step, uint32_t channels, uint32_t channel_step,
+                      uint32_t src_width, uint32_t dst_width) {
+        Component comp;
+        comp.offset = offset;
+        comp.step = step;
+        comp.channels = channels;
+        comp.channel_step = channel_step;
+        comp.src_width = src_width;
+        comp.dst_width = dst_width;
+        planes_.back().components.push_back(std::move(comp));
+    }
+
+    void BuildColumns(PlaneLayout& plane) const {
+        uint32_t out_bytes = 0;
+        for (const auto& comp : plane.components) {
+            uint32_t last = comp.offset + (comp.dst_width - 1) * comp.step + (comp.channels - 1) * comp.channel_step;
+            out_bytes = std::max(out_bytes, last + 1);
+        }
+
+        plane.out_bytes = out_bytes;
+        plane.col_src.assign(out_bytes, 0);
+        plane.col_next.assign(out_bytes, 0);
+        plane.col_weight.assign(out_bytes, 0);
+        plane.col_count.assign(out_bytes, 1);
+        plane.col_taps = 0;
+        if (method_ == ScaleMethod::AREA) {
+            for (const auto& comp : plane.components) {
+                for (const auto& t : comp.taps) {
+                    plane.col_taps = std::max(plane.col_taps, t.i1 - t.i0);
+                }
+            }
+        }
+        plane.col_box.assign(static_cast<size_t>(plane.col_taps) * out_bytes, plane.row_bytes);
+
+        for (const auto& comp : plane.components) {
+            for (uint32_t x = 0; x < comp.dst_width; ++x) {
+                const Tap& t = comp.taps[x];
+                for (uint32_t c = 0; c < comp.channels; ++c) {
+                    uint32_t k = comp.offset + c * comp.channel_step;
+                    uint32_t o = x * comp.step + k;
+                    plane.col_src[o] = t.i0 * comp.step + k;
+                    plane.col_next[o] = t.i1 * comp.step + k;
+                    plane.col_weight[o] = static_cast<uint16_t>(t.weight);
+                    if (method_ != ScaleMethod::AREA) {
+                        continue;
+                    }
+                    plane.col_count[o] = t.i1 - t.i0;
+                    for (uint32_t sx = t.i0; sx < t.i1; ++sx) {
+                        plane.col_box[static_cast<size_t>(sx - t.i0) * out_bytes + o] = sx * comp.step + k;
+                    }
+                }
+            }
+        }
+    }
+
+    // Plane rows [begin, end); `src` starts at source row `src_first`, `dst` at row `begin`
+    void ScaleRows(const PlaneLayout& plane, const uint8_t* src, uint32_t src_stride, uint32_t src_first,
+                   uint8_t* dst, uint32_t dst_stride, uint32_t begin, uint32_t end, Scratch& scratch) {
+        const size_t row_bytes = plane.row_bytes;
+        if (method_ == ScaleMethod::AREA) {
+            scratch.sums.resize(row_bytes + 1);    // Zero past the row for short boxes
+        } else {
+            scratch.row.resize(row_bytes);
+        }
+
+        for (uint32_t y = begin; y < end; ++y) {
+            const Tap& ty = plane.row_taps[y];
+            uint8_t* out = dst + static_cast<size_t>(y - begin) * dst_stride;
+
+            if (method_ == ScaleMethod::AREA) {
+                std::fill(scratch.sums.begin(), scratch.sums.end(), 0u);
+                for (uint32_t sy = ty.i0; sy < ty.i1; ++sy) {
+                    AccumulateRow(src + static_cast<size_t>(sy - src_first) * src_stride, scratch.sums.data(), row_bytes);
+                }
+                AverageColumns(scratch.sums.data(), plane.col_box.data(), plane.col_taps,
+                               plane.col_count.data(), ty.i1 - ty.i0, out, plane.out_bytes);
+                continue;
+            }
+
+            // Rows that need no blending are read straight from the source
+            const uint8_t* row = src + static_cast<size_t>(ty.i0 - src_first) * src_stride;
+            if (method_ == ScaleMethod::BILINEAR && ty.weight != 0) {
+                InterpolateRow(row, src + static_cast<size_t>(ty.i1 - src_first) * src_stride, ty.weight,
+                               scratch.row.data(), row_bytes);
+                row = scratch.row.data();
+            }
+
+            if (method_ == ScaleMethod::NEAREST) {
+                PickColumns(row, plane.col_src.data(), out, plane.out_bytes);
+            } else {
+                BlendColumns(row, plane.col_src.data(), plane.col_next.data(), plane.col_weight.data(),
+                             out, plane.out_bytes);
+            }
+        }
+    }
+
+    bool configured_{false};
+    PixelFormat format_{PixelFormat::UNKNOWN};
+    ScaleMethod method_{ScaleMethod::BILINEAR};
+    uint32_t src_width_{0};
+    uint32_t src_height_{0};
+    uint32_t dst_width_{0};
+    uint32_t dst_height_{0};
+    std::vector<PlaneLayout> planes_;
+    std::vector<Scratch> scratch_;
+};
+
+/**
+ * @brief Scale as a fusable row stage, with its own scaler and scratch rows
+ */
+class Scale::Stage : public RowStage {
+public:
+    explicit Stage(const Scale* block) : block_(block) {}
+
+    bool Configure(const FrameInfo& input) override {
+        if (!block_->SupportsFormat(input.pixel_format)) {
+            return false;
+        }
+        output_ = block_->DeriveOutputFormat(input);
+        identity_ = output_.width == input.width && output_.height == input.height;
+        return identity_ || scaler_.Configure(input.pixel_format, input.width, input.height,
+                                              output_.width, output_.height, block_->method_);
+    }
+
+    const FrameInfo& GetOutputFormat() const override { return output_; }
+
+    void GetInputRows(uint32_t begin, uint32_t end, uint32_t& first, uint32_t& last) const override {
+        if (identity_) {
+            first = begin;
+            last = end;
+        } else {
+            scaler_.GetInputRows(begin, end, first, last);
+        }
+    }
+
+    bool View(const FramePlanes& src, uint32_t src_row, FramePlanes& out, uint32_t& out_row) const override {
+        if (!identity_) {
+            return false;
+        }
+        out = src;
+        out_row = src_row;
+        return true;
+    }
+
+    void Run(const FramePlanes& src, uint32_t src_row, const MutableFramePlanes& dst,
+             uint32_t begin, uint32_t end) override {
+        scaler_.RunRows(src, src_row, dst, begin, end);
+    }
+
+private:
+    const Scale* block_;
+    Scaler scaler_;
+    FrameInfo output_;
+    bool identity_{false};
+};
+
+Scale::Scale()
+    : BaseVideoProcessor("Scale", "Scale")
+    , scaler_(std::make_unique<Scaler>()) {
+    output_format_ = DeriveOutputFormat(input_format_);
+}
+
+Scale::~Scale() {
+    Shutdown();
+}
+
+bool Scale::SupportsFormat(PixelFormat format) const {
+    return PackedBytesPerPixel(format) != 0;
+}
+
+std::vector<PixelFormat> Scale::GetSupportedFormats() const {
+    return {
+        PixelFormat::RGB24,
+        PixelFormat::BGR24,
+        PixelFormat::RGBA32,
+        PixelFormat::BGRA32,
+        PixelFormat::YUV420P,
+        PixelFormat::NV12,
+        PixelFormat::NV21,
+        PixelFormat::YUYV,
+        PixelFormat::UYVY
+    };
+}
+
+bool Scale::Initialize(const BlockParams& params) {
+    if (!BaseVideoProcessor::Initialize(params)) {
+        return false;
+    }
+
+    uint32_t width = target_width_;
+    uint32_t height = target_height_;
+
+    auto width_str = BaseBlock::GetParameter("width");
+    if (!width_str.empty()) {
+        width = std::stoul(width_str);
+    }
+
+    auto height_str = BaseBlock::GetParameter("height");
+    if (!height_str.empty()) {
+        height = std::stoul(height_str);
+    }
+
+    if (!SetTargetSize(width, height)) {
+        return false;
+    }
+
+    auto method_str = BaseBlock::GetParameter("method");
+    if (!method_str.empty()) {
+        if (method_str == "nearest") method_ = ScaleMethod::NEAREST;
+        else if (method_str == "bilinear") method_ = ScaleMethod::BILINEAR;
+        else if (method_str == "area") method_ = ScaleMethod::AREA;
+        else {
+            VP_LOG_WARNING_F("Unknown scale method '{}', using bilinear", method_str);
+        }
+    }
+
+    auto threads_str = BaseBlock::GetParameter("threads");
+    if (!threads_str.empty()) {
+        thread_count_ = std::max<size_t>(1, std::stoul(threads_str));
+    }
+
+    // The worker thread scales one band itself; the pool takes the rest
+    if (thread_count_ > 1) {
+        thread_pool_ = std::make_unique<ThreadPool>(thread_count_ - 1);
+    }
+
+    VP_LOG_INFO_F("Scale initialized: target={}x{}, method={}, threads={}",
+                  target_width_, target_height_, static_cast<int>(method_), thread_count_);
+    return true;
+}
+
+bool Scale::Shutdown() {
+    bool ok = BaseVideoProcessor::Shutdown();
+    thread_pool_.reset();
+    return ok;
+}
+
+std::unique_ptr<RowStage> Scale::CreateRowStage() const {
+    return std::make_unique<Stage>(this);
+}
+
+bool Scale::SetTargetSize(uint32_t width, uint32_t height) {
+    if (width > 16384 || height > 16384) {
+        SetError("Invalid scale target size: " + std::to_string(width) + "x" + std::to_string(height));
+        return false;
+    }
+
+    if (BaseBlock::GetState() == BlockState::RUNNING) {
+        SetError("Cannot change scale target size while running");
+        return false;
+    }
+
+    target_width_ = width;
+    target_height_ = height;
+    output_format_ = DeriveOutputFormat(input_format_);
+    return true;
+}
+
+bool Scale::SetMethod(ScaleMethod method) {
+    if (BaseBlock::GetState() == BlockState::RUNNING) {
+        SetError("Cannot change scale method while running");
+        return false;
+    }
+
+    method_ = method;
+    return true;
+}
+
+FrameInfo Scale::DeriveOutputFormat(const FrameInfo& input) const {
+    FrameInfo output = input;
+    uint32_t width = target_width_;
+    uint32_t height = target_height_;
+
+    // A single given dimension keeps the input aspect ratio
+    if (input.width > 0 && input.height > 0) {
+        if (width == 0 && height != 0) {
+            width = static_cast<uint32_t>(static_cast<uint64_t>(height) * input.width / input.height);
+        } else if (height == 0 && width != 0) {
+            height = static_cast<uint32_t>(static_cast<uint64_t>(width) * input.height / input.width);
+        }
+    }
+    if (width == 0) width = input.width;
+    if (height == 0) height = input.height;
+
+    // Subsampled chroma needs even dimensions
+    switch (input.pixel_format) {
+        case PixelFormat::YUV420P:
+        case PixelFormat::NV12:
+        case PixelFormat::NV21:
+            height = std::max<uint32_t>(2, height & ~1u);
+            width = std::max<uint32_t>(2, width & ~1u);
+            break;
+        case PixelFormat::YUYV:
+        case PixelFormat::UYVY:
+            width = std::max<uint32_t>(2, width & ~1u);
+            break;
+        default:
+            break;
+    }
+
+    output.width = width;
+    output.height = height;
+    output.stride = width * PackedBytesPerPixel(input.pixel_format);
+    output.is_hardware_buffer = false;
+    output.hw_handle = nullptr;
+    return output;
+}
+
+bool Scale::ProcessFrameImpl(VideoFramePtr frame) {
+    if (!frame || !frame->IsValid()) {
+        VP_LOG_WARNING_F("Scale '{}' received invalid frame", GetName());
+        return false;
+    }
+
+    const auto& in_info = frame->GetFrameInfo();
+    if (!SupportsFormat(in_info.pixel_format)) {
+        VP_LOG_WARNING_F("Scale '{}' unsupported input: {}", GetName(), in_info.ToString());
+        return false;
+    }
+
+    FrameInfo out_info = DeriveOutputFormat(in_info);
+    if (out_info.width == in_info.width && out_info.height == in_info.height) {
+        EmitFrame(std::move(frame));
+        return true;
+    }
+
+    FramePlanes src;
+    if (!ResolvePlanes(static_cast<const IVideoFrame&>(*frame), src)) {
+        VP_LOG_WARNING_F("Scale '{}' cannot access input planes: {}", GetName(), in_info.ToString());
+        return false;
+    }
+
+    if (!scaler_->Configure(in_info.pixel_format, in_info.width, in_info.height,
+                            out_info.width, out_info.height, method_)) {
+        VP_LOG_WARNING_F("Scale '{}' cannot scale {} to {}x{}", GetName(), in_info.ToString(),
+                         out_info.width, out_info.height);
+        return false;
+    }
+
+    auto output = AcquireOutputFrame(out_info);
+    MutableFramePlanes dst;
+    if (!output || !ResolvePlanes(*output, dst)) {
+        VP_LOG_WARNING_F("Scale '{}' failed to allocate output frame", GetName());
+        return false;
+    }
+
+    scaler_->Run(src, dst, thread_count_, thread_pool_.get());
+    EmitFrame(std::move(output));
+    return true;
+}
+
+} // namespace video_pipeline
@@ -0,0 +1,385 @@
+#include "blocks/shm_ring.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace video_pipeline {
+
+namespace {
+
+size_t PageSize() {
+    long page = ::sysconf(_SC_PAGESIZE);
+    return page > 0 ? static_cast<size_t>(page) : 4096;
+}
+
+inline size_t RoundUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// Process-shared futex (no FUTEX_PRIVATE_FLAG): the word lives in the memfd
+void FutexWait(std::atomic<uint32_t>& word, uint32_t expected, int timeout_ms) {
+    timespec timeout{timeout_ms / 1000, (timeout_ms % 1000) * 1000000L};
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+}
+
+void FutexWakeAll(std::atomic<uint32_t>& word) {
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+bool ProcessExists(int32_t pid) {
+    return pid > 0 && (::kill(pid, 0) == 0 || errno == EPERM);
+}
+
+size_t ControlSize(uint32_t slot_count) {
+    return RoundUp(sizeof(shm::RingHeader) + slot_count * sizeof(shm::SlotHeader), PageSize());
+}
+
+} // anonymous namespace
+
+std::shared_ptr<ShmRing> ShmRing::Create(uint32_t slot_count, size_t slot_size, std::string& error) {
+    if (slot_count < 2 || slot_count > shm::kMaxSlots || slot_size == 0) {
+        error = "ring needs 2-" + std::to_string(shm::kMaxSlots) + " slots of non-zero size";
+        return nullptr;
+    }
+
+    std::shared_ptr<ShmRing> ring(new ShmRing());
+    ring->writer_ = true;
+
+    slot_size = RoundUp(slot_size, PageSize());
+    size_t control_size = ControlSize(slot_count);
+    size_t total_size = control_size + slot_count * slot_size;
+
+    ring->fd_ = ::memfd_create("video_pipeline_ring", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (ring->fd_ < 0 || ::ftruncate(ring->fd_, static_cast<off_t>(total_size)) < 0) {
+        error = std::string("memfd: ") + std::strerror(errno);
+        return nullptr;
+    }
+    // Readers can neither shrink the file under the writer nor grow it
+    ::fcntl(ring->fd_, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+
+    if (!ring->Map(control_size, total_size, error)) {
+        return nullptr;
+    }
+
+    auto* header = new (ring->control_) shm::RingHeader();
+    header->slot_count = slot_count;
+    header->writer_pid = static_cast<int32_t>(::getpid());
+    header->slot_size = slot_size;
+    header->data_offset = control_size;
+    header->total_size = total_size;
+    for (uint32_t i = 0; i < slot_count; ++i) {
+        new (&ring->slots_[i]) shm::SlotHeader();
+    }
+    return ring;
+}
+
+std::shared_ptr<ShmRing> ShmRing::Attach(int fd, std::string& error) {
+    std::shared_ptr<ShmRing> ring(new ShmRing());
+    ring->fd_ = fd;
+
+    struct stat st{};
+    if (::fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(shm::RingHeader)) {
+        error = "not a frame ring";
+        return nullptr;
+    }
+
+    // Validate the header before trusting any size in it
+    alignas(shm::RingHeader) unsigned char raw[sizeof(shm::RingHeader)];
+    if (::pread(fd, raw, sizeof(raw), 0) != static_cast<ssize_t>(sizeof(raw))) {
+        error = std::string("read: ") + std::strerror(errno);
+        return nullptr;
+    }
+    const auto& h = *reinterpret_cast<const shm::RingHeader*>(raw);
+    if (h.magic != shm::kMagic || h.version != shm::kVersion) {
+        error = "ring magic/version mismatch";
+        return nullptr;
+    }
+    if (h.slot_count < 2 || h.slot_count > shm::kMaxSlots || h.data_offset != ControlSize(h.slot_count) ||
+        h.slot_size == 0 || h.slot_size % PageSize() != 0 ||
+        h.total_size != h.data_offset + h.slot_count * h.slot_size ||
+        h.total_size != static_cast<size_t>(st.st_size)) {
+        error = "ring geometry is inconsistent";
+        return nullptr;
+    }
+
+    if (!ring->Map(h.data_offset, h.total_size, error)) {
+        return nullptr;
+    }
+    return ring;
+}
+
+bool ShmRing::Map(size_t control_size, size_t total_size, std::string& error) {
+    control_size_ = control_size;
+    data_size_ = total_size - control_size;
+
+    control_ = ::mmap(nullptr, control_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (control_ == MAP_FAILED) {
+        control_ = nullptr;
+        error = std::string("mmap: ") + std::strerror(errno);
+        return false;
+    }
+
+    // Readers only see payloads read-only, so one reader cannot corrupt another's frames
+    int protection = writer_ ? (PROT_READ | PROT_WRITE) : PROT_READ;
+    data_ = ::mmap(nullptr, data_size_, protection, MAP_SHARED, fd_, static_cast<off_t>(control_size_));
+    if (data_ == MAP_FAILED) {
+        data_ = nullptr;
+        error = std::string("mmap: ") + std::strerror(errno);
+        return false;
+    }
+
+    header_ = static_cast<shm::RingHeader*>(control_);
+    slots_ = reinterpret_cast<shm::SlotHeader*>(static_cast<uint8_t*>(control_) + sizeof(shm::RingHeader));
+    return true;
+}
+
+ShmRing::~ShmRing() {
+    if (header_) {
+        if (writer_) {
+            CloseWriter();
+        } else if (reader_index_ >= 0) {
+            // Every frame from this mapping is gone; drop any stale bits and leave
+            uint64_t bit = 1ull << reader_index_;
+            for (uint32_t i = 0; i < header_->slot_count; ++i) {
+                slots_[i].state.fetch_and(~bit, std::memory_order_release);
+            }
+            header_->readers[reader_index_].pid.store(0, std::memory_order_release);
+            header_->release_seq.fetch_add(1);
+            if (header_->writer_waiting.load()) {
+                FutexWakeAll(header_->release_seq);
+            }
+        }
+    }
+
+    if (data_) {
+        ::munmap(data_, data_size_);
+    }
+    if (control_) {
+        ::munmap(control_, control_size_);
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+int ShmRing::TryAcquireWriteSlot() {
+    // Frames newer than this are still unread by some blocking reader
+    uint64_t oldest_needed = UINT64_MAX;
+    for (const auto& reader : header_->readers) {
+        if (reader.pid.load(std::memory_order_acquire) != 0 &&
+            reader.policy.load(std::memory_order_relaxed) == static_cast<uint32_t>(ShmReaderPolicy::BLOCK)) {
+            oldest_needed = std::min(oldest_needed, reader.read_seq.load(std::memory_order_acquire));
+        }
+    }
+
+    for (int attempt = 0; attempt < 4; ++attempt) {
+        int best = -1;
+        uint64_t best_seq = UINT64_MAX;
+        for (uint32_t i = 0; i < header_->slot_count; ++i) {
+            if (slots_[i].state.load(std::memory_order_relaxed) != 0) {
+                continue;
+            }
+            uint64_t seq = slots_[i].sequence.load(std::memory_order_relaxed);
+            if (seq > oldest_needed && seq != 0) {
+                continue;
+            }
+            if (best < 0 || seq < best_seq) {
+                best = static_cast<int>(i);
+                best_seq = seq;
+            }
+        }
+        if (best < 0) {
+            return -1;
+        }
+
+        uint64_t expected = 0;
+        if (slots_[best].state.compare_exchange_strong(expected, shm::kWriting, std::memory_order_acquire)) {
+            return best;
+        }
+    }
+    return -1;
+}
+
+int ShmRing::AcquireWriteSlot(int timeout_ms) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+
+    while (true) {
+        int slot = TryAcquireWriteSlot();
+        if (slot >= 0) {
+            return slot;
+        }
+
+        // Announce the wait before sampling the counter so a release cannot slip in between
+        header_->writer_waiting.store(1);
+        uint32_t seen = header_->release_seq.load();
+        slot = TryAcquireWriteSlot();
+        if (slot >= 0) {
+            header_->writer_waiting.store(0);
+            return slot;
+        }
+
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0) {
+            header_->writer_waiting.store(0);
+            return ReapDeadReaders() > 0 ? TryAcquireWriteSlot() : -1;
+        }
+
+        FutexWait(header_->release_seq, seen, static_cast<int>(std::min<long long>(remaining, 100)));
+        header_->writer_waiting.store(0);
+
+        // Nobody released anything: maybe a reader died while holding slots
+        if (header_->release_seq.load() == seen) {
+            ReapDeadReaders();
+        }
+    }
+}
+
+uint8_t* ShmRing::GetWritableSlot(int slot) {
+    return static_cast<uint8_t*>(data_) + static_cast<size_t>(slot) * header_->slot_size;
+}
+
+void ShmRing::Publish(int slot, const shm::FrameMeta& meta) {
+    uint64_t sequence = header_->published.load(std::memory_order_relaxed) + 1;
+
+    slots_[slot].meta = meta;
+    slots_[slot].sequence.store(sequence, std::memory_order_relaxed);
+    slots_[slot].state.store(0, std::memory_order_release);
+    header_->published.store(sequence, std::memory_order_release);
+
+    header_->write_seq.fetch_add(1);
+    if (header_->readers_waiting.load()) {
+        FutexWakeAll(header_->write_seq);
+    }
+}
+
+uint32_t ShmRing::ReapDeadReaders() {
+    uint32_t reaped = 0;
+    for (uint32_t r = 0; r < shm::kMaxReaders; ++r) {
+        int32_t pid = header_->readers[r].pid.load(std::memory_order_acquire);
+        if (pid == 0 || ProcessExists(pid)) {
+            continue;
+        }
+
+        uint64_t bit = 1ull << r;
+        for (uint32_t i = 0; i < header_->slot_count; ++i) {
+            slots_[i].state.fetch_and(~bit, std::memory_order_release);
+        }
+        header_->readers[r].pid.store(0, std::memory_order_release);
+        ++reaped;
+    }
+    return reaped;
+}
+
+void ShmRing::CloseWriter() {
+    if (header_->closed.exchange(1) == 0) {
+        header_->write_seq.fetch_add(1);
+        FutexWakeAll(header_->write_seq);
+    }
+}
+
+bool ShmRing::RegisterReader(ShmReaderPolicy policy) {
+    int32_t pid = static_cast<int32_t>(::getpid());
+    for (uint32_t r = 0; r < shm::kMaxReaders; ++r) {
+        auto& reader = header_->readers[r];
+        int32_t expected = 0;
+        if (!reader.pid.compare_exchange_strong(expected, pid)) {
+            continue;
+        }
+
+        // Start with the next frame; older ones are not waited for
+        last_read_seq_ = header_->published.load(std::memory_order_acquire);
+        reader.read_seq.store(last_read_seq_, std::memory_order_release);
+        reader.policy.store(static_cast<uint32_t>(policy), std::memory_order_release);
+        reader_index_ = static_cast<int>(r);
+        return true;
+    }
+    return false;
+}
+
+int ShmRing::AcquireReadSlot(uint64_t& skipped) {
+    skipped = 0;
+    if (reader_index_ < 0) {
+        return -1;
+    }
+
+    bool newest = header_->readers[reader_index_].policy.load(std::memory_order_relaxed) ==
+                  static_cast<uint32_t>(ShmReaderPolicy::LATEST);
+    uint64_t bit = 1ull << reader_index_;
+
+    for (int attempt = 0; attempt < 4; ++attempt) {
+        int best = -1;
+        uint64_t best_seq = 0;
+        for (uint32_t i = 0; i < header_->slot_count; ++i) {
+            uint64_t seq = slots_[i].sequence.load(std::memory_order_acquire);
+            if (seq <= last_read_seq_) {
+                continue;
+            }
+            if (best < 0 || (newest ? seq > best_seq : seq < best_seq)) {
+                best = static_cast<int>(i);
+                best_seq = seq;
+            }
+        }
+        if (best < 0) {
+            return -1;
+        }
+
+        // Take a hold unless the writer is refilling the slot right now
+        auto& state = slots_[best].state;
+        uint64_t current = state.load(std::memory_order_relaxed);
+        bool held = false;
+        while (!(current & shm::kWriting)) {
+            if (state.compare_exchange_weak(current, current | bit, std::memory_order_acquire)) {
+                held = true;
+                break;
+            }
+        }
+        if (!held) {
+            continue;
+        }
+        if (slots_[best].sequence.load(std::memory_order_relaxed) != best_seq) {
+            ReleaseReadSlot(best);
+            continue;
+        }
+
+        skipped = best_seq - last_read_seq_ - 1;
+        last_read_seq_ = best_seq;
+        header_->readers[reader_index_].read_seq.store(best_seq, std::memory_order_release);
+        return best;
+    }
+    return -1;
+}
+
+void ShmRing::ReleaseReadSlot(int slot) {
+    slots_[slot].state.fetch_and(~(1ull << reader_index_), std::memory_order_release);
+    header_->release_seq.fetch_add(1);
+    if (header_->writer_waiting.load()) {
+        FutexWakeAll(header_->release_seq);
+    }
+}
+
+const uint8_t* ShmRing::GetReadableSlot(int slot) const {
+    return static_cast<const uint8_t*>(data_) + static_cast<size_t>(slot) * header_->slot_size;
+}
+
+void ShmRing::WaitForFrame(uint32_t seen_write_seq, int timeout_ms) {
+    header_->readers_waiting.fetch_add(1);
+    FutexWait(header_->write_seq, seen_write_seq, timeout_ms);
+    header_->readers_waiting.fetch_sub(1);
+}
+
+bool ShmRing::IsWriterAlive() const {
+    return header_->closed.load() == 0 && ProcessExists(header_->writer_pid);
+}
+
+} // namespace video_pipeline
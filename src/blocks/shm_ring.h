@@ -0,0 +1,156 @@
+#pragma once
+
+#include "video_pipeline/blocks/shm_sink.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <sys/types.h>
+
+/**
+ * @file shm_ring.h
+ * @brief Shared-memory frame ring used by ShmSink and ShmSource
+ *
+ * One writer process owns a memfd holding a RingHeader, `slot_count`
+ * SlotHeaders and the slot payloads (page aligned). Readers receive the memfd
+ * over a Unix socket, map the headers read-write and the payloads read-only.
+ *
+ * Each slot has one 64-bit state word: bit 63 is set while the writer fills
+ * the slot, bits 0..kMaxReaders-1 are set while the corresponding reader
+ * holds it. The writer only claims a slot whose word is 0 and a reader only
+ * sets its bit while bit 63 is clear, both with a CAS, so a payload is never
+ * read while it is being written. Slot sequences only grow; readers pick the
+ * next slot by sequence according to their policy.
+ *
+ * Notification uses process-shared futexes on two counters: `write_seq` is
+ * bumped after every publish, `release_seq` whenever a reader gives a slot
+ * back. Liveness is checked through the pids stored in the header, so a
+ * crashed reader's slots are reclaimed and readers notice a dead writer.
+ * Both processes must share a pid namespace.
+ */
+
+namespace video_pipeline {
+namespace shm {
+
+constexpr uint32_t kMagic = 0x52535056;  // "VPSR"
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kMaxReaders = 32;
+constexpr uint32_t kMaxSlots = 64;
+constexpr uint64_t kWriting = 1ull << 63;
+
+// Sent by the writer with the memfd attached when a reader connects
+struct Hello {
+    uint32_t magic{kMagic};
+    uint32_t version{kVersion};
+};
+
+struct FrameMeta {
+    uint32_t width{0};
+    uint32_t height{0};
+    uint32_t stride{0};
+    uint32_t pixel_format{0};
+    uint64_t size{0};               // Payload bytes
+    uint64_t timestamp_us{0};
+    uint64_t frame_sequence{0};     // FrameInfo::sequence_number of the writer
+};
+
+struct alignas(64) ReaderState {
+    std::atomic<int32_t> pid{0};            // 0 = free entry
+    std::atomic<uint32_t> policy{0};
+    std::atomic<uint64_t> read_seq{0};      // Sequence of the last frame taken
+};
+
+struct alignas(64) SlotHeader {
+    std::atomic<uint64_t> state{0};         // Reader bits | kWriting
+    std::atomic<uint64_t> sequence{0};      // Ring sequence of the payload, 0 = empty
+    FrameMeta meta;
+};
+
+struct alignas(64) RingHeader {
+    uint32_t magic{kMagic};
+    uint32_t version{kVersion};
+    uint32_t slot_count{0};
+    int32_t writer_pid{0};
+    uint64_t slot_size{0};                  // Payload bytes per slot (page multiple)
+    uint64_t data_offset{0};                // Offset of slot 0's payload (page aligned)
+    uint64_t total_size{0};
+    std::atomic<uint32_t> closed{0};        // Set by the writer on shutdown
+
+    // Futex words; the *_waiting counts let the other side skip the wake syscall
+    alignas(64) std::atomic<uint32_t> write_seq{0};
+    std::atomic<uint32_t> readers_waiting{0};
+    std::atomic<uint64_t> published{0};     // Sequence of the newest frame
+    alignas(64) std::atomic<uint32_t> release_seq{0};
+    std::atomic<uint32_t> writer_waiting{0};
+
+    ReaderState readers[kMaxReaders];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "Shared ring needs address-free atomics");
+
+} // namespace shm
+
+/**
+ * @brief A process' mapping of a frame ring
+ *
+ * Shared by ShmSink/ShmSource and every frame a reader emits, so the mapping
+ * outlives the block as long as downstream holds frames from it.
+ */
+class ShmRing {
+public:
+    // Writer: new memfd-backed ring, or nullptr (error set)
+    static std::shared_ptr<ShmRing> Create(uint32_t slot_count, size_t slot_size, std::string& error);
+    // Reader: maps a ring received from the writer; takes ownership of fd
+    static std::shared_ptr<ShmRing> Attach(int fd, std::string& error);
+
+    ~ShmRing();
+    ShmRing(const ShmRing&) = delete;
+    ShmRing& operator=(const ShmRing&) = delete;
+
+    int GetFd() const { return fd_; }
+    const shm::RingHeader& GetHeader() const { return *header_; }
+    uint32_t GetSlotCount() const { return header_->slot_count; }
+    size_t GetSlotSize() const { return header_->slot_size; }
+
+    // --- Writer ---
+    // Claims the free slot holding the oldest frame that no blocking reader
+    // still needs, waiting up to timeout_ms for readers to release one.
+    // Returns -1 if none became free.
+    int AcquireWriteSlot(int timeout_ms);
+    uint8_t* GetWritableSlot(int slot);
+    void Publish(int slot, const shm::FrameMeta& meta);
+    // Frees the entries and slots of readers whose process is gone; returns how many
+    uint32_t ReapDeadReaders();
+    void CloseWriter();
+
+    // --- Reader ---
+    bool RegisterReader(ShmReaderPolicy policy);
+    // Holds the next slot to read; `skipped` counts frames missed since the last one
+    int AcquireReadSlot(uint64_t& skipped);
+    void ReleaseReadSlot(int slot);
+    const uint8_t* GetReadableSlot(int slot) const;
+    const shm::FrameMeta& GetMeta(int slot) const { return slots_[slot].meta; }
+    // Sleeps until the writer publishes or timeout_ms passes
+    void WaitForFrame(uint32_t seen_write_seq, int timeout_ms);
+    // False once the writer closed the ring or its process died
+    bool IsWriterAlive() const;
+
+private:
+    ShmRing() = default;
+    bool Map(size_t control_size, size_t total_size, std::string& error);
+    int TryAcquireWriteSlot();
+
+    int fd_{-1};
+    bool writer_{false};
+    int reader_index_{-1};
+    uint64_t last_read_seq_{0};
+    void* control_{nullptr};            // Header + slot headers, read-write
+    size_t control_size_{0};
+    void* data_{nullptr};               // Payloads; read-only for readers
+    size_t data_size_{0};
+    shm::RingHeader* header_{nullptr};
+    shm::SlotHeader* slots_{nullptr};
+};
+
+} // namespace video_pipeline
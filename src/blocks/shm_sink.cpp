@@ -0,0 +1,236 @@
+#include "video_pipeline/blocks/shm_sink.h"
+#include "video_pipeline/logger.h"
+#include "blocks/shm_ring.h"
+#include "utils/frame_planes.h"
+#include "utils/unix_socket.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace video_pipeline {
+
+namespace {
+
+constexpr int kPollTimeoutMs = 100;
+
+} // anonymous namespace
+
+ShmSink::ShmSink()
+    : BaseVideoSink("ShmSink", "ShmSink") {}
+
+ShmSink::~ShmSink() {
+    Stop();
+    CloseListener();
+}
+
+bool ShmSink::SupportsFormat(PixelFormat format) const {
+    return format != PixelFormat::UNKNOWN;
+}
+
+std::vector<PixelFormat> ShmSink::GetSupportedFormats() const {
+    return {
+        PixelFormat::RGB24, PixelFormat::BGR24, PixelFormat::RGBA32, PixelFormat::BGRA32,
+        PixelFormat::YUV420P, PixelFormat::NV12,  PixelFormat::NV21,  PixelFormat::YUYV,
+        PixelFormat::UYVY,  PixelFormat::MJPEG, PixelFormat::QOI};
+}
+
+bool ShmSink::Initialize(const BlockParams& params) {
+    if (!BaseVideoSink::Initialize(params)) {
+        return false;
+    }
+
+    auto path = BaseBlock::GetParameter("path");
+    if (!path.empty()) {
+        path_ = path;
+    }
+
+    auto slots_str = BaseBlock::GetParameter("slots");
+    if (!slots_str.empty()) {
+        slot_count_ = std::clamp<uint32_t>(std::stoul(slots_str), 2, shm::kMaxSlots);
+    }
+
+    auto slot_size_str = BaseBlock::GetParameter("slot_size");
+    if (!slot_size_str.empty()) {
+        slot_size_ = std::stoull(slot_size_str);
+    }
+
+    auto timeout_str = BaseBlock::GetParameter("timeout_ms");
+    if (!timeout_str.empty()) {
+        timeout_ms_ = std::max(0, std::stoi(timeout_str));
+    }
+
+    VP_LOG_INFO_F("ShmSink initialized: path={}, slots={}, slot_size={}, timeout={}ms",
+                  path_, slot_count_, slot_size_, timeout_ms_);
+    return true;
+}
+
+bool ShmSink::Start() {
+    std::string error;
+    listen_fd_ = ListenUnixSocket(path_, error);
+    if (listen_fd_ < 0) {
+        SetError("ShmSink failed to listen on " + path_ + ": " + error);
+        return false;
+    }
+
+    // Without a slot size the ring is sized by the first frame
+    size_t frame_size = std::max(slot_size_, input_format_.GetFrameSize());
+    if (frame_size > 0 && !CreateRing(frame_size)) {
+        CloseListener();
+        return false;
+    }
+
+    stop_acceptor_.store(false);
+    acceptor_thread_ = std::thread(&ShmSink::AcceptorThread, this);
+
+    if (!BaseVideoSink::Start()) {
+        Stop();
+        return false;
+    }
+    return true;
+}
+
+bool ShmSink::Stop() {
+    bool ok = BaseVideoSink::Stop();
+
+    stop_acceptor_.store(true);
+    if (acceptor_thread_.joinable()) {
+        acceptor_thread_.join();
+    }
+    CloseListener();
+
+    // Readers see the ring closed; their frames keep the mapping alive
+    std::lock_guard<std::mutex> lock(ring_mutex_);
+    ring_.reset();
+    return ok;
+}
+
+bool ShmSink::Shutdown() {
+    Stop();
+    return BaseVideoSink::Shutdown();
+}
+
+bool ShmSink::CreateRing(size_t frame_size) {
+    std::string error;
+    auto ring = ShmRing::Create(slot_count_, frame_size, error);
+    if (!ring) {
+        SetError("ShmSink failed to create frame ring: " + error);
+        return false;
+    }
+
+    VP_LOG_INFO_F("ShmSink '{}' ring ready: {} slots of {} bytes", GetName(), ring->GetSlotCount(), ring->GetSlotSize());
+    std::lock_guard<std::mutex> lock(ring_mutex_);
+    ring_ = std::move(ring);
+    return true;
+}
+
+std::shared_ptr<ShmRing> ShmSink::GetRing() const {
+    std::lock_guard<std::mutex> lock(ring_mutex_);
+    return ring_;
+}
+
+void ShmSink::CloseListener() {
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        UnlinkUnixSocket(path_);
+    }
+}
+
+void ShmSink::AcceptorThread() {
+    VP_LOG_DEBUG_F("ShmSink '{}' acceptor thread started", GetName());
+    ApplyThreadSettings();
+
+    while (!stop_acceptor_.load()) {
+        pollfd pfd{listen_fd_, POLLIN, 0};
+        if (::poll(&pfd, 1, kPollTimeoutMs) <= 0) {
+            continue;
+        }
+
+        // Readers retry until the ring exists, so leave them queued until then
+        auto ring = GetRing();
+        if (!ring) {
+            continue;
+        }
+
+        int conn_fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (conn_fd < 0) {
+            VP_LOG_WARNING_F("ShmSink '{}' accept failed: {}", GetName(), std::strerror(errno));
+            continue;
+        }
+
+        // The socket only carries the memfd; frames never touch it
+        shm::Hello hello;
+        int ring_fd = ring->GetFd();
+        if (SendWithFds(conn_fd, &hello, sizeof(hello), &ring_fd, 1)) {
+            VP_LOG_INFO_F("ShmSink '{}' reader connected", GetName());
+        } else {
+            VP_LOG_WARNING_F("ShmSink '{}' failed to hand over the ring: {}", GetName(), std::strerror(errno));
+        }
+        ::close(conn_fd);
+    }
+
+    VP_LOG_DEBUG_F("ShmSink '{}' acceptor thread stopped", GetName());
+}
+
+bool ShmSink::ProcessFrameImpl(VideoFramePtr frame) {
+    if (!frame || !frame->IsValid()) {
+        VP_LOG_WARNING_F("ShmSink '{}' received invalid frame", GetName());
+        return false;
+    }
+
+    const FrameInfo& info = frame->GetFrameInfo();
+    const bool compressed = IsCompressedFormat(info.pixel_format);
+    const size_t size = compressed ? frame->GetSize() : info.GetFrameSize();
+
+    auto ring = GetRing();
+    if (!ring) {
+        if (!CreateRing(std::max(slot_size_, size))) {
+            return false;
+        }
+        ring = GetRing();
+    }
+
+    if (size > ring->GetSlotSize()) {
+        VP_LOG_WARNING_F("ShmSink '{}' frame of {} bytes exceeds slot size {}; set slot_size",
+                         GetName(), size, ring->GetSlotSize());
+        return false;
+    }
+
+    FramePlanes src;
+    if (!compressed && !ResolvePlanes(*frame, src)) {
+        VP_LOG_WARNING_F("ShmSink '{}' cannot read {} frame", GetName(), info.ToString());
+        return false;
+    }
+
+    int slot = ring->AcquireWriteSlot(timeout_ms_);
+    if (slot < 0) {
+        VP_LOG_DEBUG_F("ShmSink '{}' no free slot, dropping frame", GetName());
+        return false;
+    }
+
+    // Slots are always packed, whatever the frame's stride
+    uint8_t* dst = ring->GetWritableSlot(slot);
+    MutableFramePlanes packed;
+    if (compressed) {
+        std::memcpy(dst, frame->GetData(), size);
+    } else {
+        PackedPlanes(info, dst, packed);
+        CopyPlanes(src, packed);
+    }
+
+    shm::FrameMeta meta;
+    meta.width = info.width;
+    meta.height = info.height;
+    meta.stride = compressed ? info.stride : packed.stride[0];
+    meta.pixel_format = static_cast<uint32_t>(info.pixel_format);
+    meta.size = size;
+    meta.timestamp_us = info.timestamp_us;
+    meta.frame_sequence = info.sequence_number;
+    ring->Publish(slot, meta);
+    return true;
+}
+
+} // namespace video_pipeline
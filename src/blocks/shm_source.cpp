@@ -0,0 +1,292 @@
+#include "video_pipeline/blocks/shm_source.h"
+#include "video_pipeline/logger.h"
+#include "blocks/shm_ring.h"
+#include "utils/frame_planes.h"
+#include "utils/unix_socket.h"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <poll.h>
+#include <unistd.h>
+
+namespace video_pipeline {
+
+namespace {
+
+constexpr int kPollTimeoutMs = 100;
+
+/**
+ * @brief Frame whose pixels stay in a ring slot; the slot is released with the last reference
+ */
+class ShmFrame : public IVideoFrame {
+public:
+    ShmFrame(std::shared_ptr<ShmRing> ring, int slot)
+        : ring_(std::move(ring))
+        , slot_(slot) {
+        const auto& meta = ring_->GetMeta(slot_);
+        frame_info_.width = meta.width;
+        frame_info_.height = meta.height;
+        frame_info_.stride = meta.stride;
+        frame_info_.pixel_format = static_cast<PixelFormat>(meta.pixel_format);
+        frame_info_.timestamp_us = meta.timestamp_us;
+        frame_info_.sequence_number = meta.frame_sequence;
+        size_ = meta.size;
+
+        data_ = const_cast<uint8_t*>(ring_->GetReadableSlot(slot_));
+        if (!IsCompressedFormat(frame_info_.pixel_format)) {
+            PackedPlanes(frame_info_, data_, planes_);
+        }
+    }
+
+    // IBuffer implementation; the memory is mapped read-only
+    void* GetData() override { return data_; }
+    const void* GetData() const override { return data_; }
+    size_t GetSize() const override { return size_; }
+    size_t GetCapacity() const override { return ring_->GetSlotSize(); }
+    bool SetSize(size_t size) override { return size == size_; }
+
+    const FrameInfo& GetFrameInfo() const override { return frame_info_; }
+    void SetFrameInfo(const FrameInfo& info) override {
+        frame_info_.timestamp_us = info.timestamp_us;
+        frame_info_.sequence_number = info.sequence_number;
+        frame_info_.change = info.change;
+    }
+
+    bool IsValid() const override { return data_ != nullptr && size_ <= ring_->GetSlotSize(); }
+    void Reset() override {}
+
+    // IVideoFrame implementation
+    void* GetPlaneData(int plane) override {
+        if (planes_.count == 0) return (plane == 0) ? data_ : nullptr;
+        return (plane >= 0 && plane < planes_.count) ? planes_.plane[plane] : nullptr;
+    }
+    const void* GetPlaneData(int plane) const override {
+        return const_cast<ShmFrame*>(this)->GetPlaneData(plane);
+    }
+    size_t GetPlaneSize(int plane) const override {
+        if (planes_.count == 0) return (plane == 0) ? size_ : 0;
+        if (plane < 0 || plane >= planes_.count) return 0;
+        return static_cast<size_t>(PlaneRowBytes(planes_, plane)) * PlaneRows(planes_, plane);
+    }
+    uint32_t GetPlaneStride(int plane) const override {
+        if (planes_.count == 0) return (plane == 0) ? frame_info_.stride : 0;
+        return (plane >= 0 && plane < planes_.count) ? planes_.stride[plane] : 0;
+    }
+    int GetPlaneCount() const override { return planes_.count ? planes_.count : 1; }
+
+    // Shared with the writer and other readers: never written
+    bool CopyFrom(const IVideoFrame& /*other*/) override { return false; }
+    bool CanWriteInPlace() const override { return false; }
+
+    BufferPtr Clone() const override {
+        auto clone = CreateVideoFrame(frame_info_, IsCompressedFormat(frame_info_.pixel_format) ? size_ : 0);
+        if (!clone) {
+            return nullptr;
+        }
+        if (IsCompressedFormat(frame_info_.pixel_format)) {
+            std::memcpy(clone->GetData(), data_, size_);
+            clone->SetSize(size_);
+        } else if (!clone->CopyFrom(*this)) {
+            return nullptr;
+        }
+        return clone;
+    }
+
+protected:
+    // Last reference dropped: hand the slot back to the writer
+    void Recycle() override {
+        ring_->ReleaseReadSlot(slot_);
+        delete this;
+    }
+
+private:
+    std::shared_ptr<ShmRing> ring_;
+    int slot_;
+    uint8_t* data_{nullptr};
+    size_t size_{0};
+    FrameInfo frame_info_{};
+    MutableFramePlanes planes_;
+};
+
+} // anonymous namespace
+
+ShmSource::ShmSource()
+    : BaseVideoSource("ShmSource", "ShmSource") {
+    // Frames arrive at the writer's pace; `fps` can still cap the output rate
+    SetFrameRate(1000.0);
+}
+
+ShmSource::~ShmSource() {
+    Stop();
+    Shutdown();
+}
+
+bool ShmSource::SetOutputFormat(const FrameInfo& format) {
+    if (BaseBlock::GetState() == BlockState::RUNNING) {
+        SetError("Cannot change output format while running");
+        return false;
+    }
+
+    output_format_ = format;
+    return true;
+}
+
+bool ShmSource::SupportsFormat(PixelFormat format) const {
+    return format != PixelFormat::UNKNOWN;
+}
+
+std::vector<PixelFormat> ShmSource::GetSupportedFormats() const {
+    return {
+        PixelFormat::RGB24, PixelFormat::BGR24, PixelFormat::RGBA32, PixelFormat::BGRA32,
+        PixelFormat::YUV420P, PixelFormat::NV12,  PixelFormat::NV21,  PixelFormat::YUYV,
+        PixelFormat::UYVY,  PixelFormat::MJPEG, PixelFormat::QOI};
+}
+
+bool ShmSource::Initialize(const BlockParams& params) {
+    if (!BaseVideoSource::Initialize(params)) {
+        return false;
+    }
+
+    auto path = BaseBlock::GetParameter("path");
+    if (!path.empty()) {
+        path_ = path;
+    }
+
+    auto policy_str = BaseBlock::GetParameter("policy");
+    if (!policy_str.empty()) {
+        if (policy_str == "latest") policy_ = ShmReaderPolicy::LATEST;
+        else if (policy_str == "queue") policy_ = ShmReaderPolicy::QUEUE;
+        else if (policy_str == "block") policy_ = ShmReaderPolicy::BLOCK;
+        else {
+            VP_LOG_WARNING_F("ShmSource '{}' unknown policy '{}', using latest", GetName(), policy_str);
+        }
+    }
+
+    VP_LOG_INFO_F("ShmSource initialized: path={}, policy={}", path_, policy_str.empty() ? "latest" : policy_str);
+    return true;
+}
+
+bool ShmSource::Start() {
+    if (BaseBlock::GetState() == BlockState::RUNNING) {
+        return true;
+    }
+
+    if (BaseBlock::GetState() != BlockState::INITIALIZED && BaseBlock::GetState() != BlockState::STOPPED) {
+        SetError("Cannot start from state: " + BaseBlock::GetStateString());
+        return false;
+    }
+
+    SetState(BlockState::STARTING);
+
+    stop_reader_.store(false);
+    reader_thread_ = std::thread(&ShmSource::ReaderThread, this);
+
+    SetState(BlockState::RUNNING);
+    VP_LOG_INFO_F("ShmSource '{}' reading from {}", BaseBlock::GetName(), path_);
+    return true;
+}
+
+bool ShmSource::Stop() {
+    if (BaseBlock::GetState() != BlockState::RUNNING) {
+        return true;
+    }
+
+    SetState(BlockState::STOPPING);
+
+    stop_reader_.store(true);
+    if (reader_thread_.joinable()) {
+        reader_thread_.join();
+    }
+    ring_.reset();
+
+    SetState(BlockState::STOPPED);
+    VP_LOG_INFO_F("ShmSource '{}' stopped", BaseBlock::GetName());
+    return true;
+}
+
+bool ShmSource::Shutdown() {
+    Stop();
+    return true;
+}
+
+bool ShmSource::Connect() {
+    int socket_fd = ConnectUnixSocket(path_);
+    if (socket_fd < 0) {
+        return false;
+    }
+
+    // The writer answers with a hello and the ring's memfd, then hangs up
+    shm::Hello hello{0, 0};
+    int fd = -1;
+    size_t fd_count = 0;
+    ssize_t n = -1;
+    pollfd pfd{socket_fd, POLLIN, 0};
+    if (::poll(&pfd, 1, 1000) > 0) {
+        n = ReceiveWithFds(socket_fd, &hello, sizeof(hello), &fd, 1, fd_count);
+    }
+    ::close(socket_fd);
+
+    if (n != static_cast<ssize_t>(sizeof(hello)) || fd_count != 1 ||
+        hello.magic != shm::kMagic || hello.version != shm::kVersion) {
+        VP_LOG_WARNING_F("ShmSource '{}' unexpected handshake on {}", GetName(), path_);
+        if (fd_count == 1) {
+            ::close(fd);
+        }
+        return false;
+    }
+
+    std::string error;
+    auto ring = ShmRing::Attach(fd, error);
+    if (!ring) {
+        VP_LOG_WARNING_F("ShmSource '{}' cannot map frame ring: {}", GetName(), error);
+        return false;
+    }
+    if (!ring->RegisterReader(policy_)) {
+        VP_LOG_WARNING_F("ShmSource '{}' frame ring has no free reader entry", GetName());
+        return false;
+    }
+
+    ring_ = std::move(ring);
+    VP_LOG_INFO_F("ShmSource '{}' connected to {} ({} slots)", GetName(), path_, ring_->GetSlotCount());
+    return true;
+}
+
+void ShmSource::ReaderThread() {
+    VP_LOG_DEBUG_F("ShmSource '{}' reader thread started", BaseBlock::GetName());
+    BaseBlock::ApplyThreadSettings();
+
+    while (!stop_reader_.load()) {
+        if (!ring_) {
+            if (!Connect()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(kPollTimeoutMs));
+            }
+            continue;
+        }
+
+        // Sample the counter before looking so a publish in between ends the wait at once
+        uint32_t seen = ring_->GetHeader().write_seq.load();
+
+        uint64_t skipped = 0;
+        int slot = ring_->AcquireReadSlot(skipped);
+        if (skipped > 0) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.frames_dropped += skipped;
+        }
+        if (slot >= 0) {
+            EmitFrame(MakeRef<ShmFrame>(ring_, slot));
+            continue;
+        }
+
+        if (!ring_->IsWriterAlive()) {
+            VP_LOG_INFO_F("ShmSource '{}' writer went away", BaseBlock::GetName());
+            ring_.reset();
+            continue;
+        }
+
+        ring_->WaitForFrame(seen, kPollTimeoutMs);
+    }
+
+    VP_LOG_DEBUG_F("ShmSource '{}' reader thread stopped", BaseBlock::GetName());
+}
+
+} // namespace video_pipeline
@@ -1,5 +1,9 @@
 #include "video_pipeline/blocks/tcp_sink.h"
 #include "video_pipeline/logger.h"
+#include "blocks/delta_protocol.h"
+#include "utils/frame_planes.h"
+#include "utils/simd.h"
+#include <algorithm>
 #include <arpa/inet.h>
 #include <cerrno>
 #include <cstring>
@@ -58,7 +62,32 @@ bool TcpSink::Initialize(const BlockParams& params) {
         reconnect_ = (reconnect_str == "true" || reconnect_str == "1");
     }
 
-    VP_LOG_INFO_F("TcpSink initialized: host={}, port={}, reconnect={}", host_, port_, reconnect_);
+    auto mode_str = BaseBlock::GetParameter("mode");
+    if (!mode_str.empty()) {
+        if (mode_str == "raw") mode_ = TcpTransportMode::RAW;
+        else if (mode_str == "delta") mode_ = TcpTransportMode::DELTA;
+        else {
+            VP_LOG_WARNING_F("TcpSink '{}' unknown mode '{}', using raw", GetName(), mode_str);
+        }
+    }
+
+    auto keyframe_str = BaseBlock::GetParameter("keyframe_interval");
+    if (!keyframe_str.empty()) {
+        keyframe_interval_ = std::stoul(keyframe_str);
+    }
+
+    auto tile_width_str = BaseBlock::GetParameter("tile_width");
+    if (!tile_width_str.empty()) {
+        tile_width_ = std::clamp<uint32_t>(std::stoul(tile_width_str), 16, 4096);
+    }
+
+    auto tile_height_str = BaseBlock::GetParameter("tile_height");
+    if (!tile_height_str.empty()) {
+        tile_height_ = std::clamp<uint32_t>(std::stoul(tile_height_str), 1, 4096);
+    }
+
+    VP_LOG_INFO_F("TcpSink initialized: host={}, port={}, reconnect={}, mode={}",
+                  host_, port_, reconnect_, mode_ == TcpTransportMode::DELTA ? "delta" : "raw");
     return true;
 }
 
@@ -87,23 +116,20 @@ bool TcpSink::ProcessFrameImpl(VideoFramePtr frame) {
         return false;
     }
 
-    const uint8_t* data = static_cast<const uint8_t*>(frame->GetData());
-    size_t size = frame->GetSize();
-
     if (socket_fd_ < 0) {
         if (!reconnect_ || !Connect()) {
             return false;
         }
     }
 
-    if (!SendAll(data, size)) {
+    if (!SendFrame(*frame)) {
         if (reconnect_) {
             VP_LOG_WARNING_F("TcpSink '{}' reconnecting after send failure", GetName());
             CloseSocket();
             if (!Connect()) {
                 return false;
             }
-            return SendAll(data, size);
+            return SendFrame(*frame);
         }
         return false;
     }
@@ -111,6 +137,131 @@ bool TcpSink::ProcessFrameImpl(VideoFramePtr frame) {
     return true;
 }
 
+bool TcpSink::SendFrame(const IVideoFrame& frame) {
+    if (mode_ == TcpTransportMode::RAW) {
+        size_t size = 0;
+        size_t row_bytes = 0;
+        const uint8_t* data = ContiguousData(frame, size, row_bytes);
+        return SendAll(data, size);
+    }
+
+    BuildDeltaMessage(frame);
+    if (!SendAll(message_.data(), message_.size())) {
+        // The receiver's state is unknown now; resynchronize with a keyframe
+        force_keyframe_ = true;
+        return false;
+    }
+    return true;
+}
+
+void TcpSink::BuildDeltaMessage(const IVideoFrame& frame) {
+    using namespace delta;
+
+    const auto& info = frame.GetFrameInfo();
+    size_t size = 0;
+    size_t row_bytes = 0;
+    const uint8_t* data = ContiguousData(frame, size, row_bytes);
+
+    TileGrid grid;
+    grid.Init(size, row_bytes, tile_width_, tile_height_);
+
+    bool keyframe = force_keyframe_ ||
+                    IsCompressedFormat(info.pixel_format) ||
+                    size != reference_.size() ||
+                    info.width != reference_info_.width ||
+                    info.height != reference_info_.height ||
+                    info.pixel_format != reference_info_.pixel_format ||
+                    (keyframe_interval_ > 0 && frames_since_keyframe_ + 1 >= keyframe_interval_);
+
+    size_t changed_bytes = 0;
+    if (!keyframe) {
+        changed_tiles_.clear();
+        for (size_t t = 0; t < grid.TileCount(); ++t) {
+            bool changed = false;
+            grid.ForEachRow(t, [&](size_t offset, size_t len) {
+                if (!changed && !simd::BytesEqual(data + offset, reference_.data() + offset, len)) {
+                    changed = true;
+                }
+            });
+            if (changed) {
+                changed_tiles_.push_back(static_cast<uint32_t>(t));
+                changed_bytes += grid.TileBytes(t) + sizeof(uint32_t);
+            }
+        }
+        // A mostly-changed frame is cheaper to send whole
+        keyframe = changed_bytes >= size;
+    }
+
+    MessageHeader header;
+    header.type = static_cast<uint8_t>(keyframe ? MessageType::KEYFRAME : MessageType::DELTA);
+    header.pixel_format = static_cast<uint8_t>(info.pixel_format);
+    header.width = info.width;
+    header.height = info.height;
+    header.frame_size = static_cast<uint32_t>(size);
+    header.row_bytes = static_cast<uint32_t>(grid.row_bytes);
+    header.tile_width = static_cast<uint16_t>(grid.tile_width);
+    header.tile_height = static_cast<uint16_t>(grid.tile_height);
+    header.sequence_number = info.sequence_number;
+    header.timestamp_us = info.timestamp_us;
+
+    if (keyframe) {
+        header.payload_size = static_cast<uint32_t>(size);
+        message_.resize(sizeof(header) + size);
+        std::memcpy(message_.data() + sizeof(header), data, size);
+
+        reference_.assign(data, data + size);
+        reference_info_ = info;
+        force_keyframe_ = false;
+        frames_since_keyframe_ = 0;
+        keyframes_sent_++;
+    } else {
+        header.tile_count = static_cast<uint32_t>(changed_tiles_.size());
+        header.payload_size = static_cast<uint32_t>(changed_bytes);
+        message_.resize(sizeof(header) + changed_bytes);
+
+        uint8_t* out = message_.data() + sizeof(header);
+        for (uint32_t t : changed_tiles_) {
+            std::memcpy(out, &t, sizeof(t));
+            out += sizeof(t);
+            grid.ForEachRow(t, [&](size_t offset, size_t len) {
+                std::memcpy(out, data + offset, len);
+                std::memcpy(reference_.data() + offset, data + offset, len);
+                out += len;
+            });
+        }
+        frames_since_keyframe_++;
+    }
+
+    std::memcpy(message_.data(), &header, sizeof(header));
+    bytes_sent_ += message_.size();
+
+    VP_LOG_DEBUG_F("TcpSink '{}' {} seq={} tiles={}/{} bytes={}", GetName(),
+                   keyframe ? "keyframe" : "delta", info.sequence_number,
+                   keyframe ? grid.TileCount() : changed_tiles_.size(), grid.TileCount(), message_.size());
+}
+
+const uint8_t* TcpSink::ContiguousData(const IVideoFrame& frame, size_t& size, size_t& row_bytes) {
+    const uint8_t* data = static_cast<const uint8_t*>(frame.GetData());
+    size = frame.GetSize();
+
+    // Compressed payloads are a single row
+    FramePlanes planes;
+    if (IsCompressedFormat(frame.GetFrameInfo().pixel_format) || !ResolvePlanes(frame, planes)) {
+        row_bytes = size;
+        return data;
+    }
+
+    row_bytes = PlaneRowBytes(planes, 0);
+    if (IsContiguous(planes)) {
+        return data;
+    }
+
+    packed_.resize(frame.GetFrameInfo().GetFrameSize());
+    PackPlanes(planes, packed_.data());
+    size = packed_.size();
+    return packed_.data();
+}
+
 bool TcpSink::Connect() {
     CloseSocket();
 
@@ -142,6 +293,9 @@ bool TcpSink::Connect() {
         return false;
     }
 
+    // A new connection has no reference frame
+    force_keyframe_ = true;
+
     VP_LOG_INFO_F("TcpSink '{}' connected to {}:{}", GetName(), host_, port_);
     return true;
 }
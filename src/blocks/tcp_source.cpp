@@ -0,0 +1,379 @@
+#include "video_pipeline/blocks/tcp_source.h"
+#include "video_pipeline/logger.h"
+#include "blocks/delta_protocol.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace video_pipeline {
+
+namespace {
+
+constexpr int kPollTimeoutMs = 100;
+constexpr uint32_t kMaxFrameSize = 256u * 1024 * 1024;
+
+} // anonymous namespace
+
+TcpSource::TcpSource()
+    : BaseVideoSource("TcpSource", "TcpSource") {
+    // Frames arrive at the sender's pace; `fps` can still cap the output rate
+    SetFrameRate(1000.0);
+}
+
+TcpSource::~TcpSource() {
+    Stop();
+    Shutdown();
+}
+
+bool TcpSource::SetOutputFormat(const FrameInfo& format) {
+    if (BaseBlock::GetState() == BlockState::RUNNING) {
+        SetError("Cannot change output format while running");
+        return false;
+    }
+
+    output_format_ = format;
+    return true;
+}
+
+bool TcpSource::SupportsFormat(PixelFormat format) const {
+    return format != PixelFormat::UNKNOWN;
+}
+
+std::vector<PixelFormat> TcpSource::GetSupportedFormats() const {
+    return {
+        PixelFormat::RGB24, PixelFormat::BGR24, PixelFormat::RGBA32, PixelFormat::BGRA32,
+        PixelFormat::YUV420P, PixelFormat::NV12,  PixelFormat::NV21,  PixelFormat::YUYV,
+        PixelFormat::UYVY};
+}
+
+bool TcpSource::Initialize(const BlockParams& params) {
+    if (!BaseVideoSource::Initialize(params)) {
+        return false;
+    }
+
+    auto bind_str = BaseBlock::GetParameter("bind");
+    if (!bind_str.empty()) {
+        bind_address_ = bind_str;
+    }
+
+    auto port_str = BaseBlock::GetParameter("port");
+    if (!port_str.empty()) {
+        try {
+            int port_val = std::stoi(port_str);
+            if (port_val > 0 && port_val <= 65535) {
+                port_ = static_cast<uint16_t>(port_val);
+            } else {
+                VP_LOG_WARNING_F("TcpSource '{}' invalid port '{}', keeping default {}", GetName(), port_str, port_);
+            }
+        } catch (const std::exception&) {
+            VP_LOG_WARNING_F("TcpSource '{}' failed to parse port '{}', keeping default {}", GetName(), port_str, port_);
+        }
+    }
+
+    auto mode_str = BaseBlock::GetParameter("mode");
+    if (!mode_str.empty()) {
+        if (mode_str == "raw") mode_ = TcpTransportMode::RAW;
+        else if (mode_str == "delta") mode_ = TcpTransportMode::DELTA;
+        else {
+            VP_LOG_WARNING_F("TcpSource '{}' unknown mode '{}', using raw", GetName(), mode_str);
+        }
+    }
+
+    VP_LOG_INFO_F("TcpSource initialized: bind={}, port={}, mode={}",
+                  bind_address_, port_, mode_ == TcpTransportMode::DELTA ? "delta" : "raw");
+    return true;
+}
+
+bool TcpSource::Start() {
+    if (BaseBlock::GetState() == BlockState::RUNNING) {
+        return true;
+    }
+
+    if (BaseBlock::GetState() != BlockState::INITIALIZED && BaseBlock::GetState() != BlockState::STOPPED) {
+        SetError("Cannot start from state: " + BaseBlock::GetStateString());
+        return false;
+    }
+
+    SetState(BlockState::STARTING);
+
+    if (!Listen()) {
+        SetState(BlockState::ERROR);
+        return false;
+    }
+
+    stop_receiver_.store(false);
+    receiver_thread_ = std::thread(&TcpSource::ReceiverThread, this);
+
+    SetState(BlockState::RUNNING);
+    VP_LOG_INFO_F("TcpSource '{}' listening on {}:{}", BaseBlock::GetName(), bind_address_, port_);
+    return true;
+}
+
+bool TcpSource::Stop() {
+    if (BaseBlock::GetState() != BlockState::RUNNING) {
+        return true;
+    }
+
+    SetState(BlockState::STOPPING);
+
+    stop_receiver_.store(true);
+    if (receiver_thread_.joinable()) {
+        receiver_thread_.join();
+    }
+    CloseSockets();
+
+    SetState(BlockState::STOPPED);
+    VP_LOG_INFO_F("TcpSource '{}' stopped", BaseBlock::GetName());
+    return true;
+}
+
+bool TcpSource::Shutdown() {
+    Stop();
+    current_.reset();
+    return true;
+}
+
+bool TcpSource::Listen() {
+    CloseSockets();
+
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+        SetError("TcpSource failed to create socket: " + std::string(std::strerror(errno)));
+        return false;
+    }
+
+    int flag = 1;
+    ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &flag, sizeof(flag));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port_);
+    if (::inet_pton(AF_INET, bind_address_.c_str(), &addr.sin_addr) <= 0) {
+        SetError("TcpSource invalid bind address: " + bind_address_);
+        CloseSockets();
+        return false;
+    }
+
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        ::listen(listen_fd_, 1) < 0) {
+        SetError("TcpSource failed to listen: " + std::string(std::strerror(errno)));
+        CloseSockets();
+        return false;
+    }
+
+    return true;
+}
+
+void TcpSource::CloseSockets() {
+    if (conn_fd_ >= 0) {
+        ::close(conn_fd_);
+        conn_fd_ = -1;
+    }
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+    }
+}
+
+void TcpSource::ReceiverThread() {
+    VP_LOG_DEBUG_F("TcpSource '{}' receiver thread started", BaseBlock::GetName());
+    BaseBlock::ApplyThreadSettings();
+
+    while (!stop_receiver_.load()) {
+        if (conn_fd_ < 0) {
+            pollfd pfd{listen_fd_, POLLIN, 0};
+            if (::poll(&pfd, 1, kPollTimeoutMs) <= 0) {
+                continue;
+            }
+
+            conn_fd_ = ::accept(listen_fd_, nullptr, nullptr);
+            if (conn_fd_ < 0) {
+                VP_LOG_WARNING_F("TcpSource '{}' accept failed: {}", BaseBlock::GetName(), std::strerror(errno));
+                continue;
+            }
+
+            // A new sender always starts with a keyframe
+            have_keyframe_ = false;
+            VP_LOG_INFO_F("TcpSource '{}' sender connected", BaseBlock::GetName());
+            continue;
+        }
+
+        VideoFramePtr frame;
+        bool ok = (mode_ == TcpTransportMode::DELTA) ? ReceiveDeltaMessage(frame) : ReceiveRawFrame(frame);
+        if (!ok) {
+            ::close(conn_fd_);
+            conn_fd_ = -1;
+            continue;
+        }
+
+        if (frame) {
+            EmitFrame(frame);
+        }
+    }
+
+    VP_LOG_DEBUG_F("TcpSource '{}' receiver thread stopped", BaseBlock::GetName());
+}
+
+bool TcpSource::ReadExact(uint8_t* data, size_t size) {
+    size_t received = 0;
+    while (received < size) {
+        if (stop_receiver_.load()) {
+            return false;
+        }
+
+        pollfd pfd{conn_fd_, POLLIN, 0};
+        int ready = ::poll(&pfd, 1, kPollTimeoutMs);
+        if (ready < 0 && errno != EINTR) {
+            VP_LOG_WARNING_F("TcpSource '{}' poll failed: {}", BaseBlock::GetName(), std::strerror(errno));
+            return false;
+        }
+        if (ready <= 0) {
+            continue;
+        }
+
+        ssize_t n = ::recv(conn_fd_, data + received, size - received, 0);
+        if (n < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            VP_LOG_WARNING_F("TcpSource '{}' recv failed: {}", BaseBlock::GetName(), std::strerror(errno));
+            return false;
+        }
+        if (n == 0) {
+            VP_LOG_INFO_F("TcpSource '{}' sender disconnected", BaseBlock::GetName());
+            return false;
+        }
+
+        received += static_cast<size_t>(n);
+    }
+
+    bytes_received_ += size;
+    return true;
+}
+
+bool TcpSource::ReceiveRawFrame(VideoFramePtr& frame) {
+    frame = CreateVideoFrame(output_format_);
+    if (!frame) {
+        return false;
+    }
+    return ReadExact(static_cast<uint8_t*>(frame->GetData()), output_format_.GetFrameSize());
+}
+
+bool TcpSource::ReceiveDeltaMessage(VideoFramePtr& frame) {
+    using namespace delta;
+
+    MessageHeader header;
+    if (!ReadExact(reinterpret_cast<uint8_t*>(&header), sizeof(header))) {
+        return false;
+    }
+
+    if (header.magic != kMagic || header.version != kVersion ||
+        header.frame_size == 0 || header.frame_size > kMaxFrameSize ||
+        header.pixel_format > static_cast<uint8_t>(PixelFormat::QOI)) {
+        VP_LOG_WARNING_F("TcpSource '{}' invalid delta stream header; dropping connection", BaseBlock::GetName());
+        return false;
+    }
+
+    FrameInfo info;
+    info.width = header.width;
+    info.height = header.height;
+    info.pixel_format = static_cast<PixelFormat>(header.pixel_format);
+    info.stride = IsCompressedFormat(info.pixel_format) ? 0 : header.row_bytes;
+    info.sequence_number = header.sequence_number;
+    info.timestamp_us = header.timestamp_us;
+
+    if (header.type == static_cast<uint8_t>(MessageType::KEYFRAME)) {
+        if (header.payload_size != header.frame_size) {
+            VP_LOG_WARNING_F("TcpSource '{}' malformed keyframe; dropping connection", BaseBlock::GetName());
+            return false;
+        }
+
+        // Reuse the frame when nobody downstream still holds it
+        const auto* cur = current_ ? &current_->GetFrameInfo() : nullptr;
+        bool reuse = cur && current_.use_count() == 1 &&
+                     current_->GetCapacity() >= header.frame_size &&
+                     cur->width == info.width && cur->height == info.height &&
+                     cur->pixel_format == info.pixel_format;
+        if (!reuse) {
+            current_ = CreateVideoFrame(info, header.frame_size);
+            if (!current_) {
+                return false;
+            }
+        } else {
+            current_->SetFrameInfo(info);
+        }
+
+        if (!ReadExact(static_cast<uint8_t*>(current_->GetData()), header.frame_size)) {
+            return false;
+        }
+        current_->SetSize(header.frame_size);
+        have_keyframe_ = true;
+        frame = current_;
+        return true;
+    }
+
+    if (header.type != static_cast<uint8_t>(MessageType::DELTA) ||
+        header.payload_size > header.frame_size + header.tile_count * sizeof(uint32_t)) {
+        VP_LOG_WARNING_F("TcpSource '{}' malformed delta message; dropping connection", BaseBlock::GetName());
+        return false;
+    }
+
+    payload_.resize(header.payload_size);
+    if (!ReadExact(payload_.data(), payload_.size())) {
+        return false;
+    }
+
+    if (!have_keyframe_ || current_->GetSize() != header.frame_size) {
+        VP_LOG_DEBUG_F("TcpSource '{}' waiting for keyframe", BaseBlock::GetName());
+        return true;
+    }
+
+    TileGrid grid;
+    if (!grid.Init(header.frame_size, header.row_bytes, header.tile_width, header.tile_height)) {
+        VP_LOG_WARNING_F("TcpSource '{}' invalid tile geometry; dropping connection", BaseBlock::GetName());
+        return false;
+    }
+
+    // Copy-on-write: a frame still queued downstream must not change under its reader
+    if (current_.use_count() > 1) {
+        auto copy = CreateVideoFrame(current_->GetFrameInfo(), header.frame_size);
+        if (!copy) {
+            return false;
+        }
+        std::memcpy(copy->GetData(), current_->GetData(), header.frame_size);
+        copy->SetSize(header.frame_size);
+        current_ = copy;
+    }
+
+    uint8_t* dst = static_cast<uint8_t*>(current_->GetData());
+    const uint8_t* in = payload_.data();
+    const uint8_t* end = in + payload_.size();
+    for (uint32_t i = 0; i < header.tile_count; ++i) {
+        uint32_t tile;
+        if (end - in < static_cast<ptrdiff_t>(sizeof(tile))) {
+            break;
+        }
+        std::memcpy(&tile, in, sizeof(tile));
+        in += sizeof(tile);
+
+        if (tile >= grid.TileCount() || static_cast<size_t>(end - in) < grid.TileBytes(tile)) {
+            VP_LOG_WARNING_F("TcpSource '{}' corrupt tile {}; waiting for keyframe", BaseBlock::GetName(), tile);
+            have_keyframe_ = false;
+            return true;
+        }
+
+        grid.ForEachRow(tile, [&](size_t offset, size_t len) {
+            std::memcpy(dst + offset, in, len);
+            in += len;
+        });
+    }
+
+    frame = current_;
+    return true;
+}
+
+} // namespace video_pipeline
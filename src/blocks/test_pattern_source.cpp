@@ -12,6 +12,21 @@ namespace video_pipeline {
 BufferPtr CreateBuffer(size_t capacity);
 VideoFramePtr CreateVideoFrame(const FrameInfo& info);
 
+namespace {
+
+bool ParseTestPattern(const std::string& name, TestPattern& pattern) {
+    if (name == "solid") pattern = TestPattern::SOLID_COLOR;
+    else if (name == "bars") pattern = TestPattern::COLOR_BARS;
+    else if (name == "checkerboard") pattern = TestPattern::CHECKERBOARD;
+    else if (name == "gradient") pattern = TestPattern::GRADIENT;
+    else if (name == "noise") pattern = TestPattern::NOISE;
+    else if (name == "moving_box") pattern = TestPattern::MOVING_BOX;
+    else return false;
+    return true;
+}
+
+} // namespace
+
 TestPatternSource::TestPatternSource() 
     : BaseVideoSource("TestPatternSource", "TestPatternSource") {
     // Set default format
@@ -109,12 +124,7 @@ bool TestPatternSource::Initialize(const BlockParams& params) {
     // Parse test pattern specific parameters
     auto pattern_str = BaseBlock::GetParameter("pattern");
     if (!pattern_str.empty()) {
-        if (pattern_str == "solid") test_pattern_ = TestPattern::SOLID_COLOR;
-        else if (pattern_str == "bars") test_pattern_ = TestPattern::COLOR_BARS;
-        else if (pattern_str == "checkerboard") test_pattern_ = TestPattern::CHECKERBOARD;
-        else if (pattern_str == "gradient") test_pattern_ = TestPattern::GRADIENT;
-        else if (pattern_str == "noise") test_pattern_ = TestPattern::NOISE;
-        else if (pattern_str == "moving_box") test_pattern_ = TestPattern::MOVING_BOX;
+        ParseTestPattern(pattern_str, test_pattern_);
     }
     
     auto color_str = BaseBlock::GetParameter("color");
@@ -157,10 +167,8 @@ bool TestPatternSource::Start() {
     
     SetState(BlockState::STARTING);
     
-    // Start generator thread
-    stop_generator_.store(false);
     frame_counter_ = 0;
-    generator_thread_ = std::thread(&TestPatternSource::GeneratorThread, this);
+    StartProducer();
     
     SetState(BlockState::RUNNING);
     VP_LOG_INFO_F("TestPatternSource '{}' started", BaseBlock::GetName());
@@ -174,11 +182,7 @@ bool TestPatternSource::Stop() {
     
     SetState(BlockState::STOPPING);
     
-    // Stop generator thread
-    stop_generator_.store(true);
-    if (generator_thread_.joinable()) {
-        generator_thread_.join();
-    }
+    StopProducer();
     
     SetState(BlockState::STOPPED);
     VP_LOG_INFO_F("TestPatternSource '{}' stopped", BaseBlock::GetName());
@@ -190,6 +194,24 @@ bool TestPatternSource::Shutdown() {
     return true;
 }
 
+bool TestPatternSource::IsHotParameter(const std::string& key) const {
+    return key == "pattern" || BaseVideoSource::IsHotParameter(key);
+}
+
+void TestPatternSource::ApplyParameter(const std::string& key, const std::string& value) {
+    if (key != "pattern") {
+        BaseVideoSource::ApplyParameter(key, value);
+        return;
+    }
+    
+    TestPattern pattern;
+    if (ParseTestPattern(value, pattern)) {
+        SetTestPattern(pattern);
+    } else {
+        VP_LOG_WARNING_F("TestPatternSource '{}': unknown pattern '{}'", GetName(), value);
+    }
+}
+
 bool TestPatternSource::SetTestPattern(TestPattern pattern) {
     test_pattern_ = pattern;
     VP_LOG_DEBUG_F("TestPatternSource test pattern set to: {}", static_cast<int>(pattern));
@@ -208,32 +230,22 @@ void TestPatternSource::GetColor(uint8_t& r, uint8_t& g, uint8_t& b) const {
     b = color_b_;
 }
 
-void TestPatternSource::GeneratorThread() {
-    VP_LOG_DEBUG_F("TestPatternSource '{}' generator thread started", BaseBlock::GetName());
-    
-    while (!stop_generator_.load()) {
-        if (!ShouldEmitFrame()) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
-            continue;
-        }
-        
-        // Create frame buffer
-        auto frame = CreateVideoFrame(output_format_);
-        if (!frame) {
-            VP_LOG_ERROR("Failed to create video frame");
-            break;
-        }
-        
-        // Generate test pattern
-        GenerateFrame(frame);
-        
-        // Emit frame
-        EmitFrame(frame);
-        
-        frame_counter_++;
+bool TestPatternSource::ProduceFrame() {
+    // Create frame buffer; over a frame pool quota this slot is skipped
+    auto frame = AllocateFrame(output_format_);
+    if (!frame) {
+        last_frame_time_ = std::chrono::steady_clock::now();
+        return true;
     }
     
-    VP_LOG_DEBUG_F("TestPatternSource '{}' generator thread stopped", BaseBlock::GetName());
+    // Generate test pattern
+    GenerateFrame(frame);
+    
+    // Emit frame
+    EmitFrame(std::move(frame));
+    
+    frame_counter_++;
+    return true;
 }
 
 void TestPatternSource::GenerateFrame(VideoFramePtr frame) {
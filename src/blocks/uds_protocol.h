@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file uds_protocol.h
+ * @brief Messages exchanged by UdsSink and UdsSource
+ *
+ * Both directions use SOCK_SEQPACKET, one message per packet. A FRAME message
+ * carries the fd of the memory holding the frame (memfd or dmabuf) as
+ * SCM_RIGHTS ancillary data; the receiver maps it and sends RELEASE with the
+ * same id once it no longer needs the frame, so the sender can reuse the
+ * buffer. Plane offsets are relative to the start of the fd.
+ */
+
+namespace video_pipeline {
+namespace uds {
+
+constexpr uint32_t kMagic = 0x46445056;  // "VPDF"
+constexpr uint8_t kVersion = 1;
+
+enum class MessageType : uint8_t {
+    FRAME = 0,
+    RELEASE = 1
+};
+
+struct FrameMessage {
+    uint32_t magic{kMagic};
+    uint8_t version{kVersion};
+    uint8_t type{static_cast<uint8_t>(MessageType::FRAME)};
+    uint8_t pixel_format{0};
+    uint8_t plane_count{0};         // 0 for compressed payloads
+    uint32_t width{0};
+    uint32_t height{0};
+    uint64_t id{0};
+    uint64_t size{0};               // Payload bytes (compressed) or FrameInfo::GetFrameSize()
+    uint64_t offset[3]{};
+    uint32_t stride[3]{};
+    uint32_t reserved{0};
+    uint64_t timestamp_us{0};
+    uint64_t sequence_number{0};
+};
+
+struct ReleaseMessage {
+    uint32_t magic{kMagic};
+    uint8_t version{kVersion};
+    uint8_t type{static_cast<uint8_t>(MessageType::RELEASE)};
+    uint16_t reserved{0};
+    uint64_t id{0};
+};
+
+static_assert(sizeof(FrameMessage) == 88, "FrameMessage layout is part of the protocol");
+static_assert(sizeof(ReleaseMessage) == 16, "ReleaseMessage layout is part of the protocol");
+
+} // namespace uds
+} // namespace video_pipeline
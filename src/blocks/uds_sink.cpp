@@ -0,0 +1,333 @@
+#include "video_pipeline/blocks/uds_sink.h"
+#include "video_pipeline/logger.h"
+#include "blocks/uds_protocol.h"
+#include "utils/frame_planes.h"
+#include "utils/unix_socket.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace video_pipeline {
+
+namespace {
+
+constexpr int kPollTimeoutMs = 100;
+
+} // anonymous namespace
+
+UdsSink::UdsSink()
+    : BaseVideoSink("UdsSink", "UdsSink") {}
+
+UdsSink::~UdsSink() {
+    Stop();
+    CloseAll();
+}
+
+bool UdsSink::SupportsFormat(PixelFormat format) const {
+    return format != PixelFormat::UNKNOWN;
+}
+
+std::vector<PixelFormat> UdsSink::GetSupportedFormats() const {
+    return {
+        PixelFormat::RGB24, PixelFormat::BGR24, PixelFormat::RGBA32, PixelFormat::BGRA32,
+        PixelFormat::YUV420P, PixelFormat::NV12,  PixelFormat::NV21,  PixelFormat::YUYV,
+        PixelFormat::UYVY,  PixelFormat::MJPEG, PixelFormat::QOI};
+}
+
+bool UdsSink::Initialize(const BlockParams& params) {
+    if (!BaseVideoSink::Initialize(params)) {
+        return false;
+    }
+
+    auto path = BaseBlock::GetParameter("path");
+    if (!path.empty()) {
+        path_ = path;
+    }
+
+    auto in_flight_str = BaseBlock::GetParameter("max_in_flight");
+    if (!in_flight_str.empty()) {
+        max_in_flight_ = std::clamp<uint32_t>(std::stoul(in_flight_str), 1, 64);
+    }
+
+    auto pool_str = BaseBlock::GetParameter("pool_size");
+    if (!pool_str.empty()) {
+        pool_size_ = std::clamp<size_t>(std::stoul(pool_str), 1, 64);
+    }
+
+    VP_LOG_INFO_F("UdsSink initialized: path={}, max_in_flight={}, pool_size={}",
+                  path_, max_in_flight_, pool_size_);
+    return true;
+}
+
+bool UdsSink::Start() {
+    std::string error;
+    listen_fd_ = ListenUnixSocket(path_, error);
+    if (listen_fd_ < 0) {
+        SetError("UdsSink failed to listen on " + path_ + ": " + error);
+        return false;
+    }
+
+    stop_io_.store(false);
+    io_thread_ = std::thread(&UdsSink::IoThread, this);
+
+    if (!BaseVideoSink::Start()) {
+        Stop();
+        return false;
+    }
+    return true;
+}
+
+bool UdsSink::Stop() {
+    bool ok = BaseVideoSink::Stop();
+
+    stop_io_.store(true);
+    if (io_thread_.joinable()) {
+        io_thread_.join();
+    }
+    CloseAll();
+    return ok;
+}
+
+bool UdsSink::Shutdown() {
+    Stop();
+    pool_.clear();
+    return BaseVideoSink::Shutdown();
+}
+
+size_t UdsSink::GetReceiverCount() const {
+    std::lock_guard<std::mutex> lock(io_mutex_);
+    return receivers_.size();
+}
+
+void UdsSink::CloseAll() {
+    std::lock_guard<std::mutex> lock(io_mutex_);
+    for (auto& receiver : receivers_) {
+        ::close(receiver.fd);
+    }
+    receivers_.clear();
+    // Outstanding frames go back to their owners (camera, pools)
+    in_flight_.clear();
+
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        UnlinkUnixSocket(path_);
+        VP_LOG_INFO_F("UdsSink '{}' closed ({} frames copied into shareable memory)", GetName(),
+                      frames_copied_.load());
+    }
+}
+
+void UdsSink::IoThread() {
+    VP_LOG_DEBUG_F("UdsSink '{}' I/O thread started", GetName());
+    ApplyThreadSettings();
+
+    std::vector<pollfd> fds;
+    while (!stop_io_.load()) {
+        fds.clear();
+        fds.push_back(pollfd{listen_fd_, POLLIN, 0});
+        {
+            std::lock_guard<std::mutex> lock(io_mutex_);
+            for (const auto& receiver : receivers_) {
+                fds.push_back(pollfd{receiver.fd, POLLIN, 0});
+            }
+        }
+
+        if (::poll(fds.data(), fds.size(), kPollTimeoutMs) <= 0) {
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(io_mutex_);
+        if (fds[0].revents & POLLIN) {
+            AcceptReceiver();
+        }
+
+        // Receivers may have been dropped by the worker meanwhile, so match by fd
+        for (size_t i = 1; i < fds.size(); ++i) {
+            if (!fds[i].revents) {
+                continue;
+            }
+            for (size_t r = 0; r < receivers_.size(); ++r) {
+                if (receivers_[r].fd != fds[i].fd) {
+                    continue;
+                }
+                if (!ReadReleases(receivers_[r])) {
+                    DropReceiver(r);
+                }
+                break;
+            }
+        }
+    }
+
+    VP_LOG_DEBUG_F("UdsSink '{}' I/O thread stopped", GetName());
+}
+
+void UdsSink::AcceptReceiver() {
+    int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+    if (fd < 0) {
+        VP_LOG_WARNING_F("UdsSink '{}' accept failed: {}", GetName(), std::strerror(errno));
+        return;
+    }
+
+    Receiver receiver;
+    receiver.fd = fd;
+    receivers_.push_back(std::move(receiver));
+    VP_LOG_INFO_F("UdsSink '{}' receiver connected ({} total)", GetName(), receivers_.size());
+}
+
+bool UdsSink::ReadReleases(Receiver& receiver) {
+    while (true) {
+        uds::ReleaseMessage message;
+        ssize_t n = ::recv(receiver.fd, &message, sizeof(message), MSG_DONTWAIT);
+        if (n < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        if (n == 0) {
+            VP_LOG_INFO_F("UdsSink '{}' receiver disconnected", GetName());
+            return false;
+        }
+        if (n != static_cast<ssize_t>(sizeof(message)) || message.magic != uds::kMagic ||
+            message.type != static_cast<uint8_t>(uds::MessageType::RELEASE)) {
+            VP_LOG_WARNING_F("UdsSink '{}' unexpected message from receiver", GetName());
+            return false;
+        }
+
+        if (receiver.held.erase(message.id)) {
+            ReleaseFrame(message.id);
+        }
+    }
+}
+
+void UdsSink::ReleaseFrame(uint64_t id) {
+    auto it = in_flight_.find(id);
+    if (it != in_flight_.end() && --it->second.holders == 0) {
+        in_flight_.erase(it);
+    }
+}
+
+void UdsSink::DropReceiver(size_t index) {
+    // Whatever the receiver still held is returned on its behalf
+    for (uint64_t id : receivers_[index].held) {
+        ReleaseFrame(id);
+    }
+    ::close(receivers_[index].fd);
+    receivers_.erase(receivers_.begin() + static_cast<std::ptrdiff_t>(index));
+}
+
+VideoFramePtr UdsSink::ShareableFrame(const VideoFramePtr& frame) {
+    size_t offset = 0;
+    if (frame->GetFd(offset) >= 0) {
+        return frame;
+    }
+
+    const FrameInfo& info = frame->GetFrameInfo();
+    size_t capacity = IsCompressedFormat(info.pixel_format) ? frame->GetSize() : 0;
+    size_t required = std::max(info.GetFrameSize(), capacity);
+
+    // use_count() == 1: no receiver holds the pooled frame any more
+    VideoFramePtr copy;
+    VideoFramePtr* idle_slot = nullptr;
+    for (auto& pooled : pool_) {
+        if (pooled.use_count() != 1) {
+            continue;
+        }
+        if (pooled->GetCapacity() >= required) {
+            copy = pooled;
+            break;
+        }
+        idle_slot = &pooled;
+    }
+
+    if (!copy) {
+        FrameMemoryOptions memory;
+        memory.shareable = true;
+        copy = CreateVideoFrame(info, capacity, memory);
+        if (!copy) {
+            return nullptr;
+        }
+        if (pool_.size() < pool_size_) {
+            pool_.push_back(copy);
+        } else if (idle_slot) {
+            *idle_slot = copy;
+        }
+    }
+
+    if (!copy->CopyFrom(*frame)) {
+        return nullptr;
+    }
+    frames_copied_++;
+    return copy;
+}
+
+bool UdsSink::ProcessFrameImpl(VideoFramePtr frame) {
+    if (!frame || !frame->IsValid()) {
+        VP_LOG_WARNING_F("UdsSink '{}' received invalid frame", GetName());
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(io_mutex_);
+        if (receivers_.empty()) {
+            return true;
+        }
+    }
+
+    VideoFramePtr shared = ShareableFrame(frame);
+    if (!shared) {
+        VP_LOG_WARNING_F("UdsSink '{}' cannot share {} frame", GetName(), frame->GetFrameInfo().ToString());
+        return false;
+    }
+
+    const FrameInfo& info = shared->GetFrameInfo();
+    size_t fd_offset = 0;
+    int fd = shared->GetFd(fd_offset);
+
+    uds::FrameMessage message;
+    message.pixel_format = static_cast<uint8_t>(info.pixel_format);
+    message.width = info.width;
+    message.height = info.height;
+    message.timestamp_us = info.timestamp_us;
+    message.sequence_number = info.sequence_number;
+    if (IsCompressedFormat(info.pixel_format)) {
+        message.size = shared->GetSize();
+        message.offset[0] = fd_offset;
+    } else {
+        FramePlanes planes;
+        if (!ResolvePlanes(*shared, planes)) {
+            return false;
+        }
+        message.size = info.GetFrameSize();
+        message.plane_count = static_cast<uint8_t>(planes.count);
+        for (int p = 0; p < planes.count; ++p) {
+            message.offset[p] = fd_offset + static_cast<uint64_t>(planes.plane[p] - planes.plane[0]);
+            message.stride[p] = planes.stride[p];
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(io_mutex_);
+    message.id = ++next_id_;
+
+    uint32_t holders = 0;
+    for (size_t r = receivers_.size(); r-- > 0;) {
+        auto& receiver = receivers_[r];
+        if (receiver.held.size() >= max_in_flight_) {
+            continue;   // Slow receiver: it misses this frame
+        }
+        if (SendWithFds(receiver.fd, &message, sizeof(message), &fd, 1)) {
+            receiver.held.insert(message.id);
+            holders++;
+        } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            VP_LOG_INFO_F("UdsSink '{}' dropping receiver: {}", GetName(), std::strerror(errno));
+            DropReceiver(r);
+        }
+    }
+
+    if (holders > 0) {
+        in_flight_[message.id] = InFlightFrame{std::move(shared), holders};
+    }
+    return true;
+}
+
+} // namespace video_pipeline
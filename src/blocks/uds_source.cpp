@@ -0,0 +1,401 @@
+#include "video_pipeline/blocks/uds_source.h"
+#include "video_pipeline/logger.h"
+#include "blocks/uds_protocol.h"
+#include "utils/frame_planes.h"
+#include "utils/unix_socket.h"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace video_pipeline {
+
+namespace {
+
+constexpr int kPollTimeoutMs = 100;
+
+} // anonymous namespace
+
+/**
+ * @brief Socket to the sender; frames keep it alive to send their release
+ */
+struct UdsSource::Connection {
+    explicit Connection(int socket_fd) : fd(socket_fd) {}
+    ~Connection() { ::close(fd); }
+
+    void Release(uint64_t id) {
+        uds::ReleaseMessage message;
+        message.id = id;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!closed) {
+            ::send(fd, &message, sizeof(message), MSG_NOSIGNAL);
+        }
+    }
+
+    int fd;
+    std::mutex mutex;
+    bool closed{false};
+};
+
+/**
+ * @brief Read-only mapping of one sender buffer
+ */
+struct UdsSource::Mapping {
+    ~Mapping() {
+        if (data) {
+            ::munmap(data, length);
+        }
+    }
+
+    dev_t device{0};
+    ino_t inode{0};
+    void* data{nullptr};
+    size_t length{0};
+};
+
+namespace {
+
+/**
+ * @brief Frame mapped from the sender's buffer; released back to it with the last reference
+ */
+class UdsFrame : public IVideoFrame {
+public:
+    UdsFrame(std::shared_ptr<UdsSource::Mapping> mapping, std::shared_ptr<UdsSource::Connection> connection,
+             uint64_t id, const FrameInfo& info, const MutableFramePlanes& planes, uint8_t* data, size_t size)
+        : mapping_(std::move(mapping))
+        , connection_(std::move(connection))
+        , id_(id)
+        , frame_info_(info)
+        , planes_(planes)
+        , data_(data)
+        , size_(size) {}
+
+    // IBuffer implementation; the memory is mapped read-only
+    void* GetData() override { return data_; }
+    const void* GetData() const override { return data_; }
+    size_t GetSize() const override { return size_; }
+    size_t GetCapacity() const override { return size_; }
+    bool SetSize(size_t size) override { return size == size_; }
+
+    const FrameInfo& GetFrameInfo() const override { return frame_info_; }
+    void SetFrameInfo(const FrameInfo& info) override {
+        frame_info_.timestamp_us = info.timestamp_us;
+        frame_info_.sequence_number = info.sequence_number;
+        frame_info_.change = info.change;
+    }
+
+    bool IsValid() const override { return data_ != nullptr; }
+    void Reset() override {}
+
+    // IVideoFrame implementation
+    void* GetPlaneData(int plane) override {
+        if (planes_.count == 0) return (plane == 0) ? data_ : nullptr;
+        return (plane >= 0 && plane < planes_.count) ? planes_.plane[plane] : nullptr;
+    }
+    const void* GetPlaneData(int plane) const override {
+        return const_cast<UdsFrame*>(this)->GetPlaneData(plane);
+    }
+    size_t GetPlaneSize(int plane) const override {
+        if (planes_.count == 0) return (plane == 0) ? size_ : 0;
+        if (plane < 0 || plane >= planes_.count) return 0;
+        uint32_t rows = PlaneRows(planes_, plane);
+        return rows ? static_cast<size_t>(planes_.stride[plane]) * (rows - 1) + PlaneRowBytes(planes_, plane) : 0;
+    }
+    uint32_t GetPlaneStride(int plane) const override {
+        if (planes_.count == 0) return (plane == 0) ? frame_info_.stride : 0;
+        return (plane >= 0 && plane < planes_.count) ? planes_.stride[plane] : 0;
+    }
+    int GetPlaneCount() const override { return planes_.count ? planes_.count : 1; }
+
+    // Shared with the sender: never written
+    bool CopyFrom(const IVideoFrame& /*other*/) override { return false; }
+    bool CanWriteInPlace() const override { return false; }
+
+    BufferPtr Clone() const override {
+        bool compressed = IsCompressedFormat(frame_info_.pixel_format);
+        auto clone = CreateVideoFrame(frame_info_, compressed ? size_ : 0);
+        if (!clone) {
+            return nullptr;
+        }
+        if (compressed) {
+            std::memcpy(clone->GetData(), data_, size_);
+            clone->SetSize(size_);
+        } else if (!clone->CopyFrom(*this)) {
+            return nullptr;
+        }
+        return clone;
+    }
+
+protected:
+    // Last reference dropped: the sender may reuse the buffer
+    void Recycle() override {
+        connection_->Release(id_);
+        delete this;
+    }
+
+private:
+    std::shared_ptr<UdsSource::Mapping> mapping_;
+    std::shared_ptr<UdsSource::Connection> connection_;
+    uint64_t id_;
+    FrameInfo frame_info_;
+    MutableFramePlanes planes_;
+    uint8_t* data_;
+    size_t size_;
+};
+
+} // anonymous namespace
+
+UdsSource::UdsSource()
+    : BaseVideoSource("UdsSource", "UdsSource") {
+    // Frames arrive at the sender's pace; `fps` can still cap the output rate
+    SetFrameRate(1000.0);
+}
+
+UdsSource::~UdsSource() {
+    Stop();
+    Shutdown();
+}
+
+bool UdsSource::SetOutputFormat(const FrameInfo& format) {
+    if (BaseBlock::GetState() == BlockState::RUNNING) {
+        SetError("Cannot change output format while running");
+        return false;
+    }
+
+    output_format_ = format;
+    return true;
+}
+
+bool UdsSource::SupportsFormat(PixelFormat format) const {
+    return format != PixelFormat::UNKNOWN;
+}
+
+std::vector<PixelFormat> UdsSource::GetSupportedFormats() const {
+    return {
+        PixelFormat::RGB24, PixelFormat::BGR24, PixelFormat::RGBA32, PixelFormat::BGRA32,
+        PixelFormat::YUV420P, PixelFormat::NV12,  PixelFormat::NV21,  PixelFormat::YUYV,
+        PixelFormat::UYVY,  PixelFormat::MJPEG, PixelFormat::QOI};
+}
+
+bool UdsSource::Initialize(const BlockParams& params) {
+    if (!BaseVideoSource::Initialize(params)) {
+        return false;
+    }
+
+    auto path = BaseBlock::GetParameter("path");
+    if (!path.empty()) {
+        path_ = path;
+    }
+
+    auto mappings_str = BaseBlock::GetParameter("max_mappings");
+    if (!mappings_str.empty()) {
+        max_mappings_ = std::max<size_t>(1, std::stoul(mappings_str));
+    }
+
+    VP_LOG_INFO_F("UdsSource initialized: path={}", path_);
+    return true;
+}
+
+bool UdsSource::Start() {
+    if (BaseBlock::GetState() == BlockState::RUNNING) {
+        return true;
+    }
+
+    if (BaseBlock::GetState() != BlockState::INITIALIZED && BaseBlock::GetState() != BlockState::STOPPED) {
+        SetError("Cannot start from state: " + BaseBlock::GetStateString());
+        return false;
+    }
+
+    SetState(BlockState::STARTING);
+
+    stop_receiver_.store(false);
+    receiver_thread_ = std::thread(&UdsSource::ReceiverThread, this);
+
+    SetState(BlockState::RUNNING);
+    VP_LOG_INFO_F("UdsSource '{}' receiving from {}", BaseBlock::GetName(), path_);
+    return true;
+}
+
+bool UdsSource::Stop() {
+    if (BaseBlock::GetState() != BlockState::RUNNING) {
+        return true;
+    }
+
+    SetState(BlockState::STOPPING);
+
+    stop_receiver_.store(true);
+    if (receiver_thread_.joinable()) {
+        receiver_thread_.join();
+    }
+    Disconnect();
+
+    SetState(BlockState::STOPPED);
+    VP_LOG_INFO_F("UdsSource '{}' stopped", BaseBlock::GetName());
+    return true;
+}
+
+bool UdsSource::Shutdown() {
+    Stop();
+    mappings_.clear();
+    return true;
+}
+
+bool UdsSource::Connect() {
+    int fd = ConnectUnixSocket(path_);
+    if (fd < 0) {
+        return false;
+    }
+
+    connection_ = std::make_shared<Connection>(fd);
+    VP_LOG_INFO_F("UdsSource '{}' connected to {}", GetName(), path_);
+    return true;
+}
+
+void UdsSource::Disconnect() {
+    if (!connection_) {
+        return;
+    }
+
+    // Frames still held downstream stay mapped; their releases are simply not sent
+    {
+        std::lock_guard<std::mutex> lock(connection_->mutex);
+        connection_->closed = true;
+    }
+    connection_.reset();
+    mappings_.clear();
+}
+
+std::shared_ptr<UdsSource::Mapping> UdsSource::MapBuffer(int fd) {
+    struct stat st{};
+    if (::fstat(fd, &st) < 0) {
+        ::close(fd);
+        return nullptr;
+    }
+
+    // A recycled buffer arrives as a new fd for the same file
+    for (size_t i = 0; i < mappings_.size(); ++i) {
+        if (mappings_[i]->device == st.st_dev && mappings_[i]->inode == st.st_ino) {
+            auto mapping = mappings_[i];
+            mappings_.erase(mappings_.begin() + static_cast<std::ptrdiff_t>(i));
+            mappings_.push_back(mapping);
+            ::close(fd);
+            return mapping;
+        }
+    }
+
+    // st_size is not reliable for dmabufs
+    off_t length = ::lseek(fd, 0, SEEK_END);
+    void* data = (length > 0) ? ::mmap(nullptr, static_cast<size_t>(length), PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        VP_LOG_WARNING_F("UdsSource '{}' cannot map received buffer: {}", GetName(), std::strerror(errno));
+        return nullptr;
+    }
+
+    auto mapping = std::make_shared<Mapping>();
+    mapping->device = st.st_dev;
+    mapping->inode = st.st_ino;
+    mapping->data = data;
+    mapping->length = static_cast<size_t>(length);
+
+    if (mappings_.size() >= max_mappings_) {
+        mappings_.erase(mappings_.begin());
+    }
+    mappings_.push_back(mapping);
+    return mapping;
+}
+
+void UdsSource::ReceiverThread() {
+    VP_LOG_DEBUG_F("UdsSource '{}' receiver thread started", BaseBlock::GetName());
+    BaseBlock::ApplyThreadSettings();
+
+    while (!stop_receiver_.load()) {
+        if (!connection_) {
+            if (!Connect()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(kPollTimeoutMs));
+            }
+            continue;
+        }
+
+        pollfd pfd{connection_->fd, POLLIN, 0};
+        if (::poll(&pfd, 1, kPollTimeoutMs) <= 0) {
+            continue;
+        }
+
+        uds::FrameMessage message;
+        int fd = -1;
+        size_t fd_count = 0;
+        ssize_t n = ReceiveWithFds(connection_->fd, &message, sizeof(message), &fd, 1, fd_count);
+        if (n <= 0) {
+            VP_LOG_INFO_F("UdsSource '{}' sender disconnected", BaseBlock::GetName());
+            if (fd_count) {
+                ::close(fd);
+            }
+            Disconnect();
+            continue;
+        }
+
+        if (n != static_cast<ssize_t>(sizeof(message)) || fd_count != 1 || message.magic != uds::kMagic ||
+            message.version != uds::kVersion || message.type != static_cast<uint8_t>(uds::MessageType::FRAME)) {
+            VP_LOG_WARNING_F("UdsSource '{}' invalid message, dropping connection", BaseBlock::GetName());
+            if (fd_count) {
+                ::close(fd);
+            }
+            Disconnect();
+            continue;
+        }
+
+        auto mapping = MapBuffer(fd);
+        if (!mapping) {
+            connection_->Release(message.id);
+            UpdateStats(false, 0, true);
+            continue;
+        }
+
+        FrameInfo info = output_format_;
+        info.width = message.width;
+        info.height = message.height;
+        info.pixel_format = static_cast<PixelFormat>(message.pixel_format);
+        info.stride = message.stride[0];
+        info.timestamp_us = message.timestamp_us;
+        info.sequence_number = message.sequence_number;
+
+        // Every plane must lie inside the mapping
+        uint8_t* base = static_cast<uint8_t*>(mapping->data);
+        MutableFramePlanes planes;
+        bool valid = message.offset[0] < mapping->length && message.size <= mapping->length - message.offset[0];
+        if (valid && message.plane_count > 0) {
+            planes.format = info.pixel_format;
+            planes.width = info.width;
+            planes.height = info.height;
+            planes.count = std::min<int>(message.plane_count, 3);
+            for (int p = 0; p < planes.count; ++p) {
+                uint32_t rows = PlaneRows(planes, p);
+                size_t end = message.offset[p] + (rows ? static_cast<size_t>(message.stride[p]) * (rows - 1) : 0) +
+                             PlaneRowBytes(planes, p);
+                valid = valid && message.offset[p] < mapping->length && end <= mapping->length &&
+                        message.stride[p] >= PlaneRowBytes(planes, p);
+                planes.plane[p] = base + message.offset[p];
+                planes.stride[p] = message.stride[p];
+            }
+        }
+        if (!valid) {
+            VP_LOG_WARNING_F("UdsSource '{}' frame does not fit the received buffer", BaseBlock::GetName());
+            connection_->Release(message.id);
+            UpdateStats(false, 0, true);
+            continue;
+        }
+
+        EmitFrame(MakeRef<UdsFrame>(std::move(mapping), connection_, message.id, info, planes,
+                                    base + message.offset[0], static_cast<size_t>(message.size)));
+    }
+
+    VP_LOG_DEBUG_F("UdsSource '{}' receiver thread stopped", BaseBlock::GetName());
+}
+
+} // namespace video_pipeline
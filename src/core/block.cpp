@@ -1,6 +1,9 @@
 #include "video_pipeline/block.h"
 #include "video_pipeline/timer.h"
+#include "video_pipeline/frame_pool.h"
+#include "video_pipeline/logger.h"
 #include <sstream>
+#include <stdexcept>
 
 namespace video_pipeline {
 
@@ -69,6 +72,150 @@ std::string BaseBlock::GetParameter(const std::string& key) const {
     return (it != params_.end()) ? it->second : "";
 }
 
+bool BaseBlock::UpdateParameter(const std::string& key, const std::string& value) {
+    if (!IsHotParameter(key)) {
+        return false;
+    }
+    
+    SetParameter(key, value);
+    
+    BlockState state = GetState();
+    if (state != BlockState::RUNNING && state != BlockState::STARTING) {
+        BlockParams param{{key, value}};
+        ApplyParameters(param);
+        return true;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_params_[key] = value;
+    params_pending_.store(true, std::memory_order_release);
+    return true;
+}
+
+void BaseBlock::ApplyPendingParameters() {
+    if (!params_pending_.load(std::memory_order_acquire)) {
+        return;
+    }
+    
+    BlockParams pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending.swap(pending_params_);
+        params_pending_.store(false, std::memory_order_relaxed);
+    }
+    
+    ApplyParameters(pending);
+}
+
+void BaseBlock::ApplyParameters(const BlockParams& params) {
+    for (const auto& param : params) {
+        VP_LOG_INFO_F("Block '{}' applying {}={}", name_, param.first, param.second);
+        try {
+            ApplyParameter(param.first, param.second);
+        } catch (const std::exception& e) {
+            VP_LOG_WARNING_F("Block '{}' rejected {}={}: {}", name_, param.first, param.second, e.what());
+        }
+    }
+}
+
+void BaseBlock::SetExecutor(std::shared_ptr<Executor> executor, int group) {
+    executor_ = std::move(executor);
+    executor_priority_ = TaskPriority::NORMAL;
+    executor_worker_ = -1;
+    executor_group_ = group;
+    
+    auto priority_str = GetParameter("executor_priority");
+    if (priority_str == "high") {
+        executor_priority_ = TaskPriority::HIGH;
+    } else if (priority_str == "low") {
+        executor_priority_ = TaskPriority::LOW;
+    } else if (!priority_str.empty() && priority_str != "normal") {
+        VP_LOG_WARNING_F("Block '{}': unknown executor_priority '{}', using normal", name_, priority_str);
+    }
+    
+    auto worker_str = GetParameter("executor_worker");
+    if (!worker_str.empty()) {
+        executor_worker_ = std::stoi(worker_str);
+    }
+}
+
+void BaseBlock::SetFramePool(std::shared_ptr<FramePool> pool, int client) {
+    frame_pool_ = std::move(pool);
+    frame_pool_client_ = client;
+}
+
+VideoFramePtr BaseBlock::AllocateFrame(const FrameInfo& info, size_t capacity, const FrameMemoryOptions& memory) {
+    if (!frame_pool_) {
+        return CreateVideoFrame(info, capacity, memory);
+    }
+    
+    auto frame = frame_pool_->Acquire(frame_pool_client_, info, capacity, memory);
+    if (!frame) {
+        UpdateStats(false, 0, true);
+    }
+    return frame;
+}
+
+ThreadSettings BaseBlock::GetThreadSettings() const {
+    ThreadSettings settings;
+    
+    auto affinity_str = GetParameter("cpu_affinity");
+    if (!affinity_str.empty() && !CPUAffinity::ParseCoreList(affinity_str, settings.cpu_cores)) {
+        VP_LOG_WARNING_F("Block '{}': invalid cpu_affinity '{}', not pinning", name_, affinity_str);
+        settings.cpu_cores.clear();
+    }
+    
+    auto policy_str = GetParameter("sched_policy");
+    if (!policy_str.empty()) {
+        settings.set_policy = CPUAffinity::ParseSchedPolicy(policy_str, settings.policy);
+        if (!settings.set_policy) {
+            VP_LOG_WARNING_F("Block '{}': unknown sched_policy '{}', keeping the default", name_, policy_str);
+        }
+    }
+    
+    auto priority_str = GetParameter("sched_priority");
+    if (!priority_str.empty()) {
+        settings.priority = std::stoi(priority_str);
+        // A priority alone asks for round-robin real-time scheduling
+        if (policy_str.empty()) {
+            settings.policy = SchedPolicy::RR;
+            settings.set_policy = true;
+        }
+    }
+    
+    if ((settings.policy == SchedPolicy::FIFO || settings.policy == SchedPolicy::RR) &&
+        (settings.priority < 1 || settings.priority > 99)) {
+        VP_LOG_WARNING_F("Block '{}': sched_priority must be 1-99 for real-time policies, using 1", name_);
+        settings.priority = 1;
+    }
+    
+    settings.name = GetParameter("thread_name");
+    if (settings.name.empty()) {
+        settings.name = name_;
+    }
+    
+    return settings;
+}
+
+void BaseBlock::ApplyThreadSettings() {
+    if (!CPUAffinity::ApplyToCurrentThread(GetThreadSettings())) {
+        VP_LOG_WARNING_F("Block '{}': thread settings only partly applied", name_);
+    }
+}
+
+void BaseBlock::ConfigureWaitStrategy() {
+    auto strategy_str = GetParameter("wait_strategy");
+    if (!strategy_str.empty() && !ParseWaitStrategy(strategy_str, wait_strategy_)) {
+        VP_LOG_WARNING_F("Block '{}': unknown wait_strategy '{}', using block", name_, strategy_str);
+        wait_strategy_ = WaitStrategy::BLOCK;
+    }
+    
+    auto spin_str = GetParameter("spin_us");
+    if (!spin_str.empty()) {
+        spin_time_ = std::chrono::microseconds(std::stoul(spin_str));
+    }
+}
+
 void BaseBlock::SetState(BlockState state) {
     state_.store(state);
 }
@@ -1,14 +1,58 @@
 #include "video_pipeline/buffer.h"
 #include "video_pipeline/logger.h"
+#include "utils/frame_planes.h"
+#include "utils/frame_memory.h"
 #include <cstring>
 #include <sstream>
 #include <iomanip>
 #include <memory>
 #include <cstdlib>
 #include <stdexcept>
+#include <algorithm>
+#include <cctype>
 
 namespace video_pipeline {
 
+bool IsCompressedFormat(PixelFormat format) {
+    return format == PixelFormat::MJPEG || format == PixelFormat::QOI;
+}
+
+const char* PixelFormatToString(PixelFormat format) {
+    switch (format) {
+        case PixelFormat::RGB24: return "RGB24";
+        case PixelFormat::BGR24: return "BGR24";
+        case PixelFormat::RGBA32: return "RGBA32";
+        case PixelFormat::BGRA32: return "BGRA32";
+        case PixelFormat::YUV420P: return "YUV420P";
+        case PixelFormat::NV12: return "NV12";
+        case PixelFormat::NV21: return "NV21";
+        case PixelFormat::YUYV: return "YUYV";
+        case PixelFormat::UYVY: return "UYVY";
+        case PixelFormat::MJPEG: return "MJPEG";
+        case PixelFormat::QOI: return "QOI";
+        default: return "UNKNOWN";
+    }
+}
+
+bool ParsePixelFormat(const std::string& name, PixelFormat& format) {
+    std::string upper = name;
+    std::transform(upper.begin(), upper.end(), upper.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    
+    static const PixelFormat formats[] = {
+        PixelFormat::RGB24, PixelFormat::BGR24, PixelFormat::RGBA32, PixelFormat::BGRA32,
+        PixelFormat::YUV420P, PixelFormat::NV12, PixelFormat::NV21, PixelFormat::YUYV,
+        PixelFormat::UYVY, PixelFormat::MJPEG, PixelFormat::QOI
+    };
+    for (PixelFormat candidate : formats) {
+        if (upper == PixelFormatToString(candidate)) {
+            format = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
 size_t FrameInfo::GetFrameSize() const {
     switch (pixel_format) {
         case PixelFormat::RGB24:
@@ -34,19 +78,7 @@ std::string FrameInfo::ToString() const {
     std::ostringstream oss;
     oss << width << "x" << height;
     
-    // Add pixel format
-    switch (pixel_format) {
-        case PixelFormat::RGB24: oss << " RGB24"; break;
-        case PixelFormat::BGR24: oss << " BGR24"; break;
-        case PixelFormat::RGBA32: oss << " RGBA32"; break;
-        case PixelFormat::BGRA32: oss << " BGRA32"; break;
-        case PixelFormat::YUV420P: oss << " YUV420P"; break;
-        case PixelFormat::NV12: oss << " NV12"; break;
-        case PixelFormat::NV21: oss << " NV21"; break;
-        case PixelFormat::YUYV: oss << " YUYV"; break;
-        case PixelFormat::UYVY: oss << " UYVY"; break;
-        default: oss << " UNKNOWN"; break;
-    }
+    oss << " " << PixelFormatToString(pixel_format);
     
     if (stride > 0 && stride != width * 3) {  // Assuming RGB for default
         oss << " stride=" << stride;
@@ -60,6 +92,10 @@ std::string FrameInfo::ToString() const {
         oss << " seq=" << sequence_number;
     }
     
+    if (change) {
+        oss << " change=" << change->score << (change->changed ? " (changed)" : "");
+    }
+    
     return oss.str();
 }
 
@@ -68,20 +104,17 @@ std::string FrameInfo::ToString() const {
  */
 class SimpleBuffer : public IVideoFrame {
 public:
-    SimpleBuffer(size_t capacity) 
+    SimpleBuffer(size_t capacity, const FrameMemoryOptions& options = {}) 
         : capacity_(capacity)
-        , size_(0)
-        , ref_count_(1) {
-        data_ = std::aligned_alloc(32, capacity);  // 32-byte alignment for SIMD
-        if (!data_) {
+        , size_(0) {
+        if (!AllocateFrameMemory(capacity, options, memory_)) {
             throw std::bad_alloc();
         }
+        data_ = memory_.data;
     }
     
     ~SimpleBuffer() {
-        if (data_) {
-            std::free(data_);
-        }
+        FreeFrameMemory(memory_);
     }
     
     // IBuffer implementation
@@ -90,10 +123,20 @@ public:
     size_t GetSize() const override { return size_; }
     size_t GetCapacity() const override { return capacity_; }
     
+    bool SetSize(size_t size) override {
+        if (size > capacity_) return false;
+        size_ = size;
+        return true;
+    }
+    
     const FrameInfo& GetFrameInfo() const override { return frame_info_; }
     void SetFrameInfo(const FrameInfo& info) override { 
         frame_info_ = info;
         size_ = info.GetFrameSize();
+        // Rows are always stored unpadded, whatever stride the source frame had
+        if (!IsCompressedFormat(info.pixel_format)) {
+            frame_info_.stride = GetPlaneStride(0);
+        }
     }
     
     bool IsValid() const override { return data_ != nullptr && size_ <= capacity_; }
@@ -102,14 +145,6 @@ public:
         frame_info_ = FrameInfo{};
     }
     
-    void AddRef() override { ref_count_.fetch_add(1); }
-    void Release() override { 
-        if (ref_count_.fetch_sub(1) == 1) {
-            delete this;
-        }
-    }
-    uint32_t GetRefCount() const override { return ref_count_.load(); }
-    
     // IVideoFrame implementation
     void* GetPlaneData(int plane) override {
         if (!data_ || plane < 0) return nullptr;
@@ -121,6 +156,8 @@ public:
             case PixelFormat::BGRA32:
             case PixelFormat::YUYV:
             case PixelFormat::UYVY:
+            case PixelFormat::MJPEG:
+            case PixelFormat::QOI:
                 // Packed formats have only one plane
                 return (plane == 0) ? data_ : nullptr;
                 
@@ -204,45 +241,158 @@ public:
     
     bool CopyFrom(const IVideoFrame& other) override {
         const auto& other_info = other.GetFrameInfo();
-        if (other_info.GetFrameSize() > capacity_) {
+        if (other_info.GetFrameSize() > capacity_ || other.GetSize() > capacity_) {
             return false;
         }
         
         SetFrameInfo(other_info);
         
-        // Copy plane by plane for better performance
-        int plane_count = std::min(GetPlaneCount(), other.GetPlaneCount());
-        for (int i = 0; i < plane_count; ++i) {
-            const void* src_data = other.GetPlaneData(i);
-            void* dst_data = GetPlaneData(i);
-            size_t plane_size = other.GetPlaneSize(i);
-            
-            if (src_data && dst_data && plane_size > 0) {
-                std::memcpy(dst_data, src_data, plane_size);
-            }
+        if (IsCompressedFormat(other_info.pixel_format)) {
+            // Compressed payloads are a single opaque byte range
+            size_ = other.GetSize();
+            std::memcpy(data_, other.GetData(), size_);
+            return true;
         }
         
+        // Copy row by row so padded and windowed sources (FrameView) land unpadded
+        FramePlanes src;
+        MutableFramePlanes dst;
+        if (!ResolvePlanes(other, src) || !ResolvePlanes(*this, dst)) {
+            return false;
+        }
+        CopyPlanes(src, dst);
         return true;
     }
     
+    int GetFd(size_t& offset) const override {
+        offset = 0;
+        return memory_.fd;
+    }
+    
     BufferPtr Clone() const override {
-        auto clone = std::make_shared<SimpleBuffer>(capacity_);
+        auto clone = MakeRef<SimpleBuffer>(capacity_);
         clone->CopyFrom(*this);
         return clone;
     }
 
 private:
+    FrameMemory memory_;
     void* data_;
     size_t capacity_;
     size_t size_;
     FrameInfo frame_info_;
-    std::atomic<uint32_t> ref_count_;
+};
+
+/**
+ * @brief Zero-copy window into a rectangle of another frame
+ *
+ * Plane pointers are offset into the parent's memory and the parent's strides
+ * are kept, so rows are generally not contiguous. The view holds a reference
+ * to the parent for its whole lifetime.
+ */
+class FrameView : public IVideoFrame {
+public:
+    FrameView(VideoFramePtr parent, const MutableFramePlanes& planes, const FrameInfo& info)
+        : parent_(std::move(parent))
+        , planes_(planes)
+        , frame_info_(info) {}
+    
+    // IBuffer implementation; the size is that of the visible pixels
+    void* GetData() override { return planes_.plane[0]; }
+    const void* GetData() const override { return planes_.plane[0]; }
+    size_t GetSize() const override { return frame_info_.GetFrameSize(); }
+    size_t GetCapacity() const override { return frame_info_.GetFrameSize(); }
+    
+    // The geometry is fixed by the parent rectangle
+    bool SetSize(size_t size) override { return size == GetSize(); }
+    
+    const FrameInfo& GetFrameInfo() const override { return frame_info_; }
+    // The geometry is the parent's; the format may only change to one with the
+    // same layout, after the pixels were rewritten in place
+    void SetFrameInfo(const FrameInfo& info) override {
+        if (SameLayout(info.pixel_format, frame_info_.pixel_format)) {
+            frame_info_.pixel_format = info.pixel_format;
+            planes_.format = info.pixel_format;
+        }
+        frame_info_.timestamp_us = info.timestamp_us;
+        frame_info_.sequence_number = info.sequence_number;
+        frame_info_.change = info.change;
+    }
+    
+    bool IsValid() const override { return parent_ != nullptr && planes_.plane[0] != nullptr; }
+    void Reset() override {}
+    
+    // IVideoFrame implementation
+    void* GetPlaneData(int plane) override {
+        return (plane >= 0 && plane < planes_.count) ? planes_.plane[plane] : nullptr;
+    }
+    
+    const void* GetPlaneData(int plane) const override {
+        return const_cast<FrameView*>(this)->GetPlaneData(plane);
+    }
+    
+    // Bytes from the first to the last visible byte of the plane
+    size_t GetPlaneSize(int plane) const override {
+        if (plane < 0 || plane >= planes_.count) return 0;
+        uint32_t rows = PlaneRows(planes_, plane);
+        return rows ? static_cast<size_t>(planes_.stride[plane]) * (rows - 1) + PlaneRowBytes(planes_, plane) : 0;
+    }
+    
+    uint32_t GetPlaneStride(int plane) const override {
+        return (plane >= 0 && plane < planes_.count) ? planes_.stride[plane] : 0;
+    }
+    
+    int GetPlaneCount() const override { return planes_.count; }
+    
+    // Writes through to the parent; the source must have the same format and size
+    bool CopyFrom(const IVideoFrame& other) override {
+        const auto& other_info = other.GetFrameInfo();
+        if (other_info.pixel_format != frame_info_.pixel_format ||
+            other_info.width != frame_info_.width || other_info.height != frame_info_.height) {
+            return false;
+        }
+        
+        FramePlanes src;
+        if (!ResolvePlanes(other, src)) {
+            return false;
+        }
+        CopyPlanes(src, planes_);
+        SetFrameInfo(other_info);
+        return true;
+    }
+    
+    // The parent's pixels are written through, so they must be private as well
+    bool CanWriteInPlace() const override {
+        return IsExclusive() && parent_->CanWriteInPlace();
+    }
+    
+    int GetFd(size_t& offset) const override {
+        int fd = parent_->GetFd(offset);
+        if (fd >= 0) {
+            offset += planes_.plane[0] - static_cast<const uint8_t*>(parent_->GetPlaneData(0));
+        }
+        return fd;
+    }
+    
+    // Detached, unpadded copy of the visible pixels
+    BufferPtr Clone() const override {
+        auto clone = CreateVideoFrame(frame_info_);
+        if (clone && !clone->CopyFrom(*this)) {
+            return nullptr;
+        }
+        return clone;
+    }
+
+private:
+    VideoFramePtr parent_;
+    MutableFramePlanes planes_;
+    FrameInfo frame_info_;
 };
 
 // Factory function to create buffers
 BufferPtr CreateBuffer(size_t capacity) {
     try {
-        return std::make_shared<SimpleBuffer>(capacity);
+        return MakeRef<SimpleBuffer>(capacity);
     } catch (const std::exception& e) {
         VP_LOG_ERROR_F("Failed to create buffer: {}", e.what());
         return nullptr;
@@ -250,14 +400,22 @@ BufferPtr CreateBuffer(size_t capacity) {
 }
 
 VideoFramePtr CreateVideoFrame(const FrameInfo& info) {
-    size_t required_size = info.GetFrameSize();
+    return CreateVideoFrame(info, 0);
+}
+
+VideoFramePtr CreateVideoFrame(const FrameInfo& info, size_t capacity) {
+    return CreateVideoFrame(info, capacity, FrameMemoryOptions{});
+}
+
+VideoFramePtr CreateVideoFrame(const FrameInfo& info, size_t capacity, const FrameMemoryOptions& memory) {
+    size_t required_size = std::max(info.GetFrameSize(), capacity);
     if (required_size == 0) {
         VP_LOG_ERROR("Cannot create video frame: invalid frame info");
         return nullptr;
     }
     
     try {
-        auto buffer = std::make_shared<SimpleBuffer>(required_size);
+        auto buffer = MakeRef<SimpleBuffer>(required_size, memory);
         buffer->SetFrameInfo(info);
         return buffer;
     } catch (const std::exception& e) {
@@ -266,4 +424,99 @@ VideoFramePtr CreateVideoFrame(const FrameInfo& info) {
     }
 }
 
-} // namespace video_pipeline
\ No newline at end of file
+VideoFramePtr CreateFrameView(const VideoFramePtr& parent, uint32_t x, uint32_t y,
+                              uint32_t width, uint32_t height) {
+    if (!parent || IsCompressedFormat(parent->GetFrameInfo().pixel_format)) {
+        VP_LOG_ERROR("Cannot create frame view: parent is not an uncompressed frame");
+        return nullptr;
+    }
+    
+    MutableFramePlanes planes;
+    if (!ResolvePlanes(*parent, planes)) {
+        VP_LOG_ERROR_F("Cannot create frame view of {}", parent->GetFrameInfo().ToString());
+        return nullptr;
+    }
+    
+    // Keep the window on chroma sample boundaries
+    const PixelFormat format = planes.format;
+    const bool subsampled_x = planes.count > 1 || format == PixelFormat::YUYV || format == PixelFormat::UYVY;
+    const bool subsampled_y = planes.count > 1;
+    if (subsampled_x) {
+        x &= ~1u;
+        width &= ~1u;
+    }
+    if (subsampled_y) {
+        y &= ~1u;
+        height &= ~1u;
+    }
+    
+    if (width == 0 || height == 0 ||
+        static_cast<uint64_t>(x) + width > planes.width ||
+        static_cast<uint64_t>(y) + height > planes.height) {
+        VP_LOG_ERROR_F("Frame view {}x{}+{}+{} is outside of {}", width, height, x, y,
+                       parent->GetFrameInfo().ToString());
+        return nullptr;
+    }
+    
+    const uint32_t bpp = PackedBytesPerPixel(format);
+    planes.plane[0] += static_cast<size_t>(y) * planes.stride[0] + static_cast<size_t>(x) * bpp;
+    for (int p = 1; p < planes.count; ++p) {
+        // NV12/NV21 chroma is interleaved (2 bytes per sample), YUV420P is 1 byte per sample
+        size_t chroma_x = (planes.count == 2) ? x : x / 2;
+        planes.plane[p] += static_cast<size_t>(y / 2) * planes.stride[p] + chroma_x;
+    }
+    planes.width = width;
+    planes.height = height;
+    
+    FrameInfo info = parent->GetFrameInfo();
+    info.width = width;
+    info.height = height;
+    info.stride = planes.stride[0];
+    info.is_hardware_buffer = false;
+    info.hw_handle = nullptr;
+    
+    return MakeRef<FrameView>(parent, planes, info);
+}
+
+namespace {
+
+std::atomic<uint64_t> g_cow_in_place{0};
+std::atomic<uint64_t> g_cow_copied{0};
+std::atomic<uint64_t> g_cow_bytes{0};
+
+} // namespace
+
+bool MakeWritable(VideoFramePtr& frame, const FrameAllocator& allocate) {
+    if (!frame) {
+        return false;
+    }
+    
+    if (frame->CanWriteInPlace()) {
+        g_cow_in_place.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    
+    const FrameInfo& info = frame->GetFrameInfo();
+    size_t capacity = IsCompressedFormat(info.pixel_format) ? frame->GetSize() : 0;
+    
+    VideoFramePtr copy = allocate ? allocate(info, capacity) : CreateVideoFrame(info, capacity);
+    if (!copy || !copy->CopyFrom(*frame)) {
+        VP_LOG_ERROR_F("Copy-on-write failed for {} frame", info.ToString());
+        return false;
+    }
+    
+    g_cow_copied.fetch_add(1, std::memory_order_relaxed);
+    g_cow_bytes.fetch_add(copy->GetSize(), std::memory_order_relaxed);
+    frame = std::move(copy);
+    return true;
+}
+
+CopyOnWriteStats GetCopyOnWriteStats() {
+    CopyOnWriteStats stats;
+    stats.in_place = g_cow_in_place.load(std::memory_order_relaxed);
+    stats.copied = g_cow_copied.load(std::memory_order_relaxed);
+    stats.bytes_copied = g_cow_bytes.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace video_pipeline
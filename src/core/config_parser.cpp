@@ -55,6 +55,13 @@ bool YamlConfigParser::Parse(const std::string& content, PipelineConfig& config)
             config.platform = pipeline_node["platform"].as<std::string>("generic");
         }
         
+        // Parse global settings
+        if (root["settings"]) {
+            for (const auto& setting : root["settings"]) {
+                config.settings[setting.first.as<std::string>()] = setting.second.as<std::string>();
+            }
+        }
+        
         // Parse blocks
         if (root["blocks"]) {
             for (const auto& block_node : root["blocks"]) {
@@ -108,6 +115,8 @@ bool YamlConfigParser::Parse(const std::string& content, PipelineConfig& config)
                     conn.sink_block = conn_node["sink"].as<std::string>();
                     conn.source_output = conn_node["source_output"].as<std::string>("output");
                     conn.sink_input = conn_node["sink_input"].as<std::string>("input");
+                    conn.drop_policy = conn_node["policy"].as<std::string>("");
+                    conn.block_timeout_ms = conn_node["timeout_ms"].as<uint32_t>(0);
                 }
                 
                 config.connections.push_back(conn);
@@ -180,6 +189,7 @@ void SimpleConfigParser::ParseSection(const std::string& section, const std::str
     if (section == "pipeline") {
         if (key == "name") config.name = value;
         else if (key == "platform") config.platform = value;
+        else config.settings[key] = value;
     }
     else if (section.find("block:") == 0) {
         // Block definition: [block:block_name]
@@ -207,13 +217,33 @@ void SimpleConfigParser::ParseSection(const std::string& section, const std::str
         }
     }
     else if (section == "connections") {
-        // Parse connection: source_block -> sink_block
-        std::regex conn_regex(R"(\s*(\w+)\s*->\s*(\w+)\s*)");
+        // Parse connection: source_block[.output] -> sink_block[.input] [policy=<name>] [timeout_ms=<n>]
+        std::regex conn_regex(R"(\s*(\w+)(?:\.(\w+))?\s*->\s*(\w+)(?:\.(\w+))?((?:\s+\w+=\S+)*)\s*)");
         std::smatch match;
         if (std::regex_match(value, match, conn_regex)) {
             Connection conn;
             conn.source_block = match[1].str();
-            conn.sink_block = match[2].str();
+            if (match[2].matched) {
+                conn.source_output = match[2].str();
+            }
+            conn.sink_block = match[3].str();
+            if (match[4].matched) {
+                conn.sink_input = match[4].str();
+            }
+            
+            std::string options = match[5].str();
+            std::regex option_regex(R"((\w+)=(\S+))");
+            for (std::sregex_iterator it(options.begin(), options.end(), option_regex), end; it != end; ++it) {
+                std::string option = (*it)[1].str();
+                std::string option_value = (*it)[2].str();
+                if (option == "policy") {
+                    conn.drop_policy = option_value;
+                } else if (option == "timeout_ms") {
+                    conn.block_timeout_ms = static_cast<uint32_t>(std::stoul(option_value));
+                } else {
+                    VP_LOG_WARNING_F("Connection '{}': unknown option '{}'", key, option);
+                }
+            }
             config.connections.push_back(conn);
         }
     }
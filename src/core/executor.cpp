@@ -0,0 +1,316 @@
+#include "video_pipeline/executor.h"
+#include "video_pipeline/logger.h"
+#include <algorithm>
+#include <string>
+
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+namespace video_pipeline {
+
+namespace {
+
+// Executor and worker index of the calling thread if it is an executor worker
+thread_local const Executor* tls_executor = nullptr;
+thread_local int tls_worker = -1;
+thread_local int tls_group = -1;    // Group of the task running on this thread
+
+} // anonymous namespace
+
+Executor::Executor(size_t num_threads, bool pin_workers) {
+    if (num_threads == 0) {
+        num_threads = std::thread::hardware_concurrency();
+        if (num_threads == 0) num_threads = 4;  // fallback
+    }
+
+    for (size_t i = 0; i < num_threads; ++i) {
+        local_.push_back(std::make_unique<ReadyQueues>());
+    }
+    busy_.assign(num_threads, false);
+    groups_.emplace_back();
+
+    std::vector<int> cores = pin_workers ? CPUAffinity::GetAvailableCores() : std::vector<int>{};
+    threads_.reserve(num_threads);
+    for (size_t i = 0; i < num_threads; ++i) {
+        threads_.emplace_back(&Executor::WorkerThread, this, i);
+        if (!cores.empty()) {
+            CPUAffinity::SetThreadAffinity(threads_.back(), {cores[i % cores.size()]});
+        }
+#ifdef __linux__
+        std::string name = "vp-exec-" + std::to_string(i);
+        pthread_setname_np(threads_.back().native_handle(), name.c_str());
+#endif
+    }
+
+    VP_LOG_INFO_F("Executor created with {} workers{}", num_threads, cores.empty() ? "" : " (pinned)");
+}
+
+Executor::~Executor() {
+    Shutdown();
+}
+
+void Executor::Post(Task task, TaskPriority priority, int worker, int group) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Enqueue(std::move(task), priority, worker, group);
+    }
+    // A hinted task must wake its own worker
+    if (worker >= 0) {
+        condition_.notify_all();
+    } else {
+        condition_.notify_one();
+    }
+}
+
+uint64_t Executor::PostAt(std::chrono::steady_clock::time_point when, Task task,
+                          TaskPriority priority, int worker, int group) {
+    uint64_t id;
+    bool earliest;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        id = next_timer_id_++;
+        auto it = timers_.emplace(when, TimedTask{id, std::move(task), priority, worker, group});
+        earliest = (it == timers_.begin());
+    }
+    // Sleeping workers wait for the earliest deadline only
+    if (earliest) {
+        condition_.notify_all();
+    }
+    return id;
+}
+
+bool Executor::Cancel(uint64_t timer_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = timers_.begin(); it != timers_.end(); ++it) {
+        if (it->second.id == timer_id) {
+            timers_.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
+int Executor::AddGroup(size_t max_workers, unsigned weight) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Group group;
+    group.max_workers = max_workers;
+    group.weight = std::max(weight, 1u);
+    
+    // A retired group's id is free once no task refers to it any more
+    for (size_t g = 1; g < groups_.size(); ++g) {
+        const Group& old = groups_[g];
+        if (!old.removed || old.queued || old.running) {
+            continue;
+        }
+        bool timed = std::any_of(timers_.begin(), timers_.end(),
+                                 [g](const auto& timer) { return timer.second.group == static_cast<int>(g); });
+        if (!timed) {
+            groups_[g] = group;
+            return static_cast<int>(g);
+        }
+    }
+    
+    groups_.push_back(group);
+    return static_cast<int>(groups_.size() - 1);
+}
+
+void Executor::RemoveGroup(int group) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (group > 0 && static_cast<size_t>(group) < groups_.size()) {
+        groups_[group].removed = true;
+    }
+}
+
+Executor::GroupStats Executor::GetGroupStats(int group) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return (group >= 0 && static_cast<size_t>(group) < groups_.size()) ? groups_[group].stats : GroupStats{};
+}
+
+bool Executor::RunPendingTask() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    ReleaseDueTimers(std::chrono::steady_clock::now());
+    
+    Task task;
+    int group;
+    bool worker = (tls_executor == this);
+    if (!TakeTask(worker ? tls_worker : -1, worker ? tls_group : -1, task, group)) {
+        return false;
+    }
+    RunTask(task, group, lock);
+    return true;
+}
+
+void Executor::RunTask(Task& task, int group, std::unique_lock<std::mutex>& lock) {
+    groups_[group].running++;
+    lock.unlock();
+    
+    int outer_group = tls_group;
+    tls_group = group;
+    auto start = std::chrono::steady_clock::now();
+    try {
+        task();
+    } catch (const std::exception& e) {
+        VP_LOG_ERROR_F("Exception in executor task: {}", e.what());
+    } catch (...) {
+        VP_LOG_ERROR("Unknown exception in executor task");
+    }
+    task = Task();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    tls_group = outer_group;
+    
+    lock.lock();
+    Group& entry = groups_[group];
+    entry.running--;
+    entry.stats.tasks_run++;
+    entry.stats.busy_time += elapsed;
+    entry.vruntime += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) /
+                      entry.weight;
+}
+
+bool Executor::IsWorkerThread() const {
+    return tls_executor == this;
+}
+
+void Executor::Shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+
+    condition_.notify_all();
+
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    threads_.clear();
+    timers_.clear();
+}
+
+void Executor::Enqueue(Task&& task, TaskPriority priority, int worker, int group) {
+    if (group < 0 || static_cast<size_t>(group) >= groups_.size()) {
+        group = 0;
+    }
+    
+    // A group that was idle resumes at the least-served active group's
+    // position instead of claiming the time it did not use
+    Group& entry = groups_[group];
+    if (entry.queued == 0 && entry.running == 0) {
+        bool found = false;
+        uint64_t floor = 0;
+        for (const auto& other : groups_) {
+            if ((other.queued || other.running) && (!found || other.vruntime < floor)) {
+                floor = other.vruntime;
+                found = true;
+            }
+        }
+        if (found) {
+            entry.vruntime = std::max(entry.vruntime, floor);
+        }
+    }
+    entry.queued++;
+    
+    int level = static_cast<int>(priority);
+    if (worker >= 0 && !local_.empty()) {
+        local_[static_cast<size_t>(worker) % local_.size()]->level[level].push_back(ReadyTask{std::move(task), group});
+    } else {
+        shared_.level[level].push_back(ReadyTask{std::move(task), group});
+    }
+}
+
+void Executor::ReleaseDueTimers(std::chrono::steady_clock::time_point now) {
+    while (!timers_.empty() && timers_.begin()->first <= now) {
+        TimedTask& timed = timers_.begin()->second;
+        Enqueue(std::move(timed.task), timed.priority, timed.worker, timed.group);
+        timers_.erase(timers_.begin());
+    }
+}
+
+bool Executor::TakeTask(int worker, int nested, Task& task, int& group) {
+    auto eligible = [&](int g) {
+        const Group& entry = groups_[g];
+        return entry.max_workers == 0 || entry.running < entry.max_workers || g == nested;
+    };
+    
+    bool single = groups_.size() == 1;
+    for (int level = 0; level < kPriorityLevels; ++level) {
+        // Candidates in order of preference: own hinted tasks, shared tasks,
+        // then tasks hinted to a worker that is occupied. Among them the
+        // first task of the least-served eligible group wins.
+        std::deque<ReadyTask>* best_queue = nullptr;
+        size_t best_index = 0;
+        
+        auto consider = [&](std::deque<ReadyTask>& queue) {
+            for (size_t i = 0; i < queue.size() && !(single && best_queue); ++i) {
+                int g = queue[i].group;
+                if (best_queue && groups_[g].vruntime >= groups_[(*best_queue)[best_index].group].vruntime) {
+                    continue;
+                }
+                if (eligible(g)) {
+                    best_queue = &queue;
+                    best_index = i;
+                }
+            }
+        };
+        
+        if (worker >= 0) {
+            consider(local_[worker]->level[level]);
+        }
+        consider(shared_.level[level]);
+        // Hinted tasks wait for their worker unless it is occupied
+        for (size_t other = 0; other < local_.size(); ++other) {
+            if (static_cast<int>(other) != worker && busy_[other]) {
+                consider(local_[other]->level[level]);
+            }
+        }
+        
+        if (best_queue) {
+            auto it = best_queue->begin() + static_cast<std::ptrdiff_t>(best_index);
+            task = std::move(it->task);
+            group = it->group;
+            best_queue->erase(it);
+            groups_[group].queued--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Executor::WorkerThread(size_t index) {
+    tls_executor = this;
+    tls_worker = static_cast<int>(index);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        ReleaseDueTimers(std::chrono::steady_clock::now());
+
+        Task task;
+        int group;
+        if (TakeTask(tls_worker, -1, task, group)) {
+            busy_[index] = true;
+            RunTask(task, group, lock);
+            busy_[index] = false;
+            continue;
+        }
+
+        if (stop_) {
+            break;
+        }
+
+        if (timers_.empty()) {
+            condition_.wait(lock);
+        } else {
+            // By value: another worker may release the timer while we wait
+            auto deadline = timers_.begin()->first;
+            condition_.wait_until(lock, deadline);
+        }
+    }
+
+    tls_executor = nullptr;
+    tls_worker = -1;
+}
+
+} // namespace video_pipeline
@@ -0,0 +1,182 @@
+#include "video_pipeline/frame_pool.h"
+#include "video_pipeline/logger.h"
+#include <algorithm>
+
+namespace video_pipeline {
+
+namespace {
+
+bool SameMemory(const FrameMemoryOptions& a, const FrameMemoryOptions& b) {
+    return a.pages == b.pages && a.prefault == b.prefault && a.lock == b.lock && a.shareable == b.shareable;
+}
+
+// Only the pool's reference is left, so nobody can still be reading the frame
+bool IsIdle(const VideoFramePtr& frame) {
+    return frame.use_count() == 1;
+}
+
+} // anonymous namespace
+
+FramePool::FramePool(size_t max_bytes) : max_bytes_(max_bytes) {
+    clients_.push_back(Client{"default", 0});
+}
+
+FramePool::~FramePool() {
+    // Frames still in flight outlive the pool as ordinary frames
+    for (auto& entry : entries_) {
+        entry.frame->SetPoolHeld(false);
+    }
+}
+
+int FramePool::AddClient(const std::string& name, size_t max_bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // A released client's id is free once none of its frames are in flight
+    for (size_t c = 1; c < clients_.size(); ++c) {
+        if (!clients_[c].removed) {
+            continue;
+        }
+        bool holding = std::any_of(entries_.begin(), entries_.end(), [c](const Entry& entry) {
+            return entry.client == static_cast<int>(c) && !IsIdle(entry.frame);
+        });
+        if (!holding) {
+            clients_[c] = Client{name, max_bytes};
+            return static_cast<int>(c);
+        }
+    }
+
+    clients_.push_back(Client{name, max_bytes});
+    return static_cast<int>(clients_.size() - 1);
+}
+
+void FramePool::RemoveClient(int client) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (client > 0 && static_cast<size_t>(client) < clients_.size()) {
+        clients_[client].removed = true;
+    }
+}
+
+VideoFramePtr FramePool::Acquire(int client, const FrameInfo& info, size_t capacity,
+                                 const FrameMemoryOptions& memory) {
+    size_t required = std::max(info.GetFrameSize(), capacity);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (client < 0 || static_cast<size_t>(client) >= clients_.size()) {
+        client = 0;
+    }
+
+    size_t total = 0;
+    size_t held = 0;
+    Entry* fit = nullptr;
+    for (auto& entry : entries_) {
+        total += entry.capacity;
+        if (!IsIdle(entry.frame)) {
+            if (entry.client == client) {
+                held += entry.capacity;
+            }
+        } else if (entry.capacity >= required && SameMemory(entry.memory, memory) &&
+                   (!fit || entry.capacity < fit->capacity)) {
+            fit = &entry;
+        }
+    }
+
+    const Client& owner = clients_[client];
+    size_t charge = fit ? fit->capacity : required;
+    if (owner.max_bytes > 0 && held + charge > owner.max_bytes) {
+        stats_.refused++;
+        VP_LOG_DEBUG_F("Frame pool: '{}' over its quota ({} of {} bytes held)", owner.name, held, owner.max_bytes);
+        return nullptr;
+    }
+
+    if (fit) {
+        fit->client = client;
+        fit->frame->SetFrameInfo(info);
+        stats_.reused++;
+        return fit->frame;
+    }
+
+    // Make room by freeing idle frames, largest first. A frame only the pool
+    // holds stays idle, so the snapshot below cannot go stale.
+    if (max_bytes_ > 0 && total + required > max_bytes_) {
+        std::vector<size_t> idle;
+        for (size_t i = 0; i < entries_.size(); ++i) {
+            if (IsIdle(entries_[i].frame)) {
+                idle.push_back(i);
+            }
+        }
+        std::sort(idle.begin(), idle.end(),
+                  [this](size_t a, size_t b) { return entries_[a].capacity > entries_[b].capacity; });
+
+        std::vector<bool> evict(entries_.size(), false);
+        for (size_t i : idle) {
+            if (total + required <= max_bytes_) {
+                break;
+            }
+            total -= entries_[i].capacity;
+            evict[i] = true;
+        }
+        if (total + required > max_bytes_) {
+            stats_.refused++;
+            VP_LOG_DEBUG_F("Frame pool full ({} of {} bytes in use)", total, max_bytes_);
+            return nullptr;
+        }
+
+        size_t kept = 0;
+        for (size_t i = 0; i < entries_.size(); ++i) {
+            if (!evict[i]) {
+                entries_[kept++] = std::move(entries_[i]);
+            } else {
+                entries_[i].frame->SetPoolHeld(false);
+            }
+        }
+        entries_.resize(kept);
+    }
+
+    auto frame = CreateVideoFrame(info, capacity, memory);
+    if (!frame) {
+        return nullptr;
+    }
+    frame->SetPoolHeld(true);
+    entries_.push_back(Entry{frame, client, frame->GetCapacity(), memory});
+    stats_.allocated++;
+    return frame;
+}
+
+void FramePool::Trim() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.erase(std::remove_if(entries_.begin(), entries_.end(),
+                                  [](const Entry& entry) {
+                                      if (!IsIdle(entry.frame)) {
+                                          return false;
+                                      }
+                                      entry.frame->SetPoolHeld(false);
+                                      return true;
+                                  }),
+                   entries_.end());
+}
+
+FramePool::Stats FramePool::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.frames = entries_.size();
+    for (const auto& entry : entries_) {
+        stats.bytes += entry.capacity;
+        if (IsIdle(entry.frame)) {
+            stats.idle_bytes += entry.capacity;
+        }
+    }
+    return stats;
+}
+
+size_t FramePool::GetClientBytes(int client) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t bytes = 0;
+    for (const auto& entry : entries_) {
+        if (entry.client == client && !IsIdle(entry.frame)) {
+            bytes += entry.capacity;
+        }
+    }
+    return bytes;
+}
+
+} // namespace video_pipeline
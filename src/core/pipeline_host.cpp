@@ -0,0 +1,192 @@
+#include "video_pipeline/pipeline_host.h"
+#include "video_pipeline/logger.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace video_pipeline {
+
+PipelineHost::PipelineHost(size_t executor_threads, size_t pool_bytes, bool pin_workers)
+    : executor_(std::make_shared<Executor>(executor_threads, pin_workers)),
+      frame_pool_(std::make_shared<FramePool>(pool_bytes)) {
+}
+
+PipelineHost::~PipelineHost() {
+    Shutdown();
+}
+
+bool PipelineHost::AddPipeline(const PipelineConfig& config) {
+    auto pipeline = std::make_shared<PipelineManager>();
+    pipeline->SetSharedResources(executor_, frame_pool_);
+    if (!pipeline->Initialize(config)) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        last_error_ = "Pipeline '" + config.name + "': " + pipeline->GetLastError();
+        return false;
+    }
+    return AddPipeline(config.name, pipeline);
+}
+
+bool PipelineHost::LoadPipeline(const std::string& config_file) {
+    auto pipeline = std::make_shared<PipelineManager>();
+    pipeline->SetSharedResources(executor_, frame_pool_);
+    if (!pipeline->LoadConfiguration(config_file)) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        last_error_ = config_file + ": " + pipeline->GetLastError();
+        return false;
+    }
+    return AddPipeline(pipeline->GetConfiguration().name, pipeline);
+}
+
+bool PipelineHost::AddPipeline(const std::string& name, std::shared_ptr<PipelineManager> pipeline) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (name.empty() || pipelines_.count(name)) {
+        last_error_ = name.empty() ? "Pipelines in a host need a name" : "Duplicate pipeline name: " + name;
+        VP_LOG_ERROR(last_error_);
+        pipeline->Shutdown();
+        return false;
+    }
+
+    if (running_ && !pipeline->Start()) {
+        last_error_ = "Pipeline '" + name + "': " + pipeline->GetLastError();
+        pipeline->Shutdown();
+        return false;
+    }
+
+    pipelines_[name] = pipeline;
+    order_.push_back(name);
+    VP_LOG_INFO_F("Host: added pipeline '{}' ({} pipelines)", name, pipelines_.size());
+    return true;
+}
+
+bool PipelineHost::RemovePipeline(const std::string& name) {
+    std::shared_ptr<PipelineManager> pipeline;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = pipelines_.find(name);
+        if (it == pipelines_.end()) {
+            last_error_ = "Pipeline not found: " + name;
+            return false;
+        }
+        pipeline = it->second;
+        pipelines_.erase(it);
+        order_.erase(std::find(order_.begin(), order_.end(), name));
+    }
+
+    pipeline->Shutdown();
+    VP_LOG_INFO_F("Host: removed pipeline '{}'", name);
+    return true;
+}
+
+bool PipelineHost::Start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (running_) {
+        return true;
+    }
+
+    for (size_t i = 0; i < order_.size(); ++i) {
+        auto& pipeline = pipelines_[order_[i]];
+        if (!pipeline->Start()) {
+            last_error_ = "Pipeline '" + order_[i] + "': " + pipeline->GetLastError();
+            VP_LOG_ERROR(last_error_);
+
+            // All or nothing
+            while (i-- > 0) {
+                pipelines_[order_[i]]->Stop();
+            }
+            return false;
+        }
+    }
+
+    running_ = true;
+    VP_LOG_INFO_F("Host started {} pipelines on {} shared workers", order_.size(), executor_->GetThreadCount());
+    return true;
+}
+
+bool PipelineHost::Stop() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (auto it = order_.rbegin(); it != order_.rend(); ++it) {
+        pipelines_[*it]->Stop();
+    }
+    running_ = false;
+    return true;
+}
+
+bool PipelineHost::Shutdown() {
+    Stop();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = order_.rbegin(); it != order_.rend(); ++it) {
+        pipelines_[*it]->Shutdown();
+    }
+    pipelines_.clear();
+    order_.clear();
+    frame_pool_->Trim();
+    return true;
+}
+
+bool PipelineHost::IsRunning() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::any_of(pipelines_.begin(), pipelines_.end(),
+                       [](const auto& pair) { return pair.second->IsRunning(); });
+}
+
+std::shared_ptr<PipelineManager> PipelineHost::GetPipeline(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = pipelines_.find(name);
+    return (it != pipelines_.end()) ? it->second : nullptr;
+}
+
+std::vector<std::string> PipelineHost::GetPipelineNames() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return order_;
+}
+
+std::map<std::string, BlockStats> PipelineHost::GetAllStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::map<std::string, BlockStats> stats;
+
+    for (const auto& pair : pipelines_) {
+        for (const auto& block : pair.second->GetAllStats()) {
+            stats[pair.first + "/" + block.first] = block.second;
+        }
+    }
+
+    return stats;
+}
+
+std::string PipelineHost::GetResourceUsage() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2);
+
+    for (const auto& name : order_) {
+        const auto& pipeline = pipelines_.at(name);
+        size_t bytes = frame_pool_->GetClientBytes(pipeline->GetFramePoolClient());
+        oss << name << ": ";
+        if (pipeline->GetExecutorGroup() > 0) {
+            auto group = executor_->GetGroupStats(pipeline->GetExecutorGroup());
+            oss << group.tasks_run << " tasks, " << std::chrono::duration<double>(group.busy_time).count()
+                << "s worker time, ";
+        } else {
+            oss << "own threads, ";
+        }
+        oss << bytes / 1024 << " KiB pooled frames in use\n";
+    }
+
+    auto pool = frame_pool_->GetStats();
+    oss << "Frame pool: " << pool.frames << " frames, " << pool.bytes / 1024 << " KiB ("
+        << pool.idle_bytes / 1024 << " KiB idle), " << pool.reused << " reused, "
+        << pool.allocated << " allocated, " << pool.refused << " refused\n";
+
+    return oss.str();
+}
+
+std::string PipelineHost::GetLastError() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return last_error_;
+}
+
+} // namespace video_pipeline
@@ -2,13 +2,30 @@
 #include "video_pipeline/block_registry.h"
 #include "video_pipeline/config_parser.h"
 #include "video_pipeline/logger.h"
+#include "video_pipeline/blocks/color_convert.h"
+#include "video_pipeline/blocks/fused_transform.h"
+#include "utils/row_stage.h"
+#include <algorithm>
+#include <cctype>
+#include <deque>
 #include <fstream>
+#include <set>
 #include <sstream>
+#include <thread>
+#include <tuple>
 
 namespace video_pipeline {
 
 std::string Connection::ToString() const {
-    return source_block + "." + source_output + " -> " + sink_block + "." + sink_input;
+    std::string result = source_block + "." + source_output + " -> " + sink_block + "." + sink_input;
+    if (!drop_policy.empty()) {
+        result += " [" + drop_policy;
+        if (block_timeout_ms > 0) {
+            result += ", " + std::to_string(block_timeout_ms) + "ms";
+        }
+        result += "]";
+    }
+    return result;
 }
 
 PipelineManager::PipelineManager() {
@@ -23,6 +40,7 @@ PipelineManager::~PipelineManager() {
 }
 
 bool PipelineManager::Initialize(const PipelineConfig& config) {
+    std::lock_guard<std::mutex> graph_lock(graph_mutex_);
     std::lock_guard<std::mutex> lock(mutex_);
     
     if (is_running_.load()) {
@@ -33,6 +51,7 @@ bool PipelineManager::Initialize(const PipelineConfig& config) {
     
     // Store configuration
     config_ = config;
+    routes_.clear();
     
     VP_LOG_INFO_F("Initializing pipeline: {}", config_.name);
     VP_LOG_INFO_F("Platform: {}", config_.platform);
@@ -47,6 +66,26 @@ bool PipelineManager::Initialize(const PipelineConfig& config) {
         return false;
     }
     
+    if (!BuildGraph()) {
+        return false;
+    }
+    
+    if (!NegotiateFormats()) {
+        return false;
+    }
+    
+    if (!FuseTransforms()) {
+        return false;
+    }
+    
+    if (!ConfigureExecution()) {
+        return false;
+    }
+    
+    if (!ConfigureAffinity()) {
+        return false;
+    }
+    
     if (!ConnectBlocks()) {
         return false;
     }
@@ -56,9 +95,10 @@ bool PipelineManager::Initialize(const PipelineConfig& config) {
 }
 
 bool PipelineManager::Start() {
+    std::lock_guard<std::mutex> graph_lock(graph_mutex_);
     std::lock_guard<std::mutex> lock(mutex_);
     
-    if (blocks_.empty()) {
+    if (nodes_.empty()) {
         last_error_ = "No blocks to start. Call Initialize() first.";
         VP_LOG_ERROR(last_error_);
         return false;
@@ -71,46 +111,20 @@ bool PipelineManager::Start() {
     
     VP_LOG_INFO_F("Starting pipeline: {}", config_.name);
     
-    // Start all blocks in dependency order
-    // For now, start sinks first, then sources
-    std::vector<BlockPtr> sinks, sources, others;
-    
-    for (const auto& pair : blocks_) {
-        auto source = std::dynamic_pointer_cast<IVideoSource>(pair.second);
-        auto sink = std::dynamic_pointer_cast<IVideoSink>(pair.second);
-        
-        if (source) {
-            sources.push_back(pair.second);
-        } else if (sink) {
-            sinks.push_back(pair.second);
-        } else {
-            others.push_back(pair.second);
-        }
-    }
-    
-    // Start in order: sinks, others, sources
-    for (auto block : sinks) {
-        if (!block->Start()) {
-            last_error_ = "Failed to start sink: " + block->GetName();
-            VP_LOG_ERROR(last_error_);
-            return false;
-        }
-    }
-    
-    for (auto block : others) {
+    // Downstream first, so every block's consumers are running before it emits
+    std::vector<size_t> started;
+    for (auto it = topo_order_.rbegin(); it != topo_order_.rend(); ++it) {
+        const auto& block = nodes_[*it].block;
         if (!block->Start()) {
             last_error_ = "Failed to start block: " + block->GetName();
             VP_LOG_ERROR(last_error_);
+            
+            // Leave nothing half-running: stop what started, upstream first
+            std::reverse(started.begin(), started.end());
+            StopBlocks(started);
             return false;
         }
-    }
-    
-    for (auto block : sources) {
-        if (!block->Start()) {
-            last_error_ = "Failed to start source: " + block->GetName();
-            VP_LOG_ERROR(last_error_);
-            return false;
-        }
+        started.push_back(*it);
     }
     
     is_running_.store(true);
@@ -119,6 +133,11 @@ bool PipelineManager::Start() {
 }
 
 bool PipelineManager::Stop() {
+    std::lock_guard<std::mutex> graph_lock(graph_mutex_);
+    return StopPipeline();
+}
+
+bool PipelineManager::StopPipeline() {
     std::lock_guard<std::mutex> lock(mutex_);
     
     if (!is_running_.load()) {
@@ -127,42 +146,29 @@ bool PipelineManager::Stop() {
     
     VP_LOG_INFO_F("Stopping pipeline: {}", config_.name);
     
-    // Stop blocks in reverse order: sources first, then others, then sinks
-    std::vector<BlockPtr> sinks, sources, others;
-    
-    for (const auto& pair : blocks_) {
-        auto source = std::dynamic_pointer_cast<IVideoSource>(pair.second);
-        auto sink = std::dynamic_pointer_cast<IVideoSink>(pair.second);
-        
-        if (source) {
-            sources.push_back(pair.second);
-        } else if (sink) {
-            sinks.push_back(pair.second);
-        } else {
-            others.push_back(pair.second);
-        }
-    }
-    
-    // Stop in reverse order
-    for (auto block : sources) {
-        block->Stop();
-    }
-    
-    for (auto block : others) {
-        block->Stop();
-    }
-    
-    for (auto block : sinks) {
-        block->Stop();
-    }
+    StopBlocks(topo_order_);
     
     is_running_.store(false);
     VP_LOG_INFO_F("Pipeline '{}' stopped", config_.name);
     return true;
 }
 
+void PipelineManager::StopBlocks(const std::vector<size_t>& order) {
+    for (size_t index : order) {
+        const auto& node = nodes_[index];
+        
+        // Everything upstream has stopped, so the queue only shrinks from here
+        if (node.sink && drain_timeout_.count() > 0 && !node.sink->Drain(drain_timeout_)) {
+            VP_LOG_WARNING_F("Block '{}' did not drain within {}ms, dropping queued frames",
+                             node.block->GetName(), drain_timeout_.count());
+        }
+        node.block->Stop();
+    }
+}
+
 bool PipelineManager::Shutdown() {
-    Stop();
+    std::lock_guard<std::mutex> graph_lock(graph_mutex_);
+    StopPipeline();
     
     std::lock_guard<std::mutex> lock(mutex_);
     
@@ -172,8 +178,15 @@ bool PipelineManager::Shutdown() {
     }
     
     blocks_.clear();
+    nodes_.clear();
+    edges_.clear();
+    topo_order_.clear();
+    format_plan_.clear();
+    routes_.clear();
     config_ = PipelineConfig{};
     
+    ReleaseExecution();
+    
     VP_LOG_INFO("Pipeline shutdown complete");
     return true;
 }
@@ -248,6 +261,33 @@ void PipelineManager::ResetAllStats() {
 }
 
 bool PipelineManager::LoadConfiguration(const std::string& config_file) {
+    PipelineConfig config;
+    if (!ReadConfiguration(config_file, config)) {
+        return false;
+    }
+    
+    return Initialize(config);
+}
+
+bool PipelineManager::LoadConfigurationFromString(const std::string& config_content, const std::string& format) {
+    PipelineConfig config;
+    if (!ParseConfiguration(config_content, format, config)) {
+        return false;
+    }
+    
+    return Initialize(config);
+}
+
+bool PipelineManager::ReloadConfiguration(const std::string& config_file) {
+    PipelineConfig config;
+    if (!ReadConfiguration(config_file, config)) {
+        return false;
+    }
+    
+    return Reconfigure(config);
+}
+
+bool PipelineManager::ReadConfiguration(const std::string& config_file, PipelineConfig& config) {
     // Read file content
     std::ifstream file(config_file);
     if (!file.is_open()) {
@@ -269,10 +309,11 @@ bool PipelineManager::LoadConfiguration(const std::string& config_file) {
         else if (ext == "ini" || ext == "conf") format = "simple";
     }
     
-    return LoadConfigurationFromString(buffer.str(), format);
+    return ParseConfiguration(buffer.str(), format, config);
 }
 
-bool PipelineManager::LoadConfigurationFromString(const std::string& config_content, const std::string& format) {
+bool PipelineManager::ParseConfiguration(const std::string& config_content, const std::string& format,
+                                         PipelineConfig& config) {
     auto parser = ConfigParserFactory::CreateParser(format);
     if (!parser) {
         last_error_ = "Unsupported configuration format: " + format;
@@ -280,14 +321,284 @@ bool PipelineManager::LoadConfigurationFromString(const std::string& config_cont
         return false;
     }
     
-    PipelineConfig config;
     if (!parser->Parse(config_content, config)) {
         last_error_ = "Failed to parse configuration: " + parser->GetLastError();
         VP_LOG_ERROR(last_error_);
         return false;
     }
     
-    return Initialize(config);
+    return true;
+}
+
+bool PipelineManager::Reconfigure(const PipelineConfig& config) {
+    std::lock_guard<std::mutex> graph_lock(graph_mutex_);
+    std::unique_lock<std::mutex> lock(mutex_);
+    
+    if (nodes_.empty()) {
+        last_error_ = "Cannot reconfigure: pipeline is not initialized";
+        VP_LOG_ERROR(last_error_);
+        return false;
+    }
+    
+    // Settings shape the whole pipeline (execution, affinity, negotiation)
+    std::set<std::string> setting_keys;
+    for (const auto& setting : config_.settings) setting_keys.insert(setting.first);
+    for (const auto& setting : config.settings) setting_keys.insert(setting.first);
+    for (const auto& key : setting_keys) {
+        auto old_it = config_.settings.find(key);
+        auto new_it = config.settings.find(key);
+        std::string old_value = old_it != config_.settings.end() ? old_it->second : std::string();
+        std::string new_value = new_it != config.settings.end() ? new_it->second : std::string();
+        if (key != "drain_timeout_ms" && old_value != new_value) {
+            last_error_ = "Setting '" + key + "' cannot change while the pipeline is initialized";
+            VP_LOG_ERROR(last_error_);
+            return false;
+        }
+    }
+    
+    // Blocks to create (new, or type or a non-hot parameter changed) and hot
+    // parameter updates for the blocks that stay
+    struct ParameterUpdate {
+        BlockPtr block;
+        std::string key;
+        std::string value;
+    };
+    std::map<std::string, const PipelineConfig::BlockDef*> old_defs;
+    for (const auto& block_def : config_.blocks) {
+        old_defs[block_def.name] = &block_def;
+    }
+    
+    std::vector<const PipelineConfig::BlockDef*> created;
+    std::vector<ParameterUpdate> updates;
+    std::set<std::string> names;
+    for (const auto& block_def : config.blocks) {
+        if (!names.insert(block_def.name).second) {
+            last_error_ = "Duplicate block name: " + block_def.name;
+            VP_LOG_ERROR(last_error_);
+            return false;
+        }
+        
+        auto old_it = old_defs.find(block_def.name);
+        if (old_it == old_defs.end() || old_it->second->type != block_def.type) {
+            created.push_back(&block_def);
+            continue;
+        }
+        
+        const auto& block = blocks_[block_def.name];
+        const auto& old_params = old_it->second->parameters;
+        std::set<std::string> keys;
+        for (const auto& param : old_params) keys.insert(param.first);
+        for (const auto& param : block_def.parameters) keys.insert(param.first);
+        
+        std::vector<ParameterUpdate> changes;
+        bool replace = false;
+        for (const auto& key : keys) {
+            auto old_param = old_params.find(key);
+            auto new_param = block_def.parameters.find(key);
+            if (old_param != old_params.end() && new_param != block_def.parameters.end() &&
+                old_param->second == new_param->second) {
+                continue;
+            }
+            if (new_param == block_def.parameters.end() || !block->IsHotParameter(key)) {
+                replace = true;
+                break;
+            }
+            changes.push_back(ParameterUpdate{block, key, new_param->second});
+        }
+        
+        if (replace) {
+            created.push_back(&block_def);
+        } else {
+            updates.insert(updates.end(), changes.begin(), changes.end());
+        }
+    }
+    
+    // Build new blocks aside, before anything running is touched
+    std::map<std::string, BlockPtr> fresh;
+    for (const auto* block_def : created) {
+        auto block = CreateConfiguredBlock(*block_def);
+        if (!block) {
+            for (const auto& pair : fresh) {
+                pair.second->Shutdown();
+            }
+            return false;
+        }
+        fresh[block_def->name] = block;
+    }
+    
+    // Rebuild the graph; the old one is kept to roll back to
+    PipelineConfig old_config = config_;
+    auto old_blocks = blocks_;
+    auto old_nodes = nodes_;
+    auto old_edges = edges_;
+    auto old_order = topo_order_;
+    auto old_plan = format_plan_;
+    auto old_drain_timeout = drain_timeout_;
+    
+    std::set<const IBlock*> previous;
+    for (const auto& node : old_nodes) {
+        previous.insert(node.block.get());
+        if (node.inserted) {
+            reusable_[node.block->GetName()] = node.block;
+        }
+    }
+    
+    config_ = config;
+    blocks_.clear();
+    for (const auto& block_def : config_.blocks) {
+        auto it = fresh.find(block_def.name);
+        blocks_[block_def.name] = it != fresh.end() ? it->second : old_blocks[block_def.name];
+    }
+    
+    // Undo everything up to publishing the new routes
+    auto roll_back = [&]() {
+        for (const auto& node : nodes_) {
+            if (!previous.count(node.block.get())) {
+                node.block->Stop();
+                node.block->Shutdown();
+                routes_.erase(node.block.get());
+            }
+        }
+        config_ = old_config;
+        blocks_ = old_blocks;
+        nodes_ = old_nodes;
+        edges_ = old_edges;
+        topo_order_ = old_order;
+        format_plan_ = old_plan;
+        drain_timeout_ = old_drain_timeout;
+        reusable_.clear();
+        
+        // Negotiation may have changed the input of blocks that are not running
+        for (size_t index : topo_order_) {
+            for (size_t e : nodes_[index].out_edges) {
+                FrameInfo output = nodes_[index].source->GetOutputFormat();
+                const auto& downstream = nodes_[edges_[e].to];
+                if (downstream.block->GetState() != BlockState::RUNNING &&
+                    downstream.sink->SupportsFormat(output.pixel_format)) {
+                    downstream.sink->SetInputFormat(output);
+                }
+            }
+        }
+        VP_LOG_WARNING_F("Reconfiguration of pipeline '{}' rolled back", config_.name);
+    };
+    
+    if (!BuildGraph() || !NegotiateFormats() || !FuseTransforms()) {
+        roll_back();
+        return false;
+    }
+    reusable_.clear();
+    
+    std::vector<size_t> joining;
+    std::set<const IBlock*> kept;
+    for (size_t index : topo_order_) {
+        kept.insert(nodes_[index].block.get());
+        if (!previous.count(nodes_[index].block.get())) {
+            joining.push_back(index);
+        }
+    }
+    
+    for (size_t index : joining) {
+        auto block = std::dynamic_pointer_cast<BaseBlock>(nodes_[index].block);
+        if (block && executor_) {
+            block->SetExecutor(executor_, executor_group_);
+        }
+        if (block && frame_pool_) {
+            block->SetFramePool(frame_pool_, frame_pool_client_);
+        }
+    }
+    
+    std::vector<std::pair<std::shared_ptr<Route>, TargetList>> deferred;
+    if (!ConfigureAffinity() || !ConnectBlocks(&deferred)) {
+        roll_back();
+        return false;
+    }
+    
+    // New blocks start downstream first, before any frame can reach them
+    bool running = is_running_.load();
+    if (running) {
+        for (auto it = joining.rbegin(); it != joining.rend(); ++it) {
+            const auto& block = nodes_[*it].block;
+            if (!block->Start()) {
+                last_error_ = "Failed to start block: " + block->GetName();
+                VP_LOG_ERROR(last_error_);
+                roll_back();
+                return false;
+            }
+        }
+    }
+    
+    // Existing sources switch to their new connections at the next frame
+    std::vector<TargetList> replaced;
+    for (auto& route : deferred) {
+        replaced.push_back(PublishRoute(*route.first, std::move(route.second)));
+    }
+    
+    // Wait out frames already being delivered to the old targets, so a block
+    // that leaves the graph receives nothing once it is retired. A delivery
+    // may wait on a full queue, so status calls are not held up meanwhile;
+    // graph_mutex_ keeps Start(), Stop() and other graph changes out, so the
+    // pipeline is still running (or not) as `running` says afterwards.
+    lock.unlock();
+    bool switched = WaitForRoutes(replaced, kRouteSwitchTimeout);
+    lock.lock();
+    if (!switched) {
+        for (size_t i = 0; i < deferred.size(); ++i) {
+            PublishRoute(*deferred[i].first, replaced[i]);
+        }
+        last_error_ = "Sources did not finish delivering to their old connections within " +
+                      std::to_string(kRouteSwitchTimeout.count()) + "ms";
+        VP_LOG_ERROR(last_error_);
+        roll_back();
+        return false;
+    }
+    replaced.clear();
+    
+    // Retire blocks that left the graph, upstream first, so each drains into
+    // consumers that are still running
+    size_t retired = 0;
+    for (size_t index : old_order) {
+        const auto& node = old_nodes[index];
+        if (kept.count(node.block.get())) {
+            continue;
+        }
+        if (running && node.sink && drain_timeout_.count() > 0 && !node.sink->Drain(drain_timeout_)) {
+            VP_LOG_WARNING_F("Block '{}' did not drain within {}ms, dropping queued frames",
+                             node.block->GetName(), drain_timeout_.count());
+        }
+        node.block->Stop();
+        node.block->Shutdown();
+        routes_.erase(node.block.get());
+        retired++;
+    }
+    
+    // A fused chain runs with its first member's queue settings
+    std::map<const IBlock*, BlockPtr> fused_heads;
+    for (const auto& node : nodes_) {
+        if (node.fused) {
+            auto* fused = dynamic_cast<FusedTransform*>(node.block.get());
+            fused_heads[fused->GetStages().front().get()] = node.block;
+        }
+    }
+    
+    for (const auto& update : updates) {
+        if (!update.block->UpdateParameter(update.key, update.value)) {
+            VP_LOG_WARNING_F("Block '{}' did not accept {} = {}", update.block->GetName(), update.key, update.value);
+        }
+        auto head = fused_heads.find(update.block.get());
+        if (head != fused_heads.end() && head->second->IsHotParameter(update.key)) {
+            head->second->UpdateParameter(update.key, update.value);
+        }
+    }
+    
+    VP_LOG_INFO_F("Pipeline '{}' reconfigured: {} blocks added, {} removed, {} parameters updated",
+                  config_.name, joining.size(), retired, updates.size());
+    return true;
+}
+
+void PipelineManager::SetSharedResources(std::shared_ptr<Executor> executor, std::shared_ptr<FramePool> frame_pool) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shared_executor_ = std::move(executor);
+    frame_pool_ = std::move(frame_pool);
 }
 
 void PipelineManager::SetErrorCallback(ErrorCallback callback) {
@@ -299,6 +610,11 @@ std::string PipelineManager::GetLastError() const {
     return last_error_;
 }
 
+std::vector<std::string> PipelineManager::GetFormatPlan() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return format_plan_;
+}
+
 bool PipelineManager::CreateBlocks() {
     blocks_.clear();
     
@@ -351,57 +667,970 @@ bool PipelineManager::ConfigureBlocks() {
     return true;
 }
 
-bool PipelineManager::ConnectBlocks() {
+BlockPtr PipelineManager::CreateConfiguredBlock(const PipelineConfig::BlockDef& block_def) {
+    auto block = BlockRegistry::Instance().CreateBlock(block_def.type, block_def.name);
+    if (!block) {
+        last_error_ = "Failed to create block '" + block_def.name + "' of type '" + block_def.type + "'";
+        VP_LOG_ERROR(last_error_);
+        return nullptr;
+    }
+    
+    block->SetErrorCallback(error_callback_);
+    for (const auto& param : block_def.parameters) {
+        block->SetParameter(param.first, param.second);
+    }
+    
+    if (!block->Initialize(block_def.parameters)) {
+        last_error_ = "Failed to initialize block '" + block_def.name + "': " + block->GetLastError();
+        VP_LOG_ERROR(last_error_);
+        block->Shutdown();
+        return nullptr;
+    }
+    
+    return block;
+}
+
+bool PipelineManager::BuildGraph() {
+    nodes_.clear();
+    edges_.clear();
+    topo_order_.clear();
+    
+    std::map<std::string, size_t> index;
+    for (const auto& block_def : config_.blocks) {
+        GraphNode node;
+        node.block = blocks_[block_def.name];
+        node.source = dynamic_cast<IVideoSource*>(node.block.get());
+        node.sink = dynamic_cast<IVideoSink*>(node.block.get());
+        index[block_def.name] = nodes_.size();
+        nodes_.push_back(std::move(node));
+    }
+    
     for (const auto& connection : config_.connections) {
-        VP_LOG_DEBUG_F("Connecting: {}", connection.ToString());
-        
-        auto source_block = blocks_.find(connection.source_block);
-        auto sink_block = blocks_.find(connection.sink_block);
+        auto source_it = index.find(connection.source_block);
+        auto sink_it = index.find(connection.sink_block);
         
-        if (source_block == blocks_.end()) {
+        if (source_it == index.end()) {
             last_error_ = "Source block not found: " + connection.source_block;
             VP_LOG_ERROR(last_error_);
             return false;
         }
         
-        if (sink_block == blocks_.end()) {
+        if (sink_it == index.end()) {
             last_error_ = "Sink block not found: " + connection.sink_block;
             VP_LOG_ERROR(last_error_);
             return false;
         }
         
-        // Connect source to sink
-        auto source = std::dynamic_pointer_cast<IVideoSource>(source_block->second);
-        auto sink = std::dynamic_pointer_cast<IVideoSink>(sink_block->second);
+        size_t from = source_it->second;
+        size_t to = sink_it->second;
         
-        if (!source) {
+        if (!nodes_[from].source) {
             last_error_ = "Block '" + connection.source_block + "' is not a video source";
             VP_LOG_ERROR(last_error_);
             return false;
         }
         
-        if (!sink) {
+        if (!nodes_[to].sink) {
             last_error_ = "Block '" + connection.sink_block + "' is not a video sink";
             VP_LOG_ERROR(last_error_);
             return false;
         }
         
-        // Set up frame callback
-        source->SetFrameCallback([sink](VideoFramePtr frame) {
-            sink->ProcessFrame(frame);
+        // Blocks have a single output; inputs are named by the sink
+        if (connection.source_output != "output") {
+            last_error_ = "Block '" + connection.source_block + "' has no output port '" + connection.source_output + "'";
+            VP_LOG_ERROR(last_error_);
+            return false;
+        }
+        
+        auto ports = nodes_[to].sink->GetInputPorts();
+        auto port = std::find(ports.begin(), ports.end(), connection.sink_input);
+        if (port == ports.end()) {
+            std::string names;
+            for (const auto& name : ports) {
+                names += (names.empty() ? "" : ", ") + name;
+            }
+            last_error_ = "Block '" + connection.sink_block + "' has no input port '" + connection.sink_input +
+                          "' (inputs: " + names + ")";
+            VP_LOG_ERROR(last_error_);
+            return false;
+        }
+        size_t port_index = static_cast<size_t>(port - ports.begin());
+        
+        for (size_t e : nodes_[from].out_edges) {
+            if (edges_[e].to == to && edges_[e].policy.port == port_index) {
+                last_error_ = "Duplicate connection: " + connection.ToString();
+                VP_LOG_ERROR(last_error_);
+                return false;
+            }
+        }
+        
+        // Several connections may feed a block's only input, but each of a
+        // multi-input block's ports takes one
+        if (ports.size() > 1) {
+            for (const auto& edge : edges_) {
+                if (edge.to == to && edge.policy.port == port_index) {
+                    last_error_ = "Input '" + connection.sink_input + "' of block '" + connection.sink_block +
+                                  "' is already connected: " + connection.ToString();
+                    VP_LOG_ERROR(last_error_);
+                    return false;
+                }
+            }
+        }
+        
+        // Per-connection delivery policy, defaulting to the sink's own behaviour
+        EdgePolicy policy;
+        if (connection.drop_policy.empty()) {
+            policy.drop = nodes_[to].sink->IsBlocking() ? DropPolicy::BLOCK : DropPolicy::DROP_OLDEST;
+        } else if (!ParseDropPolicy(connection.drop_policy, policy.drop)) {
+            last_error_ = "Unknown drop policy '" + connection.drop_policy + "' on " + connection.ToString();
+            VP_LOG_ERROR(last_error_);
+            return false;
+        }
+        policy.block_timeout = std::chrono::milliseconds(connection.block_timeout_ms);
+        policy.port = port_index;
+        
+        nodes_[from].out_edges.push_back(edges_.size());
+        nodes_[to].in_degree++;
+        edges_.push_back(GraphEdge{from, to, policy});
+    }
+    
+    // Kahn's algorithm; blocks that become ready together keep configuration order
+    std::vector<size_t> in_degree(nodes_.size());
+    std::deque<size_t> ready;
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        in_degree[i] = nodes_[i].in_degree;
+        if (in_degree[i] == 0) {
+            ready.push_back(i);
+        }
+    }
+    
+    while (!ready.empty()) {
+        size_t i = ready.front();
+        ready.pop_front();
+        topo_order_.push_back(i);
+        for (size_t e : nodes_[i].out_edges) {
+            if (--in_degree[edges_[e].to] == 0) {
+                ready.push_back(edges_[e].to);
+            }
+        }
+    }
+    
+    if (topo_order_.size() != nodes_.size()) {
+        // Unsorted blocks are on a cycle or downstream of one; peel off the
+        // latter (no edge back into the unsorted set) to name only the cycle
+        std::vector<bool> on_cycle(nodes_.size());
+        for (size_t i = 0; i < nodes_.size(); ++i) {
+            on_cycle[i] = in_degree[i] > 0;
+        }
+        for (bool changed = true; changed;) {
+            changed = false;
+            for (size_t i = 0; i < nodes_.size(); ++i) {
+                bool feeds_cycle = std::any_of(nodes_[i].out_edges.begin(), nodes_[i].out_edges.end(),
+                                               [&](size_t e) { return on_cycle[edges_[e].to]; });
+                if (on_cycle[i] && !feeds_cycle) {
+                    on_cycle[i] = false;
+                    changed = true;
+                }
+            }
+        }
+        
+        std::string blocks;
+        for (size_t i = 0; i < nodes_.size(); ++i) {
+            if (on_cycle[i]) {
+                blocks += (blocks.empty() ? "" : ", ") + nodes_[i].block->GetName();
+            }
+        }
+        last_error_ = "Connections form a cycle through: " + blocks;
+        VP_LOG_ERROR(last_error_);
+        return false;
+    }
+    
+    for (const auto& node : nodes_) {
+        if (node.sink && !node.source && node.in_degree == 0) {
+            VP_LOG_WARNING_F("Block '{}' has no input connection", node.block->GetName());
+        } else if (node.source && node.out_edges.empty()) {
+            VP_LOG_WARNING_F("Block '{}' output is not connected, its frames are discarded", node.block->GetName());
+        }
+    }
+    
+    std::string drain_str = GetSetting("drain_timeout_ms");
+    drain_timeout_ = std::chrono::milliseconds(drain_str.empty() ? 500 : std::stoul(drain_str));
+    
+    return true;
+}
+
+bool PipelineManager::NegotiateFormats() {
+    std::string mode = GetSetting("format_negotiation");
+    bool convert = mode.empty() || mode == "auto";
+    if (!convert && mode != "off") {
+        last_error_ = "Unknown format_negotiation mode: " + mode + " (expected auto or off)";
+        VP_LOG_ERROR(last_error_);
+        return false;
+    }
+    
+    // Upstream first, so a processor's output format follows its input before
+    // it is passed on. Inserted converters are placed right after their
+    // upstream block and negotiated in turn.
+    for (size_t position = 0; position < topo_order_.size(); ++position) {
+        size_t index = topo_order_[position];
+        if (nodes_[index].out_edges.empty()) {
+            continue;
+        }
+        
+        FrameInfo output = nodes_[index].source->GetOutputFormat();
+        
+        // Connections needing the same input share one conversion chain
+        std::map<std::tuple<PixelFormat, uint32_t, uint32_t>, size_t> chains;
+        std::vector<size_t> out_edges = nodes_[index].out_edges;
+        
+        for (size_t e : out_edges) {
+            size_t to = edges_[e].to;
+            IVideoSink* sink = nodes_[to].sink;
+            
+            if (!convert) {
+                if (sink->SupportsFormat(output.pixel_format)) {
+                    if (nodes_[to].block->GetState() != BlockState::RUNNING) {
+                        sink->SetInputFormat(output);
+                    }
+                } else {
+                    VP_LOG_WARNING_F("Format mismatch between '{}' and '{}'",
+                                     nodes_[index].block->GetName(), nodes_[to].block->GetName());
+                }
+                continue;
+            }
+            
+            FrameInfo input;
+            if (!ChooseInputFormat(output, *sink, input)) {
+                last_error_ = "No conversion from " + nodes_[index].block->GetName() + " output (" + output.ToString() +
+                              ") to a format block '" + nodes_[to].block->GetName() + "' accepts";
+                VP_LOG_ERROR(last_error_);
+                return false;
+            }
+            
+            if (input.pixel_format == output.pixel_format && input.width == output.width && input.height == output.height) {
+                if (!SetNodeInputFormat(to, output)) {
+                    return false;
+                }
+                continue;
+            }
+            
+            if (nodes_[index].inserted) {
+                last_error_ = "Converter '" + nodes_[index].block->GetName() + "' output (" + output.ToString() +
+                              ") is not accepted by block '" + nodes_[to].block->GetName() + "'";
+                VP_LOG_ERROR(last_error_);
+                return false;
+            }
+            
+            EdgePolicy policy = edges_[e].policy;   // edges_ grows below
+            auto key = std::make_tuple(input.pixel_format, input.width, input.height);
+            auto chain = chains.find(key);
+            size_t last;
+            if (chain != chains.end()) {
+                last = chain->second;
+            } else if (InsertConversion(index, output, input, position, policy, last)) {
+                chains[key] = last;
+            } else {
+                return false;
+            }
+            
+            // The connection now leaves from the end of the chain
+            auto& from_edges = nodes_[index].out_edges;
+            from_edges.erase(std::find(from_edges.begin(), from_edges.end(), e));
+            edges_[e].from = last;
+            nodes_[last].out_edges.push_back(e);
+        }
+    }
+    
+    return true;
+}
+
+bool PipelineManager::FuseTransforms() {
+    std::string mode = GetSetting("transform_fusion");
+    if (mode == "off") {
+        RecordFormatPlan();
+        return true;
+    }
+    if (!mode.empty() && mode != "auto") {
+        last_error_ = "Unknown transform_fusion mode: " + mode + " (expected auto or off)";
+        VP_LOG_ERROR(last_error_);
+        return false;
+    }
+    
+    // A block already running on its own (during Reconfigure) stays that way
+    auto row_stage = [&](size_t index) -> std::unique_ptr<RowStage> {
+        auto* processor = dynamic_cast<BaseVideoProcessor*>(nodes_[index].block.get());
+        if (!processor || processor->GetState() == BlockState::RUNNING) {
+            return nullptr;
+        }
+        return processor->CreateRowStage();
+    };
+    
+    // Maximal runs of fusable blocks linked one to one, upstream first
+    std::vector<std::vector<size_t>> chains;
+    std::vector<bool> visited(nodes_.size(), false);
+    for (size_t index : topo_order_) {
+        std::vector<size_t> chain;
+        std::vector<bool> views;
+        for (size_t next = index; !visited[next];) {
+            auto stage = row_stage(next);
+            if (!stage) {
+                break;
+            }
+            visited[next] = true;
+            chain.push_back(next);
+            views.push_back(stage->IsView());
+            
+            const auto& out_edges = nodes_[next].out_edges;
+            if (out_edges.size() != 1 || nodes_[edges_[out_edges[0]].to].in_degree != 1) {
+                break;
+            }
+            next = edges_[out_edges[0]].to;
+        }
+        
+        // Crops at either end stay zero-copy views of their own; fusion pays
+        // off once two stages compute pixels
+        while (!views.empty() && views.front()) {
+            chain.erase(chain.begin());
+            views.erase(views.begin());
+        }
+        while (!views.empty() && views.back()) {
+            chain.pop_back();
+            views.pop_back();
+        }
+        if (std::count(views.begin(), views.end(), false) >= 2) {
+            chains.push_back(std::move(chain));
+        }
+    }
+    
+    // Queue and thread settings come from the first block, output buffer
+    // settings from the last
+    static const char* const kHeadParameters[] = {
+        "queue_depth", "blocking", "wait_strategy", "spin_us", "executor_priority", "executor_worker",
+        "cpu_affinity", "sched_policy", "sched_priority", "thread_name"
+    };
+    static const char* const kTailParameters[] = {
+        "buffer_count", "huge_pages", "prefault", "lock_memory", "shareable"
+    };
+    
+    std::vector<bool> dead_node(nodes_.size(), false);
+    std::vector<bool> dead_edge(edges_.size(), false);
+    for (const auto& chain : chains) {
+        size_t head = chain.front();
+        size_t tail = chain.back();
+        
+        // During Reconfigure() a chain whose members all stayed keeps running
+        // in the FusedTransform it already has
+        std::shared_ptr<FusedTransform> fused = TakeReusableFusion(chain);
+        if (fused) {
+            ReplaceWithFusion(chain, fused, dead_node, dead_edge);
+            VP_LOG_INFO_F("Keeping fused block '{}'", fused->GetName());
+            continue;
+        }
+        
+        fused = std::make_shared<FusedTransform>();
+        std::string name;
+        size_t threads = 1;
+        for (size_t index : chain) {
+            const auto& block = nodes_[index].block;
+            name += (name.empty() ? "" : "+") + block->GetName();
+            std::string threads_str = block->GetParameter("threads");
+            if (!threads_str.empty()) {
+                threads = std::max<size_t>(threads, std::stoul(threads_str));
+            }
+            fused->AddStage(std::dynamic_pointer_cast<BaseVideoProcessor>(block));
+        }
+        std::string base = name;
+        for (int suffix = 2; blocks_.count(name); ++suffix) {
+            name = base + "_" + std::to_string(suffix);
+        }
+        
+        BlockParams params;
+        for (const char* key : kHeadParameters) {
+            std::string value = nodes_[head].block->GetParameter(key);
+            if (!value.empty()) {
+                params[key] = value;
+            }
+        }
+        for (const char* key : kTailParameters) {
+            std::string value = nodes_[tail].block->GetParameter(key);
+            if (!value.empty()) {
+                params[key] = value;
+            }
+        }
+        params["threads"] = std::to_string(threads);
+        std::string strip_str = GetSetting("fusion_strip_rows");
+        if (!strip_str.empty()) {
+            params["strip_rows"] = strip_str;
+        }
+        
+        fused->SetName(name);
+        fused->SetErrorCallback(error_callback_);
+        for (const auto& param : params) {
+            fused->SetParameter(param.first, param.second);
+        }
+        if (!fused->Initialize(params)) {
+            last_error_ = "Failed to initialize fused block '" + name + "': " + fused->GetLastError();
+            VP_LOG_ERROR(last_error_);
+            return false;
+        }
+        fused->SetInputFormat(nodes_[head].sink->GetInputFormat());
+        
+        // The chain must come out the same either way
+        FrameInfo expected = nodes_[tail].source->GetOutputFormat();
+        FrameInfo output = fused->GetOutputFormat();
+        if (output.pixel_format != expected.pixel_format || output.width != expected.width ||
+            output.height != expected.height) {
+            VP_LOG_WARNING_F("Not fusing {}: fused output {} differs from {}", name, output.ToString(),
+                             expected.ToString());
+            fused->Shutdown();
+            continue;
+        }
+        
+        ReplaceWithFusion(chain, fused, dead_node, dead_edge);
+        VP_LOG_INFO_F("Fused {} blocks into '{}'", chain.size(), name);
+    }
+    
+    // Drop the fused-away nodes and the connections between them
+    std::vector<size_t> node_map(nodes_.size());
+    std::vector<size_t> edge_map(edges_.size());
+    std::vector<GraphNode> nodes;
+    std::vector<GraphEdge> edges;
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        if (!dead_node[i]) {
+            node_map[i] = nodes.size();
+            nodes.push_back(std::move(nodes_[i]));
+        }
+    }
+    for (size_t e = 0; e < edges_.size(); ++e) {
+        if (!dead_edge[e]) {
+            edge_map[e] = edges.size();
+            edges.push_back(GraphEdge{node_map[edges_[e].from], node_map[edges_[e].to], edges_[e].policy});
+        }
+    }
+    for (auto& node : nodes) {
+        for (auto& e : node.out_edges) {
+            e = edge_map[e];
+        }
+    }
+    std::vector<size_t> order;
+    for (size_t index : topo_order_) {
+        if (!dead_node[index]) {
+            order.push_back(node_map[index]);
+        }
+    }
+    nodes_ = std::move(nodes);
+    edges_ = std::move(edges);
+    topo_order_ = std::move(order);
+    
+    RecordFormatPlan();
+    return true;
+}
+
+void PipelineManager::ReplaceWithFusion(const std::vector<size_t>& chain, const std::shared_ptr<FusedTransform>& fused,
+                                        std::vector<bool>& dead_node, std::vector<bool>& dead_edge) {
+    size_t head = chain.front();
+    size_t tail = chain.back();
+    
+    // The fused block takes the head's place and the tail's connections
+    for (size_t index : chain) {
+        if (index != tail) {
+            dead_edge[nodes_[index].out_edges[0]] = true;
+        }
+        if (index != head) {
+            dead_node[index] = true;
+        }
+    }
+    GraphNode& node = nodes_[head];
+    node.block = fused;
+    node.source = fused.get();
+    node.sink = fused.get();
+    node.out_edges = nodes_[tail].out_edges;
+    node.inserted = true;
+    node.fused = true;
+    for (size_t e : node.out_edges) {
+        edges_[e].from = head;
+    }
+    blocks_[fused->GetName()] = fused;
+}
+
+std::shared_ptr<FusedTransform> PipelineManager::TakeReusableFusion(const std::vector<size_t>& chain) {
+    FrameInfo input = nodes_[chain.front()].sink->GetInputFormat();
+    for (auto it = reusable_.begin(); it != reusable_.end(); ++it) {
+        auto fused = std::dynamic_pointer_cast<FusedTransform>(it->second);
+        if (!fused || fused->GetStages().size() != chain.size()) {
+            continue;
+        }
+        
+        // The same block objects: a member whose settings changed was replaced
+        bool same = true;
+        for (size_t i = 0; i < chain.size() && same; ++i) {
+            same = fused->GetStages()[i].get() == nodes_[chain[i]].block.get();
+        }
+        FrameInfo current = fused->GetInputFormat();
+        if (!same || current.pixel_format != input.pixel_format || current.width != input.width ||
+            current.height != input.height) {
+            continue;
+        }
+        
+        reusable_.erase(it);
+        return fused;
+    }
+    return nullptr;
+}
+
+void PipelineManager::RecordFormatPlan() {
+    format_plan_.clear();
+    
+    for (size_t index : topo_order_) {
+        const auto& node = nodes_[index];
+        if (node.out_edges.empty()) {
+            continue;
+        }
+        
+        FrameInfo output = node.source->GetOutputFormat();
+        for (size_t e : node.out_edges) {
+            const auto& to = nodes_[edges_[e].to];
+            auto ports = to.sink->GetInputPorts();
+            std::string sink = to.block->GetName();
+            if (ports.size() > 1) {
+                sink += "." + ports[edges_[e].policy.port];
+            }
+            std::string line = node.block->GetName() + " -> " + sink + ": " +
+                               std::to_string(output.width) + "x" + std::to_string(output.height) + " " +
+                               PixelFormatToString(output.pixel_format);
+            if (node.fused) {
+                line += " (fused)";
+            } else if (node.inserted) {
+                line += " (converted)";
+            }
+            VP_LOG_INFO_F("Format plan: {}", line);
+            format_plan_.push_back(std::move(line));
+        }
+    }
+}
+
+bool PipelineManager::ChooseInputFormat(const FrameInfo& output, const IVideoSink& sink, FrameInfo& input) const {
+    input = output;
+    
+    // Zero-copy passthrough if the sink takes the format as is, otherwise the
+    // cheapest conversion; ties go to the sink's preferred format
+    if (!sink.AcceptsFormat(output.pixel_format)) {
+        int best = -1;
+        for (PixelFormat format : sink.GetAcceptedFormats()) {
+            int cost = ColorConvert::ConversionCost(output.pixel_format, format);
+            if (cost >= 0 && (best < 0 || cost < best) && sink.AcceptsFormat(format)) {
+                best = cost;
+                input.pixel_format = format;
+            }
+        }
+        if (best < 0) {
+            return false;
+        }
+    }
+    
+    // Smallest accepted resolution that needs no downscaling, else the largest
+    auto resolutions = sink.GetAcceptedResolutions();
+    auto size = std::make_pair(output.width, output.height);
+    if (resolutions.empty() || std::find(resolutions.begin(), resolutions.end(), size) != resolutions.end()) {
+        return true;
+    }
+    if (IsCompressedFormat(output.pixel_format)) {
+        return false;
+    }
+    
+    auto area = [](const std::pair<uint32_t, uint32_t>& r) { return static_cast<uint64_t>(r.first) * r.second; };
+    const std::pair<uint32_t, uint32_t>* covering = nullptr;
+    const std::pair<uint32_t, uint32_t>* largest = nullptr;
+    for (const auto& r : resolutions) {
+        if (r.first >= output.width && r.second >= output.height && (!covering || area(r) < area(*covering))) {
+            covering = &r;
+        }
+        if (!largest || area(r) > area(*largest)) {
+            largest = &r;
+        }
+    }
+    const auto& chosen = covering ? *covering : *largest;
+    input.width = chosen.first;
+    input.height = chosen.second;
+    return true;
+}
+
+bool PipelineManager::InsertConversion(size_t from, const FrameInfo& output, const FrameInfo& input,
+                                       size_t topo_position, const EdgePolicy& policy, size_t& last) {
+    bool scale = input.width != output.width || input.height != output.height;
+    bool convert = input.pixel_format != output.pixel_format;
+    
+    // Convert as few pixels as possible: shrink before converting, enlarge after
+    std::vector<std::string> steps;
+    if (scale && convert && static_cast<uint64_t>(input.width) * input.height <
+                            static_cast<uint64_t>(output.width) * output.height) {
+        steps = {"Scale", "ColorConvert"};
+    } else {
+        if (convert) steps.push_back("ColorConvert");
+        if (scale) steps.push_back("Scale");
+    }
+    
+    auto& registry = BlockRegistry::Instance();
+    const std::string& from_name = nodes_[from].block->GetName();
+    
+    last = from;
+    FrameInfo format = output;
+    for (size_t step = 0; step < steps.size(); ++step) {
+        const std::string& type = steps[step];
+        
+        BlockParams params;
+        std::string name;
+        if (type == "Scale") {
+            params["width"] = std::to_string(input.width);
+            params["height"] = std::to_string(input.height);
+            name = from_name + "_" + params["width"] + "x" + params["height"];
+        } else {
+            params["format"] = PixelFormatToString(input.pixel_format);
+            name = from_name + "_to_" + params["format"];
+            std::transform(name.begin(), name.end(), name.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        }
+        std::string base = name;
+        for (int suffix = 2; blocks_.count(name); ++suffix) {
+            name = base + "_" + std::to_string(suffix);
+        }
+        
+        // Reconfigure() keeps a converter the old graph already had in place
+        auto block = TakeReusableBlock(name, type, params, format);
+        bool reused = block != nullptr;
+        if (!reused) {
+            block = registry.CreateBlock(type, name);
+            if (!block) {
+                last_error_ = "Format negotiation needs block type '" + type + "' to convert " + from_name + " output";
+                VP_LOG_ERROR(last_error_);
+                return false;
+            }
+            block->SetErrorCallback(error_callback_);
+            for (const auto& param : params) {
+                block->SetParameter(param.first, param.second);
+            }
+            if (!block->Initialize(params)) {
+                last_error_ = "Failed to initialize inserted block '" + name + "': " + block->GetLastError();
+                VP_LOG_ERROR(last_error_);
+                return false;
+            }
+        }
+        
+        GraphNode node;
+        node.block = block;
+        node.source = dynamic_cast<IVideoSource*>(block.get());
+        node.sink = dynamic_cast<IVideoSink*>(block.get());
+        node.inserted = true;
+        node.in_degree = 1;
+        size_t index = nodes_.size();
+        nodes_.push_back(std::move(node));
+        blocks_[name] = block;
+        
+        // Converters have one input; the connection's own port stays on its last hop
+        EdgePolicy hop = policy;
+        hop.port = 0;
+        nodes_[last].out_edges.push_back(edges_.size());
+        edges_.push_back(GraphEdge{last, index, hop});
+        topo_order_.insert(topo_order_.begin() + topo_position + 1 + step, index);
+        
+        if (!reused) {
+            nodes_[index].sink->SetInputFormat(format);
+            VP_LOG_INFO_F("Inserted {} '{}' after '{}'", type, name, from_name);
+        }
+        format = nodes_[index].source->GetOutputFormat();
+        last = index;
+    }
+    
+    return true;
+}
+
+bool PipelineManager::SetNodeInputFormat(size_t index, const FrameInfo& format) {
+    const auto& node = nodes_[index];
+    if (node.block->GetState() != BlockState::RUNNING) {
+        node.sink->SetInputFormat(format);
+        return true;
+    }
+    
+    // Multi-input blocks adapt to every frame's size, but not to other formats
+    if (node.sink->GetInputPorts().size() > 1 && node.sink->AcceptsFormat(format.pixel_format)) {
+        return true;
+    }
+    
+    FrameInfo current = node.sink->GetInputFormat();
+    if (current.pixel_format == format.pixel_format && current.width == format.width && current.height == format.height) {
+        return true;
+    }
+    
+    last_error_ = "Block '" + node.block->GetName() + "' is running with input " + current.ToString() +
+                  ", the new configuration would change it to " + format.ToString();
+    VP_LOG_ERROR(last_error_);
+    return false;
+}
+
+BlockPtr PipelineManager::TakeReusableBlock(const std::string& name, const std::string& type,
+                                            const BlockParams& params, const FrameInfo& input) {
+    auto it = reusable_.find(name);
+    if (it == reusable_.end()) {
+        return nullptr;
+    }
+    
+    BlockPtr block = it->second;
+    auto* sink = dynamic_cast<IVideoSink*>(block.get());
+    FrameInfo current = sink ? sink->GetInputFormat() : FrameInfo{};
+    if (block->GetType() != type || !sink || current.pixel_format != input.pixel_format ||
+        current.width != input.width || current.height != input.height) {
+        return nullptr;
+    }
+    for (const auto& param : params) {
+        if (block->GetParameter(param.first) != param.second) {
+            return nullptr;
+        }
+    }
+    
+    reusable_.erase(it);
+    return block;
+}
+
+bool PipelineManager::ConnectBlocks(std::vector<std::pair<std::shared_ptr<Route>, TargetList>>* deferred) {
+    for (size_t index : topo_order_) {
+        const auto& node = nodes_[index];
+        if (!node.source) {
+            continue;
+        }
+        
+        auto targets = std::make_shared<std::vector<Target>>();
+        for (size_t e : node.out_edges) {
+            const auto& edge = edges_[e];
+            const auto& downstream = nodes_[edge.to];
+            targets->emplace_back(std::shared_ptr<IVideoSink>(downstream.block, downstream.sink), edge.policy);
+        }
+        
+        auto& route = routes_[node.block.get()];
+        if (route) {
+            // Already wired up: only the targets change
+            if (deferred) {
+                deferred->emplace_back(route, std::move(targets));
+            } else {
+                PublishRoute(*route, std::move(targets));
+            }
+            continue;
+        }
+        
+        route = std::make_shared<Route>();
+        route->targets = std::move(targets);
+        
+        // Frame callback and the credit signal back to the source. On fan-out
+        // every connection gets a reference to the same frame.
+        node.source->SetFrameCallback([route](VideoFramePtr frame) {
+            auto targets = std::atomic_load(&route->targets);
+            if (targets->empty()) {
+                return;
+            }
+            for (size_t i = 0; i + 1 < targets->size(); ++i) {
+                (*targets)[i].first->PushFrame(frame, (*targets)[i].second);
+            }
+            targets->back().first->PushFrame(std::move(frame), targets->back().second);
+        });
+        node.source->SetCreditProbe([route]() {
+            auto targets = std::atomic_load(&route->targets);
+            if (targets->empty()) {
+                return true;
+            }
+            for (const auto& target : *targets) {
+                if (target.first->HasCapacity(target.second)) {
+                    return true;
+                }
+            }
+            return false;
         });
+    }
+    
+    VP_LOG_INFO_F("Connected {} block pairs", edges_.size());
+    return true;
+}
+
+PipelineManager::TargetList PipelineManager::PublishRoute(Route& route, TargetList targets) {
+    return std::atomic_exchange(&route.targets, std::move(targets));
+}
+
+bool PipelineManager::WaitForRoutes(const std::vector<TargetList>& replaced, std::chrono::milliseconds timeout) {
+    // A delivery holds the list it loaded until it returns
+    auto in_use = [&replaced] {
+        return std::any_of(replaced.begin(), replaced.end(),
+                           [](const TargetList& targets) { return targets.use_count() > 1; });
+    };
+    
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + timeout;
+    while (in_use()) {
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline) {
+            return false;
+        }
+        // Deliveries normally finish within microseconds; one stuck on a full
+        // queue is waited for without spinning
+        if (now - start < std::chrono::milliseconds(1)) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    return true;
+}
+
+std::string PipelineManager::GetSetting(const std::string& key) const {
+    auto it = config_.settings.find(key);
+    return (it != config_.settings.end()) ? it->second : std::string();
+}
+
+void PipelineManager::ReleaseExecution() {
+    // A shared executor and frame pool belong to the host, which keeps them
+    // for other pipelines; only this pipeline's group and client go
+    if (executor_ && executor_ == shared_executor_) {
+        executor_->RemoveGroup(executor_group_);
+    } else if (executor_) {
+        executor_->Shutdown();
+    }
+    if (frame_pool_) {
+        frame_pool_->RemoveClient(frame_pool_client_);
+    }
+    
+    executor_.reset();
+    executor_group_ = 0;
+    frame_pool_client_ = 0;
+}
+
+bool PipelineManager::ConfigureExecution() {
+    ReleaseExecution();
+    
+    std::string mode = GetSetting("execution");
+    if (mode.empty()) {
+        // Pipelines sharing an executor run on it unless told otherwise
+        mode = shared_executor_ ? "scheduled" : "threads";
+    }
+    
+    if (mode != "threads" && mode != "scheduled") {
+        last_error_ = "Unknown execution mode: " + mode + " (expected threads or scheduled)";
+        VP_LOG_ERROR(last_error_);
+        return false;
+    }
+    
+    if (frame_pool_) {
+        std::string quota_str = GetSetting("memory_quota_mb");
+        size_t quota = quota_str.empty() ? 0 : std::stoul(quota_str) * 1024 * 1024;
+        frame_pool_client_ = frame_pool_->AddClient(config_.name, quota);
+        
+        for (const auto& pair : blocks_) {
+            auto block = std::dynamic_pointer_cast<BaseBlock>(pair.second);
+            if (block) {
+                block->SetFramePool(frame_pool_, frame_pool_client_);
+            }
+        }
+    }
+    
+    if (mode == "threads") {
+        return true;
+    }
+    
+    if (shared_executor_) {
+        if (!GetSetting("executor_threads").empty() || !GetSetting("pin_executor").empty()) {
+            VP_LOG_WARNING_F("Pipeline '{}' runs on a shared executor, executor_threads and pin_executor are ignored",
+                             config_.name);
+        }
+        std::string workers_str = GetSetting("max_workers");
+        std::string weight_str = GetSetting("cpu_weight");
+        size_t max_workers = workers_str.empty() ? 0 : std::stoul(workers_str);
+        unsigned weight = weight_str.empty() ? 1 : static_cast<unsigned>(std::stoul(weight_str));
+        if (weight == 0) {
+            last_error_ = "cpu_weight must be at least 1";
+            VP_LOG_ERROR(last_error_);
+            return false;
+        }
+        executor_ = shared_executor_;
+        executor_group_ = executor_->AddGroup(max_workers, weight);
+    } else {
+        std::string threads_str = GetSetting("executor_threads");
+        size_t threads = threads_str.empty() ? 0 : std::stoul(threads_str);
+        std::string pin_str = GetSetting("pin_executor");
+        bool pin = (pin_str == "true" || pin_str == "1");
         
-        // Match formats if possible
-        auto output_format = source->GetOutputFormat();
-        if (!sink->SupportsFormat(output_format.pixel_format)) {
-            VP_LOG_WARNING_F("Format mismatch between '{}' and '{}'", 
-                           connection.source_block, connection.sink_block);
+        executor_ = std::make_shared<Executor>(threads, pin);
+    }
+    
+    // Every block built on BaseBlock runs its queue and producer on the executor
+    for (const auto& pair : blocks_) {
+        auto block = std::dynamic_pointer_cast<BaseBlock>(pair.second);
+        if (block) {
+            block->SetExecutor(executor_, executor_group_);
         } else {
-            sink->SetInputFormat(output_format);
+            VP_LOG_WARNING_F("Block '{}' does not support scheduled execution", pair.first);
+        }
+    }
+    
+    VP_LOG_INFO_F("Pipeline '{}' uses scheduled execution on {} workers", config_.name, executor_->GetThreadCount());
+    return true;
+}
+
+bool PipelineManager::ConfigureAffinity() {
+    std::string mode = GetSetting("auto_affinity");
+    if (mode.empty() || mode == "off") {
+        return true;
+    }
+    
+    std::vector<int> cores;
+    std::string cores_str = GetSetting("affinity_cores");
+    if (!cores_str.empty()) {
+        if (!CPUAffinity::ParseCoreList(cores_str, cores)) {
+            last_error_ = "Invalid affinity_cores: " + cores_str;
+            VP_LOG_ERROR(last_error_);
+            return false;
         }
+    } else if (mode == "isolated") {
+        cores = CPUAffinity::GetIsolatedCores();
+    } else if (mode == "available") {
+        cores = CPUAffinity::GetAvailableCores();
+    } else {
+        last_error_ = "Unknown auto_affinity mode: " + mode + " (expected off, isolated or available)";
+        VP_LOG_ERROR(last_error_);
+        return false;
+    }
+    
+    if (cores.empty()) {
+        VP_LOG_WARNING_F("auto_affinity={}: no cores to distribute blocks over, threads stay unpinned", mode);
+        return true;
+    }
+    
+    // Blocks already pinned (by hand, or here before a Reconfigure()) keep
+    // their cores and count towards their load
+    std::vector<size_t> load(cores.size(), 0);
+    for (const auto& node : nodes_) {
+        std::vector<int> pinned;
+        if (!CPUAffinity::ParseCoreList(node.block->GetParameter("cpu_affinity"), pinned)) {
+            continue;
+        }
+        for (int core : pinned) {
+            auto it = std::find(cores.begin(), cores.end(), core);
+            if (it != cores.end()) {
+                load[it - cores.begin()]++;
+            }
+        }
+    }
+    
+    // The others go to the least-loaded core in configuration order (inserted
+    // converters last), which is round-robin on a fresh start
+    for (const auto& node : nodes_) {
+        const auto& block = node.block;
+        if (!block->GetParameter("cpu_affinity").empty()) {
+            continue;
+        }
+        
+        size_t least = std::min_element(load.begin(), load.end()) - load.begin();
+        load[least]++;
+        block->SetParameter("cpu_affinity", std::to_string(cores[least]));
+        VP_LOG_INFO_F("Block '{}' pinned to core {}", block->GetName(), cores[least]);
     }
     
-    VP_LOG_INFO_F("Connected {} block pairs", config_.connections.size());
     return true;
 }
 
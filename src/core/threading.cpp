@@ -1,5 +1,7 @@
 #include "video_pipeline/threading.h"
 #include "video_pipeline/logger.h"
+#include <fstream>
+#include <sstream>
 
 #ifdef __linux__
 #include <pthread.h>
@@ -13,15 +15,66 @@
 namespace video_pipeline {
 
 // ThreadPool implementation
+namespace {
+
+// Pool and deque index of the calling thread if it is a pool worker
+thread_local ThreadPool* tls_pool = nullptr;
+thread_local size_t tls_queue = 0;
+
+} // anonymous namespace
+
+/**
+ * @brief Worker deque: a growable ring, newest end for the owner, oldest for thieves
+ */
+struct alignas(64) ThreadPool::WorkQueue {
+    std::mutex mutex;
+    std::vector<Task> ring = std::vector<Task>(64);
+    size_t head{0};     // Oldest task
+    size_t size{0};
+
+    void PushBack(Task&& task) {
+        if (size == ring.size()) {
+            std::vector<Task> grown(ring.size() * 2);
+            for (size_t i = 0; i < size; ++i) {
+                grown[i] = std::move(ring[(head + i) & (ring.size() - 1)]);
+            }
+            ring.swap(grown);
+            head = 0;
+        }
+        ring[(head + size) & (ring.size() - 1)] = std::move(task);
+        size++;
+    }
+
+    bool PopBack(Task& task) {
+        if (size == 0) return false;
+        size--;
+        task = std::move(ring[(head + size) & (ring.size() - 1)]);
+        return true;
+    }
+
+    bool PopFront(Task& task) {
+        if (size == 0) return false;
+        task = std::move(ring[head]);
+        head = (head + 1) & (ring.size() - 1);
+        size--;
+        return true;
+    }
+};
+
 ThreadPool::ThreadPool(size_t num_threads) {
     if (num_threads == 0) {
         num_threads = std::thread::hardware_concurrency();
         if (num_threads == 0) num_threads = 4;  // fallback
     }
     
+    queues_.reserve(num_threads);
+    for (size_t i = 0; i < num_threads; ++i) {
+        queues_.push_back(std::make_unique<WorkQueue>());
+    }
+    
     threads_.reserve(num_threads);
     for (size_t i = 0; i < num_threads; ++i) {
-        threads_.emplace_back(&ThreadPool::WorkerThread, this);
+        threads_.emplace_back(&ThreadPool::WorkerThread, this, i);
     }
     
     VP_LOG_INFO_F("ThreadPool created with {} threads", num_threads);
@@ -32,18 +85,17 @@ ThreadPool::~ThreadPool() {
 }
 
 size_t ThreadPool::GetPendingTaskCount() const {
-    std::lock_guard<std::mutex> lock(queue_mutex_);
-    return tasks_.size();
+    return queued_.load();
 }
 
 void ThreadPool::WaitForAll() {
-    std::unique_lock<std::mutex> lock(queue_mutex_);
-    condition_.wait(lock, [this] { return tasks_.empty(); });
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    done_condition_.wait(lock, [this] { return unfinished_.load() == 0; });
 }
 
 void ThreadPool::Shutdown() {
     {
-        std::lock_guard<std::mutex> lock(queue_mutex_);
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
         stop_ = true;
     }
     
@@ -59,32 +111,145 @@ void ThreadPool::Shutdown() {
     VP_LOG_DEBUG("ThreadPool shutdown complete");
 }
 
-void ThreadPool::WorkerThread() {
+bool ThreadPool::Push(Task&& task) {
+    if (stop_.load()) {
+        return false;
+    }
+    
+    // Workers keep their own tasks; other threads spread theirs
+    size_t index = (tls_pool == this) ? tls_queue : next_queue_.fetch_add(1) % queues_.size();
+    unfinished_.fetch_add(1);
+    queued_.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->PushBack(std::move(task));
+    }
+    
+    // Pairs with the sleeping_ increment in WorkerThread: either the worker
+    // sees the task or we see the sleeper
+    if (sleeping_.load() > 0) {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        condition_.notify_one();
+    }
+    return true;
+}
+
+bool ThreadPool::PopTask(Task& task) {
+    if (queued_.load() == 0) {
+        return false;
+    }
+    
+    size_t count = queues_.size();
+    size_t own = (tls_pool == this) ? tls_queue : next_queue_.load() % count;
+    if (tls_pool == this) {
+        std::lock_guard<std::mutex> lock(queues_[own]->mutex);
+        if (queues_[own]->PopBack(task)) {
+            queued_.fetch_sub(1);
+            return true;
+        }
+    }
+    
+    // Steal the oldest task of another deque
+    for (size_t i = (tls_pool == this) ? 1 : 0; i < count; ++i) {
+        WorkQueue& victim = *queues_[(own + i) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.PopFront(task)) {
+            queued_.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::RunTask(Task& task) {
+    try {
+        task();
+    } catch (const std::exception& e) {
+        VP_LOG_ERROR_F("Exception in thread pool task: {}", e.what());
+    } catch (...) {
+        VP_LOG_ERROR("Unknown exception in thread pool task");
+    }
+    task = Task();
+    
+    if (unfinished_.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        done_condition_.notify_all();
+    }
+}
+
+bool ThreadPool::RunPendingTask() {
+    Task task;
+    if (!PopTask(task)) {
+        return false;
+    }
+    RunTask(task);
+    return true;
+}
+
+void ThreadPool::WorkerThread(size_t index) {
+    tls_pool = this;
+    tls_queue = index;
+    
+    Task task;
     while (true) {
-        std::function<void()> task;
-        
-        {
-            std::unique_lock<std::mutex> lock(queue_mutex_);
-            condition_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
-            
-            if (stop_ && tasks_.empty()) {
-                break;
-            }
-            
-            if (!tasks_.empty()) {
-                task = std::move(tasks_.front());
-                tasks_.pop();
-            }
+        if (PopTask(task)) {
+            RunTask(task);
+            continue;
         }
         
-        if (task) {
-            try {
-                task();
-            } catch (const std::exception& e) {
-                VP_LOG_ERROR_F("Exception in thread pool task: {}", e.what());
-            }
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        sleeping_.fetch_add(1);
+        condition_.wait(lock, [this] { return stop_ || queued_.load() > 0; });
+        sleeping_.fetch_sub(1);
+        
+        if (stop_ && queued_.load() == 0) {
+            break;
         }
     }
+    
+    tls_pool = nullptr;
+}
+
+// TaskGroup implementation
+TaskGroup::~TaskGroup() {
+    WaitNoThrow();
+}
+
+void TaskGroup::Wait() {
+    WaitNoThrow();
+    
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::swap(error, error_);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void TaskGroup::WaitNoThrow() {
+    // Help instead of blocking; our tasks may be queued behind others
+    while (pending_.load() > 0 && pool_ && pool_->RunPendingTask()) {
+    }
+    
+    // Finish() decrements under the lock, so the group outlives its last task
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return pending_.load() == 0; });
+}
+
+void TaskGroup::Finish() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pending_.fetch_sub(1) == 1) {
+        done_.notify_all();
+    }
+}
+
+void TaskGroup::SetError(std::exception_ptr error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!error_) {
+        error_ = error;
+    }
 }
 
 // Precision sleep functions
@@ -207,6 +372,60 @@ bool CPUAffinity::SetCurrentThreadPriority(int priority) {
     return true;
 }
 
+bool CPUAffinity::SetCurrentThreadScheduling(SchedPolicy policy, int priority) {
+    int native_policy = SCHED_OTHER;
+    switch (policy) {
+        case SchedPolicy::OTHER: native_policy = SCHED_OTHER; break;
+        case SchedPolicy::FIFO: native_policy = SCHED_FIFO; break;
+        case SchedPolicy::RR: native_policy = SCHED_RR; break;
+        case SchedPolicy::BATCH: native_policy = SCHED_BATCH; break;
+        case SchedPolicy::IDLE: native_policy = SCHED_IDLE; break;
+    }
+    
+    struct sched_param param;
+    param.sched_priority = (policy == SchedPolicy::FIFO || policy == SchedPolicy::RR) ? priority : 0;
+    
+    int result = pthread_setschedparam(pthread_self(), native_policy, &param);
+    if (result != 0) {
+        VP_LOG_ERROR_F("Failed to set thread scheduling: {}", strerror(result));
+        return false;
+    }
+    
+    return true;
+}
+
+bool CPUAffinity::SetCurrentThreadName(const std::string& name) {
+    // The kernel limit is 16 bytes including the terminator
+    std::string truncated = name.substr(0, 15);
+    int result = pthread_setname_np(pthread_self(), truncated.c_str());
+    if (result != 0) {
+        VP_LOG_ERROR_F("Failed to set thread name '{}': {}", truncated, strerror(result));
+        return false;
+    }
+    
+    return true;
+}
+
+std::vector<int> CPUAffinity::GetIsolatedCores() {
+    std::vector<int> isolated;
+    std::ifstream file("/sys/devices/system/cpu/isolated");
+    std::string list;
+    if (!file || !std::getline(file, list) || !ParseCoreList(list, isolated)) {
+        return {};
+    }
+    
+    // Only cores we are allowed to run on are of any use
+    std::vector<int> available = GetAvailableCores();
+    std::vector<int> cores;
+    for (int core : isolated) {
+        if (std::find(available.begin(), available.end(), core) != available.end()) {
+            cores.push_back(core);
+        }
+    }
+    
+    return cores;
+}
+
 #else
 // Non-Linux platforms - stub implementations
 bool CPUAffinity::SetThreadAffinity(std::thread&, const std::vector<int>&) {
@@ -242,6 +461,107 @@ bool CPUAffinity::SetCurrentThreadPriority(int) {
     return false;
 }
 
+bool CPUAffinity::SetCurrentThreadScheduling(SchedPolicy, int) {
+    VP_LOG_WARNING("Thread scheduling not supported on this platform");
+    return false;
+}
+
+bool CPUAffinity::SetCurrentThreadName(const std::string&) {
+    return false;
+}
+
+std::vector<int> CPUAffinity::GetIsolatedCores() {
+    return {};
+}
+
 #endif
 
+bool ParseWaitStrategy(const std::string& name, WaitStrategy& strategy) {
+    if (name == "block") {
+        strategy = WaitStrategy::BLOCK;
+    } else if (name == "spin") {
+        strategy = WaitStrategy::SPIN;
+    } else if (name == "busy_poll") {
+        strategy = WaitStrategy::BUSY_POLL;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool CPUAffinity::ParseCoreList(const std::string& list, std::vector<int>& cores) {
+    std::vector<int> parsed;
+    std::stringstream stream(list);
+    std::string item;
+    
+    while (std::getline(stream, item, ',')) {
+        item.erase(0, item.find_first_not_of(" \t"));
+        item.erase(item.find_last_not_of(" \t\r\n") + 1);
+        if (item.empty()) {
+            continue;
+        }
+        
+        try {
+            size_t dash = item.find('-');
+            size_t end = 0;
+            int first = std::stoi(item.substr(0, dash), &end);
+            if (end != item.substr(0, dash).size()) {
+                return false;
+            }
+            int last = first;
+            if (dash != std::string::npos) {
+                std::string tail = item.substr(dash + 1);
+                last = std::stoi(tail, &end);
+                if (end != tail.size()) {
+                    return false;
+                }
+            }
+            if (first < 0 || last < first) {
+                return false;
+            }
+            for (int core = first; core <= last; ++core) {
+                parsed.push_back(core);
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    
+    cores = std::move(parsed);
+    return true;
+}
+
+bool CPUAffinity::ParseSchedPolicy(const std::string& name, SchedPolicy& policy) {
+    if (name == "other" || name == "normal") {
+        policy = SchedPolicy::OTHER;
+    } else if (name == "fifo") {
+        policy = SchedPolicy::FIFO;
+    } else if (name == "rr") {
+        policy = SchedPolicy::RR;
+    } else if (name == "batch") {
+        policy = SchedPolicy::BATCH;
+    } else if (name == "idle") {
+        policy = SchedPolicy::IDLE;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool CPUAffinity::ApplyToCurrentThread(const ThreadSettings& settings) {
+    bool ok = true;
+    
+    if (!settings.name.empty()) {
+        ok = SetCurrentThreadName(settings.name) && ok;
+    }
+    if (!settings.cpu_cores.empty()) {
+        ok = SetCurrentThreadAffinity(settings.cpu_cores) && ok;
+    }
+    if (settings.set_policy) {
+        ok = SetCurrentThreadScheduling(settings.policy, settings.priority) && ok;
+    }
+    
+    return ok;
+}
+
 } // namespace video_pipeline
\ No newline at end of file
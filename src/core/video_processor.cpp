@@ -0,0 +1,211 @@
+#include "video_pipeline/video_processor.h"
+#include "video_pipeline/logger.h"
+#include "utils/row_stage.h"
+#include <algorithm>
+
+namespace video_pipeline {
+
+BaseVideoProcessor::BaseVideoProcessor(const std::string& name, const std::string& type)
+    : BaseVideoSink(name, type) {
+    output_format_ = DeriveOutputFormat(input_format_);
+}
+
+BaseVideoProcessor::~BaseVideoProcessor() {
+    ReleaseOutputPool();
+}
+
+void BaseVideoProcessor::ReleaseOutputPool() {
+    // Frames still downstream become ordinary frames
+    for (auto& frame : output_pool_) {
+        frame->SetPoolHeld(false);
+    }
+    output_pool_.clear();
+}
+
+bool BaseVideoProcessor::SetFrameCallback(FrameCallback callback) {
+    frame_callback_ = callback;
+    return true;
+}
+
+bool BaseVideoProcessor::SetOutputFormat(const FrameInfo& format) {
+    if (BaseBlock::GetState() == BlockState::RUNNING) {
+        SetError("Cannot change output format while running");
+        return false;
+    }
+    
+    output_format_ = format;
+    return true;
+}
+
+bool BaseVideoProcessor::SetFrameRate(double fps) {
+    if (fps < 0 || fps > 1000) {
+        SetError("Invalid frame rate: " + std::to_string(fps));
+        return false;
+    }
+    
+    frame_rate_ = fps;
+    return true;
+}
+
+bool BaseVideoProcessor::SetBufferCount(size_t count) {
+    if (count == 0 || count > 100) {
+        SetError("Invalid buffer count: " + std::to_string(count));
+        return false;
+    }
+    
+    buffer_count_ = count;
+    return true;
+}
+
+bool BaseVideoProcessor::Initialize(const BlockParams& params) {
+    if (!BaseVideoSink::Initialize(params)) {
+        return false;
+    }
+    
+    FrameMemoryOptions memory = frame_memory_;
+    
+    auto pages_str = BaseBlock::GetParameter("huge_pages");
+    if (!pages_str.empty()) {
+        if (pages_str == "off" || pages_str == "false" || pages_str == "0") memory.pages = PageMode::DEFAULT;
+        else if (pages_str == "transparent" || pages_str == "thp") memory.pages = PageMode::TRANSPARENT;
+        else if (pages_str == "hugetlb") memory.pages = PageMode::HUGETLB;
+        else {
+            SetError("Invalid huge_pages mode: " + pages_str);
+            return false;
+        }
+    }
+    
+    auto prefault_str = BaseBlock::GetParameter("prefault");
+    if (!prefault_str.empty()) {
+        memory.prefault = (prefault_str == "true" || prefault_str == "1");
+    }
+    
+    auto lock_str = BaseBlock::GetParameter("lock_memory");
+    if (!lock_str.empty()) {
+        memory.lock = (lock_str == "true" || lock_str == "1");
+    }
+    
+    auto shareable_str = BaseBlock::GetParameter("shareable");
+    if (!shareable_str.empty()) {
+        memory.shareable = (shareable_str == "true" || shareable_str == "1");
+    }
+    
+    auto buffer_count_str = BaseBlock::GetParameter("buffer_count");
+    if (!buffer_count_str.empty() && !SetBufferCount(std::stoul(buffer_count_str))) {
+        return false;
+    }
+    
+    return SetFrameMemory(memory);
+}
+
+bool BaseVideoProcessor::SetFrameMemory(const FrameMemoryOptions& options) {
+    if (BaseBlock::GetState() == BlockState::RUNNING) {
+        SetError("Cannot change frame memory while running");
+        return false;
+    }
+    
+    frame_memory_ = options;
+    ReleaseOutputPool();
+    return true;
+}
+
+std::unique_ptr<RowStage> BaseVideoProcessor::CreateRowStage() const {
+    return nullptr;
+}
+
+bool BaseVideoProcessor::SetCreditProbe(CreditProbe probe) {
+    credit_probe_ = std::move(probe);
+    return true;
+}
+
+bool BaseVideoProcessor::HasCapacity(const EdgePolicy& policy) const {
+    return BaseVideoSink::HasCapacity(policy) && (!credit_probe_ || credit_probe_());
+}
+
+bool BaseVideoProcessor::SetInputFormat(const FrameInfo& format) {
+    if (!BaseVideoSink::SetInputFormat(format)) {
+        return false;
+    }
+    
+    output_format_ = DeriveOutputFormat(format);
+    VP_LOG_DEBUG_F("VideoProcessor {} output format: {}", BaseBlock::GetName(), output_format_.ToString());
+    return true;
+}
+
+void BaseVideoProcessor::EmitFrame(VideoFramePtr frame) {
+    if (!frame || !frame_callback_) {
+        return;
+    }
+    
+    frame_callback_(std::move(frame));
+}
+
+VideoFramePtr BaseVideoProcessor::AcquireOutputFrame(const FrameInfo& info, size_t capacity) {
+    // Pipelines sharing a frame pool recycle through it instead
+    if (frame_pool_) {
+        return AllocateFrame(info, capacity, frame_memory_);
+    }
+    
+    size_t required = std::max(info.GetFrameSize(), capacity);
+    
+    // Fault the whole pool in before the first frame rather than one frame at a time
+    if (output_pool_.empty() && (frame_memory_.prefault || frame_memory_.lock)) {
+        while (output_pool_.size() < buffer_count_) {
+            auto frame = CreateVideoFrame(info, capacity, frame_memory_);
+            if (!frame) {
+                break;
+            }
+            frame->SetPoolHeld(true);
+            output_pool_.push_back(frame);
+        }
+    }
+    
+    // use_count() == 1 means only the pool holds the frame, so nobody can still be reading it.
+    // The pool's reference is marked so that a single consumer may still write in place.
+    VideoFramePtr* idle_slot = nullptr;
+    for (auto& frame : output_pool_) {
+        if (frame.use_count() != 1) {
+            continue;
+        }
+        if (frame->GetCapacity() >= required) {
+            frame->SetFrameInfo(info);
+            return frame;
+        }
+        idle_slot = &frame;
+    }
+    
+    auto frame = CreateVideoFrame(info, capacity, frame_memory_);
+    if (!frame) {
+        return nullptr;
+    }
+    
+    // Grow the pool, or replace an idle frame that is too small for the new format
+    if (output_pool_.size() < buffer_count_) {
+        frame->SetPoolHeld(true);
+        output_pool_.push_back(frame);
+    } else if (idle_slot) {
+        (*idle_slot)->SetPoolHeld(false);
+        frame->SetPoolHeld(true);
+        *idle_slot = frame;
+    }
+    return frame;
+}
+
+bool BaseVideoProcessor::MakeWritable(VideoFramePtr& frame) {
+    const IVideoFrame* original = frame.get();
+    bool ok = video_pipeline::MakeWritable(frame, [this](const FrameInfo& info, size_t capacity) {
+        return AcquireOutputFrame(info, capacity);
+    });
+    
+    if (ok) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (frame.get() == original) {
+            stats_.frames_written_in_place++;
+        } else {
+            stats_.frames_copied_on_write++;
+        }
+    }
+    return ok;
+}
+
+} // namespace video_pipeline
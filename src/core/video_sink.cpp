@@ -1,5 +1,7 @@
 #include "video_pipeline/video_sink.h"
 #include "video_pipeline/logger.h"
+#include <algorithm>
+#include <sstream>
 #include <thread>
 
 namespace video_pipeline {
@@ -13,7 +15,41 @@ BaseVideoSink::BaseVideoSink(const std::string& name, const std::string& type)
     input_format_.stride = input_format_.width * 3;
 }
 
+bool ParseDropPolicy(const std::string& name, DropPolicy& policy) {
+    if (name == "block") {
+        policy = DropPolicy::BLOCK;
+    } else if (name == "drop_newest") {
+        policy = DropPolicy::DROP_NEWEST;
+    } else if (name == "drop_oldest") {
+        policy = DropPolicy::DROP_OLDEST;
+    } else if (name == "latest_only") {
+        policy = DropPolicy::LATEST_ONLY;
+    } else if (name == "drop_non_keyframes") {
+        policy = DropPolicy::DROP_NON_KEYFRAMES;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* DropPolicyToString(DropPolicy policy) {
+    switch (policy) {
+        case DropPolicy::BLOCK: return "block";
+        case DropPolicy::DROP_NEWEST: return "drop_newest";
+        case DropPolicy::DROP_OLDEST: return "drop_oldest";
+        case DropPolicy::LATEST_ONLY: return "latest_only";
+        case DropPolicy::DROP_NON_KEYFRAMES: return "drop_non_keyframes";
+        default: return "unknown";
+    }
+}
+
 bool BaseVideoSink::ProcessFrame(VideoFramePtr frame) {
+    EdgePolicy policy;
+    policy.drop = is_blocking_ ? DropPolicy::BLOCK : DropPolicy::DROP_OLDEST;
+    return PushFrame(std::move(frame), policy);
+}
+
+bool BaseVideoSink::PushFrame(VideoFramePtr frame, const EdgePolicy& policy) {
     if (!frame) {
         VP_LOG_WARNING_F("VideoSink {} received null frame", BaseBlock::GetName());
         return false;
@@ -26,28 +62,30 @@ bool BaseVideoSink::ProcessFrame(VideoFramePtr frame) {
     
     std::unique_lock<std::mutex> lock(queue_mutex_);
     
-    // Check queue depth
-    if (frame_queue_.size() >= max_queue_depth_) {
-        if (!is_blocking_) {
-            // Drop oldest frame
-            frame_queue_.pop();
-            UpdateStats(false, 0, true);  // Count as dropped
-            VP_LOG_DEBUG_F("VideoSink {} queue full, dropping oldest frame", BaseBlock::GetName());
-        } else {
-            // Wait for space in queue
-            queue_not_full_condition_.wait(lock, [this] {
-                return frame_queue_.size() < max_queue_depth_ || stop_worker_.load();
-            });
-            
-            if (stop_worker_.load()) {
-                return false;
-            }
+    if (policy.drop == DropPolicy::LATEST_ONLY) {
+        // Whatever is still queued is stale now
+        while (!frame_queue_.empty()) {
+            frame_queue_.pop_front();
+            UpdateStats(false, 0, true);
         }
+    } else if (frame_queue_.size() >= max_queue_depth_ && !MakeRoom(lock, frame, policy)) {
+        return false;
     }
     
     // Add frame to queue
-    frame_queue_.push(frame);
-    stats_.queue_depth = frame_queue_.size();
+    frame_queue_.push_back(std::move(frame));
+    queued_frames_.store(frame_queue_.size(), std::memory_order_release);
+    
+    // Scheduled: activate the block unless a drain task is already pending
+    if (executor_) {
+        bool activate = !scheduled_;
+        scheduled_ = true;
+        lock.unlock();
+        if (activate) {
+            executor_->Post([this]() { RunScheduled(); }, executor_priority_, executor_worker_, executor_group_);
+        }
+        return true;
+    }
     
     // Notify worker thread
     queue_condition_.notify_one();
@@ -55,6 +93,91 @@ bool BaseVideoSink::ProcessFrame(VideoFramePtr frame) {
     return true;
 }
 
+bool BaseVideoSink::MakeRoom(std::unique_lock<std::mutex>& lock, const VideoFramePtr& frame,
+                             const EdgePolicy& policy) {
+    switch (policy.drop) {
+        case DropPolicy::BLOCK: {
+            bool timed = policy.block_timeout.count() > 0;
+            auto deadline = std::chrono::steady_clock::now() + policy.block_timeout;
+            auto has_space = [this] {
+                return frame_queue_.size() < max_queue_depth_ || stop_worker_.load();
+            };
+            
+            bool done = true;
+            if (executor_) {
+                if (timed) {
+                    done = executor_->WaitUntil(lock, queue_not_full_condition_, deadline, has_space);
+                } else {
+                    executor_->Wait(lock, queue_not_full_condition_, has_space);
+                }
+            } else {
+                if (wait_strategy_ != WaitStrategy::BLOCK) {
+                    // The worker usually frees a slot within microseconds
+                    lock.unlock();
+                    SpinWait(wait_strategy_, spin_time_, [this, timed, deadline] {
+                        return queued_frames_.load(std::memory_order_acquire) < max_queue_depth_ ||
+                               stop_worker_.load() ||
+                               (timed && std::chrono::steady_clock::now() >= deadline);
+                    });
+                    lock.lock();
+                }
+                if (timed) {
+                    done = queue_not_full_condition_.wait_until(lock, deadline, has_space);
+                } else {
+                    queue_not_full_condition_.wait(lock, has_space);
+                }
+            }
+            
+            if (stop_worker_.load()) {
+                return false;
+            }
+            if (!done) {
+                UpdateStats(false, 0, true);
+                VP_LOG_DEBUG_F("VideoSink {} queue still full after {}ms, dropping frame",
+                               BaseBlock::GetName(), policy.block_timeout.count());
+            }
+            return done;
+        }
+        
+        case DropPolicy::DROP_NEWEST:
+            UpdateStats(false, 0, true);
+            VP_LOG_DEBUG_F("VideoSink {} queue full, dropping newest frame", BaseBlock::GetName());
+            return false;
+        
+        case DropPolicy::DROP_NON_KEYFRAMES: {
+            if (!frame->GetFrameInfo().is_keyframe) {
+                UpdateStats(false, 0, true);
+                return false;
+            }
+            // Keep every keyframe we can: evict the oldest frame that is not one
+            auto victim = std::find_if(frame_queue_.begin(), frame_queue_.end(), [](const VideoFramePtr& queued) {
+                return !queued->GetFrameInfo().is_keyframe;
+            });
+            frame_queue_.erase(victim != frame_queue_.end() ? victim : frame_queue_.begin());
+            UpdateStats(false, 0, true);
+            return true;
+        }
+        
+        case DropPolicy::DROP_OLDEST:
+        case DropPolicy::LATEST_ONLY:
+        default:
+            frame_queue_.pop_front();
+            UpdateStats(false, 0, true);  // Count as dropped
+            VP_LOG_DEBUG_F("VideoSink {} queue full, dropping oldest frame", BaseBlock::GetName());
+            return true;
+    }
+}
+
+bool BaseVideoSink::HasCapacity(const EdgePolicy& policy) const {
+    // A blocking edge holds the producer instead of dropping, and a latest-only
+    // edge always takes the newest frame
+    if ((policy.drop == DropPolicy::BLOCK && policy.block_timeout.count() == 0) ||
+        policy.drop == DropPolicy::LATEST_ONLY) {
+        return true;
+    }
+    return queued_frames_.load(std::memory_order_acquire) < max_queue_depth_;
+}
+
 bool BaseVideoSink::SetInputFormat(const FrameInfo& format) {
     if (BaseBlock::GetState() == BlockState::RUNNING) {
         SetError("Cannot change input format while running");
@@ -66,6 +189,12 @@ bool BaseVideoSink::SetInputFormat(const FrameInfo& format) {
     return true;
 }
 
+BlockStats BaseVideoSink::GetStats() const {
+    BlockStats stats = BaseBlock::GetStats();
+    stats.queue_depth = static_cast<uint32_t>(queued_frames_.load(std::memory_order_relaxed));
+    return stats;
+}
+
 size_t BaseVideoSink::GetQueueDepth() const {
     std::lock_guard<std::mutex> lock(queue_mutex_);
     return frame_queue_.size();
@@ -94,12 +223,75 @@ bool BaseVideoSink::Initialize(const BlockParams& params) {
         SetBlocking(blocking_str == "true" || blocking_str == "1");
     }
     
+    // Restrictions for format negotiation, e.g. what an external consumer expects
+    accepted_formats_.clear();
+    std::istringstream formats(BaseBlock::GetParameter("accept_formats"));
+    for (std::string name; std::getline(formats, name, ',');) {
+        name.erase(std::remove(name.begin(), name.end(), ' '), name.end());
+        PixelFormat format;
+        if (name.empty()) {
+            continue;
+        }
+        if (!ParsePixelFormat(name, format)) {
+            SetError("Unknown pixel format in accept_formats: " + name);
+            return false;
+        }
+        if (!SupportsFormat(format)) {
+            SetError("accept_formats lists " + name + ", which " + BaseBlock::GetType() + " does not support");
+            return false;
+        }
+        accepted_formats_.push_back(format);
+    }
+    
+    accepted_resolutions_.clear();
+    std::istringstream resolutions(BaseBlock::GetParameter("accept_resolutions"));
+    for (std::string size; std::getline(resolutions, size, ',');) {
+        size.erase(std::remove(size.begin(), size.end(), ' '), size.end());
+        unsigned width = 0, height = 0;
+        char sep = 0;
+        if (size.empty()) {
+            continue;
+        }
+        std::istringstream parser(size);
+        if (!(parser >> width >> sep >> height) || sep != 'x' || width == 0 || height == 0) {
+            SetError("Invalid resolution in accept_resolutions: " + size + " (expected WxH)");
+            return false;
+        }
+        accepted_resolutions_.emplace_back(width, height);
+    }
+    
+    ConfigureWaitStrategy();
+    
     SetState(BlockState::INITIALIZED);
     VP_LOG_INFO_F("VideoSink {} initialized, queue_depth={}, blocking={}", 
-                  BaseBlock::GetName(), max_queue_depth_, is_blocking_);
+                  BaseBlock::GetName(), max_queue_depth_.load(), is_blocking_);
     return true;
 }
 
+bool BaseVideoSink::IsHotParameter(const std::string& key) const {
+    return key == "queue_depth";
+}
+
+void BaseVideoSink::ApplyParameter(const std::string& key, const std::string& value) {
+    if (key == "queue_depth" && SetMaxQueueDepth(std::stoul(value))) {
+        // A deeper queue may have room for producers parked on a full one
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        queue_not_full_condition_.notify_all();
+    }
+}
+
+bool BaseVideoSink::AcceptsFormat(PixelFormat format) const {
+    if (!SupportsFormat(format)) {
+        return false;
+    }
+    return accepted_formats_.empty() ||
+           std::find(accepted_formats_.begin(), accepted_formats_.end(), format) != accepted_formats_.end();
+}
+
+std::vector<PixelFormat> BaseVideoSink::GetAcceptedFormats() const {
+    return accepted_formats_.empty() ? GetSupportedFormats() : accepted_formats_;
+}
+
 bool BaseVideoSink::Start() {
     if (BaseBlock::GetState() != BlockState::INITIALIZED && BaseBlock::GetState() != BlockState::STOPPED) {
         SetError("Cannot start VideoSink from state: " + BaseBlock::GetStateString());
@@ -108,9 +300,11 @@ bool BaseVideoSink::Start() {
     
     SetState(BlockState::STARTING);
     
-    // Start worker thread
+    // Start worker thread (scheduled sinks run on the executor when frames arrive)
     stop_worker_.store(false);
-    worker_thread_ = std::thread(&BaseVideoSink::WorkerThread, this);
+    if (!executor_) {
+        worker_thread_ = std::thread(&BaseVideoSink::WorkerThread, this);
+    }
     
     SetState(BlockState::RUNNING);
     VP_LOG_INFO_F("VideoSink {} started", BaseBlock::GetName());
@@ -129,17 +323,20 @@ bool BaseVideoSink::Stop() {
     stop_worker_.store(true);
     queue_condition_.notify_all();
     queue_not_full_condition_.notify_all();
+    idle_condition_.notify_all();
     
     // Wait for worker thread to finish
     if (worker_thread_.joinable()) {
         worker_thread_.join();
     }
     
-    // Clear remaining frames
-    std::lock_guard<std::mutex> lock(queue_mutex_);
-    while (!frame_queue_.empty()) {
-        frame_queue_.pop();
+    // Clear remaining frames once no drain task can touch the queue
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    if (executor_) {
+        executor_->Wait(lock, queue_condition_, [this] { return !scheduled_; });
     }
+    frame_queue_.clear();
+    queued_frames_.store(0, std::memory_order_release);
     
     SetState(BlockState::STOPPED);
     VP_LOG_INFO_F("VideoSink {} stopped", BaseBlock::GetName());
@@ -153,10 +350,16 @@ bool BaseVideoSink::Shutdown() {
 
 void BaseVideoSink::WorkerThread() {
     VP_LOG_DEBUG_F("VideoSink {} worker thread started", BaseBlock::GetName());
+    BaseBlock::ApplyThreadSettings();
     
     while (!stop_worker_.load()) {
         VideoFramePtr frame;
         
+        // Catch the next frame without a futex wake-up if the strategy allows
+        SpinWait(wait_strategy_, spin_time_, [this] {
+            return queued_frames_.load(std::memory_order_acquire) > 0 || stop_worker_.load();
+        });
+        
         // Get frame from queue
         {
             std::unique_lock<std::mutex> lock(queue_mutex_);
@@ -169,9 +372,10 @@ void BaseVideoSink::WorkerThread() {
             }
             
             if (!frame_queue_.empty()) {
-                frame = frame_queue_.front();
-                frame_queue_.pop();
-                stats_.queue_depth = frame_queue_.size();
+                frame = std::move(frame_queue_.front());
+                frame_queue_.pop_front();
+                queued_frames_.store(frame_queue_.size(), std::memory_order_release);
+                ++in_flight_;
                 
                 // Notify that queue has space
                 queue_not_full_condition_.notify_one();
@@ -180,21 +384,79 @@ void BaseVideoSink::WorkerThread() {
         
         // Process frame
         if (frame) {
-            try {
-                bool success = ProcessFrameImpl(frame);
-                UpdateStats(success, frame->GetSize(), !success);
-                
-                if (!success) {
-                    VP_LOG_WARNING_F("VideoSink {} failed to process frame", BaseBlock::GetName());
-                }
-            } catch (const std::exception& e) {
-                VP_LOG_ERROR_F("VideoSink {} exception in ProcessFrameImpl: {}", BaseBlock::GetName(), e.what());
-                UpdateStats(false, 0, true);
-            }
+            HandleFrame(std::move(frame));
+            FinishFrame();
         }
     }
     
     VP_LOG_DEBUG_F("VideoSink {} worker thread stopped", BaseBlock::GetName());
 }
 
+void BaseVideoSink::RunScheduled() {
+    for (size_t n = 0; n < kScheduledBatch; ++n) {
+        VideoFramePtr frame;
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            if (stop_worker_.load() || frame_queue_.empty()) {
+                scheduled_ = false;
+                queue_condition_.notify_all();  // Stop() waits for this
+                return;
+            }
+            
+            frame = std::move(frame_queue_.front());
+            frame_queue_.pop_front();
+            queued_frames_.store(frame_queue_.size(), std::memory_order_release);
+            ++in_flight_;
+            queue_not_full_condition_.notify_one();
+        }
+        
+        HandleFrame(std::move(frame));
+        FinishFrame();
+    }
+    
+    // Still busy: requeue behind the other ready blocks
+    executor_->Post([this]() { RunScheduled(); }, executor_priority_, executor_worker_, executor_group_);
+}
+
+void BaseVideoSink::FinishFrame() {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    if (--in_flight_ == 0 && frame_queue_.empty()) {
+        idle_condition_.notify_all();
+    }
+}
+
+bool BaseVideoSink::Drain(std::chrono::milliseconds timeout) {
+    if (BaseBlock::GetState() != BlockState::RUNNING) {
+        return true;
+    }
+    
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    return idle_condition_.wait_for(lock, timeout, [this] {
+        return (frame_queue_.empty() && in_flight_ == 0) || stop_worker_.load();
+    });
+}
+
+void BaseVideoSink::HandleFrame(VideoFramePtr frame) {
+    ApplyPendingParameters();
+    
+    try {
+        // Hand over the only reference so the block can write in place
+        size_t bytes = frame->GetSize();
+        frame_discarded_ = false;
+        bool success = ProcessFrameImpl(std::move(frame));
+        if (success && frame_discarded_) {
+            UpdateStats(false, 0, true);
+            return;
+        }
+        UpdateStats(success, bytes, !success);
+        
+        if (!success) {
+            VP_LOG_WARNING_F("VideoSink {} failed to process frame", BaseBlock::GetName());
+        }
+    } catch (const std::exception& e) {
+        VP_LOG_ERROR_F("VideoSink {} exception in ProcessFrameImpl: {}", BaseBlock::GetName(), e.what());
+        UpdateStats(false, 0, true);
+    }
+}
+
 } // namespace video_pipeline
\ No newline at end of file
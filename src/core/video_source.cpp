@@ -18,6 +18,11 @@ bool BaseVideoSource::SetFrameCallback(FrameCallback callback) {
     return true;
 }
 
+bool BaseVideoSource::SetCreditProbe(CreditProbe probe) {
+    credit_probe_ = std::move(probe);
+    return true;
+}
+
 bool BaseVideoSource::SetFrameRate(double fps) {
     if (fps <= 0 || fps > 1000) {
         SetError("Invalid frame rate: " + std::to_string(fps));
@@ -58,6 +63,10 @@ bool BaseVideoSource::Initialize(const BlockParams& params) {
         SetFrameRate(std::stod(fps_str));
     }
     
+    ConfigureWaitStrategy();
+    
+    SetCongestionMode(BaseBlock::GetParameter("congestion"));
+    
     if (!format_str.empty()) {
         // Parse pixel format string
         if (format_str == "RGB24") output_format_.pixel_format = PixelFormat::RGB24;
@@ -99,7 +108,34 @@ bool BaseVideoSource::Stop() {
     return true;
 }
 
+bool BaseVideoSource::IsHotParameter(const std::string& key) const {
+    return key == "fps" || key == "congestion";
+}
+
+void BaseVideoSource::ApplyParameter(const std::string& key, const std::string& value) {
+    if (key == "fps") {
+        SetFrameRate(std::stod(value));
+    } else if (key == "congestion") {
+        SetCongestionMode(value);
+    }
+}
+
+void BaseVideoSource::SetCongestionMode(const std::string& mode) {
+    if (mode == "ignore") {
+        congestion_mode_ = CongestionMode::IGNORE;
+    } else if (mode == "throttle") {
+        congestion_mode_ = CongestionMode::THROTTLE;
+    } else if (mode.empty() || mode == "skip") {
+        congestion_mode_ = CongestionMode::SKIP;
+    } else {
+        VP_LOG_WARNING_F("VideoSource {}: unknown congestion mode '{}', using skip", BaseBlock::GetName(), mode);
+        congestion_mode_ = CongestionMode::SKIP;
+    }
+}
+
 void BaseVideoSource::EmitFrame(VideoFramePtr frame) {
+    ApplyPendingParameters();
+    
     if (!frame || !frame_callback_) {
         return;
     }
@@ -115,11 +151,12 @@ void BaseVideoSource::EmitFrame(VideoFramePtr frame) {
     info.timestamp_us = Timer::GetCurrentTimestampUs();
     info.sequence_number = BaseBlock::GetStats().frames_processed + 1;
     
-    // Emit the frame
-    frame_callback_(frame);
+    // Emit the frame; the source keeps no reference, so a single consumer can write in place
+    size_t bytes = frame->GetSize();
+    frame_callback_(std::move(frame));
     
     // Update statistics
-    UpdateStats(true, frame->GetSize(), false);
+    UpdateStats(true, bytes, false);
     last_frame_time_ = std::chrono::steady_clock::now();
 }
 
@@ -129,7 +166,132 @@ bool BaseVideoSource::ShouldEmitFrame() const {
     auto now = std::chrono::steady_clock::now();
     auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - last_frame_time_);
     
-    return elapsed >= frame_interval_;
+    return elapsed >= CurrentInterval();
+}
+
+void BaseVideoSource::StartProducer() {
+    stop_producer_.store(false);
+    
+    if (!executor_) {
+        producer_thread_ = std::thread(&BaseVideoSource::ProducerThread, this);
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(producer_mutex_);
+    producer_active_ = true;
+    producer_timer_ = executor_->PostAt(std::chrono::steady_clock::now(), [this]() { ProducerTick(); },
+                                        executor_priority_, executor_worker_, executor_group_);
+}
+
+void BaseVideoSource::StopProducer() {
+    stop_producer_.store(true);
+    {
+        // Taking the mutex orders the store before a producer about to park
+        std::lock_guard<std::mutex> lock(producer_mutex_);
+    }
+    producer_condition_.notify_all();
+    
+    if (producer_thread_.joinable()) {
+        producer_thread_.join();
+    }
+    
+    if (!executor_) {
+        return;
+    }
+    
+    // A tick still waiting for its deadline is dropped, a running one finishes
+    std::unique_lock<std::mutex> lock(producer_mutex_);
+    if (producer_active_ && executor_->Cancel(producer_timer_)) {
+        producer_active_ = false;
+    }
+    executor_->Wait(lock, producer_condition_, [this] { return !producer_active_; });
+}
+
+void BaseVideoSource::ProducerThread() {
+    VP_LOG_DEBUG_F("VideoSource {} producer thread started", BaseBlock::GetName());
+    BaseBlock::ApplyThreadSettings();
+    
+    while (!stop_producer_.load()) {
+        ApplyPendingParameters();
+        
+        if (!ShouldEmitFrame()) {
+            WaitForNextFrame();
+            continue;
+        }
+        
+        if (!HasDownstreamCredit()) {
+            continue;
+        }
+        
+        if (!ProduceFrame()) {
+            break;
+        }
+    }
+    
+    VP_LOG_DEBUG_F("VideoSource {} producer thread stopped", BaseBlock::GetName());
+}
+
+bool BaseVideoSource::HasDownstreamCredit() {
+    if (!credit_probe_ || congestion_mode_ == CongestionMode::IGNORE || credit_probe_()) {
+        // Recover one step per frame that gets through
+        if (throttle_ > 0) {
+            --throttle_;
+        }
+        return true;
+    }
+    
+    if (congestion_mode_ == CongestionMode::THROTTLE && throttle_ < kMaxThrottle) {
+        ++throttle_;
+    }
+    
+    last_frame_time_ = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.frames_skipped++;
+    }
+    return false;
+}
+
+void BaseVideoSource::WaitForNextFrame() {
+    auto deadline = last_frame_time_ + CurrentInterval();
+    
+    // Park until the deadline, or until spin_time_ before it when spinning
+    if (wait_strategy_ != WaitStrategy::BUSY_POLL) {
+        auto wake = deadline;
+        if (wait_strategy_ == WaitStrategy::SPIN) {
+            wake -= spin_time_;
+        }
+        std::unique_lock<std::mutex> lock(producer_mutex_);
+        producer_condition_.wait_until(lock, wake, [this] { return stop_producer_.load(); });
+    }
+    
+    SpinWait(wait_strategy_, spin_time_ + CurrentInterval(), [this, deadline] {
+        return stop_producer_.load() || std::chrono::steady_clock::now() >= deadline;
+    });
+}
+
+void BaseVideoSource::ProducerTick() {
+    ApplyPendingParameters();
+    
+    bool more = true;
+    if (!stop_producer_.load() && ShouldEmitFrame() && HasDownstreamCredit()) {
+        more = ProduceFrame();
+    }
+    
+    // Next frame is due one interval after the last one emitted
+    auto now = std::chrono::steady_clock::now();
+    auto next = last_frame_time_ + CurrentInterval();
+    if (next <= now) {
+        next = now + CurrentInterval();
+    }
+    
+    std::lock_guard<std::mutex> lock(producer_mutex_);
+    if (!more || stop_producer_.load()) {
+        producer_active_ = false;
+        producer_condition_.notify_all();
+        return;
+    }
+    producer_timer_ = executor_->PostAt(next, [this]() { ProducerTick(); }, executor_priority_, executor_worker_, executor_group_);
 }
 
 void BaseVideoSource::UpdateFrameInterval() {
@@ -1,8 +1,24 @@
 #include "video_pipeline/video_pipeline.h"
 #include "video_pipeline/blocks/test_pattern_source.h"
 #include "video_pipeline/blocks/file_sink.h"
+#include "video_pipeline/blocks/file_source.h"
 #include "video_pipeline/blocks/console_sink.h"
 #include "video_pipeline/blocks/tcp_sink.h"
+#include "video_pipeline/blocks/tcp_source.h"
+#include "video_pipeline/blocks/shm_sink.h"
+#include "video_pipeline/blocks/shm_source.h"
+#include "video_pipeline/blocks/uds_sink.h"
+#include "video_pipeline/blocks/uds_source.h"
+#include "video_pipeline/blocks/jpeg_encode.h"
+#include "video_pipeline/blocks/qoi_encode.h"
+#include "video_pipeline/blocks/qoi_decode.h"
+#include "video_pipeline/blocks/scale.h"
+#include "video_pipeline/blocks/crop.h"
+#include "video_pipeline/blocks/color_convert.h"
+#include "video_pipeline/blocks/compositor.h"
+#include "video_pipeline/blocks/frame_rate_convert.h"
+#include "video_pipeline/blocks/change_detect.h"
+#include "video_pipeline/blocks/pre_roll_recorder.h"
 #ifdef HAVE_LIBCAMERA
 #include "video_pipeline/blocks/libcamera_source.h"
 #endif
@@ -12,12 +28,15 @@
 #include <chrono>
 #include <thread>
 #include <iomanip>
+#include <map>
 #include <memory>
+#include <vector>
 
 using namespace video_pipeline;
 
 // Global variables for signal handling
 static std::atomic<bool> g_shutdown_requested{false};
+static std::atomic<bool> g_reload_requested{false};
 static std::unique_ptr<PipelineManager> g_pipeline;
 
 // Signal handler
@@ -30,11 +49,19 @@ void SignalHandler(int signal) {
     }
 }
 
+#ifdef SIGHUP
+// Reload handler: the main loop applies the config file again
+void ReloadHandler(int) {
+    g_reload_requested.store(true);
+}
+#endif
+
 void PrintUsage(const char* program_name) {
     std::cout << "Usage: " << program_name << " [options]\n"
               << "\n"
               << "Options:\n"
-              << "  -c, --config <file>     Configuration file (YAML/JSON/simple)\n"
+              << "  -c, --config <file>     Configuration file (YAML/JSON/simple); repeat to run\n"
+              << "                          several pipelines on a shared executor and frame pool\n"
               << "  -t, --time <seconds>    Run for specified time (0 = infinite)\n"
               << "  -v, --verbose           Enable verbose logging\n"
               << "  -l, --log-file <file>   Log to file instead of console\n"
@@ -45,7 +72,8 @@ void PrintUsage(const char* program_name) {
               << "  " << program_name << " --config pipeline.yaml --time 10\n"
               << "  " << program_name << " --verbose --stats\n"
               << "\n"
-              << "Without a config file, a default test pattern -> console pipeline will be created.\n";
+              << "Without a config file, a default test pattern -> console pipeline will be created.\n"
+              << "Send SIGHUP to apply changes to the config file without restarting the pipeline.\n";
 }
 
 PipelineConfig CreateDefaultConfig() {
@@ -79,9 +107,7 @@ PipelineConfig CreateDefaultConfig() {
     return config;
 }
 
-void PrintStatistics(const PipelineManager& pipeline) {
-    auto stats = pipeline.GetAllStats();
-    
+void PrintStatistics(const std::map<std::string, BlockStats>& stats) {
     std::cout << "\n=== Pipeline Statistics ===\n";
     for (const auto& pair : stats) {
         const auto& block_name = pair.first;
@@ -90,17 +116,97 @@ void PrintStatistics(const PipelineManager& pipeline) {
         std::cout << block_name << ":\n";
         std::cout << "  Frames processed: " << block_stats.frames_processed << "\n";
         std::cout << "  Frames dropped: " << block_stats.frames_dropped << "\n";
+        if (block_stats.frames_skipped) {
+            std::cout << "  Frames skipped (no downstream credit): " << block_stats.frames_skipped << "\n";
+        }
         std::cout << "  Bytes processed: " << block_stats.bytes_processed << "\n";
         std::cout << "  Average FPS: " << std::fixed << std::setprecision(1) << block_stats.avg_fps << "\n";
         std::cout << "  Average latency: " << std::fixed << std::setprecision(2) << block_stats.avg_latency_ms << "ms\n";
         std::cout << "  Queue depth: " << block_stats.queue_depth << "\n";
+        if (block_stats.frames_written_in_place || block_stats.frames_copied_on_write) {
+            std::cout << "  Copy-on-write: " << block_stats.frames_written_in_place << " in place, "
+                      << block_stats.frames_copied_on_write << " copied\n";
+        }
+        if (block_stats.buffered_bytes) {
+            std::cout << "  Buffered: " << block_stats.buffered_bytes / 1024 << " KiB\n";
+        }
         std::cout << "\n";
     }
 }
 
+// Several pipelines in one process on a shared executor and frame pool
+int RunHost(const std::vector<std::string>& config_files, int run_time_seconds, bool show_stats) {
+    PipelineHost host;
+    std::map<std::string, std::string> files;   // Pipeline name -> config file
+    
+    for (const auto& file : config_files) {
+        VP_LOG_INFO_F("Loading configuration from: {}", file);
+        if (!host.LoadPipeline(file)) {
+            std::cerr << "Failed to initialize pipeline: " << host.GetLastError() << "\n";
+            return 1;
+        }
+        files[host.GetPipelineNames().back()] = file;
+    }
+    
+    std::signal(SIGINT, SignalHandler);
+    std::signal(SIGTERM, SignalHandler);
+#ifdef SIGHUP
+    std::signal(SIGHUP, ReloadHandler);
+#endif
+    
+    VP_LOG_INFO("Starting pipelines...");
+    if (!host.Start()) {
+        std::cerr << "Failed to start pipelines: " << host.GetLastError() << "\n";
+        return 1;
+    }
+    
+    std::cout << host.GetPipelineNames().size() << " pipelines started. Press Ctrl+C to stop.\n";
+    
+    Timer runtime_timer;
+    Timer stats_timer;
+    
+    while (!g_shutdown_requested.load() && host.IsRunning()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        
+        if (run_time_seconds > 0 && runtime_timer.GetElapsedSeconds() >= run_time_seconds) {
+            VP_LOG_INFO_F("Runtime limit reached ({} seconds)", run_time_seconds);
+            break;
+        }
+        
+        if (g_reload_requested.exchange(false)) {
+            for (const auto& pair : files) {
+                VP_LOG_INFO_F("Reloading configuration from: {}", pair.second);
+                auto pipeline = host.GetPipeline(pair.first);
+                if (pipeline && !pipeline->ReloadConfiguration(pair.second)) {
+                    VP_LOG_ERROR_F("Configuration not applied: {}", pipeline->GetLastError());
+                }
+            }
+        }
+        
+        if (show_stats && stats_timer.GetElapsedSeconds() >= 1.0) {
+            PrintStatistics(host.GetAllStats());
+            std::cout << host.GetResourceUsage();
+            stats_timer.Reset();
+        }
+    }
+    
+    VP_LOG_INFO("Stopping pipelines...");
+    host.Stop();
+    
+    if (show_stats) {
+        std::cout << "\n=== Final Statistics ===\n";
+        PrintStatistics(host.GetAllStats());
+        std::cout << host.GetResourceUsage();
+    }
+    
+    host.Shutdown();
+    VP_LOG_INFO_F("Pipelines ran for {}", runtime_timer.ToString());
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
     // Parse command line arguments
-    std::string config_file;
+    std::vector<std::string> config_files;
     int run_time_seconds = 0;
     bool verbose = false;
     std::string log_file;
@@ -115,7 +221,7 @@ int main(int argc, char* argv[]) {
         }
         else if (arg == "-c" || arg == "--config") {
             if (++i < argc) {
-                config_file = argv[i];
+                config_files.push_back(argv[i]);
             } else {
                 std::cerr << "Error: --config requires a filename\n";
                 return 1;
@@ -181,9 +287,57 @@ int main(int argc, char* argv[]) {
     registry.RegisterBlock("FileSink", []() -> BlockPtr {
         return std::make_shared<FileSink>();
     });
+    registry.RegisterBlock("FileSource", []() -> BlockPtr {
+        return std::make_shared<FileSource>();
+    });
     registry.RegisterBlock("TcpSink", []() -> BlockPtr {
         return std::make_shared<TcpSink>();
     });
+    registry.RegisterBlock("TcpSource", []() -> BlockPtr {
+        return std::make_shared<TcpSource>();
+    });
+    registry.RegisterBlock("ShmSink", []() -> BlockPtr {
+        return std::make_shared<ShmSink>();
+    });
+    registry.RegisterBlock("ShmSource", []() -> BlockPtr {
+        return std::make_shared<ShmSource>();
+    });
+    registry.RegisterBlock("UdsSink", []() -> BlockPtr {
+        return std::make_shared<UdsSink>();
+    });
+    registry.RegisterBlock("UdsSource", []() -> BlockPtr {
+        return std::make_shared<UdsSource>();
+    });
+    registry.RegisterBlock("JpegEncode", []() -> BlockPtr {
+        return std::make_shared<JpegEncode>();
+    });
+    registry.RegisterBlock("QoiEncode", []() -> BlockPtr {
+        return std::make_shared<QoiEncode>();
+    });
+    registry.RegisterBlock("QoiDecode", []() -> BlockPtr {
+        return std::make_shared<QoiDecode>();
+    });
+    registry.RegisterBlock("Scale", []() -> BlockPtr {
+        return std::make_shared<Scale>();
+    });
+    registry.RegisterBlock("Crop", []() -> BlockPtr {
+        return std::make_shared<Crop>();
+    });
+    registry.RegisterBlock("ColorConvert", []() -> BlockPtr {
+        return std::make_shared<ColorConvert>();
+    });
+    registry.RegisterBlock("Compositor", []() -> BlockPtr {
+        return std::make_shared<Compositor>();
+    });
+    registry.RegisterBlock("FrameRateConvert", []() -> BlockPtr {
+        return std::make_shared<FrameRateConvert>();
+    });
+    registry.RegisterBlock("ChangeDetect", []() -> BlockPtr {
+        return std::make_shared<ChangeDetect>();
+    });
+    registry.RegisterBlock("PreRollRecorder", []() -> BlockPtr {
+        return std::make_shared<PreRollRecorder>();
+    });
 #ifdef HAVE_LIBCAMERA
     registry.RegisterBlock("LibcameraSource", []() -> BlockPtr {
         return std::make_shared<LibcameraSource>();
@@ -196,6 +350,14 @@ int main(int argc, char* argv[]) {
     VP_LOG_INFO_F("Video Pipeline Framework v{}", Framework::GetVersion());
     VP_LOG_INFO_F("Registered {} block types", registry.GetRegisteredCount());
     
+    if (config_files.size() > 1) {
+        int result = RunHost(config_files, run_time_seconds, show_stats);
+        VP_LOG_INFO("Shutting down framework");
+        Framework::Shutdown();
+        return result;
+    }
+    std::string config_file = config_files.empty() ? std::string() : config_files[0];
+    
     // Create and initialize pipeline
     g_pipeline = std::make_unique<PipelineManager>();
     
@@ -218,6 +380,9 @@ int main(int argc, char* argv[]) {
     // Set up signal handlers
     std::signal(SIGINT, SignalHandler);
     std::signal(SIGTERM, SignalHandler);
+#ifdef SIGHUP
+    std::signal(SIGHUP, ReloadHandler);
+#endif
     
     // Start pipeline
     VP_LOG_INFO("Starting pipeline...");
@@ -243,9 +408,17 @@ int main(int argc, char* argv[]) {
             break;
         }
         
+        // Apply an edited config file to the running pipeline
+        if (g_reload_requested.exchange(false) && !config_file.empty()) {
+            VP_LOG_INFO_F("Reloading configuration from: {}", config_file);
+            if (!g_pipeline->ReloadConfiguration(config_file)) {
+                VP_LOG_ERROR_F("Configuration not applied: {}", g_pipeline->GetLastError());
+            }
+        }
+        
         // Print statistics
         if (show_stats && stats_timer.GetElapsedSeconds() >= 1.0) {
-            PrintStatistics(*g_pipeline);
+            PrintStatistics(g_pipeline->GetAllStats());
             stats_timer.Reset();
         }
     }
@@ -257,7 +430,7 @@ int main(int argc, char* argv[]) {
     // Print final statistics
     if (show_stats) {
         std::cout << "\n=== Final Statistics ===\n";
-        PrintStatistics(*g_pipeline);
+        PrintStatistics(g_pipeline->GetAllStats());
     }
     
     // Shutdown
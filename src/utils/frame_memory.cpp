@@ -0,0 +1,249 @@
+#include "utils/frame_memory.h"
+#include "video_pipeline/logger.h"
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace video_pipeline {
+
+namespace {
+
+inline size_t RoundUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+size_t PageSize() {
+    static const size_t size = [] {
+        long page = ::sysconf(_SC_PAGESIZE);
+        return page > 0 ? static_cast<size_t>(page) : size_t{4096};
+    }();
+    return size;
+}
+
+// Default huge page size from /proc/meminfo (2 MiB if unknown)
+size_t HugePageSize() {
+    static const size_t size = [] {
+        std::ifstream meminfo("/proc/meminfo");
+        std::string key;
+        size_t kb = 0;
+        while (meminfo >> key) {
+            if (key == "Hugepagesize:" && (meminfo >> kb) && kb > 0) {
+                return kb * 1024;
+            }
+            meminfo.ignore(256, '\n');
+        }
+        return size_t{2} * 1024 * 1024;
+    }();
+    return size;
+}
+
+// Logs a degraded request once per process instead of once per frame
+void WarnOnce(std::atomic<bool>& warned, const std::string& message) {
+    if (!warned.exchange(true)) {
+        VP_LOG_WARNING(message);
+    }
+}
+
+std::atomic<bool> g_hugetlb_warned{false};
+std::atomic<bool> g_mlock_warned{false};
+
+// Anonymous mapping aligned to `alignment`, so THP can back it from the first byte
+void* MapAligned(size_t size, size_t alignment) {
+    size_t length = size + alignment;
+    void* raw = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        return nullptr;
+    }
+    
+    uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+    uintptr_t aligned = RoundUp(start, alignment);
+    size_t head = aligned - start;
+    size_t tail = length - head - size;
+    if (head) {
+        ::munmap(raw, head);
+    }
+    if (tail) {
+        ::munmap(reinterpret_cast<void*>(aligned + size), tail);
+    }
+    return reinterpret_cast<void*>(aligned);
+}
+
+// Fault in every page after the huge page advice, which MAP_POPULATE would precede
+void Prefault(void* data, size_t size) {
+#ifdef MADV_POPULATE_WRITE
+    if (::madvise(data, size, MADV_POPULATE_WRITE) == 0) {
+        return;
+    }
+#endif
+    volatile uint8_t* bytes = static_cast<volatile uint8_t*>(data);
+    for (size_t offset = 0; offset < size; offset += PageSize()) {
+        bytes[offset] = 0;
+    }
+}
+
+void* MapHugeTlb(size_t size, bool prefault) {
+#ifdef MAP_HUGETLB
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (prefault ? MAP_POPULATE : 0);
+    void* data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (data != MAP_FAILED) {
+        return data;
+    }
+    WarnOnce(g_hugetlb_warned, std::string("No HugeTLB pages available (") + std::strerror(errno) +
+             "), using transparent huge pages; reserve them via /proc/sys/vm/nr_hugepages");
+#else
+    (void)size;
+    (void)prefault;
+    WarnOnce(g_hugetlb_warned, "HugeTLB is not supported, using transparent huge pages");
+#endif
+    return nullptr;
+}
+
+// memfd-backed mapping whose fd can be handed to other processes
+bool MapShareable(size_t size, PageMode pages, bool prefault, FrameMemory& memory) {
+    int fd = -1;
+    size_t length = 0;
+    void* data = MAP_FAILED;
+
+#ifdef MFD_HUGETLB
+    if (pages == PageMode::HUGETLB) {
+        length = RoundUp(size, HugePageSize());
+        fd = ::memfd_create("video_frame", MFD_CLOEXEC | MFD_HUGETLB);
+        if (fd >= 0 && ::ftruncate(fd, static_cast<off_t>(length)) == 0) {
+            data = ::mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | (prefault ? MAP_POPULATE : 0), fd, 0);
+        }
+        if (data == MAP_FAILED) {
+            WarnOnce(g_hugetlb_warned, std::string("No HugeTLB pages available (") + std::strerror(errno) +
+                     "), using transparent huge pages; reserve them via /proc/sys/vm/nr_hugepages");
+            if (fd >= 0) {
+                ::close(fd);
+                fd = -1;
+            }
+        }
+    }
+#endif
+
+    if (data == MAP_FAILED) {
+        length = RoundUp(size, pages == PageMode::DEFAULT ? PageSize() : HugePageSize());
+        fd = ::memfd_create("video_frame", MFD_CLOEXEC);
+        if (fd < 0 || ::ftruncate(fd, static_cast<off_t>(length)) < 0) {
+            VP_LOG_ERROR_F("Failed to create {} bytes of shareable frame memory: {}", length, std::strerror(errno));
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            return false;
+        }
+
+        bool populate = prefault && pages == PageMode::DEFAULT;
+        data = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED | (populate ? MAP_POPULATE : 0), fd, 0);
+        if (data == MAP_FAILED) {
+            VP_LOG_ERROR_F("Failed to map {} bytes of shareable frame memory: {}", length, std::strerror(errno));
+            ::close(fd);
+            return false;
+        }
+        if (pages != PageMode::DEFAULT) {
+#ifdef MADV_HUGEPAGE
+            // Honoured for shmem when /sys/kernel/mm/transparent_hugepage/shmem_enabled allows it
+            ::madvise(data, length, MADV_HUGEPAGE);
+#endif
+            if (prefault) {
+                Prefault(data, length);
+            }
+        }
+    }
+
+    memory.data = data;
+    memory.mapped_size = length;
+    memory.fd = fd;
+    return true;
+}
+
+} // namespace
+
+bool AllocateFrameMemory(size_t size, const FrameMemoryOptions& options, FrameMemory& memory) {
+    memory = FrameMemory{};
+    
+    if (options.IsDefault()) {
+        // 32-byte alignment for SIMD; aligned_alloc needs a size that is a multiple of it
+        memory.data = std::aligned_alloc(32, RoundUp(size, 32));
+        return memory.data != nullptr;
+    }
+    
+    bool prefault = options.prefault || options.lock;
+    
+    if (options.shareable) {
+        if (!MapShareable(size, options.pages, prefault, memory)) {
+            return false;
+        }
+    }
+    
+    if (!memory.data && options.pages == PageMode::HUGETLB) {
+        size_t length = RoundUp(size, HugePageSize());
+        if (void* data = MapHugeTlb(length, prefault)) {
+            memory.data = data;
+            memory.mapped_size = length;
+        }
+    }
+    
+    if (!memory.data && options.pages != PageMode::DEFAULT) {
+        size_t length = RoundUp(size, HugePageSize());
+        if (void* data = MapAligned(length, HugePageSize())) {
+#ifdef MADV_HUGEPAGE
+            // Fails harmlessly when THP is disabled system-wide
+            ::madvise(data, length, MADV_HUGEPAGE);
+#endif
+            if (prefault) {
+                Prefault(data, length);
+            }
+            memory.data = data;
+            memory.mapped_size = length;
+        }
+    }
+    
+    if (!memory.data) {
+        size_t length = RoundUp(size, PageSize());
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS | (prefault ? MAP_POPULATE : 0);
+        void* data = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if (data == MAP_FAILED) {
+            VP_LOG_ERROR_F("Failed to map {} bytes of frame memory: {}", length, std::strerror(errno));
+            return false;
+        }
+        memory.data = data;
+        memory.mapped_size = length;
+    }
+    
+    if (options.lock) {
+        if (::mlock(memory.data, memory.mapped_size) == 0) {
+            memory.locked = true;
+        } else {
+            WarnOnce(g_mlock_warned, std::string("Cannot lock frame memory (") + std::strerror(errno) +
+                     "); raise RLIMIT_MEMLOCK or grant CAP_IPC_LOCK");
+        }
+    }
+    return true;
+}
+
+void FreeFrameMemory(FrameMemory& memory) {
+    if (!memory.data) {
+        return;
+    }
+    
+    if (memory.mapped_size) {
+        // munmap() also drops the lock
+        ::munmap(memory.data, memory.mapped_size);
+        if (memory.fd >= 0) {
+            ::close(memory.fd);
+        }
+    } else {
+        std::free(memory.data);
+    }
+    memory = FrameMemory{};
+}
+
+} // namespace video_pipeline
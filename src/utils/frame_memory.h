@@ -0,0 +1,35 @@
+#pragma once
+
+#include "video_pipeline/buffer.h"
+#include <cstddef>
+
+/**
+ * @file frame_memory.h
+ * @brief Frame memory backends
+ *
+ * Large frames allocated from the heap are faulted in 4K page by page on
+ * first write. The mmap backends can place a frame on huge pages, fault it
+ * in up front and lock it in RAM, so capture never stalls on the kernel.
+ * Shareable frames live in a memfd whose descriptor can be passed to
+ * another process.
+ */
+
+namespace video_pipeline {
+
+/**
+ * @brief One frame allocation and how to release it
+ */
+struct FrameMemory {
+    void* data{nullptr};
+    size_t mapped_size{0};   // Length of the mapping; 0 for heap memory
+    int fd{-1};              // memfd for shareable memory
+    bool locked{false};
+};
+
+// Allocates at least `size` bytes, 32-byte aligned. Requests the system cannot
+// honour (no huge pages reserved, RLIMIT_MEMLOCK) degrade with a warning.
+// Returns false only if no memory could be obtained at all.
+bool AllocateFrameMemory(size_t size, const FrameMemoryOptions& options, FrameMemory& memory);
+void FreeFrameMemory(FrameMemory& memory);
+
+} // namespace video_pipeline
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "video_pipeline/buffer.h"
+#include "utils/plane_copy.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @file frame_planes.h
+ * @brief Plane pointer/stride resolution for uncompressed frames
+ *
+ * Frames are not required to expose every plane: zero-copy buffers (e.g.
+ * libcamera) only report plane 0 and its stride. Missing chroma planes are
+ * assumed to follow contiguously, as the capture stacks lay them out.
+ */
+
+namespace video_pipeline {
+
+template<typename Byte>
+struct FramePlanesT {
+    PixelFormat format{PixelFormat::UNKNOWN};
+    uint32_t width{0};
+    uint32_t height{0};
+    int count{0};
+    Byte* plane[3]{};
+    uint32_t stride[3]{};
+};
+
+using FramePlanes = FramePlanesT<const uint8_t>;
+using MutableFramePlanes = FramePlanesT<uint8_t>;
+
+// Bytes per pixel of the first plane (1 for planar formats), 0 if not an uncompressed format
+inline uint32_t PackedBytesPerPixel(PixelFormat format) {
+    switch (format) {
+        case PixelFormat::RGB24:
+        case PixelFormat::BGR24: return 3;
+        case PixelFormat::RGBA32:
+        case PixelFormat::BGRA32: return 4;
+        case PixelFormat::YUYV:
+        case PixelFormat::UYVY: return 2;
+        case PixelFormat::YUV420P:
+        case PixelFormat::NV12:
+        case PixelFormat::NV21: return 1;
+        default: return 0;
+    }
+}
+
+// True if `a` and `b` have the same planes and bytes per pixel and differ at
+// most in the order of the bytes of a pixel (RGB24/BGR24, YUYV/UYVY, NV12/NV21)
+inline bool SameLayout(PixelFormat a, PixelFormat b) {
+    uint32_t bpp = PackedBytesPerPixel(a);
+    return bpp != 0 && bpp == PackedBytesPerPixel(b) &&
+           (a == PixelFormat::YUV420P) == (b == PixelFormat::YUV420P);
+}
+
+template<typename Frame, typename Byte>
+bool ResolvePlanes(Frame& frame, FramePlanesT<Byte>& out) {
+    const auto& info = frame.GetFrameInfo();
+    out.format = info.pixel_format;
+    out.width = info.width;
+    out.height = info.height;
+
+    uint32_t bpp = PackedBytesPerPixel(out.format);
+    if (bpp == 0 || out.width == 0 || out.height == 0) {
+        return false;
+    }
+
+    out.plane[0] = static_cast<Byte*>(frame.GetPlaneData(0));
+    out.stride[0] = frame.GetPlaneStride(0);
+    if (!out.plane[0]) {
+        return false;
+    }
+    if (out.stride[0] < out.width * bpp) {
+        out.stride[0] = out.width * bpp;
+    }
+    out.count = 1;
+
+    uint32_t chroma_height = (out.height + 1) / 2;
+    if (out.format == PixelFormat::NV12 || out.format == PixelFormat::NV21) {
+        out.plane[1] = static_cast<Byte*>(frame.GetPlaneData(1));
+        out.stride[1] = frame.GetPlaneStride(1);
+        if (!out.plane[1]) {
+            out.plane[1] = out.plane[0] + static_cast<size_t>(out.stride[0]) * out.height;
+            out.stride[1] = out.stride[0];
+        }
+        out.count = 2;
+    } else if (out.format == PixelFormat::YUV420P) {
+        for (int p = 1; p < 3; ++p) {
+            out.plane[p] = static_cast<Byte*>(frame.GetPlaneData(p));
+            out.stride[p] = frame.GetPlaneStride(p);
+        }
+        if (!out.plane[1] || !out.plane[2]) {
+            out.stride[1] = out.stride[2] = out.stride[0] / 2;
+            out.plane[1] = out.plane[0] + static_cast<size_t>(out.stride[0]) * out.height;
+            out.plane[2] = out.plane[1] + static_cast<size_t>(out.stride[1]) * chroma_height;
+        }
+        out.count = 3;
+    }
+
+    return true;
+}
+
+// Planes of an unpadded frame stored at `data` (the CreateVideoFrame layout)
+template<typename Byte>
+bool PackedPlanes(const FrameInfo& info, Byte* data, FramePlanesT<Byte>& out) {
+    struct Packed {
+        const FrameInfo& info;
+        Byte* data;
+        const FrameInfo& GetFrameInfo() const { return info; }
+        Byte* GetPlaneData(int p) const { return (p == 0) ? data : nullptr; }
+        uint32_t GetPlaneStride(int p) const { return (p == 0) ? info.width * PackedBytesPerPixel(info.pixel_format) : 0; }
+    } frame{info, data};
+    return ResolvePlanes(frame, out);
+}
+
+// Visible bytes per row of plane p (chroma planes are subsampled 2x2)
+template<typename Byte>
+inline uint32_t PlaneRowBytes(const FramePlanesT<Byte>& f, int p) {
+    if (p == 0) {
+        return f.width * PackedBytesPerPixel(f.format);
+    }
+    return (f.format == PixelFormat::YUV420P) ? f.width / 2 : (f.width / 2) * 2;
+}
+
+template<typename Byte>
+inline uint32_t PlaneRows(const FramePlanesT<Byte>& f, int p) {
+    return (p == 0) ? f.height : f.height / 2;
+}
+
+// Bytes from plane[0] to the end of the last visible row of any plane
+template<typename Byte>
+size_t PlanesExtent(const FramePlanesT<Byte>& f) {
+    size_t extent = 0;
+    for (int p = 0; p < f.count; ++p) {
+        uint32_t rows = PlaneRows(f, p);
+        if (rows == 0) {
+            continue;
+        }
+        size_t end = static_cast<size_t>(f.plane[p] - f.plane[0]) +
+                     static_cast<size_t>(f.stride[p]) * (rows - 1) + PlaneRowBytes(f, p);
+        extent = std::max(extent, end);
+    }
+    return extent;
+}
+
+// True if the planes are unpadded and back to back, i.e. one contiguous
+// FrameInfo::GetFrameSize() byte range starting at plane[0]
+template<typename Byte>
+bool IsContiguous(const FramePlanesT<Byte>& f) {
+    for (int p = 0; p < f.count; ++p) {
+        if (f.stride[p] != PlaneRowBytes(f, p)) {
+            return false;
+        }
+        if (p > 0 && f.plane[p] != f.plane[p - 1] + static_cast<size_t>(f.stride[p - 1]) * PlaneRows(f, p - 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Call fn(row, bytes) for every visible row of every plane, in storage order
+template<typename Byte, typename Fn>
+void ForEachPlaneRow(const FramePlanesT<Byte>& f, Fn&& fn) {
+    for (int p = 0; p < f.count; ++p) {
+        const size_t row_bytes = PlaneRowBytes(f, p);
+        const uint32_t rows = PlaneRows(f, p);
+        for (uint32_t y = 0; y < rows; ++y) {
+            fn(f.plane[p] + static_cast<size_t>(y) * f.stride[p], row_bytes);
+        }
+    }
+}
+
+// Copy between frames of identical format and size with any strides. Frames
+// larger than the last-level cache are streamed past it; with a pool, large
+// planes are split into row bands.
+inline void CopyPlanes(const FramePlanes& src, const MutableFramePlanes& dst, ThreadPool* pool = nullptr) {
+    size_t total = 0;
+    for (int p = 0; p < src.count; ++p) {
+        total += static_cast<size_t>(PlaneRowBytes(src, p)) * PlaneRows(src, p);
+    }
+    const bool non_temporal = UseNonTemporalCopy(total);
+
+    for (int p = 0; p < src.count && p < dst.count; ++p) {
+        CopyRows(src.plane[p], src.stride[p], dst.plane[p], dst.stride[p],
+                 PlaneRowBytes(src, p), PlaneRows(src, p), non_temporal, pool);
+    }
+}
+
+// Write the visible rows back to back; dst must hold FrameInfo::GetFrameSize() bytes
+inline void PackPlanes(const FramePlanes& src, uint8_t* dst) {
+    ForEachPlaneRow(src, [&](const uint8_t* row, size_t bytes) {
+        std::memcpy(dst, row, bytes);
+        dst += bytes;
+    });
+}
+
+} // namespace video_pipeline
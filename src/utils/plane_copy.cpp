@@ -0,0 +1,122 @@
+#include "utils/plane_copy.h"
+#include "video_pipeline/threading.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <unistd.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace video_pipeline {
+
+namespace {
+
+// Below this a band is not worth a task switch
+constexpr size_t kMinBandBytes = 256 * 1024;
+
+size_t DetectLastLevelCacheSize() {
+    long size = -1;
+#ifdef _SC_LEVEL3_CACHE_SIZE
+    size = ::sysconf(_SC_LEVEL3_CACHE_SIZE);
+#endif
+#ifdef _SC_LEVEL2_CACHE_SIZE
+    if (size <= 0) {
+        size = ::sysconf(_SC_LEVEL2_CACHE_SIZE);
+    }
+#endif
+    return (size > 0) ? static_cast<size_t>(size) : 8u * 1024 * 1024;
+}
+
+size_t DetectL2CacheSize() {
+    long size = -1;
+#ifdef _SC_LEVEL2_CACHE_SIZE
+    size = ::sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+    return (size > 0) ? static_cast<size_t>(size) : 256u * 1024;
+}
+
+#if defined(__SSE2__)
+// Streaming copy of one row; the head up to 16-byte destination alignment
+// and the tail go through regular stores
+inline void StreamRow(const uint8_t* src, uint8_t* dst, size_t len) {
+    size_t head = (16 - (reinterpret_cast<uintptr_t>(dst) & 15)) & 15;
+    if (head >= len) {
+        std::memcpy(dst, src, len);
+        return;
+    }
+    std::memcpy(dst, src, head);
+
+    size_t i = head;
+    for (; i + 64 <= len; i += 64) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16));
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 32));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 48));
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + i), a);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + i + 16), b);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + i + 32), c);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + i + 48), d);
+    }
+    for (; i + 16 <= len; i += 16) {
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + i),
+                         _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+    }
+    std::memcpy(dst + i, src + i, len - i);
+}
+#endif
+
+void CopyBand(const uint8_t* src, size_t src_stride, uint8_t* dst, size_t dst_stride,
+              size_t row_bytes, size_t rows, bool non_temporal) {
+    // Unpadded on both sides: one block
+    if (src_stride == row_bytes && dst_stride == row_bytes) {
+        row_bytes *= rows;
+        rows = 1;
+    }
+
+#if defined(__SSE2__)
+    if (non_temporal) {
+        for (size_t y = 0; y < rows; ++y) {
+            StreamRow(src + y * src_stride, dst + y * dst_stride, row_bytes);
+        }
+        // Streaming stores are weakly ordered; publish them before the frame is handed on
+        _mm_sfence();
+        return;
+    }
+#else
+    (void)non_temporal;
+#endif
+
+    for (size_t y = 0; y < rows; ++y) {
+        std::memcpy(dst + y * dst_stride, src + y * src_stride, row_bytes);
+    }
+}
+
+} // namespace
+
+size_t LastLevelCacheSize() {
+    static const size_t size = DetectLastLevelCacheSize();
+    return size;
+}
+
+size_t L2CacheSize() {
+    static const size_t size = DetectL2CacheSize();
+    return size;
+}
+
+void CopyRows(const uint8_t* src, size_t src_stride, uint8_t* dst, size_t dst_stride,
+              size_t row_bytes, size_t rows, bool non_temporal, ThreadPool* pool) {
+    if (row_bytes == 0 || rows == 0) {
+        return;
+    }
+
+    // Bands of at least kMinBandBytes
+    size_t grain = std::max<size_t>(1, kMinBandBytes / row_bytes);
+    ParallelFor(pool, 0, rows, grain, [=](size_t begin, size_t end) {
+        CopyBand(src + begin * src_stride, src_stride, dst + begin * dst_stride, dst_stride,
+                 row_bytes, end - begin, non_temporal);
+    });
+}
+
+} // namespace video_pipeline
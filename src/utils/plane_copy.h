@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file plane_copy.h
+ * @brief Strided row copy kernels
+ *
+ * Source and destination may have different row pitches. Copies whose data
+ * does not fit in the last-level cache are written with non-temporal stores
+ * so they do not evict the working set of the pipeline (on x86-64; other
+ * targets fall back to memcpy per row).
+ */
+
+namespace video_pipeline {
+
+class ThreadPool;
+
+// Size of the last-level cache in bytes (detected once, 8 MiB if unknown)
+size_t LastLevelCacheSize();
+
+// Size of the L2 cache in bytes (detected once, 256 KiB if unknown)
+size_t L2CacheSize();
+
+// True if a copy of `bytes` should bypass the cache
+inline bool UseNonTemporalCopy(size_t bytes) {
+    return bytes > LastLevelCacheSize();
+}
+
+// Copy `rows` rows of `row_bytes` bytes. With a pool, large copies are split
+// into row bands; band 0 runs on the calling thread, which therefore must not
+// be a worker of the same pool.
+void CopyRows(const uint8_t* src, size_t src_stride, uint8_t* dst, size_t dst_stride,
+              size_t row_bytes, size_t rows, bool non_temporal, ThreadPool* pool = nullptr);
+
+} // namespace video_pipeline
@@ -0,0 +1,502 @@
+#include "video_pipeline/qoi.h"
+#include "video_pipeline/threading.h"
+#include "video_pipeline/logger.h"
+#include <algorithm>
+#include <cstring>
+#include <atomic>
+#include <vector>
+
+namespace video_pipeline {
+
+namespace {
+
+constexpr uint8_t kOpIndex = 0x00;  // 00xxxxxx
+constexpr uint8_t kOpDiff  = 0x40;  // 01xxxxxx
+constexpr uint8_t kOpLuma  = 0x80;  // 10xxxxxx
+constexpr uint8_t kOpRun   = 0xc0;  // 11xxxxxx
+constexpr uint8_t kOpRgb   = 0xfe;
+constexpr uint8_t kOpRgba  = 0xff;
+constexpr uint8_t kMask2   = 0xc0;
+
+constexpr uint32_t kMaxRun = 62;
+constexpr uint32_t kOpaqueBlack = 0xff000000u;  // r=g=b=0, a=255 (little-endian byte order)
+
+const uint8_t kEndMarker[kQoiEndMarkerSize] = {0, 0, 0, 0, 0, 0, 0, 1};
+
+// Pixels are held as uint32 with bytes in memory order r, g, b, a
+inline uint8_t R(uint32_t px) { return static_cast<uint8_t>(px); }
+inline uint8_t G(uint32_t px) { return static_cast<uint8_t>(px >> 8); }
+inline uint8_t B(uint32_t px) { return static_cast<uint8_t>(px >> 16); }
+inline uint8_t A(uint32_t px) { return static_cast<uint8_t>(px >> 24); }
+
+inline uint32_t Pack(uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+    return static_cast<uint32_t>(r) | (static_cast<uint32_t>(g) << 8) |
+           (static_cast<uint32_t>(b) << 16) | (static_cast<uint32_t>(a) << 24);
+}
+
+inline uint32_t Hash(uint32_t px) {
+    return (R(px) * 3 + G(px) * 5 + B(px) * 7 + A(px) * 11) & 63;
+}
+
+inline uint32_t LoadPixel(const uint8_t* p, uint8_t channels) {
+    if (channels == 4) {
+        return Pack(p[0], p[1], p[2], p[3]);
+    }
+    return Pack(p[0], p[1], p[2], 0xff);
+}
+
+inline void StorePixel(uint8_t* p, uint32_t px, uint8_t channels) {
+    p[0] = R(px);
+    p[1] = G(px);
+    p[2] = B(px);
+    if (channels == 4) {
+        p[3] = A(px);
+    }
+}
+
+inline void WriteBE32(uint8_t* p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v >> 24);
+    p[1] = static_cast<uint8_t>(v >> 16);
+    p[2] = static_cast<uint8_t>(v >> 8);
+    p[3] = static_cast<uint8_t>(v);
+}
+
+inline uint32_t ReadBE32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+uint8_t ChannelsForFormat(PixelFormat format) {
+    switch (format) {
+        case PixelFormat::RGB24: return 3;
+        case PixelFormat::RGBA32: return 4;
+        default: return 0;
+    }
+}
+
+// First row of band `b` when `height` rows are split into `bands` bands
+inline uint32_t BandStart(uint32_t height, size_t bands, size_t b) {
+    return static_cast<uint32_t>(static_cast<uint64_t>(height) * b / bands);
+}
+
+// Byte length of the chunk stream holding exactly `pixels` pixels, or 0 if truncated
+size_t ScanChunks(const uint8_t* data, size_t size, uint64_t pixels) {
+    size_t pos = 0;
+    uint64_t count = 0;
+    while (count < pixels) {
+        if (pos >= size) {
+            return 0;
+        }
+        uint8_t b1 = data[pos];
+        if (b1 == kOpRgb) {
+            pos += 4;
+            count += 1;
+        } else if (b1 == kOpRgba) {
+            pos += 5;
+            count += 1;
+        } else if ((b1 & kMask2) == kOpLuma) {
+            pos += 2;
+            count += 1;
+        } else if ((b1 & kMask2) == kOpRun) {
+            pos += 1;
+            count += (b1 & 0x3f) + 1;
+        } else {
+            pos += 1;
+            count += 1;
+        }
+    }
+    return (pos <= size) ? pos : 0;
+}
+
+} // anonymous namespace
+
+void QoiEncoder::Reset(uint8_t channels) {
+    channels_ = (channels == 4) ? 4 : 3;
+    prev_ = kOpaqueBlack;
+    std::memset(index_, 0, sizeof(index_));
+    run_ = 0;
+}
+
+size_t QoiEncoder::Encode(const uint8_t* pixels, size_t count, uint8_t* out) {
+    uint8_t* p = out;
+    const uint8_t channels = channels_;
+    uint32_t prev = prev_;
+    uint32_t run = run_;
+
+    for (size_t i = 0; i < count; ++i, pixels += channels) {
+        uint32_t px = LoadPixel(pixels, channels);
+
+        if (px == prev) {
+            if (++run == kMaxRun) {
+                *p++ = kOpRun | static_cast<uint8_t>(run - 1);
+                run = 0;
+            }
+            continue;
+        }
+
+        if (run > 0) {
+            *p++ = kOpRun | static_cast<uint8_t>(run - 1);
+            run = 0;
+        }
+
+        uint32_t h = Hash(px);
+        if (index_[h] == px) {
+            *p++ = kOpIndex | static_cast<uint8_t>(h);
+        } else {
+            index_[h] = px;
+
+            if (A(px) == A(prev)) {
+                int8_t vr = static_cast<int8_t>(R(px) - R(prev));
+                int8_t vg = static_cast<int8_t>(G(px) - G(prev));
+                int8_t vb = static_cast<int8_t>(B(px) - B(prev));
+                int8_t vg_r = static_cast<int8_t>(vr - vg);
+                int8_t vg_b = static_cast<int8_t>(vb - vg);
+
+                if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2) {
+                    *p++ = kOpDiff | static_cast<uint8_t>(((vr + 2) << 4) | ((vg + 2) << 2) | (vb + 2));
+                } else if (vg_r > -9 && vg_r < 8 && vg > -33 && vg < 32 && vg_b > -9 && vg_b < 8) {
+                    *p++ = kOpLuma | static_cast<uint8_t>(vg + 32);
+                    *p++ = static_cast<uint8_t>(((vg_r + 8) << 4) | (vg_b + 8));
+                } else {
+                    *p++ = kOpRgb;
+                    *p++ = R(px);
+                    *p++ = G(px);
+                    *p++ = B(px);
+                }
+            } else {
+                *p++ = kOpRgba;
+                *p++ = R(px);
+                *p++ = G(px);
+                *p++ = B(px);
+                *p++ = A(px);
+            }
+        }
+
+        prev = px;
+    }
+
+    prev_ = prev;
+    run_ = run;
+    return static_cast<size_t>(p - out);
+}
+
+size_t QoiEncoder::Finish(uint8_t* out) {
+    if (run_ == 0) {
+        return 0;
+    }
+    out[0] = kOpRun | static_cast<uint8_t>(run_ - 1);
+    run_ = 0;
+    return 1;
+}
+
+void QoiDecoder::Reset(uint8_t channels) {
+    channels_ = (channels == 4) ? 4 : 3;
+    prev_ = kOpaqueBlack;
+    std::memset(index_, 0, sizeof(index_));
+    run_ = 0;
+}
+
+size_t QoiDecoder::Decode(const uint8_t* data, size_t size, size_t& consumed,
+                          uint8_t* pixels, size_t count) {
+    const uint8_t channels = channels_;
+    uint32_t px = prev_;
+    size_t pos = 0;
+    size_t produced = 0;
+
+    while (produced < count) {
+        if (run_ > 0) {
+            size_t n = std::min<size_t>(run_, count - produced);
+            uint8_t* dst = pixels + produced * channels;
+            for (size_t i = 0; i < n; ++i, dst += channels) {
+                StorePixel(dst, px, channels);
+            }
+            run_ -= static_cast<uint32_t>(n);
+            produced += n;
+            continue;
+        }
+
+        if (pos >= size) {
+            break;
+        }
+
+        // Only consume complete chunks so a split chunk is retried with more input
+        uint8_t b1 = data[pos];
+        size_t length = (b1 == kOpRgba) ? 5 : (b1 == kOpRgb) ? 4 : ((b1 & kMask2) == kOpLuma) ? 2 : 1;
+        if (pos + length > size) {
+            break;
+        }
+
+        if (b1 == kOpRgb) {
+            px = Pack(data[pos + 1], data[pos + 2], data[pos + 3], A(px));
+        } else if (b1 == kOpRgba) {
+            px = Pack(data[pos + 1], data[pos + 2], data[pos + 3], data[pos + 4]);
+        } else {
+            switch (b1 & kMask2) {
+                case kOpIndex:
+                    px = index_[b1];
+                    break;
+                case kOpDiff:
+                    px = Pack(static_cast<uint8_t>(R(px) + ((b1 >> 4) & 0x03) - 2),
+                              static_cast<uint8_t>(G(px) + ((b1 >> 2) & 0x03) - 2),
+                              static_cast<uint8_t>(B(px) + (b1 & 0x03) - 2),
+                              A(px));
+                    break;
+                case kOpLuma: {
+                    uint8_t b2 = data[pos + 1];
+                    int vg = (b1 & 0x3f) - 32;
+                    px = Pack(static_cast<uint8_t>(R(px) + vg - 8 + ((b2 >> 4) & 0x0f)),
+                              static_cast<uint8_t>(G(px) + vg),
+                              static_cast<uint8_t>(B(px) + vg - 8 + (b2 & 0x0f)),
+                              A(px));
+                    break;
+                }
+                default:  // kOpRun: emitted at the top of the loop
+                    run_ = (b1 & 0x3f) + 1;
+                    break;
+            }
+        }
+        pos += length;
+        index_[Hash(px)] = px;
+
+        if (run_ == 0) {
+            StorePixel(pixels + produced * channels, px, channels);
+            ++produced;
+        }
+    }
+
+    prev_ = px;
+    consumed = pos;
+    return produced;
+}
+
+void WriteQoiHeader(const QoiDesc& desc, uint8_t* out) {
+    std::memcpy(out, "qoif", 4);
+    WriteBE32(out + 4, desc.width);
+    WriteBE32(out + 8, desc.height);
+    out[12] = desc.channels;
+    out[13] = desc.colorspace;
+}
+
+bool ParseQoiHeader(const uint8_t* data, size_t size, QoiDesc& desc, size_t* bands) {
+    if (!data || size < kQoiHeaderSize) {
+        return false;
+    }
+
+    size_t band_count = 1;
+    if (std::memcmp(data, "qoit", 4) == 0) {
+        if (size < kQoiBandedHeaderSize) {
+            return false;
+        }
+        band_count = (static_cast<size_t>(data[14]) << 8) | data[15];
+    } else if (std::memcmp(data, "qoif", 4) != 0) {
+        return false;
+    }
+
+    desc.width = ReadBE32(data + 4);
+    desc.height = ReadBE32(data + 8);
+    desc.channels = data[12];
+    desc.colorspace = data[13];
+
+    if (desc.width == 0 || desc.height == 0 || (desc.channels != 3 && desc.channels != 4) ||
+        band_count == 0 || band_count > kQoiMaxBands || band_count > desc.height) {
+        return false;
+    }
+
+    if (bands) {
+        *bands = band_count;
+    }
+    return true;
+}
+
+size_t QoiImageSize(const uint8_t* data, size_t size) {
+    QoiDesc desc;
+    size_t bands = 1;
+    if (!ParseQoiHeader(data, size, desc, &bands)) {
+        return 0;
+    }
+
+    size_t total;
+    if (std::memcmp(data, "qoit", 4) == 0) {
+        total = kQoiBandedHeaderSize + bands * 4;
+        if (total > size) {
+            return 0;
+        }
+        for (size_t b = 0; b < bands; ++b) {
+            total += ReadBE32(data + kQoiBandedHeaderSize + b * 4);
+        }
+    } else {
+        uint64_t pixels = static_cast<uint64_t>(desc.width) * desc.height;
+        size_t chunks = ScanChunks(data + kQoiHeaderSize, size - kQoiHeaderSize, pixels);
+        if (chunks == 0) {
+            return 0;
+        }
+        total = kQoiHeaderSize + chunks;
+    }
+
+    total += kQoiEndMarkerSize;
+    return (total <= size) ? total : 0;
+}
+
+VideoFramePtr QoiEncodeFrame(const IVideoFrame& frame, size_t bands, ThreadPool* pool) {
+    const auto& info = frame.GetFrameInfo();
+    uint8_t channels = ChannelsForFormat(info.pixel_format);
+    if (channels == 0 || info.width == 0 || info.height == 0) {
+        VP_LOG_ERROR_F("QOI encode: unsupported frame {}", info.ToString());
+        return nullptr;
+    }
+
+    const uint8_t* src = static_cast<const uint8_t*>(frame.GetPlaneData(0));
+    if (!src) {
+        return nullptr;
+    }
+    size_t row_bytes = static_cast<size_t>(info.width) * channels;
+    size_t stride = std::max<size_t>(frame.GetPlaneStride(0), row_bytes);
+
+    bands = std::clamp<size_t>(bands, 1, std::min<size_t>(info.height, kQoiMaxBands));
+    size_t header_size = (bands > 1) ? kQoiBandedHeaderSize + bands * 4 : kQoiHeaderSize;
+
+    // Each band encodes into its own worst-case region; regions are compacted afterwards
+    std::vector<size_t> offsets(bands + 1);
+    std::vector<size_t> sizes(bands);
+    offsets[0] = header_size;
+    for (size_t b = 0; b < bands; ++b) {
+        size_t rows = BandStart(info.height, bands, b + 1) - BandStart(info.height, bands, b);
+        offsets[b + 1] = offsets[b] + QoiMaxChunkBytes(rows * info.width, channels) + 1;
+    }
+
+    FrameInfo out_info;
+    out_info.width = info.width;
+    out_info.height = info.height;
+    out_info.pixel_format = PixelFormat::QOI;
+    out_info.timestamp_us = info.timestamp_us;
+    out_info.sequence_number = info.sequence_number;
+
+    auto output = CreateVideoFrame(out_info, offsets[bands] + kQoiEndMarkerSize);
+    if (!output) {
+        return nullptr;
+    }
+    uint8_t* dst = static_cast<uint8_t*>(output->GetData());
+
+    auto encode_band = [&](size_t b) {
+        QoiEncoder encoder(channels);
+        uint8_t* start = dst + offsets[b];
+        uint8_t* p = start;
+        for (uint32_t y = BandStart(info.height, bands, b); y < BandStart(info.height, bands, b + 1); ++y) {
+            p += encoder.Encode(src + y * stride, info.width, p);
+        }
+        p += encoder.Finish(p);
+        sizes[b] = static_cast<size_t>(p - start);
+    };
+
+    // The first bands run on the calling thread, the rest on the pool
+    ParallelFor(pool, 0, bands, 1, [&](size_t first, size_t last) {
+        for (size_t b = first; b < last; ++b) {
+            encode_band(b);
+        }
+    });
+
+    QoiDesc desc;
+    desc.width = info.width;
+    desc.height = info.height;
+    desc.channels = channels;
+
+    size_t pos;
+    if (bands == 1) {
+        WriteQoiHeader(desc, dst);
+        pos = header_size + sizes[0];
+    } else {
+        WriteQoiHeader(desc, dst);
+        std::memcpy(dst, "qoit", 4);
+        dst[14] = static_cast<uint8_t>(bands >> 8);
+        dst[15] = static_cast<uint8_t>(bands);
+        pos = header_size;
+        for (size_t b = 0; b < bands; ++b) {
+            WriteBE32(dst + kQoiBandedHeaderSize + b * 4, static_cast<uint32_t>(sizes[b]));
+            std::memmove(dst + pos, dst + offsets[b], sizes[b]);
+            pos += sizes[b];
+        }
+    }
+    std::memcpy(dst + pos, kEndMarker, kQoiEndMarkerSize);
+    pos += kQoiEndMarkerSize;
+
+    output->SetSize(pos);
+    return output;
+}
+
+VideoFramePtr QoiDecodeFrame(const uint8_t* data, size_t size, uint8_t channels, ThreadPool* pool,
+                             size_t* consumed) {
+    QoiDesc desc;
+    size_t bands = 1;
+    if (!ParseQoiHeader(data, size, desc, &bands)) {
+        VP_LOG_ERROR("QOI decode: invalid header");
+        return nullptr;
+    }
+    if (channels == 0) {
+        channels = desc.channels;
+    }
+
+    // Locate each band's chunk stream
+    std::vector<size_t> offsets(bands + 1);
+    if (std::memcmp(data, "qoit", 4) == 0) {
+        offsets[0] = kQoiBandedHeaderSize + bands * 4;
+        if (offsets[0] > size) {
+            VP_LOG_ERROR("QOI decode: truncated band table");
+            return nullptr;
+        }
+        for (size_t b = 0; b < bands; ++b) {
+            offsets[b + 1] = offsets[b] + ReadBE32(data + kQoiBandedHeaderSize + b * 4);
+        }
+    } else {
+        offsets[0] = kQoiHeaderSize;
+        offsets[1] = size - std::min(size, kQoiEndMarkerSize);
+    }
+    if (offsets[bands] > size) {
+        VP_LOG_ERROR("QOI decode: truncated payload");
+        return nullptr;
+    }
+
+    FrameInfo out_info;
+    out_info.width = desc.width;
+    out_info.height = desc.height;
+    out_info.pixel_format = (channels == 4) ? PixelFormat::RGBA32 : PixelFormat::RGB24;
+    out_info.stride = desc.width * channels;
+
+    auto output = CreateVideoFrame(out_info);
+    if (!output) {
+        return nullptr;
+    }
+    uint8_t* dst = static_cast<uint8_t*>(output->GetData());
+
+    std::vector<size_t> used(bands, 0);
+    auto decode_band = [&](size_t b) -> bool {
+        QoiDecoder decoder(channels);
+        size_t first = BandStart(desc.height, bands, b);
+        size_t pixels = (BandStart(desc.height, bands, b + 1) - first) * desc.width;
+        size_t produced = decoder.Decode(data + offsets[b], offsets[b + 1] - offsets[b], used[b],
+                                         dst + first * desc.width * channels, pixels);
+        return produced == pixels;
+    };
+
+    std::atomic<bool> complete{true};
+    ParallelFor(pool, 0, bands, 1, [&](size_t first, size_t last) {
+        for (size_t b = first; b < last && complete.load(std::memory_order_relaxed); ++b) {
+            if (!decode_band(b)) {
+                complete.store(false);
+            }
+        }
+    });
+    bool ok = complete.load();
+    if (!ok) {
+        VP_LOG_ERROR("QOI decode: truncated chunk stream");
+        return nullptr;
+    }
+
+    if (consumed) {
+        // A standard image ends where its chunk stream does; banded images carry their sizes
+        size_t end = (bands == 1) ? offsets[0] + used[0] : offsets[bands];
+        *consumed = std::min(size, end + kQoiEndMarkerSize);
+    }
+    return output;
+}
+
+} // namespace video_pipeline
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "utils/frame_planes.h"
+
+/**
+ * @file row_stage.h
+ * @brief Strip-wise form of a per-row transform, for transform fusion
+ *
+ * A processor that can produce any band of output rows from a band of input
+ * rows returns a RowStage from CreateRowStage(). FusedTransform runs chains
+ * of stages strip by strip, so the frames between them never exist in full.
+ * Plane sets passed to a stage hold a window of rows of a frame: `height`
+ * rows starting at a given frame row (even for 4:2:0 formats).
+ */
+
+namespace video_pipeline {
+
+// Window of `rows` rows of `planes`, starting at frame row `row`
+template<typename Byte>
+FramePlanesT<Byte> RowWindow(const FramePlanesT<Byte>& planes, uint32_t row, uint32_t rows) {
+    FramePlanesT<Byte> window = planes;
+    window.plane[0] += static_cast<size_t>(row) * planes.stride[0];
+    for (int p = 1; p < planes.count; ++p) {
+        window.plane[p] += static_cast<size_t>(row / 2) * planes.stride[p];
+    }
+    window.height = rows;
+    return window;
+}
+
+class RowStage {
+public:
+    virtual ~RowStage() = default;
+
+    // Prepare for frames of `input`; false if the stage cannot process them
+    virtual bool Configure(const FrameInfo& input) = 0;
+
+    // Output format for the configured input (same as the processor's)
+    virtual const FrameInfo& GetOutputFormat() const = 0;
+
+    // Input rows [first, last) that output rows [begin, end) are computed from
+    virtual void GetInputRows(uint32_t begin, uint32_t end, uint32_t& first, uint32_t& last) const = 0;
+
+    // Stages that only re-address their input (crops, and conversions that
+    // turn out to be identities) have no pixels to compute. View() then sets
+    // `out` to the output window seen through the input window `src`, which
+    // starts at input row `src_row`, and `out_row` to its first output row.
+    virtual bool View(const FramePlanes& /*src*/, uint32_t /*src_row*/, FramePlanes& /*out*/,
+                      uint32_t& /*out_row*/) const {
+        return false;
+    }
+
+    // True if View() always succeeds, whatever the input
+    virtual bool IsView() const { return false; }
+
+    // Compute output rows [begin, end) into `dst`, a window starting at row
+    // `begin`, from `src`, a window starting at input row `src_row` that
+    // covers GetInputRows(begin, end)
+    virtual void Run(const FramePlanes& src, uint32_t src_row, const MutableFramePlanes& dst,
+                     uint32_t begin, uint32_t end) = 0;
+};
+
+} // namespace video_pipeline
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @file simd.h
+ * @brief Portable 128-bit SIMD vector types for pixel kernels
+ *
+ * Built on GCC/Clang vector extensions so a single kernel compiles to SSE2 on
+ * x86-64 and NEON on ARM. Loads and stores go through memcpy, which compiles
+ * to unaligned vector moves and keeps kernels free of alignment assumptions.
+ */
+
+namespace video_pipeline {
+namespace simd {
+
+typedef uint8_t  u8x4  __attribute__((vector_size(4)));
+typedef uint8_t  u8x8  __attribute__((vector_size(8)));
+typedef uint8_t  u8x16 __attribute__((vector_size(16)));
+typedef int16_t  i16x8 __attribute__((vector_size(16)));
+typedef uint16_t u16x8 __attribute__((vector_size(16)));
+typedef int32_t  i32x4 __attribute__((vector_size(16)));
+typedef uint32_t u32x4 __attribute__((vector_size(16)));
+typedef float    f32x4 __attribute__((vector_size(16)));
+typedef uint64_t u64x2 __attribute__((vector_size(16)));
+
+template<typename V>
+inline V Load(const void* ptr) {
+    V v;
+    std::memcpy(&v, ptr, sizeof(V));
+    return v;
+}
+
+template<typename V>
+inline void Store(void* ptr, const V& v) {
+    std::memcpy(ptr, &v, sizeof(V));
+}
+
+// Widen 8 bytes to 16-bit lanes
+inline u16x8 LoadWiden(const uint8_t* ptr) {
+    return __builtin_convertvector(Load<u8x8>(ptr), u16x8);
+}
+
+// Narrow 16-bit lanes (already in 0..255) and store 8 bytes
+inline void StoreNarrow(uint8_t* ptr, const u16x8& v) {
+    Store(ptr, __builtin_convertvector(v, u8x8));
+}
+
+// Zero-extend the low / high 8 bytes to 16-bit lanes (interleaving with zero
+// bytes, which is a widening on little-endian targets)
+inline u16x8 WidenLow(const u8x16& v) {
+    return (u16x8)__builtin_shufflevector(v, u8x16{}, 0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+}
+
+inline u16x8 WidenHigh(const u8x16& v) {
+    return (u16x8)__builtin_shufflevector(v, u8x16{}, 8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+}
+
+// Even and odd lanes of the 16 lanes in a (0-7) and b (8-15)
+inline u16x8 EvenLanes(const u16x8& a, const u16x8& b) {
+    return __builtin_shufflevector(a, b, 0, 2, 4, 6, 8, 10, 12, 14);
+}
+
+inline u16x8 OddLanes(const u16x8& a, const u16x8& b) {
+    return __builtin_shufflevector(a, b, 1, 3, 5, 7, 9, 11, 13, 15);
+}
+
+inline bool AnyNonZero(const u8x16& v) {
+    u64x2 q = (u64x2)v;
+    return (q[0] | q[1]) != 0;
+}
+
+// Byte-wise equality, 64 bytes per step with an early exit on the first difference
+inline bool BytesEqual(const uint8_t* a, const uint8_t* b, size_t len) {
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        u8x16 diff = (Load<u8x16>(a + i) ^ Load<u8x16>(b + i)) |
+                     (Load<u8x16>(a + i + 16) ^ Load<u8x16>(b + i + 16)) |
+                     (Load<u8x16>(a + i + 32) ^ Load<u8x16>(b + i + 32)) |
+                     (Load<u8x16>(a + i + 48) ^ Load<u8x16>(b + i + 48));
+        if (AnyNonZero(diff)) {
+            return false;
+        }
+    }
+    for (; i + 16 <= len; i += 16) {
+        if (AnyNonZero(Load<u8x16>(a + i) ^ Load<u8x16>(b + i))) {
+            return false;
+        }
+    }
+    return std::memcmp(a + i, b + i, len - i) == 0;
+}
+
+} // namespace simd
+} // namespace video_pipeline
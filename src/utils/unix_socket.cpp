@@ -0,0 +1,147 @@
+#include "utils/unix_socket.h"
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace video_pipeline {
+
+namespace {
+
+bool MakeAddress(const std::string& path, sockaddr_un& addr, socklen_t& length) {
+    addr = sockaddr_un{};
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        return false;
+    }
+
+    std::memcpy(addr.sun_path, path.data(), path.size());
+    if (path[0] == '@') {
+        addr.sun_path[0] = '\0';   // Abstract namespace; the name is not NUL-terminated
+    }
+    length = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + path.size() + (path[0] == '@' ? 0 : 1));
+    return true;
+}
+
+} // anonymous namespace
+
+int ListenUnixSocket(const std::string& path, std::string& error) {
+    sockaddr_un addr;
+    socklen_t length = 0;
+    if (!MakeAddress(path, addr, length)) {
+        error = "invalid socket path '" + path + "'";
+        return -1;
+    }
+
+    int fd = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        error = std::strerror(errno);
+        return -1;
+    }
+
+    UnlinkUnixSocket(path);
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), length) < 0 || ::listen(fd, 8) < 0) {
+        error = std::strerror(errno);
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int ConnectUnixSocket(const std::string& path) {
+    sockaddr_un addr;
+    socklen_t length = 0;
+    if (!MakeAddress(path, addr, length)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    int fd = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), length) < 0) {
+        int saved = errno;
+        ::close(fd);
+        errno = saved;
+        return -1;
+    }
+    return fd;
+}
+
+void UnlinkUnixSocket(const std::string& path) {
+    if (!path.empty() && path[0] != '@') {
+        ::unlink(path.c_str());
+    }
+}
+
+bool SendWithFds(int socket_fd, const void* data, size_t size, const int* fds, size_t fd_count) {
+    if (fd_count > kMaxPassedFds) {
+        errno = EINVAL;
+        return false;
+    }
+
+    iovec iov{const_cast<void*>(data), size};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * kMaxPassedFds)];
+
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    if (fd_count > 0) {
+        msg.msg_control = control;
+        msg.msg_controllen = CMSG_SPACE(sizeof(int) * fd_count);
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fd_count);
+        std::memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * fd_count);
+    }
+
+    ssize_t sent;
+    do {
+        sent = ::sendmsg(socket_fd, &msg, MSG_NOSIGNAL);
+    } while (sent < 0 && errno == EINTR);
+    return sent == static_cast<ssize_t>(size);
+}
+
+ssize_t ReceiveWithFds(int socket_fd, void* data, size_t size, int* fds, size_t max_fds, size_t& fd_count) {
+    fd_count = 0;
+
+    iovec iov{data, size};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * kMaxPassedFds)];
+
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t received;
+    do {
+        received = ::recvmsg(socket_fd, &msg, MSG_CMSG_CLOEXEC);
+    } while (received < 0 && errno == EINTR);
+    if (received < 0) {
+        return -1;
+    }
+
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+            continue;
+        }
+        size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        const unsigned char* payload = CMSG_DATA(cmsg);
+        for (size_t i = 0; i < count; ++i) {
+            int fd;
+            std::memcpy(&fd, payload + i * sizeof(int), sizeof(int));
+            if (fd_count < max_fds) {
+                fds[fd_count++] = fd;
+            } else {
+                ::close(fd);
+            }
+        }
+    }
+    return received;
+}
+
+} // namespace video_pipeline
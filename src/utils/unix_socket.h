@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <sys/types.h>
+
+/**
+ * @file unix_socket.h
+ * @brief Local SOCK_SEQPACKET sockets with file descriptor passing
+ *
+ * Used to hand memfd/dmabuf descriptors between processes. A path starting
+ * with '@' names a socket in the Linux abstract namespace (no file is created
+ * and nothing is left behind if the process dies); anything else is a
+ * filesystem path.
+ */
+
+namespace video_pipeline {
+
+// Most descriptors carried by one message
+constexpr size_t kMaxPassedFds = 8;
+
+// Listening socket bound to `path`; a stale filesystem socket is replaced.
+// Returns -1 and sets `error` on failure.
+int ListenUnixSocket(const std::string& path, std::string& error);
+
+// Connected socket, or -1 (errno set) if nobody listens on `path`
+int ConnectUnixSocket(const std::string& path);
+
+// Removes the socket file created by ListenUnixSocket (no-op for abstract names)
+void UnlinkUnixSocket(const std::string& path);
+
+// Send one message with up to kMaxPassedFds descriptors attached
+bool SendWithFds(int socket_fd, const void* data, size_t size, const int* fds, size_t fd_count);
+
+// Receive one message. Received descriptors are stored in fds (the caller owns
+// them); extras beyond max_fds are closed. Returns the message size, 0 when
+// the peer closed, -1 on error.
+ssize_t ReceiveWithFds(int socket_fd, void* data, size_t size, int* fds, size_t max_fds, size_t& fd_count);
+
+} // namespace video_pipeline